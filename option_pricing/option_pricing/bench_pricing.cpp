@@ -0,0 +1,420 @@
+/*
+	bench_pricing.cpp
+	Benchmark of every pricing path, for tracking regressions between builds.
+
+	Usage: bench_pricing [--quick] [--out file.json] [--threads 1,2,4] [--filter text]
+		--quick    shorter runs and smaller sweeps (smoke test, noisy numbers)
+		--out      writes the JSON report to file.json instead of stdout
+		--threads  thread counts of the sweep benchmarks (default: 1, 2, 4, ... up to the hardware threads)
+		--filter   only runs benchmarks whose name contains text
+
+	Each benchmark repeats its body until it has run for at least the minimum time, five times, and
+	keeps the fastest run. The JSON report lists every result (ns/op, ops/s) and, for the sweeps, the
+	scaling curve over thread counts (time, speedup and efficiency against one thread). A readable
+	table goes to stderr.
+
+	Single thread results also get hardware counters per op (cycles, instructions, IPC, cache and
+	branch misses, see utils/PerfCounters.hpp), from one more run of as many calls as the fastest
+	run. Where counters cannot be read, the report says why and the counters are null.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "financial_instruments/EuropeanOption.hpp"
+#include "financial_instruments/AmericanPerpetualOption.hpp"
+#include "financial_instruments/OptionConstants.hpp"
+#include "financial_instruments/OptionFormulas.hpp"
+#include "financial_instruments/OptionParameter.hpp"
+#include "financial_instruments/OptionManager.hpp"
+#include "financial_instruments/OptionBatch.hpp"
+#include "financial_instruments/BatchPricer.hpp"
+#include "utils/ThreadPool.hpp"
+#include "utils/PerfCounters.hpp"
+
+using namespace std;
+using namespace Colin::FinancialInstruments;
+using namespace Colin::Utils;
+
+struct BenchResult {
+	string name;
+	string group; // formula, batch, calculate_parameter or matrix_pricer
+	size_t size; // operations per call of the body
+	size_t threads;
+	size_t calls; // calls of the body in the fastest run
+	double ns_per_op;
+	double ops_per_second;
+	bool counted; // hardware counters read (single thread runs, counters available)
+	PerfSample counters; // over calls * size operations
+};
+
+struct BenchSettings {
+	bool quick;
+	double min_seconds; // minimum length of one run
+	vector<size_t> threads;
+	string filter;
+	PerfCounters* counters;
+};
+
+static double sink_value = 0; // results are accumulated here so the compiler cannot drop the work
+
+static bool selected(const BenchSettings& settings, const string& name)
+{
+	return settings.filter.empty() || name.find(settings.filter) != string::npos;
+}
+
+// Times body (size operations per call): fastest of five runs of at least min_seconds
+static BenchResult measure(const BenchSettings& settings, const string& name, const string& group, size_t size, size_t threads, const function<double()>& body)
+{
+	sink_value += body(); // warm up: caches, pages, thread pool
+	double best = 1e300;
+	size_t best_calls = 0;
+	for (int run = 0; run < 5; run++)
+	{
+		size_t calls = 0;
+		double elapsed = 0;
+		auto start = chrono::steady_clock::now();
+		do
+		{
+			sink_value += body();
+			calls++;
+			elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		} while (elapsed < settings.min_seconds);
+		if (elapsed / calls < best)
+		{
+			best = elapsed / calls;
+			best_calls = calls;
+		}
+	}
+	BenchResult result = { name, group, size, threads, best_calls, best * 1e9 / size, size / best, false, PerfSample() };
+	fprintf(stderr, "%-52s %9zu ops %3zu threads %12.2f ns/op %14.0f ops/s", name.c_str(), size, threads, result.ns_per_op, result.ops_per_second);
+
+	// Counters only see the calling thread, so parallel runs are not counted
+	if (threads == 1 && settings.counters->available())
+	{
+		result.counters = settings.counters->measure([&]()
+		{
+			for (size_t call = 0; call < best_calls; call++) { sink_value += body(); }
+		});
+		result.counted = true;
+		size_t ops = best_calls * size;
+		fprintf(stderr, " %9.1f cyc/op %9.1f ins/op %5.2f IPC %8.3f cache-miss/op %8.3f branch-miss/op", result.counters.per_element(CyclesEvent, ops),
+			result.counters.per_element(InstructionsEvent, ops), result.counters.ipc(), result.counters.per_element(CacheMissesEvent, ops), result.counters.per_element(BranchMissesEvent, ops));
+	}
+	fprintf(stderr, "\n");
+	return result;
+}
+
+// Inputs of the scalar formulas: a spread of moneyness, maturities, vols and rates
+struct FormulaInputs {
+	vector<OptionType> type;
+	vector<double> T, K, sig, S, r, b;
+
+	FormulaInputs(size_t n)
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			double u = (i % 101) / 100.0, v = (i % 37) / 36.0;
+			type.push_back((i % 2) ? Call : Put);
+			T.push_back(0.1 + 2 * v);
+			K.push_back(100);
+			sig.push_back(0.1 + 0.4 * u);
+			S.push_back(70 + 60 * u * v + 10 * v);
+			r.push_back(0.02 + 0.06 * v);
+			b.push_back(0.01 + 0.04 * u);
+		}
+	}
+};
+
+static void bench_formulas(const BenchSettings& settings, vector<BenchResult>& results)
+{
+	const size_t n = 4096;
+	FormulaInputs in(n);
+	typedef double (*Formula)(OptionType, double, double, double, double, double, double);
+	struct { const char* name; Formula f; } formulas[] = {
+		{ "calculate_theoretical_price", calculate_theoretical_price },
+		{ "calculate_delta", calculate_delta },
+		{ "calculate_gamma", calculate_gamma },
+		{ "calculate_vega", calculate_vega },
+		{ "calculate_theta", calculate_theta },
+		{ "calculate_rho", calculate_rho },
+		{ "calculate_barone_adesi_whaley_price", calculate_barone_adesi_whaley_price },
+		{ "calculate_bjerksund_stensland_price", calculate_bjerksund_stensland_price },
+	};
+	for (const auto& formula : formulas)
+	{
+		if (!selected(settings, formula.name)) { continue; }
+		Formula f = formula.f;
+		results.push_back(measure(settings, formula.name, "formula", n, 1, [&]()
+		{
+			double sum = 0;
+			for (size_t i = 0; i < n; i++) { sum += f(in.type[i], in.T[i], in.K[i], in.sig[i], in.S[i], in.r[i], in.b[i]); }
+			return sum;
+		}));
+	}
+
+	// Divided difference approximations, with the step EuropeanOption::approximate_delta uses
+	double h = Option::get_h();
+	if (selected(settings, "calculate_delta_approximation"))
+	{
+		results.push_back(measure(settings, "calculate_delta_approximation", "formula", n, 1, [&]()
+		{
+			double sum = 0;
+			for (size_t i = 0; i < n; i++) { sum += calculate_delta_approximation(in.type[i], in.T[i], in.K[i], in.sig[i], in.S[i], in.r[i], in.b[i], h); }
+			return sum;
+		}));
+	}
+	if (selected(settings, "calculate_gamma_approximation"))
+	{
+		results.push_back(measure(settings, "calculate_gamma_approximation", "formula", n, 1, [&]()
+		{
+			double sum = 0;
+			for (size_t i = 0; i < n; i++) { sum += calculate_gamma_approximation(in.type[i], in.T[i], in.K[i], in.sig[i], in.S[i], in.r[i], in.b[i], h); }
+			return sum;
+		}));
+	}
+	if (selected(settings, "calculate_price_and_greeks"))
+	{
+		results.push_back(measure(settings, "calculate_price_and_greeks", "formula", n, 1, [&]()
+		{
+			double sum = 0;
+			for (size_t i = 0; i < n; i++) { sum += calculate_price_and_greeks(in.type[i], in.T[i], in.K[i], in.sig[i], in.S[i], in.r[i], in.b[i]).delta; }
+			return sum;
+		}));
+	}
+	if (selected(settings, "calculate_american_perpetual_theoretical_price"))
+	{
+		results.push_back(measure(settings, "calculate_american_perpetual_theoretical_price", "formula", n, 1, [&]()
+		{
+			double sum = 0;
+			for (size_t i = 0; i < n; i++) { sum += calculate_american_perpetual_theoretical_price(in.type[i], in.K[i], in.sig[i], in.S[i], in.r[i] + 0.05, in.b[i]); } // b < r: finite calls
+			return sum;
+		}));
+	}
+}
+
+static void bench_batch(const BenchSettings& settings, const vector<size_t>& sizes, vector<BenchResult>& results)
+{
+	BatchPricer pricer;
+	for (size_t n : sizes)
+	{
+		FormulaInputs in(n);
+		OptionBatch batch(European);
+		batch.reserve(n);
+		for (size_t i = 0; i < n; i++) { batch.add(in.type[i], in.S[i], in.K[i], in.T[i], in.r[i], in.sig[i], in.b[i]); }
+		vector<double> prices;
+		if (selected(settings, "BatchPricer::theoretical_prices"))
+		{
+			results.push_back(measure(settings, "BatchPricer::theoretical_prices", "batch", n, 1, [&]()
+			{
+				pricer.theoretical_prices(batch, prices);
+				return prices[n / 2];
+			}));
+		}
+	}
+}
+
+// calculate_parameter and matrix_pricer sweeps over every size and thread count
+static void bench_sweeps(const BenchSettings& settings, const vector<size_t>& sizes, vector<BenchResult>& results)
+{
+	EuropeanOption european(Call, 105, 100, 0.5, 0.1, 0.36, 0);
+	AmericanPerpetualOption perpetual(Put, 110, 100, 0.1, 0.1, 0.02);
+	struct Sweep { string name; Option* option; OptionFunctionType oft; bool greeks; };
+	vector<Sweep> sweeps = {
+		{ "European/TheoreticalPrice", &european, TheoreticalPrice, false },
+		{ "European/Delta", &european, Delta, false },
+		{ "European/ApproxGamma", &european, ApproxGamma, false },
+		{ "European/OptionGreeks", &european, TheoreticalPrice, true },
+		{ "AmericanPerpetual/TheoreticalPrice", &perpetual, TheoreticalPrice, false },
+	};
+	for (size_t threads : settings.threads)
+	{
+		OptionManager manager(threads);
+		for (size_t n : sizes)
+		{
+			OptionParameter spots(AssetPrice, ArithmeticRange, 50, 150, n);
+			vector<OptionParameter> axes = { spots, OptionParameter(Volatility, ArithmeticRange, 0.1, 0.6, n), OptionParameter(RFRate, ArithmeticRange, 0.0, 0.09, n),
+				OptionParameter(Maturity, ArithmeticRange, 0.1, 2.0, n) }; // point i sets every parameter to its i-th value
+			for (const Sweep& sweep : sweeps)
+			{
+				string name = "calculate_parameter/" + sweep.name;
+				if (selected(settings, name))
+				{
+					results.push_back(measure(settings, name, "calculate_parameter", n, threads, [&]()
+					{
+						if (sweep.greeks) { return manager.calculate_parameter(*sweep.option, spots)[n / 2].price; }
+						return manager.calculate_parameter(*sweep.option, sweep.oft, spots)[n / 2];
+					}));
+				}
+				name = "matrix_pricer/" + sweep.name;
+				if (selected(settings, name))
+				{
+					results.push_back(measure(settings, name, "matrix_pricer", n, threads, [&]()
+					{
+						if (sweep.greeks) { return manager.matrix_pricer(*sweep.option, axes)[0][n / 2].price; }
+						return manager.matrix_pricer(*sweep.option, sweep.oft, axes)[0][n / 2];
+					}));
+				}
+			}
+		}
+	}
+}
+
+static string json_number(double value) // null for NaN (missing counter)
+{
+	if (value != value) { return "null"; }
+	stringstream out;
+	out.precision(6);
+	out << value;
+	return out.str();
+}
+
+static string json_string(const string& s)
+{
+	string out = "\"";
+	for (char c : s)
+	{
+		if (c == '"' || c == '\\') { out += '\\'; }
+		out += c;
+	}
+	return out + "\"";
+}
+
+static void write_json(ostream& out, const BenchSettings& settings, const vector<BenchResult>& results)
+{
+	out.precision(6);
+	out << "{\n";
+	out << "  \"benchmark\": \"bench_pricing\",\n";
+	out << "  \"format_version\": 1,\n";
+	out << "  \"quick\": " << (settings.quick ? "true" : "false") << ",\n";
+	out << "  \"min_seconds_per_run\": " << settings.min_seconds << ",\n";
+	out << "  \"hardware_threads\": " << ThreadPool::hardware_threads() << ",\n";
+	const char* simd[] = { "scalar", "avx2", "avx512" }; // SimdInstructionSet
+	out << "  \"simd\": \"" << simd[BatchPricer::supported_instruction_set()] << "\",\n";
+#if defined(__VERSION__)
+	out << "  \"compiler\": " << json_string(__VERSION__) << ",\n";
+#elif defined(_MSC_FULL_VER)
+	out << "  \"compiler\": \"MSVC " << _MSC_FULL_VER << "\",\n";
+#endif
+	PerfCounters& counters = *settings.counters;
+	out << "  \"perf_counters\": {\"available\": " << (counters.available() ? "true" : "false") << ", \"events\": [";
+	for (int e = 0, first = 1; e < PerfEventCount; e++)
+	{
+		if (!counters.available((PerfEvent)e)) { continue; }
+		out << (first ? "" : ", ") << json_string(PerfCounters::event_name((PerfEvent)e));
+		first = 0;
+	}
+	out << "], \"unavailable_reason\": " << json_string(counters.unavailable_reason()) << "},\n";
+	out << "  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult& r = results[i];
+		out << "    {\"name\": " << json_string(r.name) << ", \"group\": " << json_string(r.group) << ", \"size\": " << r.size << ", \"threads\": " << r.threads
+			<< ", \"calls\": " << r.calls << ", \"ns_per_op\": " << r.ns_per_op << ", \"ops_per_second\": " << r.ops_per_second << ", \"counters\": ";
+		if (r.counted)
+		{
+			size_t ops = r.calls * r.size;
+			out << "{\"cycles_per_op\": " << json_number(r.counters.per_element(CyclesEvent, ops)) << ", \"instructions_per_op\": " << json_number(r.counters.per_element(InstructionsEvent, ops))
+				<< ", \"ipc\": " << json_number(r.counters.ipc()) << ", \"cache_misses_per_op\": " << json_number(r.counters.per_element(CacheMissesEvent, ops))
+				<< ", \"branch_misses_per_op\": " << json_number(r.counters.per_element(BranchMissesEvent, ops)) << "}";
+		}
+		else { out << "null"; }
+		out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  ],\n";
+
+	// Scaling curves: the same sweep and size over every thread count, against its one thread time
+	out << "  \"scaling\": [\n";
+	bool first = true;
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult& base = results[i];
+		if (base.threads != settings.threads.front() || (base.group != "calculate_parameter" && base.group != "matrix_pricer")) { continue; }
+		vector<const BenchResult*> curve;
+		for (const BenchResult& r : results)
+		{
+			if (r.name == base.name && r.size == base.size) { curve.push_back(&r); }
+		}
+		out << (first ? "" : ",\n") << "    {\"name\": " << json_string(base.name) << ", \"size\": " << base.size << ", \"points\": [";
+		for (size_t k = 0; k < curve.size(); k++)
+		{
+			double speedup = base.ns_per_op / curve[k]->ns_per_op * base.threads;
+			out << (k ? ", " : "") << "{\"threads\": " << curve[k]->threads << ", \"ns_per_op\": " << curve[k]->ns_per_op << ", \"speedup\": " << speedup
+				<< ", \"efficiency\": " << speedup / curve[k]->threads << "}";
+		}
+		out << "]}";
+		first = false;
+	}
+	out << (first ? "" : "\n") << "  ]\n";
+	out << "}\n";
+}
+
+int main(int argc, char** argv)
+{
+	PerfCounters counters;
+	BenchSettings settings = { false, 0.1, {}, "", &counters };
+	string out_path;
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg == "--quick") { settings.quick = true; }
+		else if (arg == "--out" && i + 1 < argc) { out_path = argv[++i]; }
+		else if (arg == "--filter" && i + 1 < argc) { settings.filter = argv[++i]; }
+		else if (arg == "--threads" && i + 1 < argc)
+		{
+			stringstream list(argv[++i]);
+			string item;
+			while (getline(list, item, ','))
+			{
+				size_t threads = strtoul(item.c_str(), nullptr, 10);
+				if (threads == 0)
+				{
+					cerr << "Invalid thread count: " << item << endl;
+					return 1;
+				}
+				settings.threads.push_back(threads);
+			}
+		}
+		else
+		{
+			cerr << "Invalid argument: " << arg << "\nUsage: bench_pricing [--quick] [--out file.json] [--threads 1,2,4] [--filter text]" << endl;
+			return 1;
+		}
+	}
+	if (settings.threads.empty())
+	{
+		for (size_t threads = 1; threads < ThreadPool::hardware_threads(); threads *= 2) { settings.threads.push_back(threads); }
+		settings.threads.push_back(ThreadPool::hardware_threads());
+	}
+	sort(settings.threads.begin(), settings.threads.end());
+	settings.threads.erase(unique(settings.threads.begin(), settings.threads.end()), settings.threads.end());
+	if (settings.quick) { settings.min_seconds = 0.005; }
+	vector<size_t> sizes = settings.quick ? vector<size_t>{ 1024, 16384 } : vector<size_t>{ 1024, 16384, 262144, 1048576 };
+
+	if (!counters.available()) { fprintf(stderr, "Hardware counters unavailable: %s\n", counters.unavailable_reason().c_str()); }
+
+	vector<BenchResult> results;
+	bench_formulas(settings, results);
+	bench_batch(settings, sizes, results);
+	bench_sweeps(settings, sizes, results);
+
+	if (out_path.empty()) { write_json(cout, settings, results); }
+	else
+	{
+		ofstream file(out_path);
+		if (!file)
+		{
+			cerr << "Invalid output path: " << out_path << endl;
+			return 1;
+		}
+		write_json(file, settings, results);
+	}
+	fprintf(stderr, "(checksum %g)\n", sink_value);
+	return 0;
+}
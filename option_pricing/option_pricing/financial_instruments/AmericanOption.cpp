@@ -0,0 +1,129 @@
+/*
+* AmericanOption.cpp
+* Defines the AmericanOption class methods
+*/
+
+
+// Standard Libraries
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <iostream>
+
+// Custom header
+#include "Option.hpp"
+#include "AmericanOption.hpp"
+#include "OptionConstants.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		AmericanOption::AmericanOption() : Option::Option() {} // Default constructor
+		AmericanOption::AmericanOption(OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc) : Option::Option(t, ap, sp, ttm, rf, vol, cc) {}
+		AmericanOption::AmericanOption(OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc, const LatticeEngine& le) : Option::Option(t, ap, sp, ttm, rf, vol, cc), m_engine(le) {}
+
+		AmericanOption::AmericanOption(const AmericanOption& ao) : Option::Option(ao), m_engine(ao.m_engine) {} // Copy constructor
+		AmericanOption::~AmericanOption() {} // Destructor
+
+		AmericanOption& AmericanOption::operator = (const AmericanOption& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			Option::operator=(source);
+			m_engine = source.m_engine;
+			return *this; // return current object's pointer
+		}
+
+		// Returns type of option class
+		OptionClass AmericanOption::option_class() const
+		{
+			return AmericanFinite;
+		}
+
+		PricingModel AmericanOption::pricing_model() const
+		{
+			return LatticeModel;
+		}
+
+		// Returns heap allocated copy with its own lattice buffers, used to price on several threads at once
+		Option* AmericanOption::clone() const
+		{
+			return new AmericanOption(*this);
+		}
+
+		void AmericanOption::set_engine(const LatticeEngine& le) { m_engine = le; }
+		const LatticeEngine& AmericanOption::engine() const { return m_engine; }
+
+		// Returns custom theoretical price, derived from Option class
+		double AmericanOption::theoretical_price() const
+		{
+			return m_engine.price(
+				this->option_type(),
+				this->time_to_maturity(),
+				this->strike_price(),
+				this->volatility(),
+				this->current_price(),
+				this->risk_free_rate(),
+				this->cost_of_carry()
+			);
+		}
+
+		OptionSensitivities AmericanOption::sensitivities() const
+		{
+			return m_engine.sensitivities(
+				this->option_type(),
+				this->time_to_maturity(),
+				this->strike_price(),
+				this->volatility(),
+				this->current_price(),
+				this->risk_free_rate(),
+				this->cost_of_carry()
+			);
+		}
+
+		double AmericanOption::delta() const { return sensitivities().get(AssetPrice); }
+		double AmericanOption::gamma() const { return bumped_second_derivative(AssetPrice, 0.01 * this->current_price()); }
+		double AmericanOption::vega() const { return sensitivities().get(Volatility); }
+		double AmericanOption::theta() const { return -sensitivities().get(Maturity); }
+		double AmericanOption::rho() const
+		{
+			OptionSensitivities s = sensitivities();
+			return s.get(RFRate) + s.get(CostOfCarry); // carry moving with the rate, as the Black-Scholes rho
+		}
+
+		// Returns price and all greeks of the lattice, derived from Option class
+		OptionGreeks AmericanOption::greeks() const
+		{
+			OptionSensitivities s = sensitivities();
+			OptionGreeks g;
+			g.price = s.price;
+			g.delta = s.get(AssetPrice);
+			g.gamma = bumped_second_derivative(AssetPrice, 0.01 * this->current_price(), s.price); // the lattice already priced the center
+			g.vega = s.get(Volatility);
+			g.theta = -s.get(Maturity);
+			g.rho = s.get(RFRate) + s.get(CostOfCarry);
+			return g;
+		}
+
+
+		// overloading << Operator for printing out American Option as String
+		ostream& operator << (ostream& os, const AmericanOption& ao)
+		{
+			string optionType;
+			optionType = ao.option_type();
+			os << "\nAmerican Option (" << optionType << "):" << endl; // We can access private elements due to friend
+			os << "Price: " << ao.current_price() << endl;
+			os << "Strike: " << ao.strike_price() << endl;
+			os << "Time to Maturity: " << ao.time_to_maturity() << endl;
+			os << "Volatility: " << ao.volatility() << endl;
+			os << "Lattice Steps: " << ao.engine().steps() << endl;
+			os << "Theoretical Price: " << ao.theoretical_price() << endl;
+			return os; // display the Option
+		}
+
+	}
+}
@@ -0,0 +1,70 @@
+/*
+* AmericanOption.hpp
+* Provides template methods for finite maturity American Options,
+* priced on the lattice of a LatticeEngine
+*/
+#ifndef AMERICAN_OPTION_HPP // Verify we have unique HPP file reference
+#define AMERICAN_OPTION_HPP // Name the file AMERICAN_OPTION_HPP
+
+#include <string>
+#include <iostream>
+
+
+// Custom HPP files
+#include "Option.hpp"
+#include "OptionConstants.hpp"
+#include "OptionParameter.hpp"
+#include "OptionFormulas.hpp"
+#include "LatticeEngine.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+		class AmericanOption : public Option
+		{
+		public:
+			AmericanOption(); // Default constructor: initializes a default American Option
+
+			// Constructor with the default lattice engine
+			AmericanOption(OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc);
+
+			// Constructor pricing on a copy of the given lattice engine settings
+			AmericanOption(OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc, const LatticeEngine& le);
+
+			AmericanOption(const AmericanOption& ao);  // Copy constructor for American Option
+			~AmericanOption(); // Destructor: called when American Option
+
+			// Operators
+			AmericanOption& operator = (const AmericanOption& source); // Assignment operator.
+
+			OptionClass option_class() const; // Returns class of option
+			PricingModel pricing_model() const; // Returns model of the price
+			Option* clone() const; // Returns heap allocated copy of the option
+
+			void set_engine(const LatticeEngine& le); // Copies the lattice settings (steps, corrections)
+			const LatticeEngine& engine() const; // Lattice used for pricing
+
+			// Calculates the American Theoretical Price on the lattice
+			double theoretical_price() const;
+
+			// Greeks of the lattice price: first order ones from one adjoint sweep (LatticeEngine::sensitivities),
+			// gamma from bumps of the spot by 1% (about the node spacing of the lattice)
+			double delta() const;
+			double gamma() const;
+			double vega() const;
+			double theta() const;
+			double rho() const;
+			OptionGreeks greeks() const; // One adjoint sweep and the gamma bumps
+
+			// String Methods
+			friend ostream& operator << (ostream& os, const AmericanOption& ao); // overloading << Operator for printing out AmericanOption as String
+
+		private:
+			OptionSensitivities sensitivities() const; // Lattice price and its derivative in every parameter
+
+			mutable LatticeEngine m_engine; // holds reusable buffers, so pricing stays const
+		};
+	}
+}
+#endif // !AMERICAN_OPTION_HPP
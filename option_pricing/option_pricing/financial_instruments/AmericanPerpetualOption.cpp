@@ -42,6 +42,17 @@ namespace Colin {
 			return American;
 		}
 
+		PricingModel AmericanPerpetualOption::pricing_model() const
+		{
+			return PerpetualModel;
+		}
+
+		// Returns heap allocated copy, used to price on several threads at once
+		Option* AmericanPerpetualOption::clone() const
+		{
+			return new AmericanPerpetualOption(*this);
+		}
+
 		// Returns custom theoretical price, derived from Option class
 		double AmericanPerpetualOption::theoretical_price() const
 		{
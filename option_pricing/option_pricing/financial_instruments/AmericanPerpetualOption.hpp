@@ -39,6 +39,8 @@ namespace Colin {
 			//bool valid_option(const AmericanOption& eo) const; // Returns if the two options have valid put call parity
 
 			OptionClass option_class() const; // Returns class of option
+			PricingModel pricing_model() const; // Returns model of the price
+			Option* clone() const; // Returns heap allocated copy of the option
 
 			// Calculates the American Theoretical Price according to Black-Scholes option model
 			double theoretical_price() const;
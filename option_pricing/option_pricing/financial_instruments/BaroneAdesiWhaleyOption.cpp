@@ -0,0 +1,93 @@
+/*
+* BaroneAdesiWhaleyOption.cpp
+* Defines the BaroneAdesiWhaleyOption class methods
+*/
+
+
+// Standard Libraries
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <iostream>
+
+// Custom header
+#include "Option.hpp"
+#include "BaroneAdesiWhaleyOption.hpp"
+#include "OptionConstants.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		BaroneAdesiWhaleyOption::BaroneAdesiWhaleyOption() : Option::Option() {} // Default constructor
+		BaroneAdesiWhaleyOption::BaroneAdesiWhaleyOption(OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc) : Option::Option(t, ap, sp, ttm, rf, vol, cc) {}
+
+		BaroneAdesiWhaleyOption::BaroneAdesiWhaleyOption(const BaroneAdesiWhaleyOption& bawo) : Option::Option(bawo) {}
+		BaroneAdesiWhaleyOption::~BaroneAdesiWhaleyOption() {} // Destructor
+
+		BaroneAdesiWhaleyOption& BaroneAdesiWhaleyOption::operator = (const BaroneAdesiWhaleyOption& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			Option::operator=(source);
+			return *this; // return current object's pointer
+		}
+
+		// Returns the class of option
+		OptionClass BaroneAdesiWhaleyOption::option_class() const
+		{
+			return AmericanFinite;
+		}
+
+		PricingModel BaroneAdesiWhaleyOption::pricing_model() const
+		{
+			return BaroneAdesiWhaleyModel;
+		}
+
+		// Returns heap allocated copy, used to price on several threads at once
+		Option* BaroneAdesiWhaleyOption::clone() const
+		{
+			return new BaroneAdesiWhaleyOption(*this);
+		}
+
+		// Returns custom theoretical price, derived from Option class
+		double BaroneAdesiWhaleyOption::theoretical_price() const
+		{
+			return calculate_barone_adesi_whaley_price(
+				this->option_type(),
+				this->time_to_maturity(),
+				this->strike_price(),
+				this->volatility(),
+				this->current_price(),
+				this->risk_free_rate(),
+				this->cost_of_carry()
+			);
+		}
+
+
+		double BaroneAdesiWhaleyOption::delta() const { return bumped_derivative(AssetPrice, bump_step(AssetPrice, 1e-4)); }
+		double BaroneAdesiWhaleyOption::gamma() const { return bumped_second_derivative(AssetPrice, 0.01 * this->current_price()); }
+		double BaroneAdesiWhaleyOption::vega() const { return bumped_derivative(Volatility, bump_step(Volatility, 1e-4)); }
+		double BaroneAdesiWhaleyOption::theta() const { return -bumped_derivative(Maturity, bump_step(Maturity, 1e-4)); }
+		double BaroneAdesiWhaleyOption::rho() const { return bumped_derivative(RFRate, bump_step(RFRate, 1e-4)); } // carry moving with the rate
+
+
+		// overloading << Operator for printing out Barone-Adesi Whaley Option as String
+		ostream& operator << (ostream& os, const BaroneAdesiWhaleyOption& bawo)
+		{
+			string optionType;
+			optionType = bawo.option_type();
+			os << "\nBarone-Adesi Whaley Option (" << optionType << "):" << endl; // We can access private elements due to friend
+			os << "Price: " << bawo.current_price() << endl;
+			os << "Strike: " << bawo.strike_price() << endl;
+			os << "Time to Maturity: " << bawo.time_to_maturity() << endl;
+			os << "Volatility: " << bawo.volatility() << endl;
+			os << "Theoretical Price: " << bawo.theoretical_price() << endl;
+			return os; // display the Option
+		}
+
+	}
+}
\ No newline at end of file
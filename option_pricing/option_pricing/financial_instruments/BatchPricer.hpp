@@ -0,0 +1,74 @@
+/*
+* BatchPricer.hpp
+* Provides template methods for the Batch Pricer: prices whole
+* structure-of-arrays books with AVX2/AVX-512 kernels, picking the widest
+* instruction set the CPU supports at runtime (scalar fallback otherwise).
+*
+* Tolerance against the scalar formulas (the kernels use the branch-free
+* exp/log/normal CDF of utils/SimdMath.hpp instead of std/boost):
+* European: |batch - calculate_theoretical_price| <= 1e-10 * (S + K)
+*           (european_greeks: every greek within 1e-10 of calculate_price_and_greeks, relative to max(1, |greek|))
+* American Perpetual: |batch - calculate_american_perpetual_theoretical_price|
+*                     <= 1e-10 * max(1, |price|)
+* Barone-Adesi & Whaley, Bjerksund & Stensland: |batch - scalar formula|
+*                     <= 1e-10 * (S + K)
+*/
+#ifndef BATCH_PRICER_HPP // Verify we have unique HPP file reference
+#define BATCH_PRICER_HPP // Name the file BATCH_PRICER_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "OptionBatch.hpp"
+#include "PriceCache.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		enum SimdInstructionSet {
+			ScalarInstructions,
+			AVX2Instructions,
+			AVX512Instructions,
+		};
+
+		class BatchPricer
+		{
+		public:
+			BatchPricer(); // Default constructor: selects widest supported instruction set
+			BatchPricer(SimdInstructionSet is); // Constructor forcing an instruction set (clamped to what is supported)
+			BatchPricer(const BatchPricer& bp);  // Copy constructor for Batch Pricer
+			~BatchPricer(); // Destructor: called when Batch Pricer gets removed from memory
+
+			// Operators
+			BatchPricer& operator = (const BatchPricer& source); // Assignment operator.
+
+			void set_instruction_set(SimdInstructionSet is); // Selects kernels, falls back if unsupported
+			SimdInstructionSet instruction_set() const; // Kernels currently in use
+			static SimdInstructionSet supported_instruction_set(); // Widest instruction set usable on this CPU and build
+
+			// Prices every option of the batch according to its option class
+			vector<double> theoretical_prices(const OptionBatch& batch) const;
+			void theoretical_prices(const OptionBatch& batch, vector<double>& out) const; // Same, writing into out (resized)
+			void theoretical_prices(const OptionBatch& batch, vector<double>& out, PriceCache& cache) const; // Same, only pricing options missing from cache
+
+			// Raw array entry points, parameter order follows OptionFormulas.hpp
+			void european_prices(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n) const;
+			void american_perpetual_prices(const OptionType* type, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n) const;
+			void european_greeks(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b,
+				double* price, double* delta, double* gamma, double* vega, double* theta, double* rho, size_t n) const; // price and every greek, one column each
+
+			// Finite maturity american approximations (see BaroneAdesiWhaleyOption.hpp, BjerksundStenslandOption.hpp)
+			void barone_adesi_whaley_prices(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n) const;
+			void bjerksund_stensland_prices(const OptionType* type, const double* T, const double* K, const double* sig, const double* S, const double* r, const double* b, double* out, size_t n) const;
+
+		private:
+			SimdInstructionSet m_instruction_set; // kernels used for pricing
+		};
+	}
+}
+#endif // !BATCH_PRICER_HPP
@@ -0,0 +1,93 @@
+/*
+* BjerksundStenslandOption.cpp
+* Defines the BjerksundStenslandOption class methods
+*/
+
+
+// Standard Libraries
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <iostream>
+
+// Custom header
+#include "Option.hpp"
+#include "BjerksundStenslandOption.hpp"
+#include "OptionConstants.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		BjerksundStenslandOption::BjerksundStenslandOption() : Option::Option() {} // Default constructor
+		BjerksundStenslandOption::BjerksundStenslandOption(OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc) : Option::Option(t, ap, sp, ttm, rf, vol, cc) {}
+
+		BjerksundStenslandOption::BjerksundStenslandOption(const BjerksundStenslandOption& bso) : Option::Option(bso) {}
+		BjerksundStenslandOption::~BjerksundStenslandOption() {} // Destructor
+
+		BjerksundStenslandOption& BjerksundStenslandOption::operator = (const BjerksundStenslandOption& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			Option::operator=(source);
+			return *this; // return current object's pointer
+		}
+
+		// Returns the class of option
+		OptionClass BjerksundStenslandOption::option_class() const
+		{
+			return AmericanFinite;
+		}
+
+		PricingModel BjerksundStenslandOption::pricing_model() const
+		{
+			return BjerksundStenslandModel;
+		}
+
+		// Returns heap allocated copy, used to price on several threads at once
+		Option* BjerksundStenslandOption::clone() const
+		{
+			return new BjerksundStenslandOption(*this);
+		}
+
+		// Returns custom theoretical price, derived from Option class
+		double BjerksundStenslandOption::theoretical_price() const
+		{
+			return calculate_bjerksund_stensland_price(
+				this->option_type(),
+				this->time_to_maturity(),
+				this->strike_price(),
+				this->volatility(),
+				this->current_price(),
+				this->risk_free_rate(),
+				this->cost_of_carry()
+			);
+		}
+
+
+		double BjerksundStenslandOption::delta() const { return bumped_derivative(AssetPrice, bump_step(AssetPrice, 1e-4)); }
+		double BjerksundStenslandOption::gamma() const { return bumped_second_derivative(AssetPrice, 0.01 * this->current_price()); }
+		double BjerksundStenslandOption::vega() const { return bumped_derivative(Volatility, bump_step(Volatility, 1e-4)); }
+		double BjerksundStenslandOption::theta() const { return -bumped_derivative(Maturity, bump_step(Maturity, 1e-4)); }
+		double BjerksundStenslandOption::rho() const { return bumped_derivative(RFRate, bump_step(RFRate, 1e-4)); } // carry moving with the rate
+
+
+		// overloading << Operator for printing out Bjerksund Stensland Option as String
+		ostream& operator << (ostream& os, const BjerksundStenslandOption& bso)
+		{
+			string optionType;
+			optionType = bso.option_type();
+			os << "\nBjerksund Stensland Option (" << optionType << "):" << endl; // We can access private elements due to friend
+			os << "Price: " << bso.current_price() << endl;
+			os << "Strike: " << bso.strike_price() << endl;
+			os << "Time to Maturity: " << bso.time_to_maturity() << endl;
+			os << "Volatility: " << bso.volatility() << endl;
+			os << "Theoretical Price: " << bso.theoretical_price() << endl;
+			return os; // display the Option
+		}
+
+	}
+}
\ No newline at end of file
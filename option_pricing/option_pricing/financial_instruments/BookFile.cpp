@@ -0,0 +1,415 @@
+/*
+* BookFile.cpp
+* Defines the BookWriter and MappedBook class methods
+*/
+
+
+// Standard Libraries
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+
+// Custom header
+#include "BookFile.hpp"
+#include "OptionConstants.hpp"
+#include "OptionBatch.hpp"
+#include "InstrumentBook.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		static const char BOOK_FILE_MAGIC[8] = { 'O', 'P', 'T', 'B', 'O', 'O', 'K', 0 };
+		static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+		static const size_t COLUMN_ALIGNMENT = 64;
+		static const size_t CHUNK_SIZE = 1024; // Contracts whose type bits are expanded at once
+
+		// The file is little-endian and its structs are written and mapped as they are in memory
+		static bool little_endian_host()
+		{
+			uint32_t probe = 1;
+			unsigned char first;
+			memcpy(&first, &probe, 1);
+			return first == 1;
+		}
+
+		static size_t bitmap_words(size_t count) { return (count + 63) / 64; }
+		static size_t align_column(size_t offset) { return (offset + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT; }
+
+		static BookColumnKind column_kind(BookColumn id) { return (id <= AmericanFiniteBits) ? BitmapColumn : Float64Column; }
+
+		BookWriter::BookWriter() : m_count(0) {}
+		BookWriter::BookWriter(size_t count) : m_count(count) {}
+		BookWriter::BookWriter(const BookWriter& bw) : m_count(bw.m_count), m_columns(bw.m_columns) {}
+		BookWriter::~BookWriter() {}
+
+		BookWriter& BookWriter::operator = (const BookWriter& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			m_count = source.m_count;
+			m_columns = source.m_columns;
+			return *this; // return current object's pointer
+		}
+
+		void BookWriter::add_column(BookColumn id, const double* values) { add_column(id, values, sizeof(double)); }
+
+		void BookWriter::add_column(BookColumn id, const double* values, size_t stride)
+		{
+			if (id < 0 || id >= BookColumnCount || column_kind(id) != Float64Column)
+			{
+				cout << "Invalid Book Column" << endl;
+				return;
+			}
+			Column c;
+			c.id = id;
+			c.kind = Float64Column;
+			c.data = (const char*)values;
+			c.stride = stride;
+			m_columns.push_back(c);
+		}
+
+		void BookWriter::add_bits(BookColumn id, const uint64_t* words)
+		{
+			if (id < 0 || id >= BookColumnCount || column_kind(id) != BitmapColumn)
+			{
+				cout << "Invalid Book Column" << endl;
+				return;
+			}
+			Column c;
+			c.id = id;
+			c.kind = BitmapColumn;
+			c.data = (const char*)words;
+			c.stride = sizeof(uint64_t);
+			m_columns.push_back(c);
+		}
+
+		size_t BookWriter::size() const { return m_count; }
+
+		bool BookWriter::write(const string& path) const
+		{
+			if (!little_endian_host())
+			{
+				cout << "Invalid byte order: book files are little-endian" << endl;
+				return false;
+			}
+			ofstream file(path.c_str(), ios::binary | ios::trunc);
+			if (!file)
+			{
+				cout << "Invalid book file path: " << path << endl;
+				return false;
+			}
+
+			BookFileHeader header;
+			memset(&header, 0, sizeof(header));
+			memcpy(header.magic, BOOK_FILE_MAGIC, sizeof(header.magic));
+			header.version = BOOK_FILE_VERSION;
+			header.byte_order = BYTE_ORDER_MARK;
+			header.count = m_count;
+			header.column_count = m_columns.size();
+
+			// Directory: columns follow each other on 64-byte boundaries
+			vector<BookFileColumn> directory(m_columns.size());
+			size_t offset = align_column(sizeof(BookFileHeader) + directory.size() * sizeof(BookFileColumn));
+			for (size_t j = 0; j < m_columns.size(); j++)
+			{
+				directory[j].id = m_columns[j].id;
+				directory[j].kind = m_columns[j].kind;
+				directory[j].offset = offset;
+				directory[j].bytes = (m_columns[j].kind == BitmapColumn) ? bitmap_words(m_count) * sizeof(uint64_t) : m_count * sizeof(double);
+				offset = align_column(offset + directory[j].bytes);
+			}
+			file.write((const char*)&header, sizeof(header));
+			if (!directory.empty()) { file.write((const char*)directory.data(), directory.size() * sizeof(BookFileColumn)); }
+
+			// Columns, strided ones gathered through a buffer
+			const char padding[COLUMN_ALIGNMENT] = { 0 };
+			vector<double> buffer(CHUNK_SIZE);
+			size_t position = sizeof(BookFileHeader) + directory.size() * sizeof(BookFileColumn);
+			for (size_t j = 0; j < m_columns.size(); j++)
+			{
+				file.write(padding, directory[j].offset - position);
+				const Column& c = m_columns[j];
+				if (c.kind == BitmapColumn || c.stride == sizeof(double))
+				{
+					file.write(c.data, directory[j].bytes);
+				}
+				else
+				{
+					for (size_t first = 0; first < m_count; first += CHUNK_SIZE)
+					{
+						size_t n = min(CHUNK_SIZE, m_count - first);
+						for (size_t i = 0; i < n; i++) { memcpy(&buffer[i], c.data + (first + i) * c.stride, sizeof(double)); }
+						file.write((const char*)buffer.data(), n * sizeof(double));
+					}
+				}
+				position = directory[j].offset + directory[j].bytes;
+			}
+			file.flush();
+			if (!file)
+			{
+				cout << "Invalid book file path: " << path << endl;
+				return false;
+			}
+			return true;
+		}
+
+		bool write_book(const string& path, const OptionBatch& batch)
+		{
+			size_t n = batch.size();
+			vector<uint64_t> words[4]; // type, then one bitmap per class
+			for (int j = 0; j < 4; j++) { words[j].assign(bitmap_words(n), 0); }
+			for (size_t i = 0; i < n; i++)
+			{
+				if (batch.type[i] == Call) { words[TypeBits][i / 64] |= (uint64_t)1 << (i % 64); }
+			}
+			words[EuropeanBits + batch.option_class()].assign(bitmap_words(n), ~(uint64_t)0);
+			if (n % 64 != 0 && n > 0) { words[EuropeanBits + batch.option_class()].back() = ((uint64_t)1 << (n % 64)) - 1; } // no bits past the last contract
+
+			BookWriter writer(n);
+			for (int j = 0; j < 4; j++) { writer.add_bits((BookColumn)j, words[j].data()); }
+			writer.add_column(SpotColumn, batch.S.data());
+			writer.add_column(StrikeColumn, batch.K.data());
+			writer.add_column(MaturityColumn, batch.T.data());
+			writer.add_column(RateColumn, batch.r.data());
+			writer.add_column(VolatilityColumn, batch.sig.data());
+			writer.add_column(CarryColumn, batch.b.data());
+			return writer.write(path);
+		}
+
+		bool write_book(const string& path, const InstrumentBook& book)
+		{
+			static const InstrumentRecord empty = InstrumentRecord(); // column addresses of an empty book
+			size_t n = book.size();
+			const InstrumentRecord* records = (n > 0) ? book.data() : &empty;
+			vector<uint64_t> words[4];
+			for (int j = 0; j < 4; j++) { words[j].assign(bitmap_words(n), 0); }
+			for (size_t i = 0; i < n; i++)
+			{
+				uint64_t bit = (uint64_t)1 << (i % 64);
+				if (records[i].type == Call) { words[TypeBits][i / 64] |= bit; }
+				if (records[i].option_class <= AmericanFinite) { words[EuropeanBits + records[i].option_class][i / 64] |= bit; }
+			}
+
+			// Fields are read in place, 64 bytes apart
+			BookWriter writer(n);
+			for (int j = 0; j < 4; j++) { writer.add_bits((BookColumn)j, words[j].data()); }
+			writer.add_column(SpotColumn, &records[0].S, sizeof(InstrumentRecord));
+			writer.add_column(StrikeColumn, &records[0].K, sizeof(InstrumentRecord));
+			writer.add_column(MaturityColumn, &records[0].T, sizeof(InstrumentRecord));
+			writer.add_column(RateColumn, &records[0].r, sizeof(InstrumentRecord));
+			writer.add_column(VolatilityColumn, &records[0].sig, sizeof(InstrumentRecord));
+			writer.add_column(CarryColumn, &records[0].b, sizeof(InstrumentRecord));
+			return writer.write(path);
+		}
+
+		MappedBook::MappedBook() : m_count(0)
+		{
+			for (int j = 0; j < BookColumnCount; j++) { m_columns[j] = nullptr; }
+		}
+
+		MappedBook::MappedBook(const string& path) : MappedBook() { open(path); }
+		MappedBook::~MappedBook() {}
+
+		bool MappedBook::open(const string& path)
+		{
+			close();
+			if (!little_endian_host())
+			{
+				cout << "Invalid byte order: book files are little-endian" << endl;
+				return false;
+			}
+			if (!m_file.open(path))
+			{
+				cout << "Invalid book file path: " << path << endl;
+				return false;
+			}
+
+			// Header, directory and every column must lie inside the file
+			const char* data = m_file.data();
+			size_t size = m_file.size();
+			BookFileHeader header;
+			bool valid = size >= sizeof(header);
+			if (valid)
+			{
+				memcpy(&header, data, sizeof(header));
+				valid = memcmp(header.magic, BOOK_FILE_MAGIC, sizeof(header.magic)) == 0 && header.version == BOOK_FILE_VERSION && header.byte_order == BYTE_ORDER_MARK
+					&& header.column_count <= (size - sizeof(header)) / sizeof(BookFileColumn) && header.count <= size / sizeof(double);
+			}
+			for (uint64_t j = 0; valid && j < header.column_count; j++)
+			{
+				BookFileColumn c;
+				memcpy(&c, data + sizeof(header) + j * sizeof(BookFileColumn), sizeof(c));
+				if (c.id >= (uint32_t)BookColumnCount) { continue; } // written by a later version
+				uint64_t expected = (c.kind == BitmapColumn) ? bitmap_words(header.count) * sizeof(uint64_t) : header.count * sizeof(double);
+				valid = c.kind == (uint32_t)column_kind((BookColumn)c.id) && c.bytes == expected && c.offset % COLUMN_ALIGNMENT == 0 && c.offset <= size && c.bytes <= size - c.offset;
+				if (valid && m_columns[c.id] == nullptr) { m_columns[c.id] = data + c.offset; }
+			}
+			if (!valid)
+			{
+				cout << "Invalid book file: " << path << endl;
+				close();
+				return false;
+			}
+			m_count = header.count;
+			return true;
+		}
+
+		void MappedBook::close()
+		{
+			m_file.close();
+			m_count = 0;
+			for (int j = 0; j < BookColumnCount; j++) { m_columns[j] = nullptr; }
+		}
+
+		bool MappedBook::is_open() const { return m_file.is_open(); }
+		size_t MappedBook::size() const { return m_count; }
+
+		const double* MappedBook::column(BookColumn id) const
+		{
+			if (id < 0 || id >= BookColumnCount || column_kind(id) != Float64Column) { return nullptr; }
+			return (const double*)m_columns[id];
+		}
+
+		const uint64_t* MappedBook::bits(BookColumn id) const
+		{
+			if (id < 0 || id >= BookColumnCount || column_kind(id) != BitmapColumn) { return nullptr; }
+			return (const uint64_t*)m_columns[id];
+		}
+
+		OptionType MappedBook::type(size_t i) const
+		{
+			const uint64_t* types = bits(TypeBits);
+			return (types != nullptr && ((types[i / 64] >> (i % 64)) & 1)) ? Call : Put;
+		}
+
+		OptionClass MappedBook::option_class(size_t i) const
+		{
+			for (int oc = European; oc <= American; oc++)
+			{
+				const uint64_t* classes = bits((BookColumn)(EuropeanBits + oc));
+				if (classes != nullptr && ((classes[i / 64] >> (i % 64)) & 1)) { return (OptionClass)oc; }
+			}
+			return AmericanFinite;
+		}
+
+		bool MappedBook::has_book() const
+		{
+			bool complete = bits(TypeBits) != nullptr;
+			for (int j = SpotColumn; j <= CarryColumn; j++) { complete = complete && m_columns[j] != nullptr; }
+			if (!complete) { cout << "Invalid book file: missing columns" << endl; } // class bitmaps may be absent (AmericanFinite)
+			return complete;
+		}
+
+		void MappedBook::expand_types(size_t first, size_t count, OptionType* out) const
+		{
+			const uint64_t* types = bits(TypeBits);
+			for (size_t i = 0; i < count; i++) { out[i] = ((types[(first + i) / 64] >> ((first + i) % 64)) & 1) ? Call : Put; }
+		}
+
+		size_t MappedBook::class_run(size_t first, size_t last) const
+		{
+			// Whole words of one class are skipped at once: sorted books have a handful of runs
+			OptionClass oc = option_class(first);
+			const uint64_t* classes = (oc == AmericanFinite) ? nullptr : bits((BookColumn)(EuropeanBits + oc));
+			size_t i = first + 1;
+			while (i < last)
+			{
+				if (classes != nullptr && i % 64 == 0 && i + 64 <= last && classes[i / 64] == ~(uint64_t)0)
+				{
+					i += 64;
+					continue;
+				}
+				if (option_class(i) != oc) { break; }
+				i++;
+			}
+			return i;
+		}
+
+		void MappedBook::theoretical_prices(const BatchPricer& pricer, vector<double>& out) const
+		{
+			out.resize(m_count);
+			if (m_count > 0) { theoretical_prices(pricer, out.data()); }
+		}
+
+		void MappedBook::theoretical_prices(const BatchPricer& pricer, double* out) const
+		{
+			if (!has_book())
+			{
+				for (size_t i = 0; i < m_count; i++) { out[i] = NAN; }
+				return;
+			}
+			const double* S = column(SpotColumn);
+			const double* K = column(StrikeColumn);
+			const double* T = column(MaturityColumn);
+			const double* r = column(RateColumn);
+			const double* sig = column(VolatilityColumn);
+			const double* b = column(CarryColumn);
+			bool invalid = false;
+
+			OptionType type[CHUNK_SIZE];
+			for (size_t first = 0; first < m_count; first += CHUNK_SIZE)
+			{
+				size_t last = min(first + CHUNK_SIZE, m_count);
+				expand_types(first, last - first, type);
+				for (size_t i = first; i < last;)
+				{
+					size_t end = class_run(i, last);
+					OptionClass oc = option_class(i);
+					if (oc == European) { pricer.european_prices(type + (i - first), T + i, K + i, sig + i, S + i, r + i, b + i, out + i, end - i); }
+					else if (oc == American) { pricer.american_perpetual_prices(type + (i - first), K + i, sig + i, S + i, r + i, b + i, out + i, end - i); }
+					else
+					{
+						for (size_t j = i; j < end; j++) { out[j] = NAN; }
+						invalid = true;
+					}
+					i = end;
+				}
+			}
+			if (invalid) { cout << "Invalid Option Class" << endl; } // AmericanFinite contracts need a lattice
+		}
+
+		void MappedBook::european_greeks(const BatchPricer& pricer, double* price, double* delta, double* gamma, double* vega, double* theta, double* rho) const
+		{
+			double* outputs[6] = { price, delta, gamma, vega, theta, rho };
+			if (!has_book())
+			{
+				for (int k = 0; k < 6; k++) { for (size_t i = 0; i < m_count; i++) { outputs[k][i] = NAN; } }
+				return;
+			}
+			const double* S = column(SpotColumn);
+			const double* K = column(StrikeColumn);
+			const double* T = column(MaturityColumn);
+			const double* r = column(RateColumn);
+			const double* sig = column(VolatilityColumn);
+			const double* b = column(CarryColumn);
+
+			OptionType type[CHUNK_SIZE];
+			for (size_t first = 0; first < m_count; first += CHUNK_SIZE)
+			{
+				size_t last = min(first + CHUNK_SIZE, m_count);
+				expand_types(first, last - first, type);
+				for (size_t i = first; i < last;)
+				{
+					size_t end = class_run(i, last);
+					if (option_class(i) == European)
+					{
+						pricer.european_greeks(type + (i - first), T + i, K + i, sig + i, S + i, r + i, b + i, price + i, delta + i, gamma + i, vega + i, theta + i, rho + i, end - i);
+					}
+					else
+					{
+						for (int k = 0; k < 6; k++) { for (size_t j = i; j < end; j++) { outputs[k][j] = NAN; } }
+					}
+					i = end;
+				}
+			}
+		}
+	}
+}
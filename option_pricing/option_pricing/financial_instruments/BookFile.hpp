@@ -0,0 +1,165 @@
+/*
+* BookFile.hpp
+* Provides template methods for Book Files: a versioned, little-endian,
+* columnar binary format for option books and their computed prices and
+* greeks, loaded by mapping the file (no parsing, no copy).
+*
+* Layout (every offset from the start of the file):
+*   BookFileHeader (64 bytes): magic "OPTBOOK", version, byte order mark,
+*     number of contracts and of columns
+*   column_count BookFileColumn entries (24 bytes each): id, kind, offset,
+*     bytes
+*   the columns, each starting on a 64-byte boundary (zero padding between):
+*     Float64Column: one IEEE double per contract
+*     BitmapColumn: bit i % 64 of 64-bit word i / 64 for contract i
+* A book has the six parameter columns, the type bitmap (bit set for calls)
+* and one bitmap per OptionClass; a results file has one Float64Column per
+* output, contracts in the book's order. Readers skip unknown column ids.
+*
+* The mapped parameter columns go straight into the BatchPricer kernels:
+* pricing only expands the type bits of 1024 contracts at a time on the
+* stack. Mapping needs a little-endian host (every x86 and ARM platform the
+* kernels target); open refuses the file otherwise.
+*/
+#ifndef BOOK_FILE_HPP // Verify we have unique HPP file reference
+#define BOOK_FILE_HPP // Name the file BOOK_FILE_HPP
+
+#include <cstdint>
+#include <string>
+#include <iostream>
+#include <vector>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "OptionBatch.hpp"
+#include "InstrumentBook.hpp"
+#include "BatchPricer.hpp"
+#include "../utils/MappedFile.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		static const uint32_t BOOK_FILE_VERSION = 1;
+
+		// Column ids, stored in the file: never renumber, only append
+		enum BookColumn {
+			TypeBits = 0, // bit set for calls
+			EuropeanBits = 1, // one bitmap per OptionClass
+			AmericanBits = 2,
+			AmericanFiniteBits = 3,
+			SpotColumn = 4,
+			StrikeColumn = 5,
+			MaturityColumn = 6, // INFINITY for perpetual americans
+			RateColumn = 7,
+			VolatilityColumn = 8,
+			CarryColumn = 9,
+			PriceColumn = 10,
+			DeltaColumn = 11,
+			GammaColumn = 12,
+			VegaColumn = 13,
+			ThetaColumn = 14,
+			RhoColumn = 15,
+			BookColumnCount = 16,
+		};
+
+		enum BookColumnKind {
+			BitmapColumn = 0,
+			Float64Column = 1,
+		};
+
+		struct BookFileHeader {
+			char magic[8]; // "OPTBOOK" and a zero byte
+			uint32_t version; // BOOK_FILE_VERSION
+			uint32_t byte_order; // 0x01020304, reads differently on a big-endian host
+			uint64_t count; // contracts
+			uint64_t column_count; // BookFileColumn entries following the header
+			uint64_t reserved[4]; // zero
+		};
+		static_assert(sizeof(BookFileHeader) == 64, "BookFileHeader is 64 bytes in the file");
+
+		struct BookFileColumn {
+			uint32_t id; // BookColumn
+			uint32_t kind; // BookColumnKind
+			uint64_t offset; // multiple of 64
+			uint64_t bytes; // count doubles, or (count + 63) / 64 words
+		};
+		static_assert(sizeof(BookFileColumn) == 24, "BookFileColumn is 24 bytes in the file");
+
+		// Collects columns (not copied: they must outlive write) and streams them into a book file
+		class BookWriter
+		{
+		public:
+			BookWriter(); // Default constructor: no contracts
+			BookWriter(size_t count); // Writer for count contracts
+			BookWriter(const BookWriter& bw);  // Copy constructor for Book Writer
+			~BookWriter(); // Destructor: called when Book Writer gets removed from memory
+
+			// Operators
+			BookWriter& operator = (const BookWriter& source); // Assignment operator.
+
+			void add_column(BookColumn id, const double* values); // count contiguous values
+			void add_column(BookColumn id, const double* values, size_t stride); // count values stride bytes apart (e.g. one field of a record array)
+			void add_bits(BookColumn id, const uint64_t* words); // (count + 63) / 64 words
+
+			size_t size() const; // Contracts
+			bool write(const string& path) const; // Writes the file, false if it cannot be written
+
+		private:
+			struct Column {
+				BookColumn id;
+				BookColumnKind kind;
+				const char* data;
+				size_t stride; // bytes between values
+			};
+
+			size_t m_count;
+			vector<Column> m_columns;
+		};
+
+		// Write every column of a book, false if the file cannot be written
+		bool write_book(const string& path, const OptionBatch& batch);
+		bool write_book(const string& path, const InstrumentBook& book);
+
+		// Read-only view of a mapped book (or results) file
+		class MappedBook
+		{
+		public:
+			MappedBook(); // Default constructor: nothing mapped
+			MappedBook(const string& path); // Maps and validates path (see open)
+			~MappedBook(); // Destructor: unmaps the file
+
+			bool open(const string& path); // Maps and validates the file, false (nothing mapped) if invalid
+			void close();
+
+			// Getter Methods
+			bool is_open() const;
+			size_t size() const; // Contracts
+			const double* column(BookColumn id) const; // count values, nullptr if the file has no such Float64Column
+			const uint64_t* bits(BookColumn id) const; // nullptr if the file has no such BitmapColumn
+			OptionType type(size_t i) const;
+			OptionClass option_class(size_t i) const; // AmericanFinite when no class bit is set
+
+			// Prices every contract from the mapped columns, writing size() prices into out (NaN for AmericanFinite)
+			void theoretical_prices(const BatchPricer& pricer, double* out) const;
+			void theoretical_prices(const BatchPricer& pricer, vector<double>& out) const; // Same, out resized
+
+			// Price and greeks of every European contract (NaN for the others), one array of size() per output
+			void european_greeks(const BatchPricer& pricer, double* price, double* delta, double* gamma, double* vega, double* theta, double* rho) const;
+
+		private:
+			MappedBook(const MappedBook& mb); // Non copyable: owns the mapping
+			MappedBook& operator = (const MappedBook& source);
+
+			bool has_book() const; // Parameter columns, type and class bitmaps present (prints otherwise)
+			void expand_types(size_t first, size_t count, OptionType* out) const;
+			size_t class_run(size_t first, size_t last) const; // End of the run of contracts of first's class, before last
+
+			Utils::MappedFile m_file;
+			size_t m_count;
+			const char* m_columns[BookColumnCount]; // nullptr if absent
+		};
+	}
+}
+#endif // !BOOK_FILE_HPP
@@ -0,0 +1,202 @@
+/*
+* BumpGreeks.cpp
+* Defines the BumpGreeks class methods
+*/
+
+
+// Standard Libraries
+#include <cmath>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <numeric>
+
+// Custom header
+#include "BumpGreeks.hpp"
+#include "BatchPricer.hpp"
+#include "OptionBatch.hpp"
+#include "OptionConstants.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		static const int GREEKS = 7; // delta, gamma, vega, volga, vanna, rho, theta
+		static const size_t STENCIL_POINTS = 12;
+
+		// Stencil point p moves S, sig, r (and b) and T by STENCIL[p][j] steps; the maturity points come last (none for perpetuals)
+		static const double STENCIL[STENCIL_POINTS][4] = {
+			{ 1, 0, 0, 0 }, { -1, 0, 0, 0 }, // S +- h
+			{ 0, 1, 0, 0 }, { 0, -1, 0, 0 }, // sig +- k
+			{ 1, 1, 0, 0 }, { 1, -1, 0, 0 }, { -1, 1, 0, 0 }, { -1, -1, 0, 0 }, // corners
+			{ 0, 0, 1, 0 }, { 0, 0, -1, 0 }, // r +- e
+			{ 0, 0, 0, 1 }, { 0, 0, 0, -1 }, // T +- t
+		};
+
+		// Steps of a round for S, sig, r and T; each is the exact difference between the bumped up and unbumped value
+		static void bump_steps(double scale, double S, double sig, double r, double T, double steps[4])
+		{
+			steps[0] = (S + scale * S) - S;
+			steps[1] = (sig + scale * sig) - sig;
+			steps[2] = (r + scale * 0.1) - r;
+			steps[3] = (T + scale * T) - T;
+		}
+
+		BumpGreeks::BumpGreeks() : m_step(0.01), m_tolerance(1e-8), m_max_rounds(5), m_evaluations(0) {}
+		BumpGreeks::BumpGreeks(double step, double tolerance) : m_step(0.01), m_tolerance(1e-8), m_max_rounds(5), m_evaluations(0)
+		{
+			set_step(step);
+			set_tolerance(tolerance);
+		}
+
+		BumpGreeks::BumpGreeks(const BumpGreeks& bg) : m_step(bg.m_step), m_tolerance(bg.m_tolerance), m_max_rounds(bg.m_max_rounds), m_evaluations(0), m_pricer(bg.m_pricer) {} // Buffers are not shared
+		BumpGreeks::~BumpGreeks() {}
+
+		BumpGreeks& BumpGreeks::operator = (const BumpGreeks& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			m_step = source.m_step;
+			m_tolerance = source.m_tolerance;
+			m_max_rounds = source.m_max_rounds;
+			m_pricer = source.m_pricer; // keep our own buffers
+			return *this; // return current object's pointer
+		}
+
+		void BumpGreeks::set_step(double step)
+		{
+			if (!(step > 0.0 && step < 0.5)) // bumped volatilities and maturities must stay positive
+			{
+				cout << "Invalid bump step" << endl;
+				return;
+			}
+			m_step = step;
+		}
+
+		void BumpGreeks::set_tolerance(double tolerance)
+		{
+			if (!(tolerance > 0.0))
+			{
+				cout << "Invalid tolerance" << endl;
+				return;
+			}
+			m_tolerance = tolerance;
+		}
+
+		void BumpGreeks::set_max_rounds(int rounds)
+		{
+			if (rounds < 2)
+			{
+				cout << "Invalid number of rounds" << endl;
+				return;
+			}
+			m_max_rounds = rounds;
+		}
+
+		void BumpGreeks::set_instruction_set(SimdInstructionSet is) { m_pricer.set_instruction_set(is); }
+
+		double BumpGreeks::step() const { return m_step; }
+		double BumpGreeks::tolerance() const { return m_tolerance; }
+		int BumpGreeks::max_rounds() const { return m_max_rounds; }
+		size_t BumpGreeks::evaluations() const { return m_evaluations; }
+
+		void BumpGreeks::greeks(const OptionBatch& batch, BumpGreekColumns& out)
+		{
+			size_t n = batch.size();
+			vector<double>* columns[GREEKS] = { &out.delta, &out.gamma, &out.vega, &out.volga, &out.vanna, &out.rho, &out.theta };
+			out.price.resize(n);
+			for (int g = 0; g < GREEKS; g++) { columns[g]->assign(n, 0.0); }
+			out.error.assign(n, 0.0);
+			out.rounds.assign(n, 0);
+			m_evaluations = 0;
+
+			OptionClass oc = batch.option_class();
+			if (oc != European && oc != American)
+			{
+				cout << "Invalid Option Class" << endl;
+				return;
+			}
+			if (n == 0) { return; }
+			size_t points = (oc == European) ? STENCIL_POINTS : STENCIL_POINTS - 2; // perpetuals have no maturity to bump
+
+			m_pricer.theoretical_prices(batch, out.price);
+			m_evaluations = n;
+
+			vector<size_t> active(n); // options still converging
+			iota(active.begin(), active.end(), (size_t)0);
+			vector<double> previous(2 * GREEKS * n); // per option: differences and extrapolated greeks of the previous round
+			if (m_stencil.option_class() != oc) { m_stencil = OptionBatch(oc); }
+
+			for (int round = 0; round < m_max_rounds && !active.empty(); round++)
+			{
+				double scale = ldexp(m_step, -round);
+				size_t m = active.size();
+
+				// Stencil point p of active option a is entry p * m + a: one kernel call for the whole round
+				m_stencil.clear();
+				m_stencil.reserve(points * m);
+				for (size_t p = 0; p < points; p++)
+				{
+					for (size_t a = 0; a < m; a++)
+					{
+						size_t i = active[a];
+						double steps[4];
+						bump_steps(scale, batch.S[i], batch.sig[i], batch.r[i], batch.T[i], steps);
+						double rate_bump = STENCIL[p][2] * steps[2];
+						m_stencil.add(batch.type[i], batch.S[i] + STENCIL[p][0] * steps[0], batch.K[i], batch.T[i] + STENCIL[p][3] * steps[3],
+							batch.r[i] + rate_bump, batch.sig[i] + STENCIL[p][1] * steps[1], batch.b[i] + rate_bump);
+					}
+				}
+				m_pricer.theoretical_prices(m_stencil, m_prices);
+				m_evaluations += m_stencil.size();
+
+				size_t kept = 0;
+				for (size_t a = 0; a < m; a++)
+				{
+					size_t i = active[a];
+					const double* P = m_prices.data() + a;
+					double f = out.price[i], h, k, e, t;
+					double steps[4];
+					bump_steps(scale, batch.S[i], batch.sig[i], batch.r[i], batch.T[i], steps);
+					h = steps[0]; k = steps[1]; e = steps[2]; t = steps[3];
+
+					double D[GREEKS];
+					D[0] = (P[0] - P[m]) / (2 * h);
+					D[1] = (P[0] - 2 * f + P[m]) / (h * h);
+					D[2] = (P[2 * m] - P[3 * m]) / (2 * k);
+					D[3] = (P[2 * m] - 2 * f + P[3 * m]) / (k * k);
+					D[4] = (P[4 * m] - P[5 * m] - P[6 * m] + P[7 * m]) / (4 * h * k);
+					D[5] = (P[8 * m] - P[9 * m]) / (2 * e);
+					D[6] = (points == STENCIL_POINTS) ? -(P[10 * m] - P[11 * m]) / (2 * t) : 0.0;
+
+					// Richardson: (4 D(h/2) - D(h)) / 3. After the second round the error is judged on the
+					// extrapolated greeks themselves; on the second, by the error of D(h/2), which bounds theirs
+					double* last_D = previous.data() + 2 * GREEKS * i;
+					double* last_R = last_D + GREEKS;
+					double R[GREEKS], error = 0.0;
+					for (int g = 0; g < GREEKS; g++)
+					{
+						R[g] = (round == 0) ? D[g] : (4 * D[g] - last_D[g]) / 3;
+						double change = (round == 1) ? fabs(D[g] - last_D[g]) / 3 : fabs(R[g] - last_R[g]);
+						error = fmax(error, change / fmax(1.0, fabs(R[g])));
+					}
+					if (round > 1 && !(error < out.error[i])) { continue; } // rounding noise now outweighs the truncation error: keep the previous greeks
+
+					for (int g = 0; g < GREEKS; g++)
+					{
+						last_D[g] = D[g];
+						last_R[g] = R[g];
+						(*columns[g])[i] = R[g];
+					}
+					out.error[i] = (round == 0) ? INFINITY : error;
+					out.rounds[i] = round + 1;
+					if (round == 0 || !(error <= m_tolerance)) { active[kept++] = i; }
+				}
+				active.resize(kept);
+			}
+		}
+	}
+}
@@ -0,0 +1,90 @@
+/*
+* BumpGreeks.hpp
+* Provides template methods for Bump Greeks: finite difference price and
+* greeks of whole batches, for models priced without closed form greeks.
+*
+* One stencil of bumped books is priced per round with the batch kernels
+* (BatchPricer::theoretical_prices): S +- h, sig +- k, the four corners
+* (S +- h, sig +- k), r +- e (b moving with r) and T +- t. Delta, gamma,
+* vega, volga, vanna, rho and theta are all central differences of the same
+* stencil and the unbumped price, nothing is priced twice.
+*
+* Steps start at a fraction of S, sig and T (of 10% for the rate) and are
+* halved every round. From the second round on, each greek is the Richardson
+* extrapolation (4 D(h/2) - D(h)) / 3, which cancels the h^2 error term of
+* the central differences, and an option leaves the stencil once the change
+* of its extrapolated greeks is within the tolerance. Large steps with
+* extrapolation are more accurate than one tiny step, whose differences are
+* lost to rounding.
+*/
+#ifndef BUMP_GREEKS_HPP // Verify we have unique HPP file reference
+#define BUMP_GREEKS_HPP // Name the file BUMP_GREEKS_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "OptionBatch.hpp"
+#include "BatchPricer.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		// Finite difference price and greeks, one entry per option of the batch
+		// (theta = -dV/dT, rho moves the carry with the rate, vanna = d2V/dSdsig, volga = d2V/dsig2)
+		struct BumpGreekColumns {
+			vector<double> price;
+			vector<double> delta;
+			vector<double> gamma;
+			vector<double> vega;
+			vector<double> theta;
+			vector<double> rho;
+			vector<double> vanna;
+			vector<double> volga;
+			vector<double> error; // last change of the extrapolated greeks, relative to max(1, |greek|)
+			vector<int> rounds; // stencils priced for the option
+		};
+
+		class BumpGreeks
+		{
+		public:
+			BumpGreeks(); // Default constructor: 1% initial steps, tolerance 1e-8, at most 5 rounds
+			BumpGreeks(double step, double tolerance); // Initial relative step and tolerance
+			BumpGreeks(const BumpGreeks& bg);  // Copy constructor for Bump Greeks
+			~BumpGreeks(); // Destructor: called when Bump Greeks gets removed from memory
+
+			// Operators
+			BumpGreeks& operator = (const BumpGreeks& source); // Assignment operator.
+
+			// Setter Methods
+			void set_step(double step); // Initial step, relative to S, sig and T (the rate step is step * 10%)
+			void set_tolerance(double tolerance); // Target change of the extrapolated greeks between rounds
+			void set_max_rounds(int rounds); // At least 2: the first round only gives the step to extrapolate from
+			void set_instruction_set(SimdInstructionSet is); // Falls back if unsupported
+
+			// Getter Methods
+			double step() const;
+			double tolerance() const;
+			int max_rounds() const;
+			size_t evaluations() const; // Option pricings of the last call, every round included
+
+			// Price and greeks of every option of the batch (European or perpetual American, which has no theta), out is resized
+			void greeks(const OptionBatch& batch, BumpGreekColumns& out);
+
+		private:
+			double m_step;
+			double m_tolerance;
+			int m_max_rounds;
+			size_t m_evaluations;
+			BatchPricer m_pricer;
+
+			OptionBatch m_stencil; // bumped books of the options still converging, grown once
+			vector<double> m_prices;
+		};
+	}
+}
+#endif // !BUMP_GREEKS_HPP
@@ -0,0 +1,324 @@
+/*
+* ChainReader.cpp
+* Defines the ChainReader class methods
+*/
+
+
+// Standard Libraries
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Custom header
+#include "ChainReader.hpp"
+#include "OptionConstants.hpp"
+#include "OptionBatch.hpp"
+#include "../utils/MappedFile.hpp"
+#include "../utils/ThreadPool.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		enum ChainField {
+			IgnoredField,
+			TypeField,
+			ClassField,
+			SpotField,
+			StrikeField,
+			MaturityField,
+			RateField,
+			VolatilityField,
+			CarryField,
+		};
+
+		// Column of a header name, IgnoredField for unknown names
+		static ChainField chain_field(string name)
+		{
+			transform(name.begin(), name.end(), name.begin(), [](char c) { return (char)tolower((unsigned char)c); });
+			if (name == "type") { return TypeField; }
+			if (name == "class") { return ClassField; }
+			if (name == "s" || name == "spot") { return SpotField; }
+			if (name == "k" || name == "strike") { return StrikeField; }
+			if (name == "t" || name == "maturity") { return MaturityField; }
+			if (name == "r" || name == "rate") { return RateField; }
+			if (name == "sig" || name == "vol" || name == "volatility") { return VolatilityField; }
+			if (name == "b" || name == "carry") { return CarryField; }
+			return IgnoredField;
+		}
+
+		static bool blank(char c) { return c == ' ' || c == '\t' || c == '"'; }
+
+		// Reads the header line [first, last), false if a required column is missing
+		static bool parse_header(const char* first, const char* last, vector<ChainField>& fields)
+		{
+			fields.clear();
+			bool seen[CarryField + 1] = { false };
+			const char* p = first;
+			while (true)
+			{
+				const char* end = (const char*)memchr(p, ',', last - p);
+				if (end == nullptr) { end = last; }
+				const char* a = p;
+				const char* b = end;
+				while (a < b && blank(*a)) { a++; }
+				while (b > a && (blank(b[-1]) || b[-1] == '\r')) { b--; }
+				ChainField f = chain_field(string(a, b));
+				fields.push_back(f);
+				seen[f] = true;
+				if (end == last) { break; }
+				p = end + 1;
+			}
+			return seen[TypeField] && seen[SpotField] && seen[StrikeField] && seen[MaturityField] && seen[RateField] && seen[VolatilityField];
+		}
+
+		// Parses one row [p, last) into the chunk, false if malformed
+		static bool parse_row(const char* p, const char* last, const vector<ChainField>& fields, size_t row, ChainChunk& chunk)
+		{
+			double value[CarryField + 1] = { 0 };
+			bool seen[CarryField + 1] = { false };
+			OptionType type = Call;
+			OptionClass oc = European;
+			for (size_t j = 0; ; j++)
+			{
+				ChainField f = (j < fields.size()) ? fields[j] : IgnoredField;
+				while (p < last && blank(*p)) { p++; }
+				if (f == TypeField || f == ClassField)
+				{
+					char c = (p < last) ? (char)toupper((unsigned char)*p) : 0;
+					if (f == TypeField && (c == 'C' || c == 'P')) { type = (c == 'C') ? Call : Put; }
+					else if (f == ClassField && (c == 'E' || c == 'A')) { oc = (c == 'E') ? European : American; }
+					else { return false; }
+					while (p < last && *p != ',') { p++; }
+				}
+				else if (f != IgnoredField)
+				{
+					if (p < last && *p == '+') { p++; } // from_chars takes no plus sign
+					from_chars_result parsed = from_chars(p, last, value[f]);
+					if (parsed.ec != errc()) { return false; }
+					p = parsed.ptr;
+					while (p < last && blank(*p)) { p++; }
+					if (p < last && *p != ',') { return false; }
+				}
+				else
+				{
+					while (p < last && *p != ',') { p++; }
+				}
+				seen[f] = true;
+				if (p == last) { break; }
+				p++; // comma
+			}
+			if (!(seen[TypeField] && seen[SpotField] && seen[StrikeField] && seen[RateField] && seen[VolatilityField])) { return false; }
+			if (oc == European && !seen[MaturityField]) { return false; }
+			double b = seen[CarryField] ? value[CarryField] : value[RateField]; // stock: carry = rate
+			double T = (oc == American) ? INFINITY : value[MaturityField];
+			OptionBatch& batch = (oc == European) ? chunk.european : chunk.american;
+			batch.add(type, value[SpotField], value[StrikeField], T, value[RateField], value[VolatilityField], b);
+			((oc == European) ? chunk.european_rows : chunk.american_rows).push_back(row);
+			return true;
+		}
+
+		// Parses the lines of [first, last) (rows counted from 0), returns the number of data rows
+		static size_t parse_chunk(const char* first, const char* last, const vector<ChainField>& fields, ChainChunk& chunk)
+		{
+			chunk.european.clear();
+			chunk.american.clear();
+			chunk.european_rows.clear();
+			chunk.american_rows.clear();
+			chunk.errors = 0;
+			size_t rows = 0;
+			for (const char* p = first; p < last;)
+			{
+				const char* end = (const char*)memchr(p, '\n', last - p);
+				if (end == nullptr) { end = last; }
+				const char* line_end = (end > p && end[-1] == '\r') ? end - 1 : end;
+				if (line_end > p) // blank lines are not rows
+				{
+					if (!parse_row(p, line_end, fields, rows, chunk)) { chunk.errors++; }
+					rows++;
+				}
+				p = end + 1;
+			}
+			return rows;
+		}
+
+		ChainReader::ChainReader() : m_threads(Utils::ThreadPool::hardware_threads()), m_chunk_bytes(4 << 20), m_rows(0), m_errors(0), m_bytes(0) {}
+		ChainReader::ChainReader(size_t threads, size_t chunk_bytes) : m_threads(threads), m_chunk_bytes(4 << 20), m_rows(0), m_errors(0), m_bytes(0)
+		{
+			set_chunk_bytes(chunk_bytes);
+		}
+
+		ChainReader::ChainReader(const ChainReader& cr) : m_threads(cr.m_threads), m_chunk_bytes(cr.m_chunk_bytes), m_rows(cr.m_rows), m_errors(cr.m_errors), m_bytes(cr.m_bytes) {}
+		ChainReader::~ChainReader() {}
+
+		ChainReader& ChainReader::operator = (const ChainReader& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			m_threads = source.m_threads;
+			m_chunk_bytes = source.m_chunk_bytes;
+			m_rows = source.m_rows;
+			m_errors = source.m_errors;
+			m_bytes = source.m_bytes;
+			return *this; // return current object's pointer
+		}
+
+		void ChainReader::set_threads(size_t threads) { m_threads = threads; }
+
+		void ChainReader::set_chunk_bytes(size_t bytes)
+		{
+			if (bytes < 4096)
+			{
+				cout << "Invalid chunk size" << endl;
+				return;
+			}
+			m_chunk_bytes = bytes;
+		}
+
+		size_t ChainReader::threads() const { return m_threads; }
+		size_t ChainReader::chunk_bytes() const { return m_chunk_bytes; }
+		size_t ChainReader::rows() const { return m_rows; }
+		size_t ChainReader::errors() const { return m_errors; }
+		size_t ChainReader::bytes() const { return m_bytes; }
+
+		bool ChainReader::read(const string& path, const function<void(const ChainChunk&)>& sink)
+		{
+			Utils::MappedFile file;
+			if (!file.open(path))
+			{
+				m_rows = 0;
+				m_errors = 0;
+				m_bytes = 0;
+				cout << "Invalid CSV file path: " << path << endl;
+				return false;
+			}
+			return read(file.data(), file.size(), sink);
+		}
+
+		bool ChainReader::read(const char* data, size_t size, const function<void(const ChainChunk&)>& sink)
+		{
+			m_rows = 0;
+			m_errors = 0;
+			m_bytes = size;
+			const char* end = data + size;
+			const char* header_end = (const char*)memchr(data, '\n', size);
+			if (header_end == nullptr) { header_end = end; }
+			vector<ChainField> fields;
+			if (!parse_header(data, header_end, fields))
+			{
+				cout << "Invalid CSV header: needs type, S, K, T, r and sig columns" << endl;
+				return false;
+			}
+
+			// Chunks of about m_chunk_bytes, each ending after a newline
+			vector<const char*> bounds(1, (header_end < end) ? header_end + 1 : end);
+			while (bounds.back() < end)
+			{
+				const char* p = bounds.back() + min(m_chunk_bytes, (size_t)(end - bounds.back()));
+				if (p < end)
+				{
+					const char* newline = (const char*)memchr(p, '\n', end - p);
+					p = (newline == nullptr) ? end : newline + 1;
+				}
+				bounds.push_back(p);
+			}
+			size_t chunks = bounds.size() - 1;
+
+			// Ring of parsed chunks: parsers run ahead of the sink by at most depth chunks
+			size_t depth = max((size_t)1, 2 * m_threads);
+			vector<ChainChunk> ring(depth);
+			vector<size_t> ring_rows(depth);
+			vector<char> ready(depth, 0);
+			size_t delivered = 0;
+			bool stop = false; // set when read returns, parsers then leave without parsing further
+			atomic<size_t> next(0);
+			mutex m;
+			condition_variable cv;
+
+			auto parse = [&](size_t k)
+			{
+				ChainChunk& chunk = ring[k % depth];
+				ring_rows[k % depth] = parse_chunk(bounds[k], bounds[k + 1], fields, chunk);
+				chunk.index = k;
+			};
+			auto work = [&]()
+			{
+				for (size_t k = next++; k < chunks; k = next++)
+				{
+					{
+						unique_lock<mutex> lock(m);
+						cv.wait(lock, [&]() { return stop || k < delivered + depth; });
+						if (stop) { return; }
+					}
+					parse(k);
+					{
+						lock_guard<mutex> lock(m);
+						ready[k % depth] = 1;
+					}
+					cv.notify_all();
+				}
+			};
+			vector<thread> parsers;
+
+			// Stops and joins the parsers on every way out, a sink that throws included (a joinable thread would terminate)
+			struct ParserJoiner
+			{
+				vector<thread>& parsers;
+				mutex& m;
+				condition_variable& cv;
+				bool& stop;
+				~ParserJoiner()
+				{
+					{
+						lock_guard<mutex> lock(m);
+						stop = true;
+					}
+					cv.notify_all();
+					for (thread& parser : parsers) { parser.join(); }
+				}
+			} joiner = { parsers, m, cv, stop };
+			for (size_t t = 0; t < m_threads; t++) { parsers.emplace_back(work); }
+
+			for (size_t k = 0; k < chunks; k++)
+			{
+				if (m_threads == 0) { parse(k); }
+				else
+				{
+					unique_lock<mutex> lock(m);
+					cv.wait(lock, [&]() { return ready[k % depth] != 0; });
+				}
+
+				// Rows were counted from the start of the chunk
+				ChainChunk& chunk = ring[k % depth];
+				for (size_t& row : chunk.european_rows) { row += m_rows; }
+				for (size_t& row : chunk.american_rows) { row += m_rows; }
+				m_rows += ring_rows[k % depth];
+				m_errors += chunk.errors;
+				sink(chunk);
+
+				{
+					lock_guard<mutex> lock(m);
+					ready[k % depth] = 0;
+					delivered = k + 1;
+				}
+				cv.notify_all();
+			}
+
+			if (m_errors > 0) { cout << "Invalid CSV rows skipped: " << m_errors << endl; }
+			return true;
+		}
+	}
+}
@@ -0,0 +1,89 @@
+/*
+* ChainReader.hpp
+* Provides template methods for the Chain Reader: parses option chains from
+* CSV files into structure-of-arrays batches on several threads, handing
+* them to a sink while the rest of the file is still being parsed.
+*
+* The first line names the columns, in any order (case does not matter):
+* type (C/Call/P/Put), S or spot, K or strike, T or maturity, r or rate,
+* sig, vol or volatility, and optionally b or carry (default: r) and class
+* (E/European or A/American, i.e. perpetual; default European). Other
+* columns are skipped. Numbers are parsed with std::from_chars: exact, and
+* independent of the locale.
+*
+* The file is mapped (utils/MappedFile.hpp) and cut into chunks of about
+* chunk_bytes ending on a newline. Parser threads take chunks in file order
+* and fill a ring of 2 * threads ChainChunks; the calling thread hands each
+* chunk to the sink in file order as soon as it is parsed, so pricing the
+* first chunks overlaps with parsing (and reading) the next ones. The ring
+* bounds the memory and its batches are reused, so a steady read allocates
+* nothing.
+*/
+#ifndef CHAIN_READER_HPP // Verify we have unique HPP file reference
+#define CHAIN_READER_HPP // Name the file CHAIN_READER_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <functional>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "OptionBatch.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		// Options parsed from one chunk of a chain, split by option class
+		struct ChainChunk {
+			size_t index; // chunks reach the sink in file order
+			OptionBatch european;
+			OptionBatch american; // perpetual, T = INFINITY
+			vector<size_t> european_rows; // data row (from 0, header excluded) of each option
+			vector<size_t> american_rows;
+			size_t errors; // malformed rows skipped
+
+			ChainChunk() : index(0), european(European), american(American), errors(0) {}
+		};
+
+		class ChainReader
+		{
+		public:
+			ChainReader(); // Default constructor: one parser thread per hardware thread, 4 MiB chunks
+			ChainReader(size_t threads, size_t chunk_bytes); // 0 threads parses on the calling thread, between sink calls
+			ChainReader(const ChainReader& cr);  // Copy constructor for Chain Reader
+			~ChainReader(); // Destructor: called when Chain Reader gets removed from memory
+
+			// Operators
+			ChainReader& operator = (const ChainReader& source); // Assignment operator.
+
+			// Setter Methods
+			void set_threads(size_t threads);
+			void set_chunk_bytes(size_t bytes); // At least 4 KiB
+
+			// Getter Methods
+			size_t threads() const;
+			size_t chunk_bytes() const;
+
+			// Parses the chain, calling sink on the calling thread with every chunk in file order; false if the
+			// file cannot be read or its header lacks a required column. An exception thrown by sink stops the parsers and propagates
+			bool read(const string& path, const function<void(const ChainChunk&)>& sink);
+			bool read(const char* data, size_t size, const function<void(const ChainChunk&)>& sink); // Same, on a chain in memory
+
+			// Statistics of the last read
+			size_t rows() const; // Data rows, malformed ones included
+			size_t errors() const; // Malformed rows skipped
+			size_t bytes() const; // Bytes parsed, header included
+
+		private:
+			size_t m_threads;
+			size_t m_chunk_bytes;
+			size_t m_rows;
+			size_t m_errors;
+			size_t m_bytes;
+		};
+	}
+}
+#endif // !CHAIN_READER_HPP
@@ -42,20 +42,48 @@ namespace Colin {
 			return European;
 		}
 
-		// Returns custom theoretical price, derived from Option class
+		PricingModel EuropeanOption::pricing_model() const
+		{
+			return BlackScholesModel;
+		}
+
+		// Returns heap allocated copy, used to price on several threads at once
+		Option* EuropeanOption::clone() const
+		{
+			return new EuropeanOption(*this);
+		}
+
+		// Returns custom theoretical price, derived from Option class, from the terms cached on the option
 		double EuropeanOption::theoretical_price() const
 		{
-			return calculate_theoretical_price(
-				this->option_type(), 
-				this->time_to_maturity(), 
-				this->strike_price(), 
-				this->volatility(), 
-				this->current_price(), 
-				this->risk_free_rate(), 
-				this->cost_of_carry()
+			return calculate_theoretical_price(this->option_type(), this->strike_price(), this->current_price(), this->price_intermediates());
+		}
+
+
+		// Returns price and all greeks, derived from Option class
+		OptionGreeks EuropeanOption::greeks() const
+		{
+			return calculate_price_and_greeks(
+				this->option_type(),
+				this->time_to_maturity(),
+				this->strike_price(),
+				this->volatility(),
+				this->current_price(),
+				this->risk_free_rate(),
+				this->cost_of_carry(),
+				this->intermediates()
 			);
 		}
 
+		double EuropeanOption::approximate_delta() const
+		{
+			return calculate_delta_approximation(this->option_type(), this->time_to_maturity(), this->strike_price(), this->volatility(), this->current_price(), this->risk_free_rate(), this->cost_of_carry(), Option::get_h());
+		}
+
+		double EuropeanOption::approximate_gamma() const
+		{
+			return calculate_gamma_approximation(this->option_type(), this->time_to_maturity(), this->strike_price(), this->volatility(), this->current_price(), this->risk_free_rate(), this->cost_of_carry(), Option::get_h());
+		}
 
 		// overloading << Operator for printing out European Option as String
 		ostream& operator << (ostream& os, const EuropeanOption& eo)
@@ -36,10 +36,19 @@ namespace Colin {
 			//bool valid_option(const EuropeanOption& eo) const; // Returns if the two options have valid put call parity
 
 			OptionClass option_class() const; // Returns class of option
+			PricingModel pricing_model() const; // Returns model of the price
+			Option* clone() const; // Returns heap allocated copy of the option
 
 			// Calculates the European Theoretical Price according to Black-Scholes option model
 			double theoretical_price() const;
 
+			// Calculates price and every greek from one evaluation of the shared Black-Scholes terms
+			OptionGreeks greeks() const;
+
+			// Same bumps as Option, on the Black-Scholes formula without copying the option
+			double approximate_delta() const;
+			double approximate_gamma() const;
+
 			// String Methods
 			friend ostream& operator << (ostream& os, const EuropeanOption& eo); // overloading << Operator for printing out EuropeanOption as String
 
@@ -0,0 +1,316 @@
+/*
+* FiniteDifferenceEngine.cpp
+* Defines the FiniteDifferenceEngine class methods
+*/
+
+
+// Standard Libraries
+#include <cmath>
+#include <string>
+#include <iostream>
+#include <vector>
+
+// Custom header
+#include "FiniteDifferenceEngine.hpp"
+#include "OptionConstants.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		void solve_tridiagonal(double lower, const double* diag, double upper, const double* rhs, double* scratch, double* x, size_t n)
+		{
+			// x may alias rhs: rhs[i] is read before x[i] is written
+			double m = diag[0];
+			scratch[0] = upper / m;
+			x[0] = rhs[0] / m;
+			for (size_t i = 1; i < n; i++) // forward elimination
+			{
+				m = diag[i] - lower * scratch[i - 1];
+				scratch[i] = upper / m;
+				x[i] = (rhs[i] - lower * x[i - 1]) / m;
+			}
+			for (size_t i = n - 1; i-- > 0;) // back substitution
+			{
+				x[i] -= scratch[i] * x[i + 1];
+			}
+		}
+
+		void factor_tridiagonal(double lower, const double* diag, double upper, double* scratch, double* pivot, size_t n)
+		{
+			pivot[0] = 1.0 / diag[0];
+			scratch[0] = upper * pivot[0];
+			for (size_t i = 1; i < n; i++)
+			{
+				pivot[i] = 1.0 / (diag[i] - lower * scratch[i - 1]);
+				scratch[i] = upper * pivot[i];
+			}
+		}
+
+		void solve_factored_tridiagonal(double lower, const double* scratch, const double* pivot, const double* rhs, double* x, size_t n)
+		{
+			x[0] = rhs[0] * pivot[0];
+			for (size_t i = 1; i < n; i++)
+			{
+				x[i] = (rhs[i] - lower * x[i - 1]) * pivot[i];
+			}
+			for (size_t i = n - 1; i-- > 0;)
+			{
+				x[i] -= scratch[i] * x[i + 1];
+			}
+		}
+
+		FiniteDifferenceEngine::FiniteDifferenceEngine() : m_space_nodes(800), m_time_steps(200), m_rannacher_steps(2), m_early_exercise(PenaltyExercise) {}
+		FiniteDifferenceEngine::FiniteDifferenceEngine(size_t space_nodes, size_t time_steps) : m_space_nodes(800), m_time_steps(200), m_rannacher_steps(2), m_early_exercise(PenaltyExercise)
+		{
+			set_space_nodes(space_nodes);
+			set_time_steps(time_steps);
+		}
+
+		FiniteDifferenceEngine::FiniteDifferenceEngine(const FiniteDifferenceEngine& fde) : m_space_nodes(fde.m_space_nodes), m_time_steps(fde.m_time_steps), m_rannacher_steps(fde.m_rannacher_steps), m_early_exercise(fde.m_early_exercise) {} // Workspaces are not shared
+		FiniteDifferenceEngine::~FiniteDifferenceEngine() {}
+
+		FiniteDifferenceEngine& FiniteDifferenceEngine::operator = (const FiniteDifferenceEngine& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			m_space_nodes = source.m_space_nodes;
+			m_time_steps = source.m_time_steps;
+			m_rannacher_steps = source.m_rannacher_steps;
+			m_early_exercise = source.m_early_exercise; // keep our own workspaces
+			return *this; // return current object's pointer
+		}
+
+		void FiniteDifferenceEngine::set_space_nodes(size_t nodes)
+		{
+			if (nodes < 5)
+			{
+				cout << "Invalid number of space nodes" << endl;
+				return;
+			}
+			m_space_nodes = nodes;
+		}
+
+		void FiniteDifferenceEngine::set_time_steps(size_t steps)
+		{
+			if (steps < 1)
+			{
+				cout << "Invalid number of time steps" << endl;
+				return;
+			}
+			m_time_steps = steps;
+		}
+
+		void FiniteDifferenceEngine::set_rannacher_steps(size_t steps) { m_rannacher_steps = steps; }
+		void FiniteDifferenceEngine::set_early_exercise(EarlyExerciseMethod eem) { m_early_exercise = eem; }
+
+		size_t FiniteDifferenceEngine::space_nodes() const { return m_space_nodes; }
+		size_t FiniteDifferenceEngine::time_steps() const { return m_time_steps; }
+		size_t FiniteDifferenceEngine::rannacher_steps() const { return m_rannacher_steps; }
+		EarlyExerciseMethod FiniteDifferenceEngine::early_exercise() const { return m_early_exercise; }
+
+		void FiniteDifferenceEngine::spot_ladder(const Option& o, const double* S, double* out, size_t n)
+		{
+			spot_ladder(o.option_class(), o.option_type(), o.time_to_maturity(), o.strike_price(), o.volatility(), o.risk_free_rate(), o.cost_of_carry(), S, out, n);
+		}
+
+		// Indexes a parameter like an array of spots
+		struct ParameterSpots
+		{
+			const OptionParameter& parameter;
+			double operator [] (size_t i) const { return parameter.get((int)i); }
+		};
+
+		void FiniteDifferenceEngine::spot_ladder(const Option& o, const OptionParameter& spots, double* out)
+		{
+			ParameterSpots S = { spots };
+			ladder(o.option_class(), o.option_type(), o.time_to_maturity(), o.strike_price(), o.volatility(), o.risk_free_rate(), o.cost_of_carry(), S, out, spots.size());
+		}
+
+		double FiniteDifferenceEngine::price(OptionClass oc, OptionType type, double T, double K, double sig, double S, double r, double b)
+		{
+			double result = 0.0;
+			spot_ladder(oc, type, T, K, sig, r, b, &S, &result, 1);
+			return result;
+		}
+
+		void FiniteDifferenceEngine::spot_ladder(OptionClass oc, OptionType type, double T, double K, double sig, double r, double b, const double* S, double* out, size_t n)
+		{
+			ladder(oc, type, T, K, sig, r, b, S, out, n);
+		}
+
+		template<class Spots>
+		void FiniteDifferenceEngine::ladder(OptionClass oc, OptionType type, double T, double K, double sig, double r, double b, const Spots& S, double* out, size_t n)
+		{
+			if (oc != European && oc != AmericanFinite)
+			{
+				cout << "Invalid Option Class" << endl;
+				return;
+			}
+			if (n == 0) { return; }
+
+			double phi = (type == Call) ? 1.0 : -1.0;
+			if (T <= 0.0) // expired: intrinsic value
+			{
+				for (size_t i = 0; i < n; i++) { out[i] = fmax(phi * (S[i] - K), 0.0); }
+				return;
+			}
+			bool exercise = (oc == AmericanFinite) && !(type == Call && b >= r); // early exercise of a call never pays when b >= r
+
+			/*
+			* Grid: x_j = x0 + j*dx, j = 0..J, covering the ladder and the strike
+			* plus 5 standard deviations on each side, shifted so ln(K) is a node
+			*/
+			size_t J = m_space_nodes - 1;
+			double s_lo = S[0], s_hi = S[0];
+			for (size_t i = 1; i < n; i++) { s_lo = fmin(s_lo, S[i]); s_hi = fmax(s_hi, S[i]); }
+			double log_k = log(K);
+			double width = fmax(5.0 * sig * sqrt(T), 0.1);
+			double x_lo = fmin(log_k, log(s_lo)) - width;
+			double x_hi = fmax(log_k, log(s_hi)) + width;
+			double dx = (x_hi - x_lo) / (J - 1); // one spare interval absorbs the shift
+			double x0 = log_k - ceil((log_k - x_lo) / dx) * dx;
+
+			// Workspaces only grow, so repeated solves do not allocate
+			if (m_values.size() < m_space_nodes)
+			{
+				m_values.resize(m_space_nodes);
+				m_payoff.resize(m_space_nodes);
+				m_rhs.resize(m_space_nodes);
+				m_diag.resize(m_space_nodes);
+				m_scratch.resize(m_space_nodes);
+				m_active.resize(m_space_nodes);
+				m_factors.resize(4 * m_space_nodes);
+			}
+			double* v = m_values.data();
+			double* payoff = m_payoff.data();
+			double* rhs = m_rhs.data();
+			double* diag = m_diag.data();
+			double* scratch = m_scratch.data();
+			char* active = m_active.data();
+
+			for (size_t j = 0; j <= J; j++)
+			{
+				payoff[j] = fmax(phi * (exp(x0 + j * dx) - K), 0.0);
+				v[j] = payoff[j];
+				active[j] = 0;
+			}
+			double s_min = exp(x0), s_max = exp(x0 + J * dx);
+
+			// L V = a V[j-1] + d V[j] + c V[j+1], the Black-Scholes operator in x = ln(S)
+			double mu = b - 0.5 * sig * sig;
+			double a = 0.5 * sig * sig / (dx * dx) - 0.5 * mu / dx;
+			double c = 0.5 * sig * sig / (dx * dx) + 0.5 * mu / dx;
+			double d = -sig * sig / (dx * dx) - r;
+
+			const double penalty = 1e8; // large enough that V >= payoff holds to ~1e-8 relative
+			const double omega = 1.2; // PSOR relaxation
+			const double tolerance = 1e-10 * K; // PSOR stopping change
+
+			double dt = T / m_time_steps;
+			double tau = 0.0;
+
+			// Without early exercise the implicit matrices never change: eliminate both once
+			double* factors[2][2];
+			for (int k = 0; k < 2; k++)
+			{
+				factors[k][0] = m_factors.data() + 2 * k * m_space_nodes;
+				factors[k][1] = factors[k][0] + m_space_nodes;
+				double theta = (k == 0) ? 1.0 : 0.5;
+				double h = (k == 0) ? 0.5 * dt : dt;
+				for (size_t j = 1; j < J; j++) { diag[j] = 1.0 - theta * h * d; }
+				if (!exercise) { factor_tridiagonal(-theta * h * a, diag + 1, -theta * h * c, factors[k][0] + 1, factors[k][1] + 1, J - 1); }
+			}
+			size_t sub_steps = m_time_steps + (m_rannacher_steps < m_time_steps ? m_rannacher_steps : m_time_steps);
+			for (size_t step = 0; step < sub_steps; step++)
+			{
+				bool implicit = step < 2 * m_rannacher_steps; // Rannacher: two implicit Euler half steps per leading step
+				double theta = implicit ? 1.0 : 0.5;
+				double h = implicit ? 0.5 * dt : dt;
+				tau += h;
+
+				// Explicit half of the step, from the previous time level
+				for (size_t j = 1; j < J; j++)
+				{
+					rhs[j] = v[j] + (1.0 - theta) * h * (a * v[j - 1] + d * v[j] + c * v[j + 1]);
+				}
+				double lower = -theta * h * a;
+				double upper = -theta * h * c;
+				double diagonal = 1.0 - theta * h * d;
+
+				// Dirichlet boundaries: deep out of the money is worthless, deep in the money is the forward (or exercise) value
+				double forward_lo = phi * (s_min * exp((b - r) * tau) - K * exp(-r * tau));
+				double forward_hi = phi * (s_max * exp((b - r) * tau) - K * exp(-r * tau));
+				v[0] = fmax(exercise ? fmax(forward_lo, payoff[0]) : forward_lo, 0.0);
+				v[J] = fmax(exercise ? fmax(forward_hi, payoff[J]) : forward_hi, 0.0);
+
+				if (exercise && m_early_exercise == PsorExercise)
+				{
+					// Projected Gauss-Seidel on the implicit half, starting from the previous level
+					for (int iteration = 0; iteration < 1000; iteration++)
+					{
+						double change = 0.0;
+						for (size_t j = 1; j < J; j++)
+						{
+							double gs = (rhs[j] - lower * v[j - 1] - upper * v[j + 1]) / diagonal;
+							double next = fmax(v[j] + omega * (gs - v[j]), payoff[j]);
+							change = fmax(change, fabs(next - v[j]));
+							v[j] = next;
+						}
+						if (change <= tolerance) { break; }
+					}
+					continue;
+				}
+
+				rhs[1] -= lower * v[0];
+				rhs[J - 1] -= upper * v[J];
+				if (!exercise)
+				{
+					int k = implicit ? 0 : 1;
+					solve_factored_tridiagonal(lower, factors[k][0] + 1, factors[k][1] + 1, rhs + 1, v + 1, J - 1);
+					continue;
+				}
+
+				// Penalty iteration: pin nodes below the payoff with a stiff spring, repeat until the exercise region settles
+				for (size_t j = 1; j < J; j++) { active[j] = v[j] <= payoff[j] && payoff[j] > 0.0; }
+				for (int iteration = 0; iteration < 50; iteration++)
+				{
+					for (size_t j = 1; j < J; j++)
+					{
+						diag[j] = active[j] ? diagonal + penalty : diagonal;
+						v[j] = active[j] ? rhs[j] + penalty * payoff[j] : rhs[j];
+					}
+					solve_tridiagonal(lower, diag + 1, upper, v + 1, scratch + 1, v + 1, J - 1);
+
+					bool changed = false;
+					for (size_t j = 1; j < J; j++)
+					{
+						char now = v[j] < payoff[j];
+						changed = changed || (now != active[j]);
+						active[j] = now;
+					}
+					if (!changed) { break; }
+				}
+			}
+
+			// Cubic Lagrange interpolation in ln(S) through the 4 nodes around each spot
+			for (size_t i = 0; i < n; i++)
+			{
+				double t = (log(S[i]) - x0) / dx;
+				double base = floor(t);
+				if (base < 1.0) { base = 1.0; }
+				if (base > J - 2.0) { base = J - 2.0; }
+				size_t j = (size_t)base;
+				double u = t - base;
+				double w0 = -u * (u - 1.0) * (u - 2.0) / 6.0;
+				double w1 = (u + 1.0) * (u - 1.0) * (u - 2.0) / 2.0;
+				double w2 = -(u + 1.0) * u * (u - 2.0) / 2.0;
+				double w3 = (u + 1.0) * u * (u - 1.0) / 6.0;
+				out[i] = w0 * v[j - 1] + w1 * v[j] + w2 * v[j + 1] + w3 * v[j + 2];
+			}
+		}
+	}
+}
@@ -0,0 +1,96 @@
+/*
+* FiniteDifferenceEngine.hpp
+* Provides template methods for the Finite Difference Engine: solves the
+* Black-Scholes PDE once on a (log S, t) grid and reads prices for a whole
+* ladder of spots off the solution, for European and finite maturity
+* American options.
+*
+* Time stepping is Crank-Nicolson, with the first Rannacher steps each
+* replaced by two implicit Euler half steps to damp the payoff kink. Every
+* step is one tridiagonal (Thomas) solve; American options add early
+* exercise through a penalty iteration or PSOR. The strike is placed on a
+* grid node and prices are interpolated (cubic, in log S) onto the ladder.
+*
+* Grid workspaces are members that only grow, so repeated solves do not
+* allocate; give each thread its own engine.
+*/
+#ifndef FINITE_DIFFERENCE_ENGINE_HPP // Verify we have unique HPP file reference
+#define FINITE_DIFFERENCE_ENGINE_HPP // Name the file FINITE_DIFFERENCE_ENGINE_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "Option.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		// Thomas algorithm for constant off diagonals: solves lower*x[i-1] + diag[i]*x[i] + upper*x[i+1] = rhs[i], i < n
+		void solve_tridiagonal(double lower, const double* diag, double upper, const double* rhs, double* scratch, double* x, size_t n);
+
+		// Same algorithm split in two, so a matrix reused every time step is only eliminated once:
+		// factor_tridiagonal fills scratch and pivot (n each), the solve then needs no divisions
+		void factor_tridiagonal(double lower, const double* diag, double upper, double* scratch, double* pivot, size_t n);
+		void solve_factored_tridiagonal(double lower, const double* scratch, const double* pivot, const double* rhs, double* x, size_t n);
+
+		class FiniteDifferenceEngine
+		{
+		public:
+			FiniteDifferenceEngine(); // Default constructor: 800 space nodes, 200 time steps, 2 Rannacher steps, penalty
+			FiniteDifferenceEngine(size_t space_nodes, size_t time_steps); // Grid of given size
+			FiniteDifferenceEngine(const FiniteDifferenceEngine& fde);  // Copy constructor for Finite Difference Engine
+			~FiniteDifferenceEngine(); // Destructor: called when Finite Difference Engine gets removed from memory
+
+			// Operators
+			FiniteDifferenceEngine& operator = (const FiniteDifferenceEngine& source); // Assignment operator.
+
+			// Setter Methods
+			void set_space_nodes(size_t nodes); // Nodes in log S, boundaries included (at least 5)
+			void set_time_steps(size_t steps); // Crank-Nicolson steps (at least 1)
+			void set_rannacher_steps(size_t steps); // Leading steps replaced by implicit Euler half steps
+			void set_early_exercise(EarlyExerciseMethod eem);
+
+			// Getter Methods
+			size_t space_nodes() const;
+			size_t time_steps() const;
+			size_t rannacher_steps() const;
+			EarlyExerciseMethod early_exercise() const;
+
+			// Prices the option at each of the n spots in S with one solve, oc must be European or AmericanFinite
+			void spot_ladder(OptionClass oc, OptionType type, double T, double K, double sig, double r, double b, const double* S, double* out, size_t n);
+
+			// Same, taking every parameter but the spot from an option
+			void spot_ladder(const Option& o, const double* S, double* out, size_t n);
+
+			// Same, reading the spots from a parameter in place (lazy ranges are not materialized), out holds spots.size() prices
+			void spot_ladder(const Option& o, const OptionParameter& spots, double* out);
+
+			// Single spot price
+			double price(OptionClass oc, OptionType type, double T, double K, double sig, double S, double r, double b);
+
+		private:
+			// Body of spot_ladder, Spots is a const double* or anything else giving the i-th spot as S[i]
+			template<class Spots>
+			void ladder(OptionClass oc, OptionType type, double T, double K, double sig, double r, double b, const Spots& S, double* out, size_t n);
+
+			size_t m_space_nodes;
+			size_t m_time_steps;
+			size_t m_rannacher_steps;
+			EarlyExerciseMethod m_early_exercise;
+
+			vector<double> m_values; // solution on the grid
+			vector<double> m_payoff; // exercise value on the grid
+			vector<double> m_rhs; // explicit half of each step
+			vector<double> m_diag; // (penalized) diagonal of each step
+			vector<double> m_scratch; // Thomas forward sweep
+			vector<double> m_factors; // factored implicit matrices: Rannacher then Crank-Nicolson (scratch, pivot each)
+			vector<char> m_active; // nodes where exercise is optimal (penalty)
+		};
+	}
+}
+#endif // !FINITE_DIFFERENCE_ENGINE_HPP
@@ -0,0 +1,317 @@
+/*
+* GenericFormulas.hpp
+* Provides template methods for the Black-Scholes, greek and perpetual
+* american formulas, written once over the scalar type R:
+* double: the instantiation behind OptionFormulas.cpp, so every double
+*   result of calculate_theoretical_price, calculate_delta... comes from here
+* float: single precision, normal CDF through erfc
+* Avx2Double / Avx512Double: lanes of utils/Simd.hpp, in translation units
+*   compiled for them. Every lane shares the option type; the batch kernels
+*   (BatchKernels.hpp) keep their own branch-free call/put form for mixed books
+* Utils::Dual<R>: forward-mode derivatives, see utils/Dual.hpp. The value
+*   part is bit-identical to the R result
+* Utils::Adjoint: reverse-mode derivatives recorded on the thread's tape, see
+*   utils/Tape.hpp. The values are bit-identical to the double result
+*
+* The math goes through the scalar_ primitives below, overloaded per type;
+* constants are spelled R(...) so no operation is promoted to double.
+* The operations and their order are those of the original double formulas.
+*
+* The templates have internal linkage, see utils/Simd.hpp.
+*/
+#ifndef GENERIC_FORMULAS_HPP // Verify we have unique HPP file reference
+#define GENERIC_FORMULAS_HPP // Name the file GENERIC_FORMULAS_HPP
+
+#include <cmath>
+
+#include "OptionConstants.hpp"
+#include "OptionFormulas.hpp"
+#include "../utils/Simd.hpp"
+#include "../utils/SimdMath.hpp"
+#include "../utils/NormalDistribution.hpp"
+#include "../utils/Dual.hpp"
+#include "../utils/Tape.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+		namespace {
+
+		/*
+		* Scalar primitives
+		*/
+
+		// double: same functions as the rest of OptionFormulas.cpp
+		inline double scalar_exp(double x) { return std::exp(x); }
+		inline double scalar_log(double x) { return std::log(x); }
+		inline double scalar_sqrt(double x) { return std::sqrt(x); }
+		inline double scalar_pow(double x, double y) { return std::pow(x, y); }
+		inline double scalar_N(double x) { return N(x); }
+		inline double scalar_n(double x) { return n(x); }
+
+		// float
+		inline float scalar_exp(float x) { return std::exp(x); }
+		inline float scalar_log(float x) { return std::log(x); }
+		inline float scalar_sqrt(float x) { return std::sqrt(x); }
+		inline float scalar_pow(float x, float y) { return std::pow(x, y); }
+		inline float scalar_N(float x) { return 0.5f * std::erfc(-x * 0.707106781f); } // N(x) = erfc(-x/sqrt(2))/2
+		inline float scalar_n(float x) { return 0.398942280f * std::exp(-0.5f * x * x); } // e^(-x^2/2)/sqrt(2pi)
+
+#if defined(__AVX2__)
+		// AVX2 lanes, pow for positive bases only
+		inline Utils::Avx2Double scalar_exp(Utils::Avx2Double x) { return Utils::vexp(x); }
+		inline Utils::Avx2Double scalar_log(Utils::Avx2Double x) { return Utils::vlog(x); }
+		inline Utils::Avx2Double scalar_sqrt(Utils::Avx2Double x) { return Utils::vsqrt(x); }
+		inline Utils::Avx2Double scalar_pow(Utils::Avx2Double x, Utils::Avx2Double y) { return Utils::vexp(y * Utils::vlog(x)); }
+		inline Utils::Avx2Double scalar_N(Utils::Avx2Double x) { return Utils::vnormal_cdf(x); }
+		inline Utils::Avx2Double scalar_n(Utils::Avx2Double x) { return Utils::vnormal_pdf(x); }
+#endif // __AVX2__
+
+#if defined(__AVX512F__)
+		// AVX-512 lanes, pow for positive bases only
+		inline Utils::Avx512Double scalar_exp(Utils::Avx512Double x) { return Utils::vexp(x); }
+		inline Utils::Avx512Double scalar_log(Utils::Avx512Double x) { return Utils::vlog(x); }
+		inline Utils::Avx512Double scalar_sqrt(Utils::Avx512Double x) { return Utils::vsqrt(x); }
+		inline Utils::Avx512Double scalar_pow(Utils::Avx512Double x, Utils::Avx512Double y) { return Utils::vexp(y * Utils::vlog(x)); }
+		inline Utils::Avx512Double scalar_N(Utils::Avx512Double x) { return Utils::vnormal_cdf(x); }
+		inline Utils::Avx512Double scalar_n(Utils::Avx512Double x) { return Utils::vnormal_pdf(x); }
+#endif // __AVX512F__
+
+		// Duals: chain rule over the primitives of T (which may itself be a Dual)
+		template<class T>
+		inline Utils::Dual<T> scalar_exp(const Utils::Dual<T>& x)
+		{
+			T e = scalar_exp(x.value);
+			return Utils::dual_chain(x, e, e);
+		}
+
+		template<class T>
+		inline Utils::Dual<T> scalar_log(const Utils::Dual<T>& x) { return Utils::dual_chain(x, scalar_log(x.value), T(1) / x.value); }
+
+		template<class T>
+		inline Utils::Dual<T> scalar_sqrt(const Utils::Dual<T>& x)
+		{
+			T s = scalar_sqrt(x.value);
+			return Utils::dual_chain(x, s, T(0.5) / s);
+		}
+
+		// x^y for a positive base: d(x^y) = x^y (y' ln(x) + y x'/x)
+		template<class T>
+		inline Utils::Dual<T> scalar_pow(const Utils::Dual<T>& x, const Utils::Dual<T>& y)
+		{
+			T p = scalar_pow(x.value, y.value);
+			return Utils::Dual<T>(p, p * (y.derivative * scalar_log(x.value) + y.value * x.derivative / x.value));
+		}
+
+		// n'(x) = -x n(x)
+		template<class T>
+		inline Utils::Dual<T> scalar_n(const Utils::Dual<T>& x)
+		{
+			T d = scalar_n(x.value);
+			return Utils::dual_chain(x, d, -x.value * d);
+		}
+
+		template<class T>
+		inline Utils::Dual<T> scalar_N(const Utils::Dual<T>& x) { return Utils::dual_chain(x, scalar_N(x.value), scalar_n(x.value)); }
+
+		// Adjoints: one tape node per primitive
+		inline Utils::Adjoint scalar_exp(const Utils::Adjoint& x)
+		{
+			double e = std::exp(x.value);
+			return Utils::adjoint_chain(x, e, e);
+		}
+
+		inline Utils::Adjoint scalar_log(const Utils::Adjoint& x) { return Utils::adjoint_chain(x, std::log(x.value), 1.0 / x.value); }
+
+		inline Utils::Adjoint scalar_sqrt(const Utils::Adjoint& x)
+		{
+			double s = std::sqrt(x.value);
+			return Utils::adjoint_chain(x, s, 0.5 / s);
+		}
+
+		// x^y for a positive base
+		inline Utils::Adjoint scalar_pow(const Utils::Adjoint& x, const Utils::Adjoint& y)
+		{
+			double p = std::pow(x.value, y.value);
+			return Utils::adjoint_chain(x, y, p, y.value * p / x.value, p * std::log(x.value));
+		}
+
+		inline Utils::Adjoint scalar_N(const Utils::Adjoint& x) { return Utils::adjoint_chain(x, N(x.value), n(x.value)); }
+
+		inline Utils::Adjoint scalar_n(const Utils::Adjoint& x)
+		{
+			double d = n(x.value);
+			return Utils::adjoint_chain(x, d, -x.value * d);
+		}
+
+		/*
+		* Formulas, see OptionFormulas.hpp for the parameters
+		*/
+
+		// term used for black scholes
+		template<class R>
+		inline R generic_d1(R S, R K, R sig, R T, R b)
+		{
+			return (scalar_log(S / K) + (b + sig * sig * R(0.5)) * T) / (sig * scalar_sqrt(T)); // d1 = (ln(S/K) + (b+sig^2)*T/2)/(sig * sqrt(T))
+		}
+
+		// term used for black scholes
+		template<class R>
+		inline R generic_d2(R d1, R sig, R T)
+		{
+			return (d1 - sig * scalar_sqrt(T)); // d2 = d1 - sigma * sqrt(T)
+		}
+
+		// American perpetual option price
+		template<class R>
+		inline R generic_american_perpetual_price(OptionType type, R K, R sig, R S, R r, R b)
+		{
+			R sig2 = sig * sig;
+			R temp = b / sig2;
+			if (type == OptionType::Call)
+			{
+				R y1 = R(0.5) - temp + scalar_sqrt((temp - R(0.5)) * (temp - R(0.5)) + R(2) * r / sig2);
+				return (K / (y1 - R(1))) * scalar_pow((((y1 - R(1)) / y1) * S / K), y1);
+			}
+			else if (type == OptionType::Put)
+			{
+				R y2 = R(0.5) - temp - scalar_sqrt((temp - R(0.5)) * (temp - R(0.5)) + R(2) * r / sig2);
+				return (K / (R(1) - y2)) * scalar_pow((((y2 - R(1)) / y2) * S / K), y2);
+			}
+			return R(0);
+		}
+
+		// European option price
+		template<class R>
+		inline R generic_theoretical_price(OptionType type, R T, R K, R sig, R S, R r, R b)
+		{
+			R d1_val = generic_d1(S, K, sig, T, b);
+			R d2_val = generic_d2(d1_val, sig, T);
+
+			if (type == OptionType::Call) // If option type is call
+			{
+				return S * scalar_exp((b - r) * T) * scalar_N(d1_val) - K * scalar_exp(-r * T) * scalar_N(d2_val); // C = S*e^(bT-rT)*N(d1) - K*e^(-rT)*N(d2)
+			}
+			else if (type == OptionType::Put) // If option type is put
+			{
+				return K * scalar_exp(-r * T) * scalar_N(-d2_val) - S * scalar_exp((b - r) * T) * scalar_N(-d1_val); // P =  K*e^(-rT)*N(-d2) - S*e^(bT-rT)*N(-d1)
+			}
+			return R(0);
+		}
+
+		template<class R>
+		inline R generic_delta(OptionType type, R T, R K, R sig, R S, R r, R b)
+		{
+			R d1_val = generic_d1(S, K, sig, T, b);
+
+			if (type == OptionType::Call) // If option type is call
+			{
+				return scalar_exp((b - r) * T) * scalar_N(d1_val);
+			}
+			else if (type == OptionType::Put) // If option type is put
+			{
+				return scalar_exp((b - r) * T) * (scalar_N(d1_val) - R(1));
+			}
+			return R(0);
+		}
+
+		template<class R>
+		inline R generic_gamma(OptionType type, R T, R K, R sig, R S, R r, R b)
+		{
+			R d1_val = generic_d1(S, K, sig, T, b);
+
+			if (type == OptionType::Call || type == OptionType::Put) // If option type is call or put
+			{
+				return scalar_exp((b - r) * T) * scalar_n(d1_val) / (S * sig * scalar_sqrt(T));
+			}
+			return R(0);
+		}
+
+		template<class R>
+		inline R generic_vega(OptionType type, R T, R K, R sig, R S, R r, R b)
+		{
+			R d1_val = generic_d1(S, K, sig, T, b);
+
+			if (type == OptionType::Call || type == OptionType::Put) // If option type is call or put
+			{
+				return S * scalar_sqrt(T) * scalar_exp((b - r) * T) * scalar_n(d1_val);
+			}
+			return R(0);
+		}
+
+		template<class R>
+		inline R generic_theta(OptionType type, R T, R K, R sig, R S, R r, R b)
+		{
+			R d1_val = generic_d1(S, K, sig, T, b);
+			R d2_val = generic_d2(d1_val, sig, T);
+			R term_1 = (S * sig * scalar_exp((b - r) * T) * scalar_n(d1_val)) / (R(2) * scalar_sqrt(T));
+			R term_2 = (b - r) * S * scalar_exp((b - r) * T);
+			R term_3 = r * K * scalar_exp(-r * T);
+
+			if (type == OptionType::Call) // If option type is call
+			{
+				return -term_1 - term_2 * scalar_N(d1_val) - term_3 * scalar_N(d2_val);
+			}
+			else if (type == OptionType::Put) // If option type is put
+			{
+				return term_2 * scalar_N(-d1_val) + term_3 * scalar_N(-d2_val) - term_1;
+			}
+			return R(0);
+		}
+
+		// Rho with the carry moving with the rate (b = r)
+		template<class R>
+		inline R generic_rho(OptionType type, R T, R K, R sig, R S, R r, R b)
+		{
+			R d1_val = generic_d1(S, K, sig, T, b);
+			R d2_val = generic_d2(d1_val, sig, T);
+
+			if (type == OptionType::Call) // If option type is call
+			{
+				return T * K * scalar_exp(-r * T) * scalar_N(d2_val);
+			}
+			else if (type == OptionType::Put) // If option type is put
+			{
+				return -T * K * scalar_exp(-r * T) * scalar_N(-d2_val);
+			}
+			return R(0);
+		}
+
+		/*
+		* Exact spot derivatives from one evaluation on second order duals:
+		* the spot is seeded as S + e1 + e2, so price.value.derivative is the
+		* delta and price.derivative.derivative the gamma.
+		*/
+		template<class R>
+		inline Utils::Dual<Utils::Dual<R>> seed_spot(R S)
+		{
+			return Utils::Dual<Utils::Dual<R>>(Utils::Dual<R>(S, R(1)), Utils::Dual<R>(R(1), R(0)));
+		}
+
+		// European price, delta and gamma
+		template<class R>
+		inline void generic_dual_delta_gamma(OptionType type, R T, R K, R sig, R S, R r, R b, R& price, R& delta, R& gamma)
+		{
+			typedef Utils::Dual<Utils::Dual<R>> D;
+			D p = generic_theoretical_price<D>(type, D(T), D(K), D(sig), seed_spot(S), D(r), D(b));
+			price = p.value.value;
+			delta = p.value.derivative;
+			gamma = p.derivative.derivative;
+		}
+
+		// American perpetual price, delta and gamma
+		template<class R>
+		inline void generic_dual_american_perpetual_delta_gamma(OptionType type, R K, R sig, R S, R r, R b, R& price, R& delta, R& gamma)
+		{
+			typedef Utils::Dual<Utils::Dual<R>> D;
+			D p = generic_american_perpetual_price<D>(type, D(K), D(sig), seed_spot(S), D(r), D(b));
+			price = p.value.value;
+			delta = p.value.derivative;
+			gamma = p.derivative.derivative;
+		}
+
+		}
+	}
+}
+#endif // !GENERIC_FORMULAS_HPP
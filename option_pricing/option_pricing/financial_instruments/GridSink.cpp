@@ -0,0 +1,87 @@
+/*
+* GridSink.cpp
+* Defines the GridSink classes methods
+*/
+
+
+// Standard Libraries
+#include <string>
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <limits>
+
+// Custom header
+#include "GridSink.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		GridSink::~GridSink() {}
+
+		GridCallbackSink::GridCallbackSink(function<void(size_t, const double*, size_t)> callback) : m_callback(callback) {}
+
+		void GridCallbackSink::consume(size_t first_index, const double* values, size_t count)
+		{
+			m_callback(first_index, values, count);
+		}
+
+		GridReduction::GridReduction() : m_low(0), m_high(0) { reset(); }
+
+		GridReduction::GridReduction(size_t bins, double low, double high) : m_histogram(bins), m_low(low), m_high(high) { reset(); }
+
+		void GridReduction::reset()
+		{
+			m_count = 0;
+			m_sum = 0;
+			m_compensation = 0;
+			m_min = numeric_limits<double>::infinity();
+			m_max = -numeric_limits<double>::infinity();
+			m_argmin = 0;
+			m_argmax = 0;
+			m_underflow = 0;
+			m_overflow = 0;
+			for (size_t i = 0; i < m_histogram.size(); i++) { m_histogram[i] = 0; }
+		}
+
+		void GridReduction::consume(size_t first_index, const double* values, size_t count)
+		{
+			size_t bins = m_histogram.size();
+			double scale = bins > 0 ? bins / (m_high - m_low) : 0.0;
+			for (size_t i = 0; i < count; i++)
+			{
+				double v = values[i];
+
+				// Kahan summation
+				double y = v - m_compensation;
+				double t = m_sum + y;
+				m_compensation = (t - m_sum) - y;
+				m_sum = t;
+
+				if (v < m_min) { m_min = v; m_argmin = first_index + i; } // strict: keep first index on ties
+				if (v > m_max) { m_max = v; m_argmax = first_index + i; }
+
+				if (bins > 0)
+				{
+					if (v < m_low) { m_underflow++; }
+					else if (v < m_high) { m_histogram[std::min(bins - 1, (size_t)((v - m_low) * scale))]++; }
+					else { m_overflow++; } // also catches NaN
+				}
+			}
+			m_count += count;
+		}
+
+		size_t GridReduction::count() const { return m_count; }
+		double GridReduction::sum() const { return m_sum; }
+		double GridReduction::mean() const { return m_count > 0 ? m_sum / m_count : 0.0; }
+		double GridReduction::min() const { return m_min; }
+		double GridReduction::max() const { return m_max; }
+		size_t GridReduction::argmin() const { return m_argmin; }
+		size_t GridReduction::argmax() const { return m_argmax; }
+		const vector<size_t>& GridReduction::histogram() const { return m_histogram; }
+		size_t GridReduction::underflow() const { return m_underflow; }
+		size_t GridReduction::overflow() const { return m_overflow; }
+	}
+}
@@ -0,0 +1,78 @@
+/*
+* GridSink.hpp
+* Provides template methods for Grid Sinks: receivers of the tiles that
+* OptionManager::grid_pricer streams while walking a ParameterGrid.
+*
+* Tiles always arrive in increasing index order on the calling thread, so
+* sinks need no locking and reductions are deterministic for any thread count.
+*/
+#ifndef GRID_SINK_HPP // Verify we have unique HPP file reference
+#define GRID_SINK_HPP // Name the file GRID_SINK_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		// Base class of every sink
+		class GridSink
+		{
+		public:
+			virtual ~GridSink();
+			virtual void consume(size_t first_index, const double* values, size_t count) = 0; // values of points [first_index, first_index + count)
+		};
+
+		// Forwards each tile to a callback
+		class GridCallbackSink : public GridSink
+		{
+		public:
+			GridCallbackSink(function<void(size_t, const double*, size_t)> callback);
+			void consume(size_t first_index, const double* values, size_t count);
+
+		private:
+			function<void(size_t, const double*, size_t)> m_callback;
+		};
+
+		// In-flight reductions: count, compensated sum, mean, min/max with their indices and an optional histogram
+		class GridReduction : public GridSink
+		{
+		public:
+			GridReduction(); // Reduction without histogram
+			GridReduction(size_t bins, double low, double high); // Reduction with histogram of bins buckets over [low, high)
+
+			void consume(size_t first_index, const double* values, size_t count);
+			void reset(); // Clears every statistic
+
+			size_t count() const; // Number of values seen
+			double sum() const; // Kahan compensated sum of values
+			double mean() const; // sum / count
+			double min() const; // Smallest value
+			double max() const; // Largest value
+			size_t argmin() const; // Index of the smallest value (first one on ties)
+			size_t argmax() const; // Index of the largest value (first one on ties)
+			const vector<size_t>& histogram() const; // Bucket counts
+			size_t underflow() const; // Values below low
+			size_t overflow() const; // Values at or above high (and NaNs)
+
+		private:
+			size_t m_count;
+			double m_sum;
+			double m_compensation; // running error of the Kahan sum
+			double m_min;
+			double m_max;
+			size_t m_argmin;
+			size_t m_argmax;
+			vector<size_t> m_histogram;
+			double m_low;
+			double m_high;
+			size_t m_underflow;
+			size_t m_overflow;
+		};
+	}
+}
+#endif // !GRID_SINK_HPP
@@ -0,0 +1,104 @@
+/*
+* ImpliedVolatility.cpp
+* Defines the ImpliedVolatilitySolver class methods
+*/
+
+
+// Standard Libraries
+#include <stdlib.h>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+// Custom header
+#include "ImpliedVolatility.hpp"
+#include "BatchKernels.hpp"
+#include "BatchPricer.hpp"
+#include "OptionBatch.hpp"
+#include "OptionConstants.hpp"
+#include "../utils/ThreadPool.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		static const size_t CHUNK_SIZE = 1024; // Quotes per kernel call (and per parallel task)
+
+		ImpliedVolatilitySolver::ImpliedVolatilitySolver() : m_max_iterations(100), m_instruction_set(BatchPricer::supported_instruction_set()) {}
+		ImpliedVolatilitySolver::ImpliedVolatilitySolver(size_t threads) : m_max_iterations(100), m_instruction_set(BatchPricer::supported_instruction_set()) { set_threads(threads); }
+		ImpliedVolatilitySolver::ImpliedVolatilitySolver(const ImpliedVolatilitySolver& ivs) : m_max_iterations(ivs.m_max_iterations), m_instruction_set(ivs.m_instruction_set), pool(ivs.pool) {}
+		ImpliedVolatilitySolver::~ImpliedVolatilitySolver() {}
+
+		ImpliedVolatilitySolver& ImpliedVolatilitySolver::operator = (const ImpliedVolatilitySolver& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			m_max_iterations = source.m_max_iterations;
+			m_instruction_set = source.m_instruction_set;
+			pool = source.pool;
+			return *this; // return current object's pointer
+		}
+
+		void ImpliedVolatilitySolver::set_threads(size_t threads)
+		{
+			if (threads <= 1) { pool.reset(); }
+			else if (!pool || pool->size() != threads) { pool = make_shared<Utils::ThreadPool>(threads); }
+		}
+
+		void ImpliedVolatilitySolver::set_max_iterations(int iterations) { m_max_iterations = iterations; }
+
+		void ImpliedVolatilitySolver::set_instruction_set(SimdInstructionSet is)
+		{
+			m_instruction_set = min(is, BatchPricer::supported_instruction_set());
+		}
+
+		void ImpliedVolatilitySolver::solve(const OptionBatch& batch, const vector<double>& prices, vector<double>& vol, vector<int>& iterations, vector<ImpliedVolatilityStatus>& status) const
+		{
+			size_t n = min(batch.size(), prices.size());
+			vol.resize(n);
+			iterations.resize(n);
+			status.resize(n);
+			if (n == 0) { return; }
+			solve(prices.data(), batch.type.data(), batch.T.data(), batch.K.data(), batch.S.data(), batch.r.data(), batch.b.data(), vol.data(), iterations.data(), status.data(), n);
+		}
+
+		void ImpliedVolatilitySolver::solve(const double* price, const OptionType* type, const double* T, const double* K, const double* S, const double* r, const double* b, double* vol, int* iterations, ImpliedVolatilityStatus* status, size_t n) const
+		{
+			auto solve_range = [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; i += CHUNK_SIZE)
+				{
+					size_t m = min(CHUNK_SIZE, last - i);
+					solve_chunk(price + i, type + i, T + i, K + i, S + i, r + i, b + i, vol + i, iterations + i, status + i, m);
+				}
+			};
+			if (pool) { pool->parallel_for(0, n, CHUNK_SIZE, solve_range); }
+			else { solve_range(0, n); }
+		}
+
+		void ImpliedVolatilitySolver::solve_chunk(const double* price, const OptionType* type, const double* T, const double* K, const double* S, const double* r, const double* b, double* vol, int* iterations, ImpliedVolatilityStatus* status, size_t n) const
+		{
+			// Kernels report counts and status as doubles, converted on the way out
+			double iteration_lanes[CHUNK_SIZE];
+			double status_lanes[CHUNK_SIZE];
+
+			switch (m_instruction_set)
+			{
+			case AVX512Instructions: { implied_volatility_avx512(price, type, T, K, S, r, b, m_max_iterations, vol, iteration_lanes, status_lanes, n); break; }
+			case AVX2Instructions: { implied_volatility_avx2(price, type, T, K, S, r, b, m_max_iterations, vol, iteration_lanes, status_lanes, n); break; }
+			default: { implied_volatility_kernel<double>(price, type, T, K, S, r, b, m_max_iterations, vol, iteration_lanes, status_lanes, n); break; }
+			}
+
+			for (size_t i = 0; i < n; i++)
+			{
+				iterations[i] = (int)iteration_lanes[i];
+				status[i] = (ImpliedVolatilityStatus)(int)status_lanes[i];
+			}
+		}
+	}
+}
@@ -0,0 +1,69 @@
+/*
+* ImpliedVolatility.hpp
+* Provides template methods for the Implied Volatility Solver: backs out
+* Black-Scholes volatilities for whole option chains at once.
+*
+* Each quote starts from the Corrado-Miller rational guess and is refined
+* with safeguarded Halley steps (bisection whenever a step leaves the
+* bracket around the root), so every quote inside the no-arbitrage limits
+* converges. Quotes are solved in AVX2/AVX-512 lanes, chunks of the chain
+* in parallel on a thread pool.
+*/
+#ifndef IMPLIED_VOLATILITY_HPP // Verify we have unique HPP file reference
+#define IMPLIED_VOLATILITY_HPP // Name the file IMPLIED_VOLATILITY_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <memory>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "OptionBatch.hpp"
+#include "BatchPricer.hpp"
+#include "../utils/ThreadPool.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		enum ImpliedVolatilityStatus {
+			ImpliedVolConverged,
+			ImpliedVolBelowIntrinsic, // price <= max(0, intrinsic): no volatility reproduces it
+			ImpliedVolAboveMaximum, // price >= S*e^(bT-rT) (call) or K*e^(-rT) (put)
+			ImpliedVolNoConvergence, // iteration limit reached, volatility is the last iterate
+			ImpliedVolAboveBracket, // the price needs a volatility above the 10000% bracket cap (e.g. T near 0)
+		};
+
+		class ImpliedVolatilitySolver
+		{
+		public:
+			ImpliedVolatilitySolver(); // Default constructor: serial, widest instruction set
+			ImpliedVolatilitySolver(size_t threads); // Solver running chunks of quotes on threads threads
+			ImpliedVolatilitySolver(const ImpliedVolatilitySolver& ivs);  // Copy constructor for Implied Volatility Solver
+			~ImpliedVolatilitySolver(); // Destructor: called when Implied Volatility Solver gets removed from memory
+
+			// Operators
+			ImpliedVolatilitySolver& operator = (const ImpliedVolatilitySolver& source); // Assignment operator.
+
+			void set_threads(size_t threads); // 1 = serial
+			void set_max_iterations(int iterations); // Iteration limit per quote (default 100)
+			void set_instruction_set(SimdInstructionSet is); // Falls back if unsupported
+
+			// Solves every quote of the batch (its volatility column is ignored), outputs are resized to the batch size
+			void solve(const OptionBatch& batch, const vector<double>& prices, vector<double>& vol, vector<int>& iterations, vector<ImpliedVolatilityStatus>& status) const;
+
+			// Raw array entry point, vol is NaN for quotes outside the no-arbitrage limits
+			void solve(const double* price, const OptionType* type, const double* T, const double* K, const double* S, const double* r, const double* b, double* vol, int* iterations, ImpliedVolatilityStatus* status, size_t n) const;
+
+		private:
+			void solve_chunk(const double* price, const OptionType* type, const double* T, const double* K, const double* S, const double* r, const double* b, double* vol, int* iterations, ImpliedVolatilityStatus* status, size_t n) const;
+
+			int m_max_iterations;
+			SimdInstructionSet m_instruction_set;
+			shared_ptr<Utils::ThreadPool> pool; // null when serial
+		};
+	}
+}
+#endif // !IMPLIED_VOLATILITY_HPP
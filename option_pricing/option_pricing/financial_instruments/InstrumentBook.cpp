@@ -0,0 +1,112 @@
+/*
+* InstrumentBook.cpp
+* Defines the InstrumentBook class methods
+*/
+
+
+// Standard Libraries
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+// Custom header
+#include "InstrumentBook.hpp"
+#include "OptionConstants.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		static const size_t CHUNK_SIZE = 256; // Records transposed at once, the buffers stay in L1
+
+		InstrumentBook::InstrumentBook() : InstrumentBook(make_shared<Utils::Arena>()) {}
+
+		InstrumentBook::InstrumentBook(shared_ptr<Utils::Arena> arena) : m_arena(arena), m_records(nullptr), m_size(0), m_capacity(0) {}
+
+		InstrumentBook::~InstrumentBook() {}
+
+		void InstrumentBook::reserve(size_t n)
+		{
+			if (n <= m_capacity) { return; }
+			InstrumentRecord* records = (InstrumentRecord*)m_arena->allocate(n * sizeof(InstrumentRecord), alignof(InstrumentRecord));
+			if (m_size > 0) { memcpy(records, m_records, m_size * sizeof(InstrumentRecord)); }
+			m_records = records;
+			m_capacity = n;
+		}
+
+		void InstrumentBook::clear() { m_size = 0; }
+
+		void InstrumentBook::add(const InstrumentRecord& record)
+		{
+			if (m_size == m_capacity) { reserve(max((size_t)64, 2 * m_capacity)); }
+			m_records[m_size++] = record;
+		}
+
+		void InstrumentBook::add(const EuropeanOption& o) { add(make_record(o)); }
+		void InstrumentBook::add(const AmericanPerpetualOption& o) { add(make_record(o)); }
+
+		size_t InstrumentBook::size() const { return m_size; }
+		size_t InstrumentBook::capacity() const { return m_capacity; }
+		InstrumentRecord* InstrumentBook::data() { return m_records; }
+		const InstrumentRecord* InstrumentBook::data() const { return m_records; }
+		InstrumentRecord& InstrumentBook::operator [] (size_t i) { return m_records[i]; }
+		const InstrumentRecord& InstrumentBook::operator [] (size_t i) const { return m_records[i]; }
+
+		void InstrumentBook::theoretical_prices(const BatchPricer& pricer, vector<double>& out) const
+		{
+			out.resize(m_size);
+			bool invalid = false;
+
+			// One structure-of-arrays buffer per kernel
+			struct Columns {
+				OptionType type[CHUNK_SIZE];
+				double T[CHUNK_SIZE], K[CHUNK_SIZE], sig[CHUNK_SIZE], S[CHUNK_SIZE], r[CHUNK_SIZE], b[CHUNK_SIZE], price[CHUNK_SIZE];
+				size_t index[CHUNK_SIZE]; // position in the book
+				size_t n;
+			};
+			Columns columns[2]; // European, American
+
+			for (size_t first = 0; first < m_size; first += CHUNK_SIZE)
+			{
+				size_t last = min(first + CHUNK_SIZE, m_size);
+				columns[European].n = 0;
+				columns[American].n = 0;
+				for (size_t i = first; i < last; i++)
+				{
+					const InstrumentRecord& record = m_records[i];
+					if (record.option_class > American)
+					{
+						out[i] = NAN;
+						invalid = true;
+						continue;
+					}
+					Columns& c = columns[record.option_class];
+					size_t k = c.n++;
+					c.type[k] = (OptionType)record.type;
+					c.T[k] = record.T;
+					c.K[k] = record.K;
+					c.sig[k] = record.sig;
+					c.S[k] = record.S;
+					c.r[k] = record.r;
+					c.b[k] = record.b;
+					c.index[k] = i;
+				}
+
+				Columns& e = columns[European];
+				pricer.european_prices(e.type, e.T, e.K, e.sig, e.S, e.r, e.b, e.price, e.n);
+				Columns& a = columns[American];
+				pricer.american_perpetual_prices(a.type, a.K, a.sig, a.S, a.r, a.b, a.price, a.n);
+				for (int oc = European; oc <= American; oc++)
+				{
+					for (size_t k = 0; k < columns[oc].n; k++) { out[columns[oc].index[k]] = columns[oc].price[k]; }
+				}
+			}
+			if (invalid) { cout << "Invalid Option Class" << endl; } // AmericanFinite records need a lattice
+		}
+	}
+}
@@ -0,0 +1,68 @@
+/*
+* InstrumentBook.hpp
+* Provides template methods for Instrument Books: a contiguous array of
+* InstrumentRecords carved from an Arena.
+*
+* Growth doubles the capacity with a fresh arena block and memcpy; the old
+* block stays in the arena until it is reset, so reserve() the final size
+* when it is known. Several books may share one arena.
+*
+* Pricing transposes chunks of 256 records into structure-of-arrays buffers
+* on the stack and runs the BatchPricer kernels on them: no virtual call and
+* no heap allocation per option. European and perpetual American records
+* can be mixed; AmericanFinite records need a lattice and are priced NaN.
+*/
+#ifndef INSTRUMENT_BOOK_HPP // Verify we have unique HPP file reference
+#define INSTRUMENT_BOOK_HPP // Name the file INSTRUMENT_BOOK_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <memory>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "InstrumentRecord.hpp"
+#include "BatchPricer.hpp"
+#include "../utils/Arena.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+		class InstrumentBook
+		{
+		public:
+			InstrumentBook(); // Default constructor: empty book on its own arena
+			InstrumentBook(shared_ptr<Utils::Arena> arena); // Empty book carving its records from arena
+			~InstrumentBook(); // Destructor: the records go with the arena
+
+			void reserve(size_t n); // Room for n records in one block
+			void clear(); // Removes every record, keeps the capacity
+			void add(const InstrumentRecord& record);
+			void add(const EuropeanOption& o);
+			void add(const AmericanPerpetualOption& o);
+
+			// Getter Methods
+			size_t size() const;
+			size_t capacity() const;
+			InstrumentRecord* data(); // size() contiguous records, 64-byte aligned
+			const InstrumentRecord* data() const;
+			InstrumentRecord& operator [] (size_t i);
+			const InstrumentRecord& operator [] (size_t i) const;
+
+			// Prices every record according to its option class, writing into out (resized)
+			void theoretical_prices(const BatchPricer& pricer, vector<double>& out) const;
+
+		private:
+			InstrumentBook(const InstrumentBook& ib); // Non copyable: records live in the arena
+			InstrumentBook& operator = (const InstrumentBook& source);
+
+			shared_ptr<Utils::Arena> m_arena;
+			InstrumentRecord* m_records;
+			size_t m_size;
+			size_t m_capacity;
+		};
+	}
+}
+#endif // !INSTRUMENT_BOOK_HPP
@@ -0,0 +1,47 @@
+/*
+* InstrumentRecord.cpp
+* Defines the InstrumentRecord adapters
+*/
+
+
+// Standard Libraries
+#include <cmath>
+#include <cstring>
+
+// Custom header
+#include "InstrumentRecord.hpp"
+#include "OptionConstants.hpp"
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		InstrumentRecord make_record(OptionClass oc, OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc)
+		{
+			InstrumentRecord record;
+			memset(&record, 0, sizeof(record)); // no uninitialized padding in copies or files
+			record.S = ap;
+			record.K = sp;
+			record.T = ttm;
+			record.r = rf;
+			record.sig = vol;
+			record.b = cc;
+			record.option_class = (uint8_t)oc;
+			record.type = (uint8_t)t;
+			return record;
+		}
+
+		InstrumentRecord make_record(const EuropeanOption& o)
+		{
+			InstrumentRecord record = make_record(European, o.option_type(), o.current_price(), o.strike_price(), o.time_to_maturity(), o.risk_free_rate(), o.volatility(), o.cost_of_carry());
+			record.id = o.id();
+			return record;
+		}
+
+		InstrumentRecord make_record(const AmericanPerpetualOption& o)
+		{
+			InstrumentRecord record = make_record(American, o.option_type(), o.current_price(), o.strike_price(), o.time_to_maturity(), o.risk_free_rate(), o.volatility(), o.cost_of_carry());
+			record.id = o.id();
+			return record;
+		}
+	}
+}
@@ -0,0 +1,46 @@
+/*
+* InstrumentRecord.hpp
+* Provides template methods for Instrument Records: a plain 64-byte,
+* cache line aligned copy of an option's parameters.
+*
+* A record has no vtable and no owned members, so millions of them can sit
+* in one contiguous block (see InstrumentBook) and be copied with memcpy.
+* Adapters take the concrete option types, so filling a book needs no
+* virtual call either.
+*/
+#ifndef INSTRUMENT_RECORD_HPP // Verify we have unique HPP file reference
+#define INSTRUMENT_RECORD_HPP // Name the file INSTRUMENT_RECORD_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "EuropeanOption.hpp"
+#include "AmericanPerpetualOption.hpp"
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		struct alignas(64) InstrumentRecord {
+			double S; // current stock price
+			double K; // Strike price
+			double T; // Time to maturity (INFINITY for perpetual americans)
+			double r; // risk free rate
+			double sig; // volatility
+			double b; // cost of carry parameter
+			int32_t id; // Option::id of the source option
+			uint8_t option_class; // OptionClass
+			uint8_t type; // OptionType
+			uint8_t reserved[10]; // pads the record to one cache line
+		};
+		static_assert(sizeof(InstrumentRecord) == 64, "InstrumentRecord must fill exactly one cache line");
+		static_assert(std::is_trivially_copyable<InstrumentRecord>::value, "InstrumentRecord must stay POD");
+
+		// Adapters from the option classes
+		InstrumentRecord make_record(const EuropeanOption& o);
+		InstrumentRecord make_record(const AmericanPerpetualOption& o);
+		InstrumentRecord make_record(OptionClass oc, OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc); // raw parameters, id 0
+	}
+}
+#endif // !INSTRUMENT_RECORD_HPP
@@ -0,0 +1,457 @@
+/*
+* LatticeEngine.cpp
+* Defines the LatticeEngine class methods
+*/
+
+
+// Standard Libraries
+#include <cmath>
+#include <string>
+#include <iostream>
+#include <vector>
+
+// Custom header
+#include "LatticeEngine.hpp"
+#include "OptionConstants.hpp"
+#include "OptionFormulas.hpp"
+#include "GenericFormulas.hpp"
+#include "../utils/Tape.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		namespace {
+
+		// Rolls slice v (and e with the control variate) from step last back to step 0 in place: node i only reads
+		// nodes i, i+1 (and i+2) of the later step
+		void roll_back(bool trinomial, bool control, double phi, double pu, double pm, double pd, const double* spot, double K, size_t n, size_t last, double* v, double* e)
+		{
+			for (size_t j = last; j-- > 0;)
+			{
+				const double* s = spot + n - j;
+				if (trinomial)
+				{
+					for (size_t i = 0; i <= 2 * j; i++)
+					{
+						double hold = pu * v[i + 2] + pm * v[i + 1] + pd * v[i];
+						double exercise = phi * (s[i] - K);
+						v[i] = (hold > exercise) ? hold : exercise; // not fmax: keeps the loop inlined and vectorizable
+					}
+					if (control)
+					{
+						for (size_t i = 0; i <= 2 * j; i++) { e[i] = pu * e[i + 2] + pm * e[i + 1] + pd * e[i]; }
+					}
+				}
+				else
+				{
+					for (size_t i = 0; i <= j; i++)
+					{
+						double hold = pu * v[i + 1] + pd * v[i];
+						double exercise = phi * (s[2 * i] - K);
+						v[i] = (hold > exercise) ? hold : exercise;
+					}
+					if (control)
+					{
+						for (size_t i = 0; i <= j; i++) { e[i] = pu * e[i + 1] + pd * e[i]; }
+					}
+				}
+			}
+		}
+
+		// First node of step j among the kept slices: steps k < j hold spread * k + 1 nodes each
+		size_t slice_offset(size_t j, size_t spread) { return j + spread * (j * (j + 1) / 2 - j); }
+
+		/*
+		* Same roll on Adjoint numbers. Recording three nodes per lattice node would make the tape hundreds of
+		* times the lattice, so the loop runs on values as above, keeping every slice in the tape's scratch
+		* memory, and the tape gets one checkpoint: its hand-written reverse walks the lattice forward from the
+		* root, recomputes each exercise decision from the kept slices and pushes the adjoints onto the later
+		* step, the branch probabilities, the spot ladder and the strike.
+		*/
+		void roll_back(bool trinomial, bool control, double phi, Utils::Adjoint pu, Utils::Adjoint pm, Utils::Adjoint pd, const Utils::Adjoint* spot, Utils::Adjoint K, size_t n, size_t last, Utils::Adjoint* v, Utils::Adjoint* e)
+		{
+			Utils::Tape& tape = Utils::thread_tape();
+			size_t spread = trinomial ? 2 : 1;
+			size_t nodes = spread * last + 1;
+			size_t ladder = 2 * n + 1;
+			size_t total = slice_offset(last, spread) + nodes;
+			double* values = (double*)tape.allocate(total * sizeof(double));
+			double* europeans = control ? (double*)tape.allocate(total * sizeof(double)) : nullptr;
+			double* spot_values = (double*)tape.allocate(ladder * sizeof(double));
+			double* spot_bars = (double*)tape.allocate(ladder * sizeof(double));
+			double* bars = (double*)tape.allocate(4 * nodes * sizeof(double)); // american and european adjoints of two steps
+			uint32_t* spot_nodes = (uint32_t*)tape.allocate(ladder * sizeof(uint32_t));
+			uint32_t* expiry_nodes = (uint32_t*)tape.allocate(2 * nodes * sizeof(uint32_t)); // american then european
+
+			for (size_t k = 0; k < ladder; k++)
+			{
+				spot_values[k] = spot[k].value;
+				spot_nodes[k] = spot[k].node;
+			}
+			double* expiry = values + slice_offset(last, spread);
+			double* european_expiry = control ? europeans + slice_offset(last, spread) : nullptr;
+			for (size_t i = 0; i < nodes; i++)
+			{
+				expiry[i] = v[i].value;
+				expiry_nodes[i] = v[i].node;
+				expiry_nodes[nodes + i] = e[i].node;
+				if (control) { european_expiry[i] = e[i].value; }
+			}
+
+			double up = pu.value, mid = pm.value, down = pd.value, strike = K.value;
+			for (size_t j = last; j-- > 0;)
+			{
+				const double* later = values + slice_offset(j + 1, spread);
+				double* now = values + slice_offset(j, spread);
+				const double* s = spot_values + n - j;
+				if (trinomial)
+				{
+					for (size_t i = 0; i <= 2 * j; i++)
+					{
+						double hold = up * later[i + 2] + mid * later[i + 1] + down * later[i];
+						double exercise = phi * (s[i] - strike);
+						now[i] = (hold > exercise) ? hold : exercise;
+					}
+					if (control)
+					{
+						const double* e_later = europeans + slice_offset(j + 1, spread);
+						double* e_now = europeans + slice_offset(j, spread);
+						for (size_t i = 0; i <= 2 * j; i++) { e_now[i] = up * e_later[i + 2] + mid * e_later[i + 1] + down * e_later[i]; }
+					}
+				}
+				else
+				{
+					for (size_t i = 0; i <= j; i++)
+					{
+						double hold = up * later[i + 1] + down * later[i];
+						double exercise = phi * (s[2 * i] - strike);
+						now[i] = (hold > exercise) ? hold : exercise;
+					}
+					if (control)
+					{
+						const double* e_later = europeans + slice_offset(j + 1, spread);
+						double* e_now = europeans + slice_offset(j, spread);
+						for (size_t i = 0; i <= j; i++) { e_now[i] = up * e_later[i + 1] + down * e_later[i]; }
+					}
+				}
+			}
+
+			// The results are new nodes without operands, the checkpoint pushes their adjoints through the lattice
+			uint32_t american = tape.record(0, 0.0, 0, 0.0);
+			uint32_t european = tape.record(0, 0.0, 0, 0.0);
+			uint32_t parameters[4] = { pu.node, pm.node, pd.node, K.node };
+			tape.checkpoint(american, [=, &tape]()
+			{
+				double* v_bar = bars;
+				double* v_next = bars + nodes;
+				double* e_bar = bars + 2 * nodes;
+				double* e_next = bars + 3 * nodes;
+				double pu_bar = 0.0, pm_bar = 0.0, pd_bar = 0.0, K_bar = 0.0;
+				for (size_t k = 0; k < ladder; k++) { spot_bars[k] = 0.0; }
+				v_bar[0] = tape.adjoint(american);
+				e_bar[0] = tape.adjoint(european);
+
+				for (size_t j = 0; j < last; j++)
+				{
+					const double* later = values + slice_offset(j + 1, spread);
+					const double* s = spot_values + n - j;
+					double* s_bar = spot_bars + n - j;
+					size_t width = spread * (j + 1) + 1; // nodes of step j + 1
+					for (size_t i = 0; i < width; i++)
+					{
+						v_next[i] = 0.0;
+						e_next[i] = 0.0;
+					}
+					if (trinomial)
+					{
+						for (size_t i = 0; i <= 2 * j; i++)
+						{
+							double hold = up * later[i + 2] + mid * later[i + 1] + down * later[i];
+							double exercise = phi * (s[i] - strike);
+							if (hold > exercise)
+							{
+								v_next[i + 2] += up * v_bar[i];
+								v_next[i + 1] += mid * v_bar[i];
+								v_next[i] += down * v_bar[i];
+								pu_bar += v_bar[i] * later[i + 2];
+								pm_bar += v_bar[i] * later[i + 1];
+								pd_bar += v_bar[i] * later[i];
+							}
+							else
+							{
+								s_bar[i] += phi * v_bar[i];
+								K_bar -= phi * v_bar[i];
+							}
+						}
+						if (control)
+						{
+							const double* e_later = europeans + slice_offset(j + 1, spread);
+							for (size_t i = 0; i <= 2 * j; i++)
+							{
+								e_next[i + 2] += up * e_bar[i];
+								e_next[i + 1] += mid * e_bar[i];
+								e_next[i] += down * e_bar[i];
+								pu_bar += e_bar[i] * e_later[i + 2];
+								pm_bar += e_bar[i] * e_later[i + 1];
+								pd_bar += e_bar[i] * e_later[i];
+							}
+						}
+					}
+					else
+					{
+						for (size_t i = 0; i <= j; i++)
+						{
+							double hold = up * later[i + 1] + down * later[i];
+							double exercise = phi * (s[2 * i] - strike);
+							if (hold > exercise)
+							{
+								v_next[i + 1] += up * v_bar[i];
+								v_next[i] += down * v_bar[i];
+								pu_bar += v_bar[i] * later[i + 1];
+								pd_bar += v_bar[i] * later[i];
+							}
+							else
+							{
+								s_bar[2 * i] += phi * v_bar[i];
+								K_bar -= phi * v_bar[i];
+							}
+						}
+						if (control)
+						{
+							const double* e_later = europeans + slice_offset(j + 1, spread);
+							for (size_t i = 0; i <= j; i++)
+							{
+								e_next[i + 1] += up * e_bar[i];
+								e_next[i] += down * e_bar[i];
+								pu_bar += e_bar[i] * e_later[i + 1];
+								pd_bar += e_bar[i] * e_later[i];
+							}
+						}
+					}
+					swap(v_bar, v_next);
+					swap(e_bar, e_next);
+				}
+
+				for (size_t i = 0; i < nodes; i++)
+				{
+					tape.seed(expiry_nodes[i], v_bar[i]);
+					tape.seed(expiry_nodes[nodes + i], e_bar[i]);
+				}
+				for (size_t k = 0; k < ladder; k++) { tape.seed(spot_nodes[k], spot_bars[k]); }
+				tape.seed(parameters[0], pu_bar);
+				tape.seed(parameters[1], pm_bar);
+				tape.seed(parameters[2], pd_bar);
+				tape.seed(parameters[3], K_bar);
+			});
+
+			v[0] = Utils::Adjoint(values[0], american);
+			if (control) { e[0] = Utils::Adjoint(europeans[0], european); }
+		}
+
+		}
+
+		LatticeEngine::LatticeEngine() : m_lattice(BinomialLattice), m_steps(200), m_richardson(false), m_control_variate(false) {}
+		LatticeEngine::LatticeEngine(LatticeType lt, size_t steps) : m_lattice(lt), m_steps(200), m_richardson(false), m_control_variate(false)
+		{
+			set_steps(steps);
+		}
+
+		LatticeEngine::LatticeEngine(const LatticeEngine& le) : m_lattice(le.m_lattice), m_steps(le.m_steps), m_richardson(le.m_richardson), m_control_variate(le.m_control_variate) {} // Buffers are not shared
+		LatticeEngine::~LatticeEngine() {}
+
+		LatticeEngine& LatticeEngine::operator = (const LatticeEngine& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			m_lattice = source.m_lattice;
+			m_steps = source.m_steps;
+			m_richardson = source.m_richardson;
+			m_control_variate = source.m_control_variate; // keep our own buffers
+			return *this; // return current object's pointer
+		}
+
+		void LatticeEngine::set_lattice(LatticeType lt) { m_lattice = lt; }
+
+		void LatticeEngine::set_steps(size_t steps)
+		{
+			if (steps < 2)
+			{
+				cout << "Invalid number of lattice steps" << endl;
+				return;
+			}
+			m_steps = steps;
+		}
+
+		void LatticeEngine::set_richardson(bool on) { m_richardson = on; }
+		void LatticeEngine::set_control_variate(bool on) { m_control_variate = on; }
+
+		LatticeType LatticeEngine::lattice() const { return m_lattice; }
+		size_t LatticeEngine::steps() const { return m_steps; }
+		bool LatticeEngine::richardson() const { return m_richardson; }
+		bool LatticeEngine::control_variate() const { return m_control_variate; }
+
+		template<class R>
+		R LatticeEngine::value(OptionType type, R T, R K, R sig, R S, R r, R b, vector<R>* buffers)
+		{
+			double phi = (type == Call) ? 1.0 : -1.0;
+			if (T <= 0.0) // expired: intrinsic value
+			{
+				R intrinsic = phi * (S - K);
+				return (intrinsic > 0.0) ? intrinsic : R(0.0);
+			}
+			if (type == Call && b >= r) { return generic_theoretical_price(type, T, K, sig, S, r, b); } // early exercise of a call never pays
+
+			R european = 0.0;
+			R price = roll(type, T, K, sig, S, r, b, m_steps, m_richardson, european, buffers);
+
+			if (m_richardson)
+			{
+				R european_half = 0.0;
+				R price_half = roll(type, T, K, sig, S, r, b, m_steps / 2, true, european_half, buffers);
+				price = 2.0 * price - price_half;
+				european = 2.0 * european - european_half;
+			}
+
+			if (m_control_variate)
+			{
+				price = price + (generic_theoretical_price(type, T, K, sig, S, r, b) - european);
+			}
+			return price;
+		}
+
+		double LatticeEngine::price(OptionType type, double T, double K, double sig, double S, double r, double b)
+		{
+			return value<double>(type, T, K, sig, S, r, b, m_buffers);
+		}
+
+		OptionSensitivities LatticeEngine::sensitivities(OptionType type, double T, double K, double sig, double S, double r, double b)
+		{
+			static thread_local vector<Utils::Adjoint> buffers[3]; // grow once per thread, like m_buffers
+			Utils::Tape& tape = Utils::thread_tape();
+			tape.clear();
+			double values[6] = { K, S, T, r, sig, b }; // in OptionParameterType order
+			Utils::Adjoint x[6];
+			for (int j = 0; j < 6; j++) { x[j] = Utils::adjoint_input(values[j]); }
+			Utils::Adjoint price = value<Utils::Adjoint>(type, x[Maturity], x[StrikePrice], x[Volatility], x[AssetPrice], x[RFRate], x[CostOfCarry], buffers);
+
+			OptionSensitivities result;
+			result.price = price.value;
+			tape.seed(price.node, 1.0);
+			tape.propagate(1);
+			for (int j = 0; j < 6; j++) { result.sensitivity[j] = tape.adjoint(x[j].node); }
+			return result;
+		}
+
+		void LatticeEngine::prices(const OptionBatch& batch, vector<double>& out)
+		{
+			size_t n = batch.size();
+			out.resize(n);
+			if (batch.option_class() != AmericanFinite)
+			{
+				cout << "Invalid Option Class" << endl;
+				return;
+			}
+			for (size_t i = 0; i < n; i++)
+			{
+				out[i] = price(batch.type[i], batch.T[i], batch.K[i], batch.sig[i], batch.S[i], batch.r[i], batch.b[i]);
+			}
+		}
+
+		void LatticeEngine::prices(const OptionBatch& batch, vector<double>& out, PriceCache& cache)
+		{
+			size_t n = batch.size();
+			out.resize(n);
+			if (batch.option_class() != AmericanFinite)
+			{
+				cout << "Invalid Option Class" << endl;
+				return;
+			}
+			for (size_t i = 0; i < n; i++)
+			{
+				if (!cache.find_price(LatticeModel, batch.type[i], batch.T[i], batch.K[i], batch.sig[i], batch.S[i], batch.r[i], batch.b[i], out[i]))
+				{
+					out[i] = price(batch.type[i], batch.T[i], batch.K[i], batch.sig[i], batch.S[i], batch.r[i], batch.b[i]);
+					cache.insert_price(LatticeModel, batch.type[i], batch.T[i], batch.K[i], batch.sig[i], batch.S[i], batch.r[i], batch.b[i], out[i]);
+				}
+			}
+		}
+
+		template<class R>
+		R LatticeEngine::roll(OptionType type, R T, R K, R sig, R S, R r, R b, size_t n, bool smooth, R& european, vector<R>* buffers)
+		{
+			/*
+			* Node i of step j sits on spot ladder entry k + n with
+			* k = 2i - j for the binomial lattice (j + 1 nodes), and
+			* k = i - j for the trinomial lattice (2j + 1 nodes).
+			* Discounting is folded into the branch probabilities.
+			*/
+			double phi = (type == Call) ? 1.0 : -1.0;
+			R dt = T / (double)n;
+			R disc = scalar_exp(-r * dt);
+			bool trinomial = (m_lattice == TrinomialLattice);
+
+			R u, pu, pm = 0.0, pd;
+			if (trinomial)
+			{
+				R up = scalar_exp(sig * scalar_sqrt(0.5 * dt));
+				R down = 1.0 / up;
+				R carry = scalar_exp(0.5 * b * dt);
+				u = up * up;
+				pu = (carry - down) / (up - down);
+				pd = (up - carry) / (up - down);
+				pu = pu * pu;
+				pd = pd * pd;
+				pm = 1.0 - pu - pd;
+			}
+			else
+			{
+				u = scalar_exp(sig * scalar_sqrt(dt));
+				pu = (scalar_exp(b * dt) - 1.0 / u) / (u - 1.0 / u);
+				pd = 1.0 - pu;
+			}
+			pu = pu * disc;
+			pm = pm * disc;
+			pd = pd * disc;
+
+			// Buffers only grow, so repeated calls do not allocate
+			size_t ladder = 2 * n + 1;
+			if (buffers[0].size() < ladder)
+			{
+				for (int j = 0; j < 3; j++) { buffers[j].resize(ladder); }
+			}
+			R* spot = buffers[0].data();
+			R* v = buffers[1].data();
+			R* e = buffers[2].data();
+
+			spot[n] = S;
+			R d = 1.0 / u;
+			for (size_t k = 1; k <= n; k++)
+			{
+				spot[n + k] = spot[n + k - 1] * u;
+				spot[n - k] = spot[n - k + 1] * d;
+			}
+
+			// Payoff at expiry, or the Black-Scholes value one step before it when smoothing
+			size_t last = smooth ? n - 1 : n;
+			size_t nodes = trinomial ? 2 * last + 1 : last + 1;
+			for (size_t i = 0; i < nodes; i++)
+			{
+				R s = spot[trinomial ? i + n - last : 2 * i + n - last];
+				R exercise = phi * (s - K);
+				exercise = (exercise > 0.0) ? exercise : R(0.0);
+				R hold = smooth ? generic_theoretical_price(type, dt, K, sig, s, r, b) : exercise;
+				v[i] = (hold > exercise) ? hold : exercise;
+				e[i] = hold;
+			}
+
+			roll_back(trinomial, m_control_variate, phi, pu, pm, pd, spot, K, n, last, v, e);
+
+			european = e[0];
+			return v[0];
+		}
+	}
+}
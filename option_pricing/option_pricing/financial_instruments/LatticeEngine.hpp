@@ -0,0 +1,94 @@
+/*
+* LatticeEngine.hpp
+* Provides template methods for the Lattice Engine: prices finite maturity
+* American options on a recombining binomial or trinomial lattice.
+*
+* Only one time slice is kept in memory and rolled back in place, so a
+* lattice of N steps needs O(N) memory. The slice, spot ladder and European
+* control buffers are members that only ever grow: an engine pricing
+* thousands of contracts in a row allocates once, on the first (or largest)
+* step count. An engine is therefore not safe to share between threads,
+* give each thread its own copy.
+*
+* Sensitivities: the same pricing runs on Utils::Adjoint numbers, recording
+* the lattice set-up on the thread's tape (utils/Tape.hpp) and the roll back
+* as one checkpoint with a hand-written reverse, so one backward sweep gives
+* the derivative of the price with respect to S, K, T, r, sig and b.
+*
+* Optional accuracy improvements (both off by default):
+* Richardson: the step before expiry is replaced by the Black-Scholes value
+*   (Broadie-Detemple smoothing), which removes the odd/even oscillation so
+*   that 2*P(N) - P(N/2) cancels the leading 1/N error term.
+* Control variate: the European option is rolled on the same lattice, the
+*   lattice error on it is removed using the exact Black-Scholes price:
+*   P = P_american(lattice) + P_european(BS) - P_european(lattice).
+*/
+#ifndef LATTICE_ENGINE_HPP // Verify we have unique HPP file reference
+#define LATTICE_ENGINE_HPP // Name the file LATTICE_ENGINE_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "OptionBatch.hpp"
+#include "PriceCache.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+		class LatticeEngine
+		{
+		public:
+			LatticeEngine(); // Default constructor: 200 step binomial lattice, no corrections
+			LatticeEngine(LatticeType lt, size_t steps); // Lattice of given type and steps
+			LatticeEngine(const LatticeEngine& le);  // Copy constructor for Lattice Engine
+			~LatticeEngine(); // Destructor: called when Lattice Engine gets removed from memory
+
+			// Operators
+			LatticeEngine& operator = (const LatticeEngine& source); // Assignment operator.
+
+			// Setter Methods
+			void set_lattice(LatticeType lt);
+			void set_steps(size_t steps); // Number of time steps (at least 2), grows the buffers once
+			void set_richardson(bool on); // Smoothed Richardson extrapolation 2*P(N) - P(N/2)
+			void set_control_variate(bool on); // Black-Scholes control variate correction
+
+			// Getter Methods
+			LatticeType lattice() const;
+			size_t steps() const;
+			bool richardson() const;
+			bool control_variate() const;
+
+			// Returns the american theoretical price, parameters in the same order as OptionFormulas
+			double price(OptionType type, double T, double K, double sig, double S, double r, double b);
+
+			// Returns the american price and its sensitivity to every parameter from one adjoint sweep of the same lattice
+			// (exercise decisions frozen as taken), at a small multiple of the cost of price
+			OptionSensitivities sensitivities(OptionType type, double T, double K, double sig, double S, double r, double b);
+
+			// Prices every option of the batch in order, reusing the same buffers
+			void prices(const OptionBatch& batch, vector<double>& out);
+			void prices(const OptionBatch& batch, vector<double>& out, PriceCache& cache); // Same, reusing prices found in cache (keep one cache per engine setting)
+
+		private:
+			// Price with the corrections enabled, R is double or Utils::Adjoint (see sensitivities)
+			template<class R>
+			R value(OptionType type, R T, R K, R sig, R S, R r, R b, vector<R>* buffers);
+
+			// Rolls an n step lattice back to today, european is only rolled with the control variate
+			template<class R>
+			R roll(OptionType type, R T, R K, R sig, R S, R r, R b, size_t n, bool smooth, R& european, vector<R>* buffers);
+
+			LatticeType m_lattice;
+			size_t m_steps;
+			bool m_richardson;
+			bool m_control_variate;
+
+			vector<double> m_buffers[3]; // spot ladder S*u^k (k = -n..n), rolling american and european (control variate) time slices
+		};
+	}
+}
+#endif // !LATTICE_ENGINE_HPP
@@ -0,0 +1,330 @@
+/*
+* MarketData.cpp
+* Defines the MarketData class methods
+*/
+
+
+// Standard Libraries
+#include <cmath>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+// Custom header
+#include "MarketData.hpp"
+#include "OptionConstants.hpp"
+#include "OptionFormulas.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		static const size_t LATENCY_SAMPLES = 65536; // applied inputs kept for the percentiles
+
+		MarketData::MarketData() : m_book(European), m_epoch(0), m_dirty(European), m_tick_count(0), m_coalesced(0), m_running(false), m_batches(0), m_repriced(0), m_latency_next(0) {}
+
+		MarketData::~MarketData() { stop(); }
+
+		size_t MarketData::add_input(const string& name, double value)
+		{
+			lock_guard<mutex> graph(m_graph);
+			auto found = m_input_ids.find(name);
+			if (found != m_input_ids.end()) // already known: only its value changes
+			{
+				m_values[found->second] = value;
+				return found->second;
+			}
+			size_t id = m_values.size();
+			m_input_ids[name] = id;
+			m_values.push_back(value);
+			m_dependents.push_back(vector<Dependent>());
+			lock_guard<mutex> ticks(m_ticks);
+			m_pending_slot.push_back(-1);
+			return id;
+		}
+
+		size_t MarketData::input(const string& name) const
+		{
+			lock_guard<mutex> graph(m_graph);
+			auto found = m_input_ids.find(name);
+			return (found == m_input_ids.end()) ? m_values.size() : found->second;
+		}
+
+		size_t MarketData::add_contract(const Option& o)
+		{
+			if (o.option_class() != European) // the kernels give closed form greeks for Europeans only
+			{
+				cout << "Invalid Option Class" << endl;
+				return contracts();
+			}
+			lock_guard<mutex> graph(m_graph);
+			m_book.add(o);
+			m_stamp.push_back(0);
+			lock_guard<mutex> results(m_results);
+			m_greeks.push_back(calculate_price_and_greeks(o.option_type(), o.time_to_maturity(), o.strike_price(), o.volatility(), o.current_price(), o.risk_free_rate(), o.cost_of_carry()));
+			return m_greeks.size() - 1;
+		}
+
+		void MarketData::subscribe(size_t contract, OptionParameterType opt, size_t input)
+		{
+			lock_guard<mutex> graph(m_graph);
+			if (contract >= m_book.size())
+			{
+				cout << "Invalid contract" << endl;
+				return;
+			}
+			if (input >= m_values.size())
+			{
+				cout << "Invalid input" << endl;
+				return;
+			}
+			if (!column(opt))
+			{
+				cout << "Invalid Option Parameter" << endl;
+				return;
+			}
+			Dependent dependent = { (uint32_t)contract, opt };
+			m_dependents[input].push_back(dependent);
+			(*column(opt))[contract] = m_values[input]; // follows the current value from now on
+			lock_guard<mutex> results(m_results);
+			m_greeks[contract] = calculate_price_and_greeks(m_book.type[contract], m_book.T[contract], m_book.K[contract], m_book.sig[contract], m_book.S[contract], m_book.r[contract], m_book.b[contract]);
+		}
+
+		void MarketData::publish(size_t input, double value)
+		{
+			{
+				lock_guard<mutex> ticks(m_ticks);
+				if (input >= m_pending_slot.size())
+				{
+					cout << "Invalid input" << endl;
+					return;
+				}
+				m_tick_count++;
+				if (m_pending_slot[input] >= 0) // still pending: the older value is stale
+				{
+					m_pending[m_pending_slot[input]].value = value;
+					m_coalesced++;
+					return;
+				}
+				m_pending_slot[input] = (int64_t)m_pending.size();
+				PendingTick tick = { input, value, Clock::now() };
+				m_pending.push_back(tick);
+			}
+			m_wake.notify_one();
+		}
+
+		size_t MarketData::process()
+		{
+			lock_guard<mutex> graph(m_graph);
+			vector<PendingTick> pending;
+			{
+				lock_guard<mutex> ticks(m_ticks);
+				pending.swap(m_pending);
+				for (size_t i = 0; i < pending.size(); i++) { m_pending_slot[pending[i].input] = -1; }
+			}
+			if (pending.empty()) { return 0; }
+
+			// Applies the ticks and gathers every dependent contract once
+			m_epoch++;
+			m_dirty_ids.clear();
+			for (size_t i = 0; i < pending.size(); i++)
+			{
+				m_values[pending[i].input] = pending[i].value;
+				const vector<Dependent>& dependents = m_dependents[pending[i].input];
+				for (size_t k = 0; k < dependents.size(); k++)
+				{
+					(*column(dependents[k].parameter))[dependents[k].contract] = pending[i].value;
+					if (m_stamp[dependents[k].contract] != m_epoch)
+					{
+						m_stamp[dependents[k].contract] = m_epoch;
+						m_dirty_ids.push_back(dependents[k].contract);
+					}
+				}
+			}
+			size_t n = m_dirty_ids.size();
+			m_dirty.type.resize(n); m_dirty.S.resize(n); m_dirty.K.resize(n); m_dirty.T.resize(n); m_dirty.r.resize(n); m_dirty.sig.resize(n); m_dirty.b.resize(n);
+			for (size_t i = 0; i < n; i++) // after every tick: a contract may follow several inputs
+			{
+				uint32_t c = m_dirty_ids[i];
+				m_dirty.type[i] = m_book.type[c];
+				m_dirty.S[i] = m_book.S[c];
+				m_dirty.K[i] = m_book.K[c];
+				m_dirty.T[i] = m_book.T[c];
+				m_dirty.r[i] = m_book.r[c];
+				m_dirty.sig[i] = m_book.sig[c];
+				m_dirty.b[i] = m_book.b[c];
+			}
+			for (int j = 0; j < 6; j++) { m_columns[j].resize(n); }
+			if (n > 0)
+			{
+				m_pricer.european_greeks(m_dirty.type.data(), m_dirty.T.data(), m_dirty.K.data(), m_dirty.sig.data(), m_dirty.S.data(), m_dirty.r.data(), m_dirty.b.data(),
+					m_columns[0].data(), m_columns[1].data(), m_columns[2].data(), m_columns[3].data(), m_columns[4].data(), m_columns[5].data(), n);
+			}
+			{
+				lock_guard<mutex> results(m_results);
+				for (size_t i = 0; i < n; i++)
+				{
+					OptionGreeks g = { m_columns[0][i], m_columns[1][i], m_columns[2][i], m_columns[3][i], m_columns[4][i], m_columns[5][i] };
+					m_greeks[m_dirty_ids[i]] = g;
+				}
+			}
+
+			Clock::time_point published = Clock::now();
+			lock_guard<mutex> stats(m_stats);
+			m_batches++;
+			m_repriced += n;
+			for (size_t i = 0; i < pending.size(); i++)
+			{
+				record_latency(chrono::duration<double, micro>(published - pending[i].first).count());
+			}
+			return n;
+		}
+
+		void MarketData::start()
+		{
+			lock_guard<mutex> ticks(m_ticks);
+			if (m_running) { return; }
+			m_running = true;
+			m_worker = thread([this]()
+			{
+				while (true)
+				{
+					{
+						unique_lock<mutex> ticks(m_ticks);
+						m_wake.wait(ticks, [this]() { return !m_running || !m_pending.empty(); });
+						if (!m_running) { return; }
+					}
+					process(); // ticks arriving meanwhile are coalesced into the next batch
+				}
+			});
+		}
+
+		void MarketData::stop()
+		{
+			{
+				lock_guard<mutex> ticks(m_ticks);
+				if (!m_running) { return; }
+				m_running = false;
+			}
+			m_wake.notify_all();
+			m_worker.join();
+		}
+
+		void MarketData::set_instruction_set(SimdInstructionSet is)
+		{
+			lock_guard<mutex> graph(m_graph);
+			m_pricer.set_instruction_set(is);
+		}
+
+		void MarketData::reset_statistics()
+		{
+			{
+				lock_guard<mutex> ticks(m_ticks);
+				m_tick_count = 0;
+				m_coalesced = 0;
+			}
+			lock_guard<mutex> stats(m_stats);
+			m_batches = 0;
+			m_repriced = 0;
+			m_latencies.clear();
+			m_latency_next = 0;
+		}
+
+		size_t MarketData::inputs() const
+		{
+			lock_guard<mutex> graph(m_graph);
+			return m_values.size();
+		}
+
+		size_t MarketData::contracts() const
+		{
+			lock_guard<mutex> results(m_results);
+			return m_greeks.size();
+		}
+
+		double MarketData::value(size_t input) const
+		{
+			lock_guard<mutex> graph(m_graph);
+			if (input >= m_values.size())
+			{
+				cout << "Invalid input" << endl;
+				return 0.0;
+			}
+			return m_values[input];
+		}
+
+		OptionGreeks MarketData::greeks(size_t contract) const
+		{
+			lock_guard<mutex> results(m_results);
+			if (contract >= m_greeks.size())
+			{
+				cout << "Invalid contract" << endl;
+				return OptionGreeks{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+			}
+			return m_greeks[contract];
+		}
+
+		MarketDataStatistics MarketData::statistics() const
+		{
+			MarketDataStatistics s;
+			{
+				lock_guard<mutex> ticks(m_ticks);
+				s.ticks = m_tick_count;
+				s.coalesced = m_coalesced;
+			}
+			{
+				lock_guard<mutex> stats(m_stats);
+				s.batches = m_batches;
+				s.repriced = m_repriced;
+			}
+			s.latency_p50 = latency_percentile(0.5);
+			s.latency_p99 = latency_percentile(0.99);
+			s.latency_p999 = latency_percentile(0.999);
+			s.latency_max = latency_percentile(1.0);
+			return s;
+		}
+
+		double MarketData::latency_percentile(double q) const
+		{
+			vector<double> samples;
+			{
+				lock_guard<mutex> stats(m_stats);
+				samples = m_latencies;
+			}
+			if (samples.empty()) { return 0.0; }
+			q = fmin(fmax(q, 0.0), 1.0);
+			size_t k = (size_t)ceil(q * samples.size());
+			k = (k == 0) ? 0 : k - 1; // nearest rank
+			nth_element(samples.begin(), samples.begin() + k, samples.end());
+			return samples[k];
+		}
+
+		vector<double>* MarketData::column(OptionParameterType opt)
+		{
+			switch (opt)
+			{
+			case StrikePrice: { return &m_book.K; }
+			case AssetPrice: { return &m_book.S; }
+			case Maturity: { return &m_book.T; }
+			case RFRate: { return &m_book.r; }
+			case Volatility: { return &m_book.sig; }
+			case CostOfCarry: { return &m_book.b; }
+			default: { return nullptr; } // Invalid case
+			}
+		}
+
+		void MarketData::record_latency(double microseconds)
+		{
+			if (m_latencies.size() < LATENCY_SAMPLES) { m_latencies.push_back(microseconds); }
+			else { m_latencies[m_latency_next] = microseconds; }
+			m_latency_next = (m_latency_next + 1) % LATENCY_SAMPLES;
+		}
+	}
+}
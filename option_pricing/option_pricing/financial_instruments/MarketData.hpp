@@ -0,0 +1,145 @@
+/*
+* MarketData.hpp
+* Provides template methods for Market Data: named market inputs (spots,
+* rates, volatilities...) driving the price and greeks of the European
+* contracts subscribed to them.
+*
+* Dependency graph: every input keeps the list of (contract, parameter)
+* pairs following it. A tick only marks the input; process() applies every
+* pending input, gathers the contracts depending on at least one of them
+* into a structure-of-arrays batch and reprices it with the batch kernels
+* (closed form greeks). Other contracts are not touched.
+*
+* Coalescing: ticks on an input that is still pending overwrite its value,
+* so a burst arriving while a batch is being priced costs one repricing,
+* with the latest value. Skipped ticks are counted as coalesced.
+*
+* Latency: measured from the first tick that made an input pending to the
+* moment the greeks of its dependents are published, over the last 65536
+* applied inputs (see statistics and latency_percentile).
+*
+* Threads: publish may be called from any thread. Inputs, contracts and
+* subscriptions are best set up before start(); greeks can be read while the
+* worker runs.
+*/
+#ifndef MARKET_DATA_HPP // Verify we have unique HPP file reference
+#define MARKET_DATA_HPP // Name the file MARKET_DATA_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "Option.hpp"
+#include "OptionBatch.hpp"
+#include "BatchPricer.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		// Counters since the last reset_statistics, latencies in microseconds
+		struct MarketDataStatistics {
+			uint64_t ticks; // published
+			uint64_t coalesced; // overwritten by a later tick before being applied
+			uint64_t batches; // process calls that applied at least one tick
+			uint64_t repriced; // contracts repriced, over every batch
+			double latency_p50;
+			double latency_p99;
+			double latency_p999;
+			double latency_max;
+		};
+
+		class MarketData
+		{
+		public:
+			MarketData(); // Default constructor: no inputs or contracts, widest supported kernels
+			~MarketData(); // Destructor: stops the worker
+
+			// Graph
+			size_t add_input(const string& name, double value); // Returns the input id
+			size_t input(const string& name) const; // Id of a named input, inputs() if unknown
+			size_t add_contract(const Option& o); // European contract with o's parameters, returns the contract id
+			void subscribe(size_t contract, OptionParameterType opt, size_t input); // opt of contract now follows input
+
+			// Ticks
+			void publish(size_t input, double value); // Thread safe, coalesced with pending ticks of the same input
+			size_t process(); // Applies pending ticks and reprices their dependents, returns the contracts repriced
+			void start(); // Runs process on a worker thread whenever ticks are pending
+			void stop(); // Joins the worker, ticks still pending stay pending
+
+			// Setter Methods
+			void set_instruction_set(SimdInstructionSet is); // Batch kernels, falls back if unsupported
+			void reset_statistics();
+
+			// Getter Methods
+			size_t inputs() const;
+			size_t contracts() const;
+			double value(size_t input) const; // Last applied value
+			OptionGreeks greeks(size_t contract) const; // Price and greeks after the last batch
+			MarketDataStatistics statistics() const;
+			double latency_percentile(double q) const; // q in [0, 1], microseconds
+
+		private:
+			MarketData(const MarketData& md); // Non copyable: owns locks and a thread
+			MarketData& operator = (const MarketData& source);
+
+			typedef chrono::steady_clock Clock;
+			struct Dependent {
+				uint32_t contract;
+				OptionParameterType parameter;
+			};
+			struct PendingTick {
+				size_t input;
+				double value;
+				Clock::time_point first; // arrival of the oldest tick it replaces
+			};
+
+			vector<double>* column(OptionParameterType opt); // Column of m_book holding opt, null if invalid
+			void record_latency(double microseconds);
+
+			// Graph and contracts, guarded by m_graph
+			mutable mutex m_graph;
+			map<string, size_t> m_input_ids;
+			vector<double> m_values; // per input
+			vector<vector<Dependent>> m_dependents; // per input
+			OptionBatch m_book; // contract parameters
+			vector<uint64_t> m_stamp; // per contract, batch that last gathered it
+			uint64_t m_epoch; // batches processed
+			OptionBatch m_dirty; // scratch batch of contracts to reprice
+			vector<uint32_t> m_dirty_ids;
+			vector<double> m_columns[6]; // scratch kernel output, in OptionGreeks field order
+			BatchPricer m_pricer;
+
+			// Results, guarded by m_results
+			mutable mutex m_results;
+			vector<OptionGreeks> m_greeks; // per contract
+
+			// Pending ticks, guarded by m_ticks
+			mutable mutex m_ticks;
+			condition_variable m_wake;
+			vector<PendingTick> m_pending;
+			vector<int64_t> m_pending_slot; // per input, index in m_pending or -1
+			uint64_t m_tick_count;
+			uint64_t m_coalesced;
+			bool m_running;
+			thread m_worker;
+
+			// Statistics, guarded by m_stats
+			mutable mutex m_stats;
+			uint64_t m_batches;
+			uint64_t m_repriced;
+			vector<double> m_latencies; // ring of the last samples
+			size_t m_latency_next;
+		};
+	}
+}
+#endif // !MARKET_DATA_HPP
@@ -0,0 +1,509 @@
+/*
+* MonteCarloEngine.cpp
+* Defines the MonteCarloEngine class methods
+*/
+
+
+// Standard Libraries
+#include <cmath>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+// Custom header
+#include "MonteCarloEngine.hpp"
+#include "BatchKernels.hpp"
+#include "BatchPricer.hpp"
+#include "OptionConstants.hpp"
+#include "OptionFormulas.hpp"
+#include "GenericFormulas.hpp"
+#include "../utils/Philox.hpp"
+#include "../utils/ThreadPool.hpp"
+#include "../utils/Tape.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		static const size_t BLOCK_SIZE = 512; // Samples (or paths) per task and per partial sum, fixed so results never depend on the threads
+
+		// Uniforms of samples [first, first + n) at one time step, taken from Philox counter (sample, step)
+		static void draw_uniforms(uint64_t seed, size_t first, size_t step, double* u, size_t n)
+		{
+			uint32_t key[2] = { (uint32_t)seed, (uint32_t)(seed >> 32) };
+			uint32_t counter[4] = { 0, 0, (uint32_t)step, 0 };
+			uint32_t words[4];
+			for (size_t i = 0; i < n; i++)
+			{
+				uint64_t k = first + i;
+				counter[0] = (uint32_t)k;
+				counter[1] = (uint32_t)(k >> 32);
+				Utils::philox4x32(counter, key, words);
+				u[i] = Utils::philox_uniform(words[0], words[1]);
+			}
+		}
+
+		static void draw_normals(SimdInstructionSet is, const double* u, double* z, size_t n)
+		{
+			switch (is)
+			{
+			case AVX512Instructions: { normal_inverse_avx512(u, z, n); break; }
+			case AVX2Instructions: { normal_inverse_avx2(u, z, n); break; }
+			default: { normal_inverse_kernel<double>(u, z, n); break; }
+			}
+		}
+
+		static void lognormal_step(SimdInstructionSet is, const double* in, const double* z, double drift, double diffusion, double* out, size_t n)
+		{
+			switch (is)
+			{
+			case AVX512Instructions: { lognormal_step_avx512(in, z, drift, diffusion, out, n); break; }
+			case AVX2Instructions: { lognormal_step_avx2(in, z, drift, diffusion, out, n); break; }
+			default: { lognormal_step_kernel<double>(in, z, drift, diffusion, out, n); break; }
+			}
+		}
+
+		// Least squares fit of y on 1, x, x^2 from the sums n, x, x^2, x^3, x^4, y, xy, x^2y; false if singular
+		static bool fit_quadratic(const double* sums, double beta[3])
+		{
+			double a[3][4] = {
+				{ sums[0], sums[1], sums[2], sums[5] },
+				{ sums[1], sums[2], sums[3], sums[6] },
+				{ sums[2], sums[3], sums[4], sums[7] },
+			};
+			for (int c = 0; c < 3; c++) // Gaussian elimination with partial pivoting
+			{
+				int pivot = c;
+				for (int row = c + 1; row < 3; row++) { if (fabs(a[row][c]) > fabs(a[pivot][c])) { pivot = row; } }
+				if (fabs(a[pivot][c]) < 1e-12 * fabs(sums[0])) { return false; }
+				for (int col = 0; col < 4; col++) { swap(a[c][col], a[pivot][col]); }
+				for (int row = c + 1; row < 3; row++)
+				{
+					double f = a[row][c] / a[c][c];
+					for (int col = c; col < 4; col++) { a[row][col] -= f * a[c][col]; }
+				}
+			}
+			for (int c = 2; c >= 0; c--)
+			{
+				double s = a[c][3];
+				for (int col = c + 1; col < 3; col++) { s -= a[c][col] * beta[col]; }
+				beta[c] = s / a[c][c];
+			}
+			return true;
+		}
+
+		MonteCarloEngine::MonteCarloEngine() : m_paths(100000), m_time_steps(50), m_seed(1), m_antithetic(false), m_control_variate(false), m_instruction_set(BatchPricer::supported_instruction_set()) {}
+		MonteCarloEngine::MonteCarloEngine(size_t paths, size_t threads) : m_paths(100000), m_time_steps(50), m_seed(1), m_antithetic(false), m_control_variate(false), m_instruction_set(BatchPricer::supported_instruction_set())
+		{
+			set_paths(paths);
+			set_threads(threads);
+		}
+
+		MonteCarloEngine::MonteCarloEngine(const MonteCarloEngine& mce) : m_paths(mce.m_paths), m_time_steps(mce.m_time_steps), m_seed(mce.m_seed), m_antithetic(mce.m_antithetic), m_control_variate(mce.m_control_variate), m_instruction_set(mce.m_instruction_set), pool(mce.pool) {}
+		MonteCarloEngine::~MonteCarloEngine() {}
+
+		MonteCarloEngine& MonteCarloEngine::operator = (const MonteCarloEngine& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			m_paths = source.m_paths;
+			m_time_steps = source.m_time_steps;
+			m_seed = source.m_seed;
+			m_antithetic = source.m_antithetic;
+			m_control_variate = source.m_control_variate;
+			m_instruction_set = source.m_instruction_set;
+			pool = source.pool;
+			return *this; // return current object's pointer
+		}
+
+		void MonteCarloEngine::set_paths(size_t paths)
+		{
+			if (paths < (m_antithetic ? 3 : 2)) // the standard error needs at least 2 samples, after pairing with antithetic variates
+			{
+				cout << "Invalid number of paths" << endl;
+				return;
+			}
+			m_paths = paths;
+		}
+
+		void MonteCarloEngine::set_time_steps(size_t steps)
+		{
+			if (steps < 1)
+			{
+				cout << "Invalid number of time steps" << endl;
+				return;
+			}
+			m_time_steps = steps;
+		}
+
+		void MonteCarloEngine::set_seed(uint64_t seed) { m_seed = seed; }
+		void MonteCarloEngine::set_antithetic(bool on)
+		{
+			if (on && m_paths < 3) // 2 paths would pair into a single sample
+			{
+				cout << "Invalid number of paths for antithetic variates" << endl;
+				return;
+			}
+			m_antithetic = on;
+		}
+		void MonteCarloEngine::set_control_variate(bool on) { m_control_variate = on; }
+
+		void MonteCarloEngine::set_threads(size_t threads)
+		{
+			if (threads <= 1) { pool.reset(); }
+			else if (!pool || pool->size() != threads) { pool = make_shared<Utils::ThreadPool>(threads); }
+		}
+
+		void MonteCarloEngine::set_instruction_set(SimdInstructionSet is)
+		{
+			m_instruction_set = min(is, BatchPricer::supported_instruction_set());
+		}
+
+		size_t MonteCarloEngine::paths() const { return m_paths; }
+		size_t MonteCarloEngine::time_steps() const { return m_time_steps; }
+		uint64_t MonteCarloEngine::seed() const { return m_seed; }
+		bool MonteCarloEngine::antithetic() const { return m_antithetic; }
+		bool MonteCarloEngine::control_variate() const { return m_control_variate; }
+		size_t MonteCarloEngine::threads() const { return pool ? pool->size() : 1; }
+
+		MonteCarloResult MonteCarloEngine::price(const Option& o) const
+		{
+			switch (o.option_class())
+			{
+			case European: // Terminal payoff, one step
+			{
+				return european(o.option_type(), o.time_to_maturity(), o.strike_price(), o.volatility(), o.current_price(), o.risk_free_rate(), o.cost_of_carry());
+			}
+			case AmericanFinite: // Longstaff-Schwartz
+			{
+				vector<double> policy;
+				return american(o.option_type(), o.time_to_maturity(), o.strike_price(), o.volatility(), o.current_price(), o.risk_free_rate(), o.cost_of_carry(), policy);
+			}
+			default: // Invalid case
+			{
+				cout << "Invalid Option Class" << endl;
+				MonteCarloResult none = { 0.0, 0.0, 0 };
+				return none;
+			}
+			}
+		}
+
+		OptionSensitivities MonteCarloEngine::sensitivities(const Option& o) const
+		{
+			OptionType type = o.option_type();
+			double T = o.time_to_maturity(), K = o.strike_price(), sig = o.volatility(), S = o.current_price(), r = o.risk_free_rate(), b = o.cost_of_carry();
+			switch (o.option_class())
+			{
+			case European: // Terminal payoff, one step
+			{
+				return pathwise(type, T, K, sig, S, r, b, nullptr);
+			}
+			case AmericanFinite: // Exercise policy fitted by the Longstaff-Schwartz pricing, then frozen
+			{
+				vector<double> policy;
+				american(type, T, K, sig, S, r, b, policy);
+				OptionSensitivities result = pathwise(type, T, K, sig, S, r, b, &policy);
+				double phi = (type == Call) ? 1.0 : -1.0;
+				if (phi * (S - K) > result.price) // exercising today is always possible
+				{
+					OptionSensitivities intrinsic = { phi * (S - K), { -phi, phi, 0.0, 0.0, 0.0, 0.0 } };
+					return intrinsic;
+				}
+				return result;
+			}
+			default: // Invalid case
+			{
+				cout << "Invalid Option Class" << endl;
+				OptionSensitivities none = { 0.0, { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 } };
+				return none;
+			}
+			}
+		}
+
+		void MonteCarloEngine::for_each_block(size_t blocks, const function<void(size_t)>& task) const
+		{
+			auto run = [&](size_t first, size_t last) { for (size_t k = first; k < last; k++) { task(k); } };
+			if (pool) { pool->parallel_for(0, blocks, 1, run); }
+			else { run(0, blocks); }
+		}
+
+		MonteCarloResult MonteCarloEngine::european(OptionType type, double T, double K, double sig, double S, double r, double b) const
+		{
+			double phi = (type == Call) ? 1.0 : -1.0;
+			double drift = (b - 0.5 * sig * sig) * T;
+			double diffusion = sig * sqrt(T);
+			double discount = exp(-r * T);
+			size_t samples = m_antithetic ? (m_paths + 1) / 2 : m_paths;
+			vector<double> x(samples), y(samples);
+
+			for_each_block((samples + BLOCK_SIZE - 1) / BLOCK_SIZE, [&](size_t block)
+			{
+				double u[BLOCK_SIZE] = {}, z[BLOCK_SIZE], spot[BLOCK_SIZE], up[BLOCK_SIZE], down[BLOCK_SIZE];
+				size_t first = block * BLOCK_SIZE;
+				size_t n = min(BLOCK_SIZE, samples - first);
+				draw_uniforms(m_seed, first, 0, u, n);
+				draw_normals(m_instruction_set, u, z, n);
+				for (size_t i = 0; i < n; i++) { spot[i] = S; }
+				lognormal_step(m_instruction_set, spot, z, drift, diffusion, up, n);
+				if (m_antithetic) { lognormal_step(m_instruction_set, spot, z, drift, -diffusion, down, n); }
+				for (size_t i = 0; i < n; i++)
+				{
+					double payoff = discount * fmax(phi * (up[i] - K), 0.0);
+					if (m_antithetic) { payoff = 0.5 * (payoff + discount * fmax(phi * (down[i] - K), 0.0)); }
+					x[first + i] = payoff;
+					y[first + i] = payoff; // the control is the product itself
+				}
+			});
+
+			MonteCarloResult result = estimate(x, y, calculate_theoretical_price(type, T, K, sig, S, r, b));
+			result.paths = m_antithetic ? 2 * samples : samples;
+			return result;
+		}
+
+		MonteCarloResult MonteCarloEngine::american(OptionType type, double T, double K, double sig, double S, double r, double b, vector<double>& policy) const
+		{
+			/*
+			* Paths are stored step major, paths[(m - 1) * P + p] for exercise date m = 1..M,
+			* sample k owns path k and, with antithetic variates, its mirror k + samples.
+			*/
+			double phi = (type == Call) ? 1.0 : -1.0;
+			size_t M = m_time_steps;
+			double dt = T / M;
+			double drift = (b - 0.5 * sig * sig) * dt;
+			double diffusion = sig * sqrt(dt);
+			double discount = exp(-r * dt);
+			size_t samples = m_antithetic ? (m_paths + 1) / 2 : m_paths;
+			size_t P = m_antithetic ? 2 * samples : samples;
+			size_t sample_blocks = (samples + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			size_t path_blocks = (P + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			vector<double> paths(M * P);
+
+			for_each_block(sample_blocks, [&](size_t block)
+			{
+				double u[BLOCK_SIZE] = {}, z[BLOCK_SIZE], spot[BLOCK_SIZE]; // u zeroed: the compiler cannot see draw_uniforms fill it (-Wmaybe-uninitialized)
+				size_t first = block * BLOCK_SIZE;
+				size_t n = min(BLOCK_SIZE, samples - first);
+				for (size_t i = 0; i < n; i++) { spot[i] = S; }
+				for (size_t m = 1; m <= M; m++)
+				{
+					draw_uniforms(m_seed, first, m, u, n);
+					draw_normals(m_instruction_set, u, z, n);
+					double* row = paths.data() + (m - 1) * P;
+					const double* up = (m == 1) ? spot : row - P + first;
+					const double* down = (m == 1) ? spot : row - P + samples + first;
+					lognormal_step(m_instruction_set, up, z, drift, diffusion, row + first, n);
+					if (m_antithetic) { lognormal_step(m_instruction_set, down, z, drift, -diffusion, row + samples + first, n); }
+				}
+			});
+
+			// Backward induction: cash holds each path's cash flow, discounted to the current date
+			vector<double> cash(P);
+			const double* last = paths.data() + (M - 1) * P;
+			for (size_t p = 0; p < P; p++) { cash[p] = fmax(phi * (last[p] - K), 0.0); }
+
+			vector<double> sums(path_blocks * 8);
+			policy.assign(3 * M, numeric_limits<double>::quiet_NaN());
+			for (size_t m = M - 1; m >= 1; m--)
+			{
+				const double* row = paths.data() + (m - 1) * P;
+				for_each_block(path_blocks, [&](size_t block)
+				{
+					double* s = sums.data() + 8 * block;
+					fill(s, s + 8, 0.0);
+					size_t first = block * BLOCK_SIZE;
+					size_t end = min(first + BLOCK_SIZE, P);
+					for (size_t p = first; p < end; p++)
+					{
+						cash[p] *= discount;
+						if (phi * (row[p] - K) <= 0.0) { continue; } // regress on in the money paths only
+						double xx = row[p] / K, x2 = xx * xx, yy = cash[p];
+						s[0] += 1.0; s[1] += xx; s[2] += x2; s[3] += x2 * xx; s[4] += x2 * x2;
+						s[5] += yy; s[6] += xx * yy; s[7] += x2 * yy;
+					}
+				});
+
+				double total[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+				for (size_t block = 0; block < path_blocks; block++) // in block order
+				{
+					for (int j = 0; j < 8; j++) { total[j] += sums[8 * block + j]; }
+				}
+				double beta[3];
+				if (total[0] < 3.0 || !fit_quadratic(total, beta)) { continue; } // too few paths to estimate continuation
+				for (int j = 0; j < 3; j++) { policy[3 * (m - 1) + j] = beta[j]; }
+
+				for_each_block(path_blocks, [&](size_t block)
+				{
+					size_t first = block * BLOCK_SIZE;
+					size_t end = min(first + BLOCK_SIZE, P);
+					for (size_t p = first; p < end; p++)
+					{
+						double exercise = phi * (row[p] - K);
+						if (exercise <= 0.0) { continue; }
+						double xx = row[p] / K;
+						if (exercise > beta[0] + xx * (beta[1] + xx * beta[2])) { cash[p] = exercise; }
+					}
+				});
+			}
+
+			// Samples: cash flows discounted to today, control = discounted European payoff of the same path(s)
+			vector<double> x(samples), y(samples);
+			double to_today = discount;
+			double european_discount = exp(-r * T);
+			for (size_t k = 0; k < samples; k++)
+			{
+				x[k] = to_today * cash[k];
+				y[k] = european_discount * fmax(phi * (last[k] - K), 0.0);
+				if (m_antithetic)
+				{
+					x[k] = 0.5 * (x[k] + to_today * cash[samples + k]);
+					y[k] = 0.5 * (y[k] + european_discount * fmax(phi * (last[samples + k] - K), 0.0));
+				}
+			}
+
+			MonteCarloResult result = estimate(x, y, calculate_theoretical_price(type, T, K, sig, S, r, b));
+			result.price = fmax(result.price, fmax(phi * (S - K), 0.0)); // exercising today is always possible
+			result.paths = P;
+			return result;
+		}
+
+		OptionSensitivities MonteCarloEngine::pathwise(OptionType type, double T, double K, double sig, double S, double r, double b, const vector<double>* policy) const
+		{
+			/*
+			* Each block records the parameters and the per step terms once, then every
+			* sample after that mark: its discounted cash flow is seeded, swept back to
+			* the mark and rewound, so the tape never holds more than one path. The
+			* adjoints the terms gathered over the block are swept to the parameters
+			* last. Samples draw the normals of price(), block partials are added in
+			* block order.
+			*/
+			double phi = (type == Call) ? 1.0 : -1.0;
+			size_t M = policy ? m_time_steps : 1;
+			size_t samples = m_antithetic ? (m_paths + 1) / 2 : m_paths;
+			size_t blocks = (samples + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			vector<double> partials(blocks * 7); // price, then the sensitivities in OptionParameterType order
+			double values[6] = { K, S, T, r, sig, b };
+
+			for_each_block(blocks, [&](size_t block)
+			{
+				double u[BLOCK_SIZE];
+				vector<double> z(M * BLOCK_SIZE); // normal of sample i at date m in z[(m - 1) * BLOCK_SIZE + i]
+				size_t first = block * BLOCK_SIZE;
+				size_t n = min(BLOCK_SIZE, samples - first);
+				for (size_t m = 1; m <= M; m++)
+				{
+					draw_uniforms(m_seed, first, policy ? m : 0, u, n); // europeans draw at step 0, as in european()
+					draw_normals(m_instruction_set, u, z.data() + (m - 1) * BLOCK_SIZE, n);
+				}
+
+				Utils::Tape& tape = Utils::thread_tape();
+				tape.clear();
+				Utils::Adjoint x[6];
+				for (int j = 0; j < 6; j++) { x[j] = Utils::adjoint_input(values[j]); }
+				Utils::Adjoint dt = x[Maturity] / (double)M;
+				Utils::Adjoint drift = (x[CostOfCarry] - 0.5 * x[Volatility] * x[Volatility]) * dt;
+				Utils::Adjoint diffusion = x[Volatility] * scalar_sqrt(dt);
+				vector<Utils::Adjoint> discount(M); // to today from date m, at m - 1
+				discount[0] = scalar_exp(-x[RFRate] * dt);
+				for (size_t m = 1; m < M; m++) { discount[m] = discount[m - 1] * discount[0]; }
+				size_t mark = tape.mark();
+
+				// Discounted cash flow of the path of sample i, mirrored when sign is -1
+				auto cash_flow = [&](size_t i, double sign) -> Utils::Adjoint
+				{
+					Utils::Adjoint spot = x[AssetPrice];
+					for (size_t m = 1; m <= M; m++)
+					{
+						spot = spot * scalar_exp(drift + diffusion * (sign * z[(m - 1) * BLOCK_SIZE + i]));
+						double exercise = phi * (spot.value - K);
+						if (exercise <= 0.0) { continue; }
+						bool stop = (m == M);
+						if (!stop && !isnan(policy->at(3 * (m - 1)))) // exercise where it beats the fitted continuation
+						{
+							const double* beta = policy->data() + 3 * (m - 1);
+							double xx = spot.value / K;
+							stop = exercise > beta[0] + xx * (beta[1] + xx * beta[2]);
+						}
+						if (stop) { return discount[m - 1] * (phi * (spot - x[StrikePrice])); }
+					}
+					return Utils::Adjoint(0.0);
+				};
+
+				double price = 0.0;
+				for (size_t i = 0; i < n; i++)
+				{
+					Utils::Adjoint sample = cash_flow(i, 1.0);
+					if (m_antithetic) { sample = 0.5 * (sample + cash_flow(i, -1.0)); }
+					price += sample.value;
+					if (sample.node != 0)
+					{
+						tape.seed(sample.node, 1.0);
+						tape.propagate(mark);
+					}
+					tape.rewind(mark);
+				}
+				tape.propagate(1);
+
+				double* partial = partials.data() + 7 * block;
+				partial[0] = price;
+				for (int j = 0; j < 6; j++) { partial[1 + j] = tape.adjoint(x[j].node); }
+			});
+
+			double total[7] = { 0, 0, 0, 0, 0, 0, 0 };
+			for (size_t block = 0; block < blocks; block++) // in block order
+			{
+				for (int j = 0; j < 7; j++) { total[j] += partials[7 * block + j]; }
+			}
+			OptionSensitivities result;
+			result.price = total[0] / samples;
+			for (int j = 0; j < 6; j++) { result.sensitivity[j] = total[1 + j] / samples; }
+			return result;
+		}
+
+		MonteCarloResult MonteCarloEngine::estimate(const vector<double>& x, const vector<double>& y, double control_mean) const
+		{
+			// Sums of x, x^2, y, y^2, xy centered on the control mean (limits cancellation), per block then in block order
+			size_t n = x.size();
+			size_t blocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			vector<double> sums(blocks * 5);
+			for_each_block(blocks, [&](size_t block)
+			{
+				double* s = sums.data() + 5 * block;
+				fill(s, s + 5, 0.0);
+				size_t end = min((block + 1) * BLOCK_SIZE, n);
+				for (size_t i = block * BLOCK_SIZE; i < end; i++)
+				{
+					double dx = x[i] - control_mean, dy = y[i] - control_mean;
+					s[0] += dx; s[1] += dx * dx; s[2] += dy; s[3] += dy * dy; s[4] += dx * dy;
+				}
+			});
+			double total[5] = { 0, 0, 0, 0, 0 };
+			for (size_t block = 0; block < blocks; block++)
+			{
+				for (int j = 0; j < 5; j++) { total[j] += sums[5 * block + j]; }
+			}
+
+			double mean_x = total[0] / n, mean_y = total[2] / n;
+			double var_x = (total[1] - n * mean_x * mean_x) / (n - 1);
+			double var_y = (total[3] - n * mean_y * mean_y) / (n - 1);
+			double cov = (total[4] - n * mean_x * mean_y) / (n - 1);
+
+			double mean = mean_x, variance = var_x;
+			if (m_control_variate && var_y > 0.0)
+			{
+				double beta = cov / var_y; // variance minimizing coefficient
+				mean = mean_x - beta * mean_y; // the control's deviation from its known mean is removed
+				variance = fmax(var_x - beta * cov, 0.0);
+			}
+
+			MonteCarloResult result = { control_mean + mean, sqrt(variance / n), n };
+			return result;
+		}
+	}
+}
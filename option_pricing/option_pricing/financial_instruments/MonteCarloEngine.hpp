@@ -0,0 +1,110 @@
+/*
+* MonteCarloEngine.hpp
+* Provides template methods for the Monte Carlo Engine: simulates
+* geometric Brownian motion paths to price European options (terminal
+* payoff) and finite maturity American options (Longstaff-Schwartz
+* regression on 1, S/K, (S/K)^2 over the in the money paths).
+*
+* Reproducibility: path k draws its normals from the Philox counter
+* (k, step) under the seed, so its numbers depend on nothing but its index.
+* Paths are processed in fixed blocks whose partial sums are reduced in
+* block order, which makes results bit-identical for any number of threads
+* (for a given instruction set: AVX kernels round differently than scalar).
+*
+* Variance reduction:
+* Antithetic: every drawn path is paired with its mirror (-z), a sample is
+*   the pair average.
+* Control variate: the discounted European payoff on the same path, whose
+*   mean is known in closed form, with the regression optimal coefficient.
+*   For a European option this returns the analytic price with no error, it
+*   is meant for AmericanFinite.
+*
+* Sensitivities (adjoint, see utils/Tape.hpp): every path is recorded on
+* the thread's tape and swept back, giving the pathwise derivative of its
+* discounted cash flow with respect to S, K, T, r, sig and b at once. The
+* payoff kink has zero measure, so the averages are unbiased. Americans
+* first run the Longstaff-Schwartz pricing and then freeze its exercise
+* policy (first order optimal, the boundary's own sensitivity vanishes).
+* The price returned is the plain pathwise mean, without control variate.
+*/
+#ifndef MONTE_CARLO_ENGINE_HPP // Verify we have unique HPP file reference
+#define MONTE_CARLO_ENGINE_HPP // Name the file MONTE_CARLO_ENGINE_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "Option.hpp"
+#include "BatchPricer.hpp"
+#include "../utils/ThreadPool.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		struct MonteCarloResult {
+			double price;
+			double standard_error; // of the price estimate
+			size_t paths; // simulated paths, antithetic mirrors included
+		};
+
+		class MonteCarloEngine
+		{
+		public:
+			MonteCarloEngine(); // Default constructor: 100000 paths, 50 exercise dates, seed 1, serial
+			MonteCarloEngine(size_t paths, size_t threads); // Engine simulating paths paths on threads threads
+			MonteCarloEngine(const MonteCarloEngine& mce);  // Copy constructor for Monte Carlo Engine
+			~MonteCarloEngine(); // Destructor: called when Monte Carlo Engine gets removed from memory
+
+			// Operators
+			MonteCarloEngine& operator = (const MonteCarloEngine& source); // Assignment operator.
+
+			// Setter Methods
+			void set_paths(size_t paths); // Simulated paths, at least 2 (3 with antithetic variates, rounded up to an even number)
+			void set_time_steps(size_t steps); // Exercise dates of AmericanFinite options (Europeans need one step)
+			void set_seed(uint64_t seed); // Philox key
+			void set_antithetic(bool on); // Needs at least 3 paths, so pairing leaves 2 samples
+			void set_control_variate(bool on);
+			void set_threads(size_t threads); // 1 = serial, results do not depend on it
+			void set_instruction_set(SimdInstructionSet is); // Path generation kernels, falls back if unsupported
+
+			// Getter Methods
+			size_t paths() const;
+			size_t time_steps() const;
+			uint64_t seed() const;
+			bool antithetic() const;
+			bool control_variate() const;
+			size_t threads() const;
+
+			// Prices a European or AmericanFinite option
+			MonteCarloResult price(const Option& o) const;
+
+			// Returns the pathwise price and its sensitivity to every parameter, one adjoint sweep per path
+			OptionSensitivities sensitivities(const Option& o) const;
+
+		private:
+			// Runs task(block) for every block, on the pool when there is one
+			void for_each_block(size_t blocks, const function<void(size_t)>& task) const;
+
+			// Fills the discounted payoff x and control y of every sample, then reduces them to a result
+			MonteCarloResult european(OptionType type, double T, double K, double sig, double S, double r, double b) const;
+			MonteCarloResult american(OptionType type, double T, double K, double sig, double S, double r, double b, vector<double>& policy) const; // policy: fitted continuation of every date, NaN if unfitted
+			OptionSensitivities pathwise(OptionType type, double T, double K, double sig, double S, double r, double b, const vector<double>* policy) const; // policy null for Europeans
+			MonteCarloResult estimate(const vector<double>& x, const vector<double>& y, double control_mean) const;
+
+			size_t m_paths;
+			size_t m_time_steps;
+			uint64_t m_seed;
+			bool m_antithetic;
+			bool m_control_variate;
+			SimdInstructionSet m_instruction_set;
+			shared_ptr<Utils::ThreadPool> pool; // null when serial
+		};
+	}
+}
+#endif // !MONTE_CARLO_ENGINE_HPP
@@ -10,7 +10,9 @@
 #include <string>
 #include <iostream>
 
+#include <algorithm>
 #include <map>
+#include <memory>
 #include <vector>
 
 // Custom header
@@ -18,6 +20,9 @@
 #include "OptionConstants.hpp"
 #include "OptionParameter.hpp"
 #include "OptionFormulas.hpp"
+#include "PriceCache.hpp"
+#include "OptionInstrumentation.hpp"
+#include "../utils/Instrumentation.hpp"
 
 using namespace std;
 
@@ -28,9 +33,9 @@ namespace Colin {
 
 
 		// Constructor for Shape object, defaulting with random ID
-		Option::Option() : m_id(rand()), type(OptionType::Call), S(0), K(0), T(0), r(0), sig(0), b(0){}
+		Option::Option() : m_id(rand()), type(OptionType::Call), S(0), K(0), T(0), r(0), sig(0), b(0), dirty(AllTerms) {}
 
-		Option::Option(OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc) : m_id(rand()), type(t), S(ap), K(sp), T(ttm), r(rf), sig(vol), b(cc)
+		Option::Option(OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc) : m_id(rand()), type(t), S(ap), K(sp), T(ttm), r(rf), sig(vol), b(cc), dirty(AllTerms)
 		{
 			/*
 			* Parameters:
@@ -44,7 +49,7 @@ namespace Colin {
 			*/
 		}
 
-		Option::Option(OptionType t, double ap, double sp, double rf, double vol, double cc) : m_id(rand()), type(t), S(ap), K(sp), T(INFINITY), r(rf), sig(vol), b(cc)
+		Option::Option(OptionType t, double ap, double sp, double rf, double vol, double cc) : m_id(rand()), type(t), S(ap), K(sp), T(INFINITY), r(rf), sig(vol), b(cc), dirty(AllTerms)
 		{
 			/*
 			* Parameters:
@@ -58,7 +63,7 @@ namespace Colin {
 			*/
 		}
 
-		Option::Option(const Option& o) : m_id(o.m_id), type(o.type), S(o.S), K(o.K), T(o.T), r(o.r), sig(o.sig), b(o.b){}
+		Option::Option(const Option& o) : m_id(o.m_id), type(o.type), S(o.S), K(o.K), T(o.T), r(o.r), sig(o.sig), b(o.b), cache(o.cache), dirty(o.dirty), m_price_cache(o.m_price_cache) {}
 
 		Option::~Option() {}
 
@@ -77,41 +82,51 @@ namespace Colin {
 			r = source.r;
 			sig = source.sig;
 			b = source.b;
+			cache = source.cache;
+			dirty = source.dirty;
+			m_price_cache = source.m_price_cache;
 
 			return *this; // return current object's pointer
 		}
 
 		void Option::set_parameter(OptionParameterType opt, double value)
 		{
+			// Only the cached terms depending on the parameter are invalidated, and only if it changes
 			switch (opt)
 			{
 			case StrikePrice: // If parameter was strike price
 			{
+				if (K != value) { dirty |= SpotTerms; }
 				K = value;
 				break;
 			}
 			case AssetPrice: // If parameter is current asset price
 			{
+				if (S != value) { dirty |= SpotTerms; }
 				S = value;
 				break;
 			}
 			case Maturity: // If parameter is maturity date
 			{
+				if (T != value) { dirty |= AllTerms; }
 				T = value;
 				break;
 			}
 			case RFRate: // If parameter is risk free rate
 			{
+				if (r != value) { dirty |= DiscountTerm | CarryTerm | SpotTerms; }
 				r = value;
 				break;
 			}
 			case Volatility: // If parameter is volatility
 			{
+				if (sig != value) { dirty |= SqrtTerms | DriftTerm | SpotTerms; }
 				sig = value;
 				break;
 			}
 			case CostOfCarry: // If parameter was cost of carry
 			{
+				if (b != value) { dirty |= DriftTerm | CarryTerm | SpotTerms; }
 				b = value;
 				break;
 			}
@@ -127,6 +142,9 @@ namespace Colin {
 			h = val;
 		}
 
+		void Option::set_price_cache(shared_ptr<PriceCache> cache) { m_price_cache = cache; }
+		shared_ptr<PriceCache> Option::price_cache() const { return m_price_cache; }
+
 
 		// Getter Methods to return private variables of option
 		double Option::get(OptionParameterType opt) const
@@ -167,6 +185,13 @@ namespace Colin {
 
 		double Option::calculate(OptionFunctionType oft) const
 		{
+			INSTRUMENT_SCOPE(probe, calculate_probe(option_class(), oft), 1); // compiled out unless OPTION_PRICING_INSTRUMENTATION
+
+			if (m_price_cache) // memoized, the cache calls back into the methods below on a miss
+			{
+				return m_price_cache->calculate(*this, oft);
+			}
+
 			switch (oft)
 			{
 			case TheoreticalPrice: // If user chooses Theoretical Price to calculate
@@ -197,6 +222,10 @@ namespace Colin {
 			{
 				return this->approximate_gamma();
 			}
+			case Rho: // If user chooses Rho to calculate
+			{
+				return this->rho();
+			}
 			default: // Invalid case
 			{
 				cout << "Invalid Option Function" << endl;
@@ -227,31 +256,127 @@ namespace Colin {
 		
 		double Option::delta() const
 		{
-			return calculate_delta(type, T, K, sig, S, r, b);
+			return calculate_delta(type, terms(CarryTerm | N1Term));
 		}
 
 		double Option::gamma() const
 		{
-			return calculate_gamma(type, T, K, sig, S, r, b);
+			return calculate_gamma(S, terms(SqrtTerms | CarryTerm | DensityTerm));
 		}
 
 		double Option::vega() const
 		{
-			return calculate_vega(type, T, K, sig, S, r, b);
+			return calculate_vega(S, terms(SqrtTerms | CarryTerm | DensityTerm));
 		}
 
 		double Option::theta() const
 		{
-			return calculate_theta(type, T, K, sig, S, r, b);
+			return calculate_price_and_greeks(type, T, K, sig, S, r, b, intermediates()).theta;
+		}
+
+		double Option::rho() const
+		{
+			return calculate_rho(type, T, K, terms(DiscountTerm | N2Term));
+		}
+
+		// Default: one call per greek, subclasses with a closed form override this with a fused evaluation
+		OptionGreeks Option::greeks() const
+		{
+			OptionGreeks g;
+			g.price = this->theoretical_price();
+			g.delta = this->delta();
+			g.gamma = this->gamma();
+			g.vega = this->vega();
+			g.theta = this->theta();
+			g.rho = this->rho();
+			return g;
+		}
+
+		const OptionIntermediates& Option::intermediates() const
+		{
+			return terms(AllTerms);
+		}
+
+		const OptionIntermediates& Option::price_intermediates() const
+		{
+			return terms(AllTerms & ~DensityTerm);
+		}
+
+		const OptionIntermediates& Option::terms(unsigned needed) const
+		{
+			if (needed & (N1Term | N2Term | DensityTerm)) { needed |= D1Terms; } // normal values need d1, d2
+			if (needed & D1Terms) { needed |= SqrtTerms | DriftTerm; }
+			unsigned stale = dirty & needed;
+			if (stale == 0) { return cache; } // nothing changed since the last evaluation
+
+			if (stale & SqrtTerms)
+			{
+				cache.sqrt_T = sqrt(T);
+				cache.sig_sqrt_T = sig * cache.sqrt_T;
+			}
+			if (stale & DriftTerm) { cache.drift = (b + sig * sig * 0.5) * T; }
+			if (stale & DiscountTerm) { cache.discount = exp(-r * T); }
+			if (stale & CarryTerm) { cache.carry = exp((b - r) * T); }
+			if (stale & D1Terms)
+			{
+				cache.d1 = (log(S / K) + cache.drift) / cache.sig_sqrt_T;
+				cache.d2 = cache.d1 - cache.sig_sqrt_T;
+			}
+			double phi = (type == OptionType::Call) ? 1.0 : -1.0; // puts use N(-d)
+			if (stale & N1Term) { cache.N1 = N(phi * cache.d1); }
+			if (stale & N2Term) { cache.N2 = N(phi * cache.d2); }
+			if (stale & DensityTerm) { cache.n1 = n(cache.d1); }
+			dirty &= ~stale;
+			return cache;
 		}
 
+		// Default: bumps this->theoretical_price(), so every model approximates its own greeks
 		double Option::approximate_delta() const
 		{
-			return calculate_delta_approximation(type, T, K, sig, S, r, b, h);
+			return bumped_derivative(AssetPrice, h);
 		}
 		double Option::approximate_gamma() const
 		{
-			return calculate_gamma_approximation(type, T, K, sig, S, r, b, h);
+			return bumped_second_derivative(AssetPrice, h);
+		}
+
+		// Moves opt of o by shift from its value on source, the carry moving with the rate
+		static void shift_parameter(Option& o, const Option& source, OptionParameterType opt, double shift)
+		{
+			o.set_parameter(opt, source.get(opt) + shift);
+			if (opt == RFRate) { o.set_parameter(CostOfCarry, source.get(CostOfCarry) + shift); }
+		}
+
+		double Option::bumped_derivative(OptionParameterType opt, double step) const
+		{
+			if (opt == Maturity) { step = min(step, 0.5 * T); } // keep T - step > 0
+			unique_ptr<Option> bumped(this->clone()); // keeps the model (and its settings) of this option
+			shift_parameter(*bumped, *this, opt, step);
+			double up = bumped->theoretical_price();
+			shift_parameter(*bumped, *this, opt, -step);
+			double down = bumped->theoretical_price();
+			return (up - down) / (2 * step);
+		}
+
+		double Option::bumped_second_derivative(OptionParameterType opt, double step) const
+		{
+			return bumped_second_derivative(opt, step, this->theoretical_price());
+		}
+
+		double Option::bumped_second_derivative(OptionParameterType opt, double step, double center) const
+		{
+			if (opt == Maturity) { step = min(step, 0.5 * T); }
+			unique_ptr<Option> bumped(this->clone());
+			shift_parameter(*bumped, *this, opt, step);
+			double up = bumped->theoretical_price();
+			shift_parameter(*bumped, *this, opt, -step);
+			double down = bumped->theoretical_price();
+			return (up - 2 * center + down) / (step * step);
+		}
+
+		double Option::bump_step(OptionParameterType opt, double relative) const
+		{
+			return relative * max(fabs(get(opt)), 1.0);
 		}
 
 
@@ -8,6 +8,7 @@
 
 #include <string>
 #include <iostream>
+#include <memory>
 
 // Custom HPP files
 #include "OptionConstants.hpp"
@@ -17,6 +18,8 @@ using namespace std;
 
 namespace Colin {
 	namespace FinancialInstruments {
+		class PriceCache; // see PriceCache.hpp
+
 		class Option
 		{
 		public:
@@ -32,14 +35,18 @@ namespace Colin {
 			// Setter Methods
 			void set_parameter(OptionParameterType opt, double value); // Sets the parameter given with value
 			static void set_h(double val); // sets the error for approximating
+			void set_price_cache(shared_ptr<PriceCache> cache); // calculate() then consults cache first (null to stop), copies share it
 
 			// Getter Methods
 			double get(OptionParameterType opt) const; // Obtain value based on option parameter type
 			static double get_h();  // gets the error for approximating
+			shared_ptr<PriceCache> price_cache() const; // Cache consulted by calculate(), null if none
 			double calculate(OptionFunctionType oft) const; // Calculates the theoretical values based on what type of function type
 
 			int id() const; // getter method to return the ID
 			virtual OptionClass option_class() const = 0;
+			virtual PricingModel pricing_model() const = 0; // Model behind theoretical_price, tells apart the classes priced several ways
+			virtual Option* clone() const = 0; // Returns a heap allocated copy, caller owns it
 			double time_to_maturity() const; // exercise (maturity) date 
 			double strike_price() const; // Strike Price of option
 			double volatility() const; // Constant volatility
@@ -49,19 +56,47 @@ namespace Colin {
 			OptionType option_type() const; // Type of option (put or call)
 			OptionType complement_option_type() const; // Complement of Option
 
+			// Greeks default to Black-Scholes, models without closed form greeks override them (see the bumped methods below)
 			virtual double theoretical_price() const = 0; // Gets price of option 
-			double delta() const; // Gets delta of option
-			double gamma() const; // Gets gamma of option
-			double vega() const; // Gets vega of option
-			double theta() const; // Gets theta of option
-			double approximate_delta() const; // Approximates the delta value, given a small h value
-			double approximate_gamma() const; // Approximates the gamma value, given a small h value
+			virtual double delta() const; // Gets delta of option
+			virtual double gamma() const; // Gets gamma of option
+			virtual double vega() const; // Gets vega of option
+			virtual double theta() const; // Gets theta of option
+			virtual double rho() const; // Gets rho of option
+			virtual OptionGreeks greeks() const; // Gets price and all greeks in one call
+			const OptionIntermediates& intermediates() const; // Cached Black-Scholes terms, recomputes only what set_parameter invalidated
+			const OptionIntermediates& price_intermediates() const; // Same, leaving n(d1) stale: enough for the price
+			virtual double approximate_delta() const; // Approximates the delta value by bumping theoretical_price by h (see BumpGreeks for whole batches)
+			virtual double approximate_gamma() const; // Approximates the gamma value by bumping theoretical_price by h
 
 			double parity_price() const; // Gets the price of the opposite option based on put call parity
 
 			// String methods
 
+		protected:
+			// Central differences of theoretical_price, priced on a copy of the option; a RFRate bump moves
+			// the cost of carry with it, as rho does. Maturity steps are capped at half the maturity.
+			double bumped_derivative(OptionParameterType opt, double step) const; // d price / d opt
+			double bumped_second_derivative(OptionParameterType opt, double step) const; // d2 price / d opt2
+			double bumped_second_derivative(OptionParameterType opt, double step, double center) const; // Same, center already priced
+			double bump_step(OptionParameterType opt, double relative) const; // relative * max(|opt|, 1)
+
 		private:
+			// Groups of cached terms, each recomputed when one of its inputs changes
+			enum IntermediateTerms {
+				SqrtTerms = 1, // sqrt_T, sig_sqrt_T: T, sig
+				DriftTerm = 2, // drift: T, sig, b
+				DiscountTerm = 4, // discount: T, r
+				CarryTerm = 8, // carry: T, r, b
+				D1Terms = 16, // d1, d2: every parameter
+				N1Term = 32, // every parameter
+				N2Term = 64, // every parameter
+				DensityTerm = 128, // n1: every parameter
+				SpotTerms = D1Terms | N1Term | N2Term | DensityTerm, // everything a spot or strike change invalidates
+				AllTerms = 255,
+			};
+			const OptionIntermediates& terms(unsigned needed) const; // Recomputes the dirty terms among needed (with what they depend on)
+
 			int m_id; // id for each option, could be used eventually if making a trading system to track trades
 
 			double T; // Time to maturity
@@ -73,6 +108,10 @@ namespace Colin {
 			double b; // cost of carry parameter
 
 			static double h; // default gap for approximating greeks
+
+			mutable OptionIntermediates cache; // lazily computed, so an option must not be priced on two threads at once (clone it)
+			mutable unsigned dirty; // IntermediateTerms out of date
+			shared_ptr<PriceCache> m_price_cache; // memo shared between copies, thread safe
 		};
 	}
 }
@@ -0,0 +1,91 @@
+/*
+* OptionBatch.cpp
+* Defines the OptionBatch class methods
+*/
+
+
+// Standard Libraries
+#include <stdlib.h>
+#include <string>
+#include <iostream>
+#include <vector>
+
+// Custom header
+#include "OptionBatch.hpp"
+#include "OptionConstants.hpp"
+#include "Option.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		OptionBatch::OptionBatch() : batch_class(European) {}
+		OptionBatch::OptionBatch(OptionClass oc) : batch_class(oc) {}
+		OptionBatch::OptionBatch(const OptionBatch& ob) : type(ob.type), S(ob.S), K(ob.K), T(ob.T), r(ob.r), sig(ob.sig), b(ob.b), batch_class(ob.batch_class) {}
+		OptionBatch::~OptionBatch() {}
+
+		OptionBatch& OptionBatch::operator = (const OptionBatch& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			batch_class = source.batch_class;
+			type = source.type;
+			S = source.S;
+			K = source.K;
+			T = source.T;
+			r = source.r;
+			sig = source.sig;
+			b = source.b;
+			return *this; // return current object's pointer
+		}
+
+		void OptionBatch::reserve(size_t n)
+		{
+			type.reserve(n);
+			S.reserve(n);
+			K.reserve(n);
+			T.reserve(n);
+			r.reserve(n);
+			sig.reserve(n);
+			b.reserve(n);
+		}
+
+		void OptionBatch::clear()
+		{
+			type.clear();
+			S.clear();
+			K.clear();
+			T.clear();
+			r.clear();
+			sig.clear();
+			b.clear();
+		}
+
+		void OptionBatch::add(const Option& o)
+		{
+			if (o.option_class() != batch_class) // Mixed classes would need different kernels
+			{
+				cout << "Invalid Option Class for batch" << endl;
+				return;
+			}
+			add(o.option_type(), o.current_price(), o.strike_price(), o.time_to_maturity(), o.risk_free_rate(), o.volatility(), o.cost_of_carry());
+		}
+
+		void OptionBatch::add(OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc)
+		{
+			type.push_back(t);
+			S.push_back(ap);
+			K.push_back(sp);
+			T.push_back(ttm);
+			r.push_back(rf);
+			sig.push_back(vol);
+			b.push_back(cc);
+		}
+
+		OptionClass OptionBatch::option_class() const { return batch_class; }
+		size_t OptionBatch::size() const { return S.size(); }
+	}
+}
@@ -0,0 +1,54 @@
+/*
+* OptionBatch.hpp
+* Provides template methods for Option Batches: a structure-of-arrays book
+* of options of a single class, laid out for the batch pricing kernels
+*/
+#ifndef OPTION_BATCH_HPP // Verify we have unique HPP file reference
+#define OPTION_BATCH_HPP // Name the file OPTION_BATCH_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "Option.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+		class OptionBatch
+		{
+		public:
+			OptionBatch(); // Default constructor: empty European batch
+			OptionBatch(OptionClass oc); // Empty batch for given option class
+			OptionBatch(const OptionBatch& ob);  // Copy constructor for Option Batch
+			~OptionBatch(); // Destructor: called when Option Batch gets removed from memory
+
+			// Operators
+			OptionBatch& operator = (const OptionBatch& source); // Assignment operator.
+
+			void reserve(size_t n); // Reserves room for n options in every column
+			void clear(); // Removes every option, keeps the option class
+			void add(const Option& o); // Appends an option, must match the batch's option class
+			void add(OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc); // Appends raw parameters
+
+			OptionClass option_class() const; // Class shared by every option in the batch
+			size_t size() const; // Number of options in the batch
+
+			// Contiguous columns, one entry per option
+			vector<OptionType> type; // either call or put
+			vector<double> S; // current stock price
+			vector<double> K; // Strike price
+			vector<double> T; // Time to maturity (INFINITY for perpetual americans)
+			vector<double> r; // risk free rate
+			vector<double> sig; // volatility
+			vector<double> b; // cost of carry parameter
+
+		private:
+			OptionClass batch_class; // European, American or AmericanFinite
+		};
+	}
+}
+#endif // !OPTION_BATCH_HPP
@@ -35,11 +35,73 @@ namespace Colin {
             Theta,
             ApproxDelta,
             ApproxGamma,
+            Rho,
+        };
+
+        enum OptionParameterRange {
+            ArithmeticRange,
+            GeometricRange,
+            ChebyshevRange,
         };
 
         enum OptionClass {
             European,
-            American,
+            American, // perpetual
+            AmericanFinite, // finite maturity, priced on a lattice
+        };
+
+        // Model pricing an option, several share a class (e.g. AmericanFinite)
+        enum PricingModel {
+            BlackScholesModel,
+            PerpetualModel,
+            LatticeModel,
+            BaroneAdesiWhaleyModel,
+            BjerksundStenslandModel,
+        };
+
+        enum LatticeType {
+            BinomialLattice, // Cox-Ross-Rubinstein
+            TrinomialLattice, // Boyle / Kamrad-Ritchken
+        };
+
+        enum EarlyExerciseMethod {
+            PenaltyExercise, // Forsyth-Vetzal penalty iteration
+            PsorExercise, // Projected successive over-relaxation
+        };
+
+        // Price and every greek from one evaluation, see calculate_price_and_greeks
+        struct OptionGreeks {
+            double price;
+            double delta;
+            double gamma;
+            double vega;
+            double theta;
+            double rho;
+
+            double get(OptionFunctionType oft) const; // Returns the field matching oft (0 for approximations)
+        };
+
+        // Price and its first order sensitivity to every parameter, from one adjoint sweep (see utils/Tape.hpp)
+        // delta = AssetPrice, vega = Volatility, theta = -Maturity, rho (carry moving with the rate) = RFRate + CostOfCarry
+        struct OptionSensitivities {
+            double price;
+            double sensitivity[6]; // d price / d parameter, indexed by OptionParameterType
+
+            double get(OptionParameterType opt) const; // Returns the sensitivity to opt (0 if invalid)
+        };
+
+        // Black-Scholes terms shared by the price and every greek, cached on each Option (see Option::intermediates)
+        struct OptionIntermediates {
+            double sqrt_T; // sqrt(T)
+            double sig_sqrt_T; // sig*sqrt(T)
+            double drift; // (b + sig^2/2)*T
+            double discount; // e^(-rT)
+            double carry; // e^(bT-rT)
+            double d1;
+            double d2;
+            double N1; // N(d1) for calls, N(-d1) for puts
+            double N2; // N(d2) for calls, N(-d2) for puts
+            double n1; // n(d1)
         };
 	}
 }
@@ -12,7 +12,9 @@
 
 #include "OptionConstants.hpp"
 #include "OptionFormulas.hpp"
+#include "GenericFormulas.hpp"
 #include "Option.hpp"
+#include "../utils/NormalDistribution.hpp"
 
 using namespace std;
 
@@ -24,101 +26,216 @@ namespace Colin {
 		// Calculates american perpetual option price according to literature
 		double calculate_american_perpetual_theoretical_price(OptionType type, double K, double sig, double S, double r, double b)
 		{
-			double temp = b / pow(sig, 2);
-			if (type == OptionType::Call)
-			{
-				double y1 = 0.5 - temp + sqrt(pow(temp - 0.5, 2) + 2 * r / (pow(sig, 2)));
-				return (K / (y1 - 1)) * pow((((y1 - 1) / y1) * S / K), y1);
-			}
-			else if (type == OptionType::Put)
-			{
-				double y2 = 0.5 - temp - sqrt(pow(temp - 0.5, 2) + 2 * r / (pow(sig, 2)));
-				return (K / (1 - y2)) * pow((((y2 - 1) / y2) * S / K), y2);
-			}
-			return 0;
+			return generic_american_perpetual_price<double>(type, K, sig, S, r, b);
 		}
 
 		// Calculates theoretical european option price according to literature
         double calculate_theoretical_price(OptionType type, double T, double K, double sig, double S, double r, double b)
         {
-			double d1_val = d1(S, K, sig, T, b);
-			double d2_val = d2(d1_val, sig, T);
+			return generic_theoretical_price<double>(type, T, K, sig, S, r, b);
+        }
 
-			if (type == OptionType::Call) // If option type is call
-			{
-				return S * exp((b - r) * T) * N(d1_val) - K * exp(-r * T) * N(d2_val); // C = S*e^(bT-rT)*N(d1) - K*e^(-rT)*N(d2)
-			}
-			else if (type == OptionType::Put) // If option type is put
+		// Calculates finite maturity american price with the quadratic approximation of Barone-Adesi & Whaley (1987)
+		double calculate_barone_adesi_whaley_price(OptionType type, double T, double K, double sig, double S, double r, double b)
+		{
+			double european = calculate_theoretical_price(type, T, K, sig, S, r, b);
+			if ((type == OptionType::Call && b >= r) || (type == OptionType::Put && r <= 0)) { return european; } // early exercise never pays
+
+			double phi = (type == OptionType::Call) ? 1.0 : -1.0;
+			double sig2 = sig * sig;
+			double sig_sqrt_T = sig * sqrt(T);
+			double carry = exp((b - r) * T);
+			double n_term = 2 * b / sig2;
+			double m_term = 2 * r / sig2;
+			double k_term = (r == 0) ? 2 / (sig2 * T) : m_term / (1 - exp(-r * T)); // limit as r goes to 0
+			double q = 0.5 * (-(n_term - 1) + phi * sqrt(pow(n_term - 1, 2) + 4 * k_term)); // q2 (call) or q1 (put)
+
+			// Seed from the perpetual boundary (Haug), then Newton on the value matching condition
+			double q_inf = 0.5 * (-(n_term - 1) + phi * sqrt(pow(n_term - 1, 2) + 4 * m_term));
+			double s_inf = K / (1 - 1 / q_inf);
+			double h = -(phi * b * T + 2 * sig_sqrt_T) * K / (phi * (s_inf - K));
+			double critical = K + (s_inf - K) * (1 - exp(h));
+			for (int i = 0; i < 100; i++)
 			{
-				return K * exp(-r * T) * N(-d2_val) - S * exp((b - r) * T) * N(-d1_val); // P =  K*e^(-rT)*N(-d2) - S*e^(bT-rT)*N(-d1)
+				double d1_val = d1(critical, K, sig, T, b);
+				double hold = 1 - carry * N(phi * d1_val);
+				double f = phi * (critical - K) - calculate_theoretical_price(type, T, K, sig, critical, r, b) - phi * hold * critical / q;
+				if (fabs(f) < 1e-10 * K) { break; }
+				double slope = phi * hold * (1 - 1 / q) + carry * n(d1_val) / (q * sig_sqrt_T);
+				critical -= f / slope;
 			}
-			return 0;
-        }
 
-		// Calculates delta according to literature
-		double calculate_delta(OptionType type, double T, double K, double sig, double S, double r, double b)
+			if (phi * (critical - S) <= 0) { return phi * (S - K); } // beyond the exercise boundary
+			double a = phi * (critical / q) * (1 - carry * N(phi * d1(critical, K, sig, T, b)));
+			return european + a * pow(S / critical, q);
+		}
+
+		// phi(S, T, gamma, H, I) function of the Bjerksund & Stensland approximation
+		static double bjerksund_stensland_phi(double S, double T, double gamma, double H, double I, double r, double b, double sig)
 		{
+			double sig2 = sig * sig;
+			double lambda = (-r + gamma * b + 0.5 * gamma * (gamma - 1) * sig2) * T;
+			double kappa = 2 * b / sig2 + (2 * gamma - 1);
+			double d = -d1(S, H, sig, T, b + (gamma - 1) * sig2); // -(ln(S/H) + (b + (gamma - 1/2) sig^2) T) / (sig sqrt(T))
+			return exp(lambda) * pow(S, gamma) * (N(d) - pow(I / S, kappa) * N(d - 2 * log(I / S) / (sig * sqrt(T))));
+		}
 
-			double d1_val = d1(S, K, sig, T, b);
+		// Bjerksund & Stensland (1993) american call, flat exercise boundary I
+		static double bjerksund_stensland_call(double T, double K, double sig, double S, double r, double b)
+		{
+			if (b >= r) { return calculate_theoretical_price(OptionType::Call, T, K, sig, S, r, b); } // early exercise never pays
+
+			double sig2 = sig * sig;
+			double beta = (0.5 - b / sig2) + sqrt(pow(b / sig2 - 0.5, 2) + 2 * r / sig2);
+			double b_inf = beta / (beta - 1) * K;
+			double b_0 = fmax(K, r / (r - b) * K);
+			double h = -(b * T + 2 * sig * sqrt(T)) * b_0 / (b_inf - b_0);
+			double I = b_0 + (b_inf - b_0) * (1 - exp(h));
+			if (S >= I) { return S - K; }
+
+			double alpha = (I - K) * pow(I, -beta);
+			return alpha * pow(S, beta) - alpha * bjerksund_stensland_phi(S, T, beta, I, I, r, b, sig)
+				+ bjerksund_stensland_phi(S, T, 1, I, I, r, b, sig) - bjerksund_stensland_phi(S, T, 1, K, I, r, b, sig)
+				- K * bjerksund_stensland_phi(S, T, 0, I, I, r, b, sig) + K * bjerksund_stensland_phi(S, T, 0, K, I, r, b, sig);
+		}
 
-			if (type == OptionType::Call) // If option type is call
-			{
-				return exp((b - r) * T) * N(d1_val);
-			}
-			else if (type == OptionType::Put) // If option type is put
+		// Calculates finite maturity american price with the Bjerksund & Stensland (1993) approximation
+		double calculate_bjerksund_stensland_price(OptionType type, double T, double K, double sig, double S, double r, double b)
+		{
+			if (type == OptionType::Put) // put-call transformation: P(S, K, T, r, b) = C(K, S, T, r - b, -b)
 			{
-				return exp((b - r) * T) * (N(d1_val) - 1.0);
+				return bjerksund_stensland_call(T, S, sig, K, r - b, -b);
 			}
+			return bjerksund_stensland_call(T, K, sig, S, r, b);
+		}
 
-			return 0.0;
+		// Calculates delta according to literature
+		double calculate_delta(OptionType type, double T, double K, double sig, double S, double r, double b)
+		{
+			return generic_delta<double>(type, T, K, sig, S, r, b);
 		}
 
 		// Calculates gamma according to literature
 		double calculate_gamma(OptionType type, double T, double K, double sig, double S, double r, double b)
 		{
+			return generic_gamma<double>(type, T, K, sig, S, r, b);
+		}
+		// Calculates vega according to literature
 
-			double d1_val = d1(S, K, sig, T, b);
+		double calculate_vega(OptionType type, double T, double K, double sig, double S, double r, double b)
+		{
+			return generic_vega<double>(type, T, K, sig, S, r, b);
+		}
 
-			if (type == OptionType::Call || type == OptionType::Put) // If option type is call or put
-			{
-				return exp((b - r) * T) * n(d1_val) / (S * sig * sqrt(T));
-			}
+		// Calculates theta according to literature
+		double calculate_theta(OptionType type, double T, double K, double sig, double S, double r, double b)
+		{
+			return generic_theta<double>(type, T, K, sig, S, r, b);
+		}
 
-			return 0.0;
+		// Calculates rho according to literature (carry moves with the rate, b = r)
+		double calculate_rho(OptionType type, double T, double K, double sig, double S, double r, double b)
+		{
+			return generic_rho<double>(type, T, K, sig, S, r, b);
 		}
-		// Calculates vega according to literature
 
-		double calculate_vega(OptionType type, double T, double K, double sig, double S, double r, double b)
+		// Calculates european price and every greek, sharing d1, d2, the exponentials and the normal values
+		OptionGreeks calculate_price_and_greeks(OptionType type, double T, double K, double sig, double S, double r, double b)
 		{
-			double d1_val = d1(S, K, sig, T, b);
+			if (type != OptionType::Call && type != OptionType::Put) { return OptionGreeks{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 }; } // Invalid option type
+
+			double phi = (type == OptionType::Call) ? 1.0 : -1.0; // call/put sign, puts use N(-d)
+			OptionIntermediates c;
+			c.sqrt_T = sqrt(T);
+			c.sig_sqrt_T = sig * c.sqrt_T;
+			c.drift = (b + sig * sig * 0.5) * T;
+			c.discount = exp(-r * T); // e^(-rT)
+			c.carry = exp((b - r) * T); // e^(bT-rT)
+			c.d1 = (log(S / K) + c.drift) / c.sig_sqrt_T;
+			c.d2 = c.d1 - c.sig_sqrt_T;
+			c.N1 = N(phi * c.d1);
+			c.N2 = N(phi * c.d2);
+			c.n1 = n(c.d1);
+			return calculate_price_and_greeks(type, T, K, sig, S, r, b, c);
+		}
 
-			if (type == OptionType::Call || type == OptionType::Put) // If option type is call or put
-			{
-				return S * sqrt(T) * exp((b - r) * T) * n(d1_val);
-			}
+		// Calculates european price and every greek from terms computed beforehand (e.g. cached on an Option)
+		OptionGreeks calculate_price_and_greeks(OptionType type, double T, double K, double sig, double S, double r, double b, const OptionIntermediates& c)
+		{
+			OptionGreeks g = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+			if (type != OptionType::Call && type != OptionType::Put) { return g; } // Invalid option type
+
+			double phi = (type == OptionType::Call) ? 1.0 : -1.0;
+			double S_carry = S * c.carry;
+			double K_discount = K * c.discount;
+
+			g.price = phi * (S_carry * c.N1 - K_discount * c.N2);
+			g.delta = phi * c.carry * c.N1;
+			g.gamma = c.carry * c.n1 / (S * c.sig_sqrt_T);
+			g.vega = S_carry * c.sqrt_T * c.n1;
+			g.theta = -(S_carry * sig * c.n1) / (2 * c.sqrt_T) - phi * ((b - r) * S_carry * c.N1 + r * K_discount * c.N2);
+			g.rho = phi * T * K_discount * c.N2;
+			return g;
+		}
 
-			return 0.0;
+		// Calculates theoretical european option price from terms computed beforehand
+		double calculate_theoretical_price(OptionType type, double K, double S, const OptionIntermediates& c)
+		{
+			double phi = (type == OptionType::Call) ? 1.0 : -1.0;
+			return phi * (S * c.carry * c.N1 - K * c.discount * c.N2); // C = S*e^(bT-rT)*N(d1) - K*e^(-rT)*N(d2), P mirrored
 		}
 
-		// Calculates theta according to literature
-		double calculate_theta(OptionType type, double T, double K, double sig, double S, double r, double b)
+		// Calculates delta from terms computed beforehand
+		double calculate_delta(OptionType type, const OptionIntermediates& c)
+		{
+			double phi = (type == OptionType::Call) ? 1.0 : -1.0;
+			return phi * c.carry * c.N1;
+		}
+
+		// Calculates gamma from terms computed beforehand
+		double calculate_gamma(double S, const OptionIntermediates& c)
 		{
-			double d1_val = d1(S, K, sig, T, b);
-			double d2_val = d2(d1_val, sig, T);
-			double term_1 = (S * sig * exp((b - r) * T) * n(d1_val)) / (2 * sqrt(T));
-			double term_2 = (b-r) * S * exp((b - r) * T);
-			double term_3 = r * K * exp(-r * T);
+			return c.carry * c.n1 / (S * c.sig_sqrt_T);
+		}
 
-			if (type == OptionType::Call) // If option type is call
+		// Calculates vega from terms computed beforehand
+		double calculate_vega(double S, const OptionIntermediates& c)
+		{
+			return S * c.sqrt_T * c.carry * c.n1;
+		}
+
+		// Calculates rho from terms computed beforehand
+		double calculate_rho(OptionType type, double T, double K, const OptionIntermediates& c)
+		{
+			double phi = (type == OptionType::Call) ? 1.0 : -1.0;
+			return phi * T * K * c.discount * c.N2;
+		}
+
+		// Returns the value of the greeks matching function type
+		double OptionGreeks::get(OptionFunctionType oft) const
+		{
+			switch (oft)
 			{
-				return -term_1 - term_2 * N(d1_val) - term_3 * N(d2_val);
-			}
-			else if (type == OptionType::Put) // If option type is put
+			case TheoreticalPrice: { return price; }
+			case Delta: { return delta; }
+			case Gamma: { return gamma; }
+			case Vega: { return vega; }
+			case Theta: { return theta; }
+			case Rho: { return rho; }
+			default: // Approximations are not part of the fused evaluation
 			{
-				return term_2 * N(-d1_val) + term_3 * N(-d2_val) - term_1;
+				return 0.0;
 			}
+			}
+		}
 
-			return 0.0;
+		double OptionSensitivities::get(OptionParameterType opt) const
+		{
+			if (opt < StrikePrice || opt > CostOfCarry) // Invalid case
+			{
+				return 0.0;
+			}
+			return sensitivity[opt];
 		}
 
 		// Approximates delta greek
@@ -139,30 +256,101 @@ namespace Colin {
 			return (term_1 - 2 * term_2 + term_3) / (h * h);
 		}
 
+		// Calculates exact delta from one dual number evaluation
+		double calculate_dual_delta(OptionType type, double T, double K, double sig, double S, double r, double b)
+		{
+			double price, delta, gamma;
+			generic_dual_delta_gamma(type, T, K, sig, S, r, b, price, delta, gamma);
+			return delta;
+		}
+
+		// Calculates exact gamma from one second order dual number evaluation
+		double calculate_dual_gamma(OptionType type, double T, double K, double sig, double S, double r, double b)
+		{
+			double price, delta, gamma;
+			generic_dual_delta_gamma(type, T, K, sig, S, r, b, price, delta, gamma);
+			return gamma;
+		}
+
+		// Calculates exact american perpetual delta from one dual number evaluation
+		double calculate_american_perpetual_dual_delta(OptionType type, double K, double sig, double S, double r, double b)
+		{
+			double price, delta, gamma;
+			generic_dual_american_perpetual_delta_gamma(type, K, sig, S, r, b, price, delta, gamma);
+			return delta;
+		}
+
+		// Calculates exact american perpetual gamma from one second order dual number evaluation
+		double calculate_american_perpetual_dual_gamma(OptionType type, double K, double sig, double S, double r, double b)
+		{
+			double price, delta, gamma;
+			generic_dual_american_perpetual_delta_gamma(type, K, sig, S, r, b, price, delta, gamma);
+			return gamma;
+		}
+
+		// Calculates european price and every first order sensitivity from one adjoint sweep
+		OptionSensitivities calculate_adjoint_sensitivities(OptionType type, double T, double K, double sig, double S, double r, double b)
+		{
+			Utils::Tape& tape = Utils::thread_tape();
+			tape.clear();
+			double values[6] = { K, S, T, r, sig, b }; // in OptionParameterType order
+			Utils::Adjoint x[6];
+			for (int j = 0; j < 6; j++) { x[j] = Utils::adjoint_input(values[j]); }
+			Utils::Adjoint price = generic_theoretical_price<Utils::Adjoint>(type, x[Maturity], x[StrikePrice], x[Volatility], x[AssetPrice], x[RFRate], x[CostOfCarry]);
+
+			OptionSensitivities result;
+			result.price = price.value;
+			tape.seed(price.node, 1.0);
+			tape.propagate(1);
+			for (int j = 0; j < 6; j++) { result.sensitivity[j] = tape.adjoint(x[j].node); }
+			return result;
+		}
+
 		// Returns normal CDF value
+		// Define OPTION_PRICING_BOOST_NORMAL to price with boost as an accuracy reference
 		double N(double val)
 		{
-			normal_distribution<> nd;  // Default type is 'double'
-			return cdf(nd, val);
+#if defined(OPTION_PRICING_BOOST_NORMAL)
+			return N_reference(val);
+#else
+			return Colin::Utils::normal_cdf(val); // see utils/NormalDistribution.hpp for max error
+#endif
 		}
 
 		// Returns normal PDF of value
 		double n(double val)
 		{
-			normal_distribution<> nd;  // Default type is 'double'
+#if defined(OPTION_PRICING_BOOST_NORMAL)
+			return n_reference(val);
+#else
+			return Colin::Utils::normal_pdf(val);
+#endif
+		}
+
+		// Returns boost's normal CDF value, reference for accuracy checks
+		double N_reference(double val)
+		{
+			static const normal_distribution<> nd;  // Default type is 'double'
+			return cdf(nd, val);
+		}
+
+		// Returns boost's normal PDF value, reference for accuracy checks
+		double n_reference(double val)
+		{
+			static const normal_distribution<> nd;  // Default type is 'double'
 			return pdf(nd, val);
 		}
 
 		// term used in european pricing
 		double d1(double S, double K, double sig, double T, double b)
 		{
-			return (log(S / K) + (b + sig * sig * 0.5) * T) / (sig * sqrt(T)); // d1 = (ln(S/K) + (b+sig^2)*T/2)/(sig * sqrt(T))
+			return generic_d1<double>(S, K, sig, T, b);
 		}
 
 		// term used in european pricing
 		double d2(double d1, double sig, double T)
 		{
-			return (d1 - sig * sqrt(T)); // d2 = d1 - sigma * sqrt(T)
+			return generic_d2<double>(d1, sig, T);
 		}
 
 		bool have_same_option_values(Option& a, Option& b)
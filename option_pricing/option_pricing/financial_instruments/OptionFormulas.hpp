@@ -26,15 +26,32 @@ namespace Colin {
         */
 		double calculate_american_perpetual_theoretical_price(OptionType type, double K, double sig, double S, double r, double b); // Returns american perpetual theoretical price
         double calculate_theoretical_price(OptionType type, double T, double K, double sig, double S, double r, double b); // Returns european theoretical price
+		double calculate_barone_adesi_whaley_price(OptionType type, double T, double K, double sig, double S, double r, double b); // Returns finite american price, Barone-Adesi & Whaley approximation
+		double calculate_bjerksund_stensland_price(OptionType type, double T, double K, double sig, double S, double r, double b); // Returns finite american price, Bjerksund & Stensland (1993) approximation
 		double calculate_delta(OptionType type, double T, double K, double sig, double S, double r, double b); // returns delta of option
 		double calculate_gamma(OptionType type, double T, double K, double sig, double S, double r, double b); // returns gamma of option
 		double calculate_vega(OptionType type, double T, double K, double sig, double S, double r, double b); // returns vega of option
 		double calculate_theta(OptionType type, double T, double K, double sig, double S, double r, double b); // returns theta of option
+		double calculate_rho(OptionType type, double T, double K, double sig, double S, double r, double b); // returns rho of option
+		OptionGreeks calculate_price_and_greeks(OptionType type, double T, double K, double sig, double S, double r, double b); // returns european price and all greeks from shared terms
+		OptionGreeks calculate_price_and_greeks(OptionType type, double T, double K, double sig, double S, double r, double b, const OptionIntermediates& c); // same, from precomputed terms
+		double calculate_theoretical_price(OptionType type, double K, double S, const OptionIntermediates& c); // returns european theoretical price from precomputed terms (n1 unused)
+		double calculate_delta(OptionType type, const OptionIntermediates& c); // returns delta from precomputed carry, N1
+		double calculate_gamma(double S, const OptionIntermediates& c); // returns gamma from precomputed carry, n1, sig_sqrt_T
+		double calculate_vega(double S, const OptionIntermediates& c); // returns vega from precomputed carry, n1, sqrt_T
+		double calculate_rho(OptionType type, double T, double K, const OptionIntermediates& c); // returns rho from precomputed discount, N2
 		double calculate_delta_approximation(OptionType type, double T, double K, double sig, double S, double r, double b, double h); // returns delta approximation
 		double calculate_gamma_approximation(OptionType type, double T, double K, double sig, double S, double r, double b, double h); // returns gamma approximation
+		double calculate_dual_delta(OptionType type, double T, double K, double sig, double S, double r, double b); // returns exact delta, one dual number pricing (see GenericFormulas.hpp)
+		double calculate_dual_gamma(OptionType type, double T, double K, double sig, double S, double r, double b); // returns exact gamma, one second order dual pricing
+		double calculate_american_perpetual_dual_delta(OptionType type, double K, double sig, double S, double r, double b); // returns exact american perpetual delta
+		double calculate_american_perpetual_dual_gamma(OptionType type, double K, double sig, double S, double r, double b); // returns exact american perpetual gamma
+		OptionSensitivities calculate_adjoint_sensitivities(OptionType type, double T, double K, double sig, double S, double r, double b); // returns european price and its sensitivity to every parameter, one adjoint sweep
 
 		double N(double val); // Returns CDF of given value
 		double n(double val); // Returns PDF of given value
+		double N_reference(double val); // Returns boost CDF of given value (accuracy reference)
+		double n_reference(double val); // Returns boost PDF of given value (accuracy reference)
 		double d1(double S, double K, double sig, double T, double b); // term used for black scholes
 		double d2(double d1, double sig, double T); // term used for black scholes
 
@@ -0,0 +1,93 @@
+/*
+* OptionInstrumentation.hpp
+* Provides the probes of the pricing hot paths (see utils/Instrumentation.hpp):
+*   Option::calculate/<option class>/<function>
+*   OptionManager::calculate_parameter/<engine>/<function>
+*   OptionManager::matrix_pricer/<engine>/<function>
+* The engine of a sweep is the path it ran on: Kernel (SweepKernels.hpp),
+* SpotLadder (FiniteDifferenceEngine), Parallel or Serial (Option::calculate
+* per point); the function is an OptionFunctionType, or Greeks for the
+* overloads filling every greek. Elements are the points of a sweep.
+*
+* Probe ids are registered on first use and then read from a table, so a
+* recorded call costs no lookup. Only compiled with OPTION_PRICING_INSTRUMENTATION.
+*/
+#ifndef OPTION_INSTRUMENTATION_HPP // Verify we have unique HPP file reference
+#define OPTION_INSTRUMENTATION_HPP // Name the file OPTION_INSTRUMENTATION_HPP
+
+#if defined(OPTION_PRICING_INSTRUMENTATION)
+
+#include <string>
+#include <vector>
+
+#include "OptionConstants.hpp"
+#include "../utils/Instrumentation.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		enum SweepSite {
+			CalculateParameterSite,
+			MatrixPricerSite,
+		};
+
+		enum SweepEngine {
+			KernelSweep,
+			SpotLadderSweep,
+			ParallelSweep,
+			SerialSweep,
+		};
+
+		static const int GreeksFunction = Rho + 1; // overloads filling every greek
+		static const int PROBE_FUNCTIONS = GreeksFunction + 1;
+
+		inline const char* probe_function_name(int function)
+		{
+			static const char* names[PROBE_FUNCTIONS] = { "TheoreticalPrice", "Delta", "Gamma", "Vega", "Theta", "ApproxDelta", "ApproxGamma", "Rho", "Greeks" };
+			return names[function];
+		}
+
+		// Probe of Option::calculate for an option class and function (not recorded for an invalid function)
+		inline size_t calculate_probe(OptionClass oc, OptionFunctionType oft)
+		{
+			static const vector<size_t> probes = []()
+			{
+				const char* classes[] = { "European", "AmericanPerpetual", "AmericanFinite" }; // OptionClass
+				vector<size_t> ids;
+				for (int c = European; c <= AmericanFinite; c++)
+				{
+					for (int f = TheoreticalPrice; f <= Rho; f++) { ids.push_back(Utils::Instrumentation::probe(string("Option::calculate/") + classes[c] + "/" + probe_function_name(f))); }
+				}
+				return ids;
+			}();
+			if (oft < TheoreticalPrice || oft > Rho) { return Utils::Instrumentation::MAX_PROBES; }
+			return probes[oc * (Rho + 1) + oft];
+		}
+
+		// Probe of an OptionManager sweep, function an OptionFunctionType or GreeksFunction
+		inline size_t sweep_probe(SweepSite site, SweepEngine engine, int function)
+		{
+			static const vector<size_t> probes = []()
+			{
+				const char* sites[] = { "OptionManager::calculate_parameter", "OptionManager::matrix_pricer" }; // SweepSite
+				const char* engines[] = { "Kernel", "SpotLadder", "Parallel", "Serial" }; // SweepEngine
+				vector<size_t> ids;
+				for (int s = CalculateParameterSite; s <= MatrixPricerSite; s++)
+				{
+					for (int e = KernelSweep; e <= SerialSweep; e++)
+					{
+						for (int f = 0; f < PROBE_FUNCTIONS; f++) { ids.push_back(Utils::Instrumentation::probe(string(sites[s]) + "/" + engines[e] + "/" + probe_function_name(f))); }
+					}
+				}
+				return ids;
+			}();
+			if (function < 0 || function >= PROBE_FUNCTIONS) { return Utils::Instrumentation::MAX_PROBES; }
+			return probes[(site * (SerialSweep + 1) + engine) * PROBE_FUNCTIONS + function];
+		}
+	}
+}
+
+#endif // OPTION_PRICING_INSTRUMENTATION
+#endif // !OPTION_INSTRUMENTATION_HPP
@@ -13,6 +13,9 @@
 #include <cmath>
 #include <map>
 #include <vector>
+#include <memory>
+#include <algorithm>
+#include <utility>
 
 
 // Custom header
@@ -20,6 +23,10 @@
 #include "OptionConstants.hpp"
 #include "OptionParameter.hpp"
 #include "OptionManager.hpp"
+#include "SweepKernels.hpp"
+#include "OptionInstrumentation.hpp"
+#include "../utils/ThreadPool.hpp"
+#include "../utils/Instrumentation.hpp"
 
 using namespace std;
 
@@ -27,10 +34,186 @@ namespace Colin {
 	namespace FinancialInstruments {
 
 
-		OptionManager::OptionManager(){}
-		
+		/*
+		* Parallel sweeps: every chunk of points is priced on its own clone of the
+		* option, so the caller's option is never modified and the result of each
+		* point depends only on its parameters, identical to the serial loop.
+		*/
+		template<class R, class Apply, class Evaluate>
+		static vector<R> parallel_sweep(Utils::ThreadPool& pool, const Option& o, size_t n, size_t grain, Apply apply, Evaluate evaluate)
+		{
+			vector<R> result(n);
+			pool.parallel_for(0, n, grain, [&](size_t first, size_t last)
+			{
+				unique_ptr<Option> local(o.clone()); // worker's own copy of the parameters
+				for (size_t i = first; i < last; i++)
+				{
+					apply(*local, i);
+					result[i] = evaluate(*local);
+				}
+			});
+			return result;
+		}
+
+
+		template<OptionType Type, unsigned Moving>
+		static SweepKernel european_sweep(unsigned outputs)
+		{
+			switch (outputs)
+			{
+			case PriceOutput: { return &european_sweep_kernel<Type, PriceOutput, Moving>; }
+			case DeltaOutput: { return &european_sweep_kernel<Type, DeltaOutput, Moving>; }
+			case GammaOutput: { return &european_sweep_kernel<Type, GammaOutput, Moving>; }
+			case VegaOutput: { return &european_sweep_kernel<Type, VegaOutput, Moving>; }
+			case ThetaOutput: { return &european_sweep_kernel<Type, ThetaOutput, Moving>; }
+			case RhoOutput: { return &european_sweep_kernel<Type, RhoOutput, Moving>; }
+			case GreekOutputs: { return &european_sweep_kernel<Type, GreekOutputs, Moving>; }
+			default: { return nullptr; }
+			}
+		}
+
+		// One instantiation per set of moving parameters, indexed by the SweepMoving bits
+		template<OptionType Type, size_t... Moving>
+		static SweepKernel european_sweep(unsigned outputs, unsigned moving, index_sequence<Moving...>)
+		{
+			SweepKernel kernels[] = { european_sweep<Type, (unsigned)Moving>(outputs)... };
+			return kernels[moving];
+		}
+
+
+		/*
+		* Picks the sweep kernel for the option's class and type, the outputs and the moving parameters
+		* (SweepMoving bits), null when none applies: finite american classes (lattice or approximations),
+		* perpetual greeks (not closed form here), and options with a price cache, whose values must come from the cache.
+		*/
+		static SweepKernel select_sweep_kernel(const Option& o, unsigned outputs, unsigned moving)
+		{
+			if (o.price_cache() || outputs == 0) { return nullptr; }
+			OptionType type = o.option_type();
+			if (type != Call && type != Put) { return nullptr; }
+			switch (o.option_class())
+			{
+			case European:
+			{
+				if (type == Call) { return european_sweep<Call>(outputs, moving, make_index_sequence<MovesAll + 1>()); }
+				return european_sweep<Put>(outputs, moving, make_index_sequence<MovesAll + 1>());
+			}
+			case American:
+			{
+				if (outputs != PriceOutput) { return nullptr; }
+				return (type == Call) ? &american_perpetual_sweep_kernel<Call> : &american_perpetual_sweep_kernel<Put>;
+			}
+			default: { return nullptr; }
+			}
+		}
+
+
+		// Output bit of a single function sweep, 0 for the approximations
+		static unsigned sweep_output(OptionFunctionType oft)
+		{
+			switch (oft)
+			{
+			case TheoreticalPrice: { return PriceOutput; }
+			case Delta: { return DeltaOutput; }
+			case Gamma: { return GammaOutput; }
+			case Vega: { return VegaOutput; }
+			case Theta: { return ThetaOutput; }
+			case Rho: { return RhoOutput; }
+			default: { return 0; }
+			}
+		}
+
+
+		// Column of OptionGreeks holding a single function sweep
+		static int sweep_column(OptionFunctionType oft)
+		{
+			unsigned output = sweep_output(oft);
+			int column = 0;
+			while (output > 1) { output >>= 1; column++; }
+			return column;
+		}
+
+
+		// Fills a greeks sweep from the kernel columns
+		static vector<OptionGreeks> pack_greeks(const vector<double> (&columns)[6])
+		{
+			vector<OptionGreeks> result(columns[0].size());
+			for (size_t i = 0; i < result.size(); i++)
+			{
+				OptionGreeks g = { columns[0][i], columns[1][i], columns[2][i], columns[3][i], columns[4][i], columns[5][i] };
+				result[i] = g;
+			}
+			return result;
+		}
+
+
+		/*
+		* Evaluates grid points [first, last) into out, on the specialized sweep kernel when one
+		* applies, otherwise on its own clone of the option.
+		* Coordinates advance like an odometer, so only the axes that changed are set.
+		*/
+		static void price_grid_tile(const Option& o, OptionFunctionType oft, const ParameterGrid& grid, size_t first, size_t last, double* out)
+		{
+			size_t dims = grid.dimensions();
+			vector<size_t> coords;
+			grid.coordinates(first, coords);
+
+			unsigned moving = 0;
+			for (size_t j = 0; j < dims; j++) { moving |= sweep_moving(grid.axis(j).type()); }
+			SweepKernel kernel = select_sweep_kernel(o, sweep_output(oft), moving);
+			if (kernel) // lay the tile's coordinates out per axis, then one specialized loop
+			{
+				double base[6];
+				for (int j = StrikePrice; j <= CostOfCarry; j++) { base[j] = o.get((OptionParameterType)j); }
+				size_t count = last - first;
+				vector<double> values(dims * count);
+				vector<SweepAxis> axes(dims);
+				for (size_t j = 0; j < dims; j++) { axes[j] = sweep_axis(grid.axis(j).type(), values.data() + j * count); }
+				for (size_t i = 0; i < count; i++)
+				{
+					for (size_t j = 0; j < dims; j++) { values[j * count + i] = grid.axis(j).get((int)coords[j]); }
+					for (size_t j = dims; j-- > 0;) // odometer, last axis fastest
+					{
+						if (++coords[j] < grid.axis(j).size()) { break; }
+						coords[j] = 0;
+					}
+				}
+				double* columns[6] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+				columns[sweep_column(oft)] = out;
+				kernel(base, axes.data(), dims, 0, count, columns);
+				return;
+			}
+
+			unique_ptr<Option> local(o.clone());
+			for (size_t j = 0; j < dims; j++)
+			{
+				local->set_parameter(grid.axis(j).type(), grid.axis(j).get((int)coords[j]));
+			}
+
+			for (size_t i = first; i < last; i++)
+			{
+				out[i - first] = local->calculate(oft);
+
+				// Advance to the next point, last axis fastest
+				for (size_t j = dims; j-- > 0;)
+				{
+					const OptionParameter& axis = grid.axis(j);
+					if (++coords[j] < axis.size())
+					{
+						local->set_parameter(axis.type(), axis.get((int)coords[j]));
+						break;
+					}
+					coords[j] = 0; // wrap and carry into the next slower axis
+					local->set_parameter(axis.type(), axis.get(0));
+				}
+			}
+		}
+
 
-		OptionManager::OptionManager(const OptionManager& eo){}
+		OptionManager::OptionManager() : use_spot_engine(false) {}
+		OptionManager::OptionManager(size_t threads) : use_spot_engine(false) { set_threads(threads); }
+
+		OptionManager::OptionManager(const OptionManager& eo) : pool(eo.pool), spot_engine(eo.spot_engine), use_spot_engine(eo.use_spot_engine) {}
 		OptionManager::~OptionManager() {}
 
 		OptionManager& OptionManager::operator = (const OptionManager& source)
@@ -39,16 +222,109 @@ namespace Colin {
 			{
 				return *this; // return current object (avoid assignment on itself)
 			}
+			pool = source.pool;
+			spot_engine = source.spot_engine;
+			use_spot_engine = source.use_spot_engine;
 			return *this; // return current object's pointer
 		}
+
+		void OptionManager::set_threads(size_t threads)
+		{
+			if (threads <= 1) // Serial
+			{
+				pool.reset();
+				return;
+			}
+			if (!pool || pool->size() != threads) // Pools are reused across sweeps, only rebuilt when resized
+			{
+				pool = make_shared<Utils::ThreadPool>(threads);
+			}
+		}
+
+		size_t OptionManager::threads() const
+		{
+			return pool ? pool->size() : 1;
+		}
+
+		void OptionManager::set_spot_engine(const FiniteDifferenceEngine& fde)
+		{
+			spot_engine = fde;
+			use_spot_engine = true;
+		}
+
+		void OptionManager::clear_spot_engine()
+		{
+			use_spot_engine = false;
+		}
+
+		size_t OptionManager::chunk_size(size_t n) const
+		{
+			// About 8 chunks per thread leaves room for stealing and at least 64 points amortizes the clone.
+			// Multiples of 8 doubles put every chunk boundary at the same offset within a cache line as the
+			// output's first element: neighbouring chunks share at most that one line (none if the output is 64-byte aligned)
+			size_t grain = max<size_t>(64, n / (threads() * 8));
+			return (grain + 7) / 8 * 8;
+		}
 		
 
-		vector<double> OptionManager::calculate_parameter(Option& o, OptionFunctionType oft, OptionParameter& op)
+		bool OptionManager::specialized_sweep(const Option& o, unsigned outputs, const OptionParameter* axes, size_t axis_count, double* const out[6])
+		{
+			if (axis_count == 0) { return false; }
+			unsigned moving = 0;
+			for (size_t j = 0; j < axis_count; j++) { moving |= sweep_moving(axes[j].type()); }
+			SweepKernel kernel = select_sweep_kernel(o, outputs, moving); // the only dispatch of the sweep
+			if (!kernel) { return false; }
+
+			double base[6];
+			for (int j = StrikePrice; j <= CostOfCarry; j++) { base[j] = o.get((OptionParameterType)j); }
+			vector<SweepAxis> sweep_axes(axis_count);
+			for (size_t j = 0; j < axis_count; j++) { sweep_axes[j] = sweep_axis(axes[j]); } // read in place, never copied
+
+			size_t n = axes[0].size(); // Note: We assume user provides same size parameter vectors
+			if (pool) { pool->parallel_for(0, n, chunk_size(n), [&](size_t first, size_t last) { kernel(base, sweep_axes.data(), axis_count, first, last, out); }); }
+			else { kernel(base, sweep_axes.data(), axis_count, 0, n, out); }
+			return true;
+		}
+
+		bool OptionManager::specialized_sweep(const Option& o, unsigned outputs, const vector<OptionParameter>& axes, double* const out[6])
+		{
+			return specialized_sweep(o, outputs, axes.data(), axes.size(), out);
+		}
+
+
+		vector<double> OptionManager::calculate_parameter(Option& o, OptionFunctionType oft, const OptionParameter& op)
 		{
-			vector<double> result;
+			INSTRUMENT_SCOPE(probe, sweep_probe(CalculateParameterSite, SerialSweep, oft), op.size()); // engine set below once known
+			// Only the models the PDE solves; the approximations keep their own formula and price cache
+			if (use_spot_engine && oft == TheoreticalPrice && op.type() == AssetPrice && (o.pricing_model() == BlackScholesModel || o.pricing_model() == LatticeModel))
+			{
+				INSTRUMENT_SET_PROBE(probe, sweep_probe(CalculateParameterSite, SpotLadderSweep, oft));
+				vector<double> result(op.size());
+				spot_engine.spot_ladder(o, op, result.data()); // one solve prices the whole ladder, read off op in place
+				return result;
+			}
+
+			vector<double> result(op.size());
+			double* out[6] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+			out[sweep_column(oft)] = result.data();
+			if (specialized_sweep(o, sweep_output(oft), &op, 1, out))
+			{
+				INSTRUMENT_SET_PROBE(probe, sweep_probe(CalculateParameterSite, KernelSweep, oft));
+				return result;
+			}
+
+			if (pool) // Parallel mode
+			{
+				INSTRUMENT_SET_PROBE(probe, sweep_probe(CalculateParameterSite, ParallelSweep, oft));
+				return parallel_sweep<double>(*pool, o, op.size(), chunk_size(op.size()),
+					[&op](Option& local, size_t i) { local.set_parameter(op.type(), op.get(i)); },
+					[oft](const Option& local) { return local.calculate(oft); });
+			}
+
+			result.clear();
 			double original_value = o.get(op.type()); // get original value
 
-			for (int i = 0; i < op.values().size(); i++)
+			for (size_t i = 0; i < op.size(); i++)
 			{
 				o.set_parameter(op.type(), op.get(i)); // Set new parameter
 				result.push_back(o.calculate(oft)); // Obtain each new price and append to end of result
@@ -59,8 +335,30 @@ namespace Colin {
 		}
 
 
-		vector<vector<double>> OptionManager::matrix_pricer(Option& o, OptionFunctionType oft, vector<OptionParameter> parameter_vector)
+		vector<vector<double>> OptionManager::matrix_pricer(Option& o, OptionFunctionType oft, const vector<OptionParameter>& parameter_vector)
 		{
+			vector<double> swept(parameter_vector.empty() ? 0 : parameter_vector[0].size());
+			INSTRUMENT_SCOPE(probe, sweep_probe(MatrixPricerSite, SerialSweep, oft), swept.size()); // engine set below once known
+			double* out[6] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+			out[sweep_column(oft)] = swept.data();
+			if (specialized_sweep(o, sweep_output(oft), parameter_vector, out))
+			{
+				INSTRUMENT_SET_PROBE(probe, sweep_probe(MatrixPricerSite, KernelSweep, oft));
+				return vector<vector<double>>{ swept };
+			}
+
+			if (pool) // Parallel mode
+			{
+				INSTRUMENT_SET_PROBE(probe, sweep_probe(MatrixPricerSite, ParallelSweep, oft));
+				size_t n = parameter_vector[0].size();
+				return vector<vector<double>>{ parallel_sweep<double>(*pool, o, n, chunk_size(n),
+					[&parameter_vector](Option& local, size_t i)
+					{
+						for (size_t j = 0; j < parameter_vector.size(); j++) { local.set_parameter(parameter_vector[j].type(), parameter_vector[j].get(i)); }
+					},
+					[oft](const Option& local) { return local.calculate(oft); }) };
+			}
+
 			// Map is used to restore parameters at end
 
 			map<OptionParameterType, double> original_parameters;
@@ -69,9 +367,10 @@ namespace Colin {
 			// Note: We assume user provides same size parameter vectors
 			size_t number_parameters = parameter_vector.size(); // Number of option parameters
 			size_t number_values_per_parameter = parameter_vector[0].size(); // Choose arbitrary parameter and get number of values inside
-			for (int i = 0; i < number_values_per_parameter; i++) // i = index of value per option parameter
+			result_prices.reserve(number_values_per_parameter);
+			for (size_t i = 0; i < number_values_per_parameter; i++) // i = index of value per option parameter
 			{
-				for (int j = 0; j < number_parameters; j++) // j = index of the current parameter type
+				for (size_t j = 0; j < number_parameters; j++) // j = index of the current parameter type
 				{
 					OptionParameterType adjustType = parameter_vector[j].type(); // Get current parameter		
 					double adjustValue = parameter_vector[j].get(i); // the ith element of the values inside the parameter being tuned
@@ -88,7 +387,7 @@ namespace Colin {
 			}
 
 			// Reset all the parameters back to orignal values
-			for (int j = 0; j < number_parameters; j++)
+			for (size_t j = 0; j < number_parameters; j++)
 			{
 				OptionParameterType tempType = parameter_vector[j].type(); // get the changed parameter
 				o.set_parameter(tempType, original_parameters[tempType]); // reset the changed parameter
@@ -96,5 +395,127 @@ namespace Colin {
 			return vector<vector<double>>{ result_prices }; // Return matrix of the prices
 		}
 
+
+		vector<OptionGreeks> OptionManager::calculate_parameter(Option& o, const OptionParameter& op)
+		{
+			INSTRUMENT_SCOPE(probe, sweep_probe(CalculateParameterSite, SerialSweep, GreeksFunction), op.size()); // engine set below once known
+			vector<double> columns[6];
+			for (int j = 0; j < 6; j++) { columns[j].resize(op.size()); }
+			double* out[6] = { columns[0].data(), columns[1].data(), columns[2].data(), columns[3].data(), columns[4].data(), columns[5].data() };
+			if (specialized_sweep(o, GreekOutputs, &op, 1, out))
+			{
+				INSTRUMENT_SET_PROBE(probe, sweep_probe(CalculateParameterSite, KernelSweep, GreeksFunction));
+				return pack_greeks(columns);
+			}
+
+			if (pool) // Parallel mode
+			{
+				INSTRUMENT_SET_PROBE(probe, sweep_probe(CalculateParameterSite, ParallelSweep, GreeksFunction));
+				return parallel_sweep<OptionGreeks>(*pool, o, op.size(), chunk_size(op.size()),
+					[&op](Option& local, size_t i) { local.set_parameter(op.type(), op.get(i)); },
+					[](const Option& local) { return local.greeks(); });
+			}
+
+			vector<OptionGreeks> result;
+			result.reserve(op.size());
+			double original_value = o.get(op.type()); // get original value
+
+			for (size_t i = 0; i < op.size(); i++)
+			{
+				o.set_parameter(op.type(), op.get(i)); // Set new parameter
+				result.push_back(o.greeks()); // Price and all greeks for the new parameter
+			}
+			o.set_parameter(op.type(), original_value); // reset value for option
+
+			return result;
+		}
+
+
+		vector<vector<OptionGreeks>> OptionManager::matrix_pricer(Option& o, const vector<OptionParameter>& parameter_vector)
+		{
+			vector<double> columns[6];
+			for (int j = 0; j < 6; j++) { columns[j].resize(parameter_vector.empty() ? 0 : parameter_vector[0].size()); }
+			INSTRUMENT_SCOPE(probe, sweep_probe(MatrixPricerSite, SerialSweep, GreeksFunction), columns[0].size()); // engine set below once known
+			double* out[6] = { columns[0].data(), columns[1].data(), columns[2].data(), columns[3].data(), columns[4].data(), columns[5].data() };
+			if (specialized_sweep(o, GreekOutputs, parameter_vector, out))
+			{
+				INSTRUMENT_SET_PROBE(probe, sweep_probe(MatrixPricerSite, KernelSweep, GreeksFunction));
+				return vector<vector<OptionGreeks>>{ pack_greeks(columns) };
+			}
+
+			if (pool) // Parallel mode
+			{
+				INSTRUMENT_SET_PROBE(probe, sweep_probe(MatrixPricerSite, ParallelSweep, GreeksFunction));
+				size_t n = parameter_vector[0].size();
+				return vector<vector<OptionGreeks>>{ parallel_sweep<OptionGreeks>(*pool, o, n, chunk_size(n),
+					[&parameter_vector](Option& local, size_t i)
+					{
+						for (size_t j = 0; j < parameter_vector.size(); j++) { local.set_parameter(parameter_vector[j].type(), parameter_vector[j].get(i)); }
+					},
+					[](const Option& local) { return local.greeks(); }) };
+			}
+
+			// Same walk as the single function matrix_pricer, filling every greek per point
+			map<OptionParameterType, double> original_parameters;
+			vector<OptionGreeks> result_greeks;
+
+			size_t number_parameters = parameter_vector.size(); // Number of option parameters
+			size_t number_values_per_parameter = parameter_vector[0].size(); // Choose arbitrary parameter and get number of values inside
+			for (size_t i = 0; i < number_values_per_parameter; i++) // i = index of value per option parameter
+			{
+				for (size_t j = 0; j < number_parameters; j++) // j = index of the current parameter type
+				{
+					OptionParameterType adjustType = parameter_vector[j].type(); // Get current parameter
+					if (i == 0) // First time iterating through values, store all the original parameters
+					{
+						original_parameters[adjustType] = o.get(adjustType);
+					}
+					o.set_parameter(adjustType, parameter_vector[j].get(i)); // Change the parameter of the option
+				}
+				result_greeks.push_back(o.greeks()); // Append price and greeks for this point
+			}
+
+			// Reset all the parameters back to orignal values
+			for (size_t j = 0; j < number_parameters; j++)
+			{
+				OptionParameterType tempType = parameter_vector[j].type();
+				o.set_parameter(tempType, original_parameters[tempType]);
+			}
+			return vector<vector<OptionGreeks>>{ result_greeks };
+		}
+
+
+		void OptionManager::grid_pricer(const Option& o, OptionFunctionType oft, const ParameterGrid& grid, GridSink& sink, size_t tile_size)
+		{
+			size_t n = grid.size();
+			if (tile_size == 0) { tile_size = 4096; }
+			size_t tiles = (n + tile_size - 1) / tile_size;
+
+			// Tiles are priced a wave at a time (several per thread) into reused buffers,
+			// then handed to the sink in index order: memory stays bounded by the wave
+			size_t wave = pool ? pool->size() * 4 : 1;
+			vector<vector<double>> buffers(min(wave, max<size_t>(tiles, 1)), vector<double>(tile_size));
+
+			for (size_t wave_first = 0; wave_first < tiles; wave_first += wave)
+			{
+				size_t wave_tiles = min(wave, tiles - wave_first);
+				auto price_tiles = [&](size_t t_first, size_t t_last)
+				{
+					for (size_t t = t_first; t < t_last; t++)
+					{
+						size_t first = (wave_first + t) * tile_size;
+						price_grid_tile(o, oft, grid, first, min(n, first + tile_size), buffers[t].data());
+					}
+				};
+				if (pool) { pool->parallel_for(0, wave_tiles, 1, price_tiles); }
+				else { price_tiles(0, wave_tiles); }
+
+				for (size_t t = 0; t < wave_tiles; t++)
+				{
+					size_t first = (wave_first + t) * tile_size;
+					sink.consume(first, buffers[t].data(), min(n, first + tile_size) - first);
+				}
+			}
+		}
 	}
-}
\ No newline at end of file
+}
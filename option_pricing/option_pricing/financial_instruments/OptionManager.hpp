@@ -8,6 +8,7 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <memory>
 
 // Boost libraries
 
@@ -16,6 +17,11 @@
 #include "OptionConstants.hpp"
 #include "OptionParameter.hpp"
 #include "Option.hpp"
+#include "ParameterGrid.hpp"
+#include "GridSink.hpp"
+#include "FiniteDifferenceEngine.hpp"
+#include "SweepKernels.hpp"
+#include "../utils/ThreadPool.hpp"
 
 using namespace std;
 
@@ -25,20 +31,43 @@ namespace Colin {
 		{
 		public:
 
-			OptionManager();
+			OptionManager(); // Default constructor: sweeps run serially
+			OptionManager(size_t threads); // Sweeps run in parallel on a work-stealing pool of threads threads
 			OptionManager(const OptionManager& eo);  // Copy constructor for European Option
 			~OptionManager(); // Destructor: called when European Option
 
 			// Operators
 			OptionManager& operator = (const OptionManager& source); // Assignment operator.
 
-			vector<double> calculate_parameter(Option& o, OptionFunctionType oft, OptionParameter& op); // 
-			vector<vector<double>> matrix_pricer(Option& o, OptionFunctionType oft, vector<OptionParameter> parameter_vector); // Returns grid of theoretial values based on a vector of Option Parameters and Type of function
+			void set_threads(size_t threads); // 1 = serial, otherwise creates a pool of that many threads
+			size_t threads() const; // Number of threads used by sweeps
+
+			// Theoretical price sweeps over AssetPrice of European / lattice priced American options are then read off one PDE solve
+			void set_spot_engine(const FiniteDifferenceEngine& fde);
+			void clear_spot_engine(); // Back to pricing every spot on its own
+
+			vector<double> calculate_parameter(Option& o, OptionFunctionType oft, const OptionParameter& op); // 
+			vector<vector<double>> matrix_pricer(Option& o, OptionFunctionType oft, const vector<OptionParameter>& parameter_vector); // Returns grid of theoretial values based on a vector of Option Parameters and Type of function
+
+			// Same sweeps, filling price and every greek per point in one pass
+			vector<OptionGreeks> calculate_parameter(Option& o, const OptionParameter& op);
+			vector<vector<OptionGreeks>> matrix_pricer(Option& o, const vector<OptionParameter>& parameter_vector);
+
+			// Walks the full Cartesian product of the grid in tiles of tile_size points and streams each tile, in order, to sink
+			void grid_pricer(const Option& o, OptionFunctionType oft, const ParameterGrid& grid, GridSink& sink, size_t tile_size = 4096);
 
 
 		private:
+			size_t chunk_size(size_t n) const; // Points per parallel chunk for a sweep of n points
 
+			// Runs the sweep on the kernel specialized for o and outputs (see SweepKernels.hpp), writing out[column][point];
+			// false when there is none, the caller then walks the points through Option::calculate
+			bool specialized_sweep(const Option& o, unsigned outputs, const OptionParameter* axes, size_t axis_count, double* const out[6]);
+			bool specialized_sweep(const Option& o, unsigned outputs, const vector<OptionParameter>& axes, double* const out[6]);
 
+			shared_ptr<Utils::ThreadPool> pool; // null when serial, shared between copies of the manager
+			FiniteDifferenceEngine spot_engine; // each manager owns its workspaces
+			bool use_spot_engine;
 		};
 	}
 }
@@ -10,6 +10,7 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <cmath>
 
 // Custom header
 #include "OptionConstants.hpp"
@@ -20,19 +21,35 @@ using namespace std;
 namespace Colin {
 	namespace FinancialInstruments {
 		
+		static const double PI = 3.14159265358979323846;
 
-		OptionParameter::OptionParameter(): parameter_type(StrikePrice), parameter_values(vector<double>{0}) {}
-		OptionParameter::OptionParameter(OptionParameterType t): parameter_type(t), parameter_values(vector<double>{0}){}
-		OptionParameter::OptionParameter(OptionParameterType t, vector<double> values) : parameter_type(t), parameter_values(values) {}
-		OptionParameter::OptionParameter(OptionParameterType t, double start, double end, double mesh_size): parameter_type(t)
+		OptionParameter::OptionParameter(): parameter_values(vector<double>{0}), parameter_type(StrikePrice), storage(OwnedValues), view_values(0), count(1), range(ArithmeticRange), range_start(0), range_end(0), range_step(0) {}
+		OptionParameter::OptionParameter(OptionParameterType t): parameter_values(vector<double>{0}), parameter_type(t), storage(OwnedValues), view_values(0), count(1), range(ArithmeticRange), range_start(0), range_end(0), range_step(0) {}
+		OptionParameter::OptionParameter(OptionParameterType t, vector<double> values) : parameter_values(values), parameter_type(t), storage(OwnedValues), view_values(0), count(values.size()), range(ArithmeticRange), range_start(0), range_end(0), range_step(0) {}
+		OptionParameter::OptionParameter(OptionParameterType t, const double* values, size_t n) : parameter_type(t), storage(ViewedValues), view_values(values), count(n), range(ArithmeticRange), range_start(0), range_end(0), range_step(0) {}
+		OptionParameter::OptionParameter(OptionParameterType t, double start, double end, double mesh_size): parameter_type(t), storage(GeneratedValues), view_values(0), range(ArithmeticRange), range_start(start), range_end(end)
 		{
-			double h = (end - start) / mesh_size;
-			for (int i = 0; i <= mesh_size; i++)
+			if (!(mesh_size >= 1)) // also rejects NaN, before the cast below
 			{
-				parameter_values.push_back(start + h * i);
+				cout << "Invalid mesh size" << endl;
+				range_step = 0.0;
+				count = 0; // empty range
+				return;
 			}
+			// Same points as materializing start + h * i for i = 0..mesh_size
+			range_step = (end - start) / mesh_size;
+			count = (size_t)floor(mesh_size) + 1;
 		}
-		OptionParameter::OptionParameter(const OptionParameter& op) : parameter_type(op.parameter_type), parameter_values(op.parameter_values){}
+		OptionParameter::OptionParameter(OptionParameterType t, OptionParameterRange r, double start, double end, size_t points) : parameter_type(t), storage(GeneratedValues), view_values(0), count(points), range(r), range_start(start), range_end(end)
+		{
+			range_step = points > 1 ? (end - start) / (points - 1) : 0.0;
+			if (r == GeometricRange && !(start > 0.0 && end > 0.0)) // the ratio end / start must be positive for the powers
+			{
+				cout << "Invalid geometric range: endpoints must be positive, using an arithmetic range" << endl;
+				range = ArithmeticRange;
+			}
+		}
+		OptionParameter::OptionParameter(const OptionParameter& op) : parameter_values(op.parameter_values), parameter_type(op.parameter_type), storage(op.storage), view_values(op.view_values), count(op.count), range(op.range), range_start(op.range_start), range_end(op.range_end), range_step(op.range_step) {}
 		OptionParameter::~OptionParameter() {}
 
 		OptionParameter& OptionParameter::operator = (const OptionParameter& source)
@@ -42,10 +59,14 @@ namespace Colin {
 				return *this; // return current object (avoid assignment on itself)
 			}
 			parameter_type = source.parameter_type;
-			for (int i = 0; i < source.parameter_values.size(); i++)
-			{
-				parameter_values.push_back(source.parameter_values[i]);
-			}
+			parameter_values = source.parameter_values; // replace, not append to, the current values
+			storage = source.storage;
+			view_values = source.view_values;
+			count = source.count;
+			range = source.range;
+			range_start = source.range_start;
+			range_end = source.range_end;
+			range_step = source.range_step;
 
 			return *this; // return current object's pointer
 		}
@@ -57,18 +78,80 @@ namespace Colin {
 
 		vector<double> OptionParameter::values() const
 		{
-			return parameter_values;
+			if (storage == OwnedValues) { return parameter_values; }
+
+			vector<double> result(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				result[i] = get((int)i);
+			}
+			return result;
+		}
+
+		const double* OptionParameter::data() const
+		{
+			switch (storage)
+			{
+			case OwnedValues: { return parameter_values.data(); }
+			case ViewedValues: { return view_values; }
+			default: { return nullptr; }
+			}
+		}
+
+		bool OptionParameter::arithmetic_range(double& start, double& step) const
+		{
+			if (storage != GeneratedValues || range != ArithmeticRange) { return false; }
+			start = range_start;
+			step = range_step;
+			return true;
 		}
 
 		double OptionParameter::get(int idx) const
 		{
-			return parameter_values[idx];
+			switch (storage)
+			{
+			case OwnedValues: // If values are stored in the parameter
+			{
+				return parameter_values[idx];
+			}
+			case ViewedValues: // If values live in caller memory
+			{
+				return view_values[idx];
+			}
+			default: // Values are generated from the range
+			{
+				break;
+			}
+			}
+
+			switch (range)
+			{
+			case ArithmeticRange: // start, start + h, start + 2h, ..., end
+			{
+				return range_start + range_step * idx;
+			}
+			case GeometricRange: // start, start * q, start * q^2, ..., end
+			{
+				return count > 1 ? range_start * pow(range_end / range_start, (double)idx / (count - 1)) : range_start;
+			}
+			case ChebyshevRange: // Chebyshev nodes of [start, end] in increasing order
+			{
+				double center = 0.5 * (range_start + range_end);
+				double half = 0.5 * (range_end - range_start);
+				return center - half * cos(PI * (2.0 * idx + 1.0) / (2.0 * count));
+			}
+			default: // Invalid case
+			{
+				cout << "Invalid Option Parameter Range" << endl;
+				return 0.0;
+			}
+			}
 		}
 
 		size_t OptionParameter::size() const
 		{
-			return parameter_values.size();
+			return count;
 		}
 
 	}
-}
\ No newline at end of file
+}
@@ -1,6 +1,10 @@
 /*
 * OptionParameter.hpp
 * Provides template methods for Option Parameters
+*
+* A parameter either owns a vector of values, views caller owned memory
+* without copying, or generates its values lazily from a range
+* (arithmetic, geometric or Chebyshev nodes), so large sweeps never allocate.
 */
 #ifndef OPTION_PARAMETER_HPP // Verify we have unique HPP file reference
 #define OPTION_PARAMETER_HPP // Name the file OPTION_PARAMETER_HPP
@@ -21,20 +25,33 @@ namespace Colin {
 			OptionParameter(); // Default Constructor
 			OptionParameter(OptionParameterType t); // Constructor with only option parameter type
 			OptionParameter(OptionParameterType t, vector<double> values); // Constructor with parameter type and doubles
-			OptionParameter(OptionParameterType t, double start, double end, double mesh_size); // Constructor for range of values
+			OptionParameter(OptionParameterType t, const double* values, size_t n); // Non-owning view of n values, caller keeps them alive
+			OptionParameter(OptionParameterType t, double start, double end, double mesh_size); // Constructor for range of values (lazy arithmetic range)
+			OptionParameter(OptionParameterType t, OptionParameterRange range, double start, double end, size_t points); // Lazy range of points values
 			OptionParameter(const OptionParameter& op);  // Copy constructor for Option Parameter
 			~OptionParameter(); // Destructor: called when Option Parameter
 
 			OptionParameterType type() const; // Returns parameter type
-			vector<double> values() const; // Returns parameter values
+			vector<double> values() const; // Returns a materialized copy of the parameter values
+			const double* data() const; // Contiguous values when owned or viewed, null for generated ranges
+			bool arithmetic_range(double& start, double& step) const; // true for a lazy arithmetic range, value i is start + step * i
 			double get(int idx) const; // Returns specific value in values
 			size_t size() const; // Returns paramter values size
 			// Operators
 			OptionParameter& operator = (const OptionParameter& source); // Assignment operator.
 
 		private:
+			enum Storage { OwnedValues, ViewedValues, GeneratedValues }; // Where values come from
+
 			vector<double> parameter_values; // values that will be inputted as parameters with the parameter type
 			OptionParameterType parameter_type; // One of the option type parameter enums
+			Storage storage; // how get() finds a value
+			const double* view_values; // caller owned values for ViewedValues
+			size_t count; // number of values
+			OptionParameterRange range; // generator for GeneratedValues
+			double range_start; // first value of the range
+			double range_end; // last value of the range
+			double range_step; // arithmetic step between points
 		};
 	}
 }
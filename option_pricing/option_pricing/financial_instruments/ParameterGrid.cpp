@@ -0,0 +1,69 @@
+/*
+* ParameterGrid.cpp
+* Defines the ParameterGrid class methods
+*/
+
+
+// Standard Libraries
+#include <stdlib.h>
+#include <string>
+#include <iostream>
+#include <vector>
+
+// Custom header
+#include "ParameterGrid.hpp"
+#include "OptionConstants.hpp"
+#include "OptionParameter.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		ParameterGrid::ParameterGrid() : points(0) {}
+
+		ParameterGrid::ParameterGrid(const vector<OptionParameter>& parameter_vector) : axes(parameter_vector), strides(parameter_vector.size()), points(parameter_vector.empty() ? 0 : 1)
+		{
+			// Last axis varies fastest
+			for (size_t j = axes.size(); j-- > 0;)
+			{
+				strides[j] = points;
+				points *= axes[j].size();
+			}
+		}
+
+		ParameterGrid::ParameterGrid(const ParameterGrid& pg) : axes(pg.axes), strides(pg.strides), points(pg.points) {}
+		ParameterGrid::~ParameterGrid() {}
+
+		ParameterGrid& ParameterGrid::operator = (const ParameterGrid& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			axes = source.axes;
+			strides = source.strides;
+			points = source.points;
+			return *this; // return current object's pointer
+		}
+
+		size_t ParameterGrid::size() const { return points; }
+		size_t ParameterGrid::dimensions() const { return axes.size(); }
+		const OptionParameter& ParameterGrid::axis(size_t j) const { return axes[j]; }
+
+		void ParameterGrid::coordinates(size_t index, vector<size_t>& coords) const
+		{
+			coords.resize(axes.size());
+			for (size_t j = 0; j < axes.size(); j++)
+			{
+				coords[j] = index / strides[j];
+				index -= coords[j] * strides[j];
+			}
+		}
+
+		double ParameterGrid::value(size_t index, size_t j) const
+		{
+			return axes[j].get((int)((index / strides[j]) % axes[j].size()));
+		}
+	}
+}
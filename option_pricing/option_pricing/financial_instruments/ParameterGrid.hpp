@@ -0,0 +1,48 @@
+/*
+* ParameterGrid.hpp
+* Provides template methods for Parameter Grids: the full Cartesian product
+* of several OptionParameter axes, addressed by a linear index.
+*
+* The last axis varies fastest, e.g. axes {S, sig} with 3 and 2 values give
+* (S0,sig0), (S0,sig1), (S1,sig0), ... Points are never materialized.
+*/
+#ifndef PARAMETER_GRID_HPP // Verify we have unique HPP file reference
+#define PARAMETER_GRID_HPP // Name the file PARAMETER_GRID_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "OptionParameter.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+		class ParameterGrid
+		{
+		public:
+			ParameterGrid(); // Default constructor: empty grid
+			ParameterGrid(const vector<OptionParameter>& parameter_vector); // Product of the given axes
+			ParameterGrid(const ParameterGrid& pg);  // Copy constructor for Parameter Grid
+			~ParameterGrid(); // Destructor: called when Parameter Grid gets removed from memory
+
+			// Operators
+			ParameterGrid& operator = (const ParameterGrid& source); // Assignment operator.
+
+			size_t size() const; // Number of points in the grid (product of axis sizes)
+			size_t dimensions() const; // Number of axes
+			const OptionParameter& axis(size_t j) const; // Returns the jth axis
+			void coordinates(size_t index, vector<size_t>& coords) const; // Per axis value index of a linear index
+			double value(size_t index, size_t j) const; // Value of axis j at linear index
+
+		private:
+			vector<OptionParameter> axes; // Parameters spanning the grid
+			vector<size_t> strides; // Linear index step of each axis
+			size_t points; // Total number of points
+		};
+	}
+}
+#endif // !PARAMETER_GRID_HPP
@@ -0,0 +1,385 @@
+/*
+* Portfolio.cpp
+* Defines the Portfolio class methods
+*/
+
+
+// Standard Libraries
+#include <cmath>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+// Custom header
+#include "Portfolio.hpp"
+#include "OptionConstants.hpp"
+#include "../utils/ThreadPool.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		static const size_t BLOCK_SIZE = 1024; // Positions per task and per partial sum, fixed so results never depend on the threads
+		static const double PERPETUAL_SPOT_BUMP = 1e-4; // relative
+		static const double LATTICE_SPOT_BUMP = 1e-2; // relative
+		static const double PARAMETER_BUMP = 1e-4; // volatility, rate and maturity
+
+		// Pairwise summation: error grows with log(n) instead of n
+		static double pairwise_sum(const double* x, size_t n)
+		{
+			if (n <= 8)
+			{
+				double s = 0.0;
+				for (size_t i = 0; i < n; i++) { s += x[i]; }
+				return s;
+			}
+			size_t half = n / 2;
+			return pairwise_sum(x, half) + pairwise_sum(x + half, n - half);
+		}
+
+		// Neumaier summation: carries the rounding error of every addition
+		struct CompensatedSum {
+			double sum;
+			double compensation;
+
+			void add(double x)
+			{
+				double t = sum + x;
+				compensation += (fabs(sum) >= fabs(x)) ? (sum - t) + x : (x - t) + sum;
+				sum = t;
+			}
+			double value() const { return sum + compensation; }
+		};
+
+		static OptionGreeks to_greeks(const CompensatedSum* s)
+		{
+			OptionGreeks g = { s[0].value(), s[1].value(), s[2].value(), s[3].value(), s[4].value(), s[5].value() };
+			return g;
+		}
+
+		// Reorders column so that its i-th entry is the old column[order[i]]
+		template<class T>
+		static void permute(vector<T>& column, const vector<size_t>& order)
+		{
+			vector<T> sorted(column.size());
+			for (size_t i = 0; i < order.size(); i++) { sorted[i] = column[order[i]]; }
+			column.swap(sorted);
+		}
+
+		size_t PortfolioRisk::buckets() const { return expiry_edges.size() + 1; }
+		const OptionGreeks& PortfolioRisk::bucket(size_t u, size_t e) const { return by_bucket[u * buckets() + e]; }
+
+		Portfolio::Portfolio() : Portfolio(1) {}
+
+		Portfolio::Portfolio(size_t threads) : m_expiry_edges({ 0.25, 0.5, 1.0, 2.0, 5.0 }), m_sorted(true)
+		{
+			for (int oc = European; oc <= AmericanFinite; oc++) { m_books[oc].batch = OptionBatch((OptionClass)oc); }
+			set_threads(threads);
+		}
+
+		Portfolio::Portfolio(const Portfolio& p) : m_underlyings(p.m_underlyings), m_underlying_ids(p.m_underlying_ids), m_expiry_edges(p.m_expiry_edges), m_sorted(p.m_sorted), m_pricer(p.m_pricer), m_lattice(p.m_lattice), pool(p.pool)
+		{
+			for (int oc = European; oc <= AmericanFinite; oc++) { m_books[oc] = p.m_books[oc]; }
+		}
+
+		Portfolio::~Portfolio() {}
+
+		Portfolio& Portfolio::operator = (const Portfolio& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			for (int oc = European; oc <= AmericanFinite; oc++) { m_books[oc] = source.m_books[oc]; }
+			m_underlyings = source.m_underlyings;
+			m_underlying_ids = source.m_underlying_ids;
+			m_expiry_edges = source.m_expiry_edges;
+			m_sorted = source.m_sorted;
+			m_pricer = source.m_pricer;
+			m_lattice = source.m_lattice;
+			pool = source.pool;
+			return *this;
+		}
+
+		void Portfolio::add_position(const string& underlying, const Option& o, double quantity)
+		{
+			add_position(underlying, o.option_class(), o.option_type(), o.current_price(), o.strike_price(), o.time_to_maturity(), o.risk_free_rate(), o.volatility(), o.cost_of_carry(), quantity);
+		}
+
+		void Portfolio::add_position(const string& underlying, OptionClass oc, OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc, double quantity)
+		{
+			if (oc < European || oc > AmericanFinite)
+			{
+				cout << "Invalid Option Class" << endl;
+				return;
+			}
+			auto found = m_underlying_ids.find(underlying);
+			uint32_t id;
+			if (found == m_underlying_ids.end()) // first position on this underlying
+			{
+				id = (uint32_t)m_underlyings.size();
+				m_underlyings.push_back(underlying);
+				m_underlying_ids[underlying] = id;
+			}
+			else { id = found->second; }
+
+			Book& book = m_books[oc];
+			book.batch.add(t, ap, sp, ttm, rf, vol, cc);
+			book.quantity.push_back(quantity);
+			book.underlying.push_back(id);
+			m_sorted = false;
+		}
+
+		void Portfolio::reserve(OptionClass oc, size_t n)
+		{
+			if (oc < European || oc > AmericanFinite)
+			{
+				cout << "Invalid Option Class" << endl;
+				return;
+			}
+			m_books[oc].batch.reserve(n);
+			m_books[oc].quantity.reserve(n);
+			m_books[oc].underlying.reserve(n);
+		}
+
+		void Portfolio::clear()
+		{
+			for (int oc = European; oc <= AmericanFinite; oc++)
+			{
+				m_books[oc].batch.clear();
+				m_books[oc].quantity.clear();
+				m_books[oc].underlying.clear();
+				m_books[oc].group.clear();
+			}
+			m_underlyings.clear();
+			m_underlying_ids.clear();
+			m_sorted = true;
+		}
+
+		void Portfolio::set_expiry_buckets(const vector<double>& edges)
+		{
+			for (size_t e = 1; e < edges.size(); e++)
+			{
+				if (!(edges[e - 1] < edges[e]))
+				{
+					cout << "Invalid expiry buckets" << endl;
+					return;
+				}
+			}
+			m_expiry_edges = edges;
+			m_sorted = false; // groups depend on the buckets
+		}
+
+		void Portfolio::set_threads(size_t threads)
+		{
+			if (threads <= 1) { pool.reset(); }
+			else if (!pool || pool->size() != threads) { pool = make_shared<Utils::ThreadPool>(threads); }
+		}
+
+		void Portfolio::set_instruction_set(SimdInstructionSet is) { m_pricer.set_instruction_set(is); }
+		void Portfolio::set_lattice_engine(const LatticeEngine& le) { m_lattice = le; }
+
+		size_t Portfolio::size() const { return m_books[European].quantity.size() + m_books[American].quantity.size() + m_books[AmericanFinite].quantity.size(); }
+		size_t Portfolio::underlyings() const { return m_underlyings.size(); }
+		const vector<double>& Portfolio::expiry_buckets() const { return m_expiry_edges; }
+		size_t Portfolio::threads() const { return pool ? pool->size() : 1; }
+		const LatticeEngine& Portfolio::lattice_engine() const { return m_lattice; }
+
+		size_t Portfolio::expiry_bucket(double T) const
+		{
+			return upper_bound(m_expiry_edges.begin(), m_expiry_edges.end(), T) - m_expiry_edges.begin(); // perpetuals land in the last bucket
+		}
+
+		void Portfolio::regroup()
+		{
+			size_t buckets = m_expiry_edges.size() + 1;
+			for (int oc = European; oc <= AmericanFinite; oc++)
+			{
+				Book& book = m_books[oc];
+				size_t n = book.quantity.size();
+				book.group.resize(n);
+				for (size_t i = 0; i < n; i++)
+				{
+					book.group[i] = (uint32_t)(book.underlying[i] * buckets + expiry_bucket(book.batch.T[i]));
+				}
+
+				vector<size_t> order(n);
+				iota(order.begin(), order.end(), 0);
+				stable_sort(order.begin(), order.end(), [&](size_t i, size_t j) { return book.group[i] < book.group[j]; }); // keeps insertion order inside a group
+				permute(book.batch.type, order);
+				permute(book.batch.S, order);
+				permute(book.batch.K, order);
+				permute(book.batch.T, order);
+				permute(book.batch.r, order);
+				permute(book.batch.sig, order);
+				permute(book.batch.b, order);
+				permute(book.quantity, order);
+				permute(book.underlying, order);
+				permute(book.group, order);
+			}
+			m_sorted = true;
+		}
+
+		void Portfolio::value_block(OptionClass oc, size_t first, size_t n, double* const columns[6]) const
+		{
+			const OptionBatch& batch = m_books[oc].batch;
+			const OptionType* type = batch.type.data() + first;
+			const double* T = batch.T.data() + first;
+			const double* K = batch.K.data() + first;
+			const double* sig = batch.sig.data() + first;
+			const double* S = batch.S.data() + first;
+			const double* r = batch.r.data() + first;
+			const double* b = batch.b.data() + first;
+			double* price = columns[0];
+
+			if (oc == European) // closed form greeks
+			{
+				m_pricer.european_greeks(type, T, K, sig, S, r, b, price, columns[1], columns[2], columns[3], columns[4], columns[5], n);
+				return;
+			}
+
+			// Prices the block with some parameters replaced by bumped columns
+			LatticeEngine lattice(m_lattice); // its buffers are not shared between threads
+			auto reprice = [&](const double* T_, const double* sig_, const double* S_, const double* r_, const double* b_, double* out)
+			{
+				if (oc == American)
+				{
+					m_pricer.american_perpetual_prices(type, K, sig_, S_, r_, b_, out, n);
+					return;
+				}
+				for (size_t i = 0; i < n; i++)
+				{
+					out[i] = lattice.price(type[i], T_[i], K[i], sig_[i], S_[i], r_[i], b_[i]);
+				}
+			};
+
+			double up[BLOCK_SIZE], down[BLOCK_SIZE], bumped[BLOCK_SIZE], carry[BLOCK_SIZE];
+			reprice(T, sig, S, r, b, price);
+
+			// Delta and gamma
+			double spot_bump = (oc == American) ? PERPETUAL_SPOT_BUMP : LATTICE_SPOT_BUMP;
+			for (size_t i = 0; i < n; i++) { bumped[i] = S[i] * (1.0 + spot_bump); }
+			reprice(T, sig, bumped, r, b, up);
+			for (size_t i = 0; i < n; i++) { bumped[i] = S[i] * (1.0 - spot_bump); }
+			reprice(T, sig, bumped, r, b, down);
+			for (size_t i = 0; i < n; i++)
+			{
+				double h = S[i] * spot_bump;
+				columns[1][i] = (up[i] - down[i]) / (2.0 * h);
+				columns[2][i] = (up[i] - 2.0 * price[i] + down[i]) / (h * h);
+			}
+
+			// Vega
+			for (size_t i = 0; i < n; i++) { bumped[i] = sig[i] + PARAMETER_BUMP; }
+			reprice(T, bumped, S, r, b, up);
+			for (size_t i = 0; i < n; i++) { bumped[i] = sig[i] - PARAMETER_BUMP; }
+			reprice(T, bumped, S, r, b, down);
+			for (size_t i = 0; i < n; i++) { columns[3][i] = (up[i] - down[i]) / (2.0 * PARAMETER_BUMP); }
+
+			// Theta: minus the maturity derivative, none for perpetuals
+			if (oc == American) { fill(columns[4], columns[4] + n, 0.0); }
+			else
+			{
+				for (size_t i = 0; i < n; i++) { bumped[i] = T[i] + fmin(PARAMETER_BUMP, 0.5 * T[i]); }
+				reprice(bumped, sig, S, r, b, up);
+				for (size_t i = 0; i < n; i++) { bumped[i] = T[i] - fmin(PARAMETER_BUMP, 0.5 * T[i]); }
+				reprice(bumped, sig, S, r, b, down);
+				for (size_t i = 0; i < n; i++) { columns[4][i] = -(up[i] - down[i]) / (2.0 * fmin(PARAMETER_BUMP, 0.5 * T[i])); }
+			}
+
+			// Rho: the carry moves with the rate
+			for (size_t i = 0; i < n; i++) { bumped[i] = r[i] + PARAMETER_BUMP; carry[i] = b[i] + PARAMETER_BUMP; }
+			reprice(T, sig, S, bumped, carry, up);
+			for (size_t i = 0; i < n; i++) { bumped[i] = r[i] - PARAMETER_BUMP; carry[i] = b[i] - PARAMETER_BUMP; }
+			reprice(T, sig, S, bumped, carry, down);
+			for (size_t i = 0; i < n; i++) { columns[5][i] = (up[i] - down[i]) / (2.0 * PARAMETER_BUMP); }
+		}
+
+		void Portfolio::sum_block(OptionClass oc, size_t block, vector<GroupPartial>& partials) const
+		{
+			const Book& book = m_books[oc];
+			size_t first = block * BLOCK_SIZE;
+			size_t n = min(BLOCK_SIZE, book.quantity.size() - first);
+
+			double values[6][BLOCK_SIZE];
+			double* const columns[6] = { values[0], values[1], values[2], values[3], values[4], values[5] };
+			value_block(oc, first, n, columns);
+			for (int j = 0; j < 6; j++)
+			{
+				for (size_t i = 0; i < n; i++) { values[j][i] *= book.quantity[first + i]; }
+			}
+
+			// One partial per group run, the book being sorted by group
+			partials.clear();
+			for (size_t i = 0; i < n;)
+			{
+				size_t end = i + 1;
+				while (end < n && book.group[first + end] == book.group[first + i]) { end++; }
+				GroupPartial partial;
+				partial.group = book.group[first + i];
+				for (int j = 0; j < 6; j++) { partial.values[j] = pairwise_sum(values[j] + i, end - i); }
+				partials.push_back(partial);
+				i = end;
+			}
+		}
+
+		PortfolioRisk Portfolio::risk()
+		{
+			if (!m_sorted) { regroup(); }
+
+			size_t buckets = m_expiry_edges.size() + 1;
+			size_t groups = m_underlyings.size() * buckets;
+			vector<CompensatedSum> sums(groups * 6, CompensatedSum{ 0.0, 0.0 });
+
+			for (int oc = European; oc <= AmericanFinite; oc++)
+			{
+				size_t blocks = (m_books[oc].quantity.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+				vector<vector<GroupPartial>> partials(blocks);
+				auto run = [&](size_t first, size_t last) { for (size_t k = first; k < last; k++) { sum_block((OptionClass)oc, k, partials[k]); } };
+				if (pool) { pool->parallel_for(0, blocks, 1, run); }
+				else { run(0, blocks); }
+
+				for (size_t block = 0; block < blocks; block++) // block order
+				{
+					for (size_t k = 0; k < partials[block].size(); k++)
+					{
+						const GroupPartial& partial = partials[block][k];
+						for (int j = 0; j < 6; j++) { sums[6 * partial.group + j].add(partial.values[j]); }
+					}
+				}
+			}
+
+			PortfolioRisk result;
+			result.underlyings = m_underlyings;
+			result.expiry_edges = m_expiry_edges;
+			result.by_bucket.resize(groups);
+			result.by_underlying.resize(m_underlyings.size());
+			CompensatedSum total[6] = {};
+			for (size_t u = 0; u < m_underlyings.size(); u++)
+			{
+				CompensatedSum underlying[6] = {};
+				for (size_t e = 0; e < buckets; e++)
+				{
+					const CompensatedSum* s = sums.data() + 6 * (u * buckets + e);
+					result.by_bucket[u * buckets + e] = to_greeks(s);
+					for (int j = 0; j < 6; j++)
+					{
+						underlying[j].add(s[j].sum);
+						underlying[j].add(s[j].compensation);
+						total[j].add(s[j].sum);
+						total[j].add(s[j].compensation);
+					}
+				}
+				result.by_underlying[u] = to_greeks(underlying);
+			}
+			result.total = to_greeks(total);
+			return result;
+		}
+	}
+}
@@ -0,0 +1,122 @@
+/*
+* Portfolio.hpp
+* Provides template methods for Portfolios: books of positions (an option
+* and a signed quantity on a named underlying) aggregated into price and
+* greeks per underlying and expiry bucket.
+*
+* Positions are stored as one structure-of-arrays OptionBatch per option
+* class, plus quantity and group columns, and are kept sorted by group
+* (underlying, then expiry bucket) so every group is a contiguous range.
+* Sorting happens lazily, on the first risk() after positions were added.
+*
+* Valuation, per option class:
+* European: price and greeks from the batch kernels in closed form.
+* American (perpetual): batch kernel prices, greeks by central bumps
+*   (relative spot bump 1e-4, 1e-4 in volatility and rate; theta is 0).
+* AmericanFinite: lattice prices (see set_lattice_engine), greeks by central
+*   bumps (relative spot bump 1e-2, as the lattice is only piecewise smooth
+*   below the node spacing; 1e-4 in volatility, rate and maturity).
+* Rho moves the cost of carry with the rate, as in calculate_rho.
+*
+* Reproducibility: positions are valued in fixed blocks; inside a block each
+* group's quantity weighted values are summed pairwise, and the block
+* partials are added in block order with Neumaier (compensated) summation.
+* The totals are therefore bit-identical for any number of threads.
+*/
+#ifndef PORTFOLIO_HPP // Verify we have unique HPP file reference
+#define PORTFOLIO_HPP // Name the file PORTFOLIO_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "Option.hpp"
+#include "OptionBatch.hpp"
+#include "BatchPricer.hpp"
+#include "LatticeEngine.hpp"
+#include "../utils/ThreadPool.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		// Quantity weighted price and greeks, see Portfolio::risk
+		struct PortfolioRisk {
+			OptionGreeks total; // whole book
+			vector<string> underlyings; // names, indexed by underlying id (order of first appearance)
+			vector<double> expiry_edges; // upper bounds of every expiry bucket but the last (which is unbounded)
+			vector<OptionGreeks> by_underlying; // one per underlying, all expiries
+			vector<OptionGreeks> by_bucket; // underlying u, expiry bucket e at u * buckets() + e
+
+			size_t buckets() const; // expiry buckets per underlying: expiry_edges.size() + 1
+			const OptionGreeks& bucket(size_t u, size_t e) const;
+		};
+
+		class Portfolio
+		{
+		public:
+			Portfolio(); // Default constructor: empty serial book, buckets at 0.25, 0.5, 1, 2 and 5 years
+			Portfolio(size_t threads); // Empty book valued on threads threads
+			Portfolio(const Portfolio& p);  // Copy constructor for Portfolio
+			~Portfolio(); // Destructor: called when Portfolio gets removed from memory
+
+			// Operators
+			Portfolio& operator = (const Portfolio& source); // Assignment operator.
+
+			// Positions
+			void add_position(const string& underlying, const Option& o, double quantity);
+			void add_position(const string& underlying, OptionClass oc, OptionType t, double ap, double sp, double ttm, double rf, double vol, double cc, double quantity);
+			void reserve(OptionClass oc, size_t n); // Reserves room for n positions of one option class
+			void clear(); // Removes every position and underlying, keeps the settings
+
+			// Setter Methods
+			void set_expiry_buckets(const vector<double>& edges); // Strictly increasing maturities, T < edges[e] falls in bucket e
+			void set_threads(size_t threads); // 1 = serial, results do not depend on it
+			void set_instruction_set(SimdInstructionSet is); // Batch kernels, falls back if unsupported
+			void set_lattice_engine(const LatticeEngine& le); // Engine valuing AmericanFinite positions
+
+			// Getter Methods
+			size_t size() const; // Number of positions
+			size_t underlyings() const; // Number of distinct underlyings
+			const vector<double>& expiry_buckets() const;
+			size_t threads() const;
+			const LatticeEngine& lattice_engine() const;
+
+			// Aggregated price and greeks of the book
+			PortfolioRisk risk();
+
+		private:
+			struct Book { // Positions of one option class
+				OptionBatch batch;
+				vector<double> quantity;
+				vector<uint32_t> underlying; // id, index of m_underlyings
+				vector<uint32_t> group; // underlying * buckets + expiry bucket, set by regroup
+			};
+			struct GroupPartial { // Weighted sums of one group over one block
+				uint32_t group;
+				double values[6]; // in OptionGreeks field order
+			};
+
+			size_t expiry_bucket(double T) const;
+			void regroup(); // Recomputes the group column and sorts every book by it
+			void value_block(OptionClass oc, size_t first, size_t n, double* const columns[6]) const; // Unweighted price and greeks of positions [first, first + n)
+			void sum_block(OptionClass oc, size_t block, vector<GroupPartial>& partials) const;
+
+			Book m_books[3]; // indexed by OptionClass
+			vector<string> m_underlyings;
+			map<string, uint32_t> m_underlying_ids;
+			vector<double> m_expiry_edges;
+			bool m_sorted; // every book sorted by group
+			BatchPricer m_pricer;
+			LatticeEngine m_lattice;
+			shared_ptr<Utils::ThreadPool> pool; // null when serial
+		};
+	}
+}
+#endif // !PORTFOLIO_HPP
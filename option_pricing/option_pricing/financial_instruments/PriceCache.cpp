@@ -0,0 +1,271 @@
+/*
+* PriceCache.cpp
+* Defines the PriceCache class methods
+*/
+
+
+// Standard Libraries
+#include <cmath>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <limits>
+
+// Custom header
+#include "PriceCache.hpp"
+#include "OptionConstants.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		// Rounds x to a whole number of buckets, non finite and out of range values get their own buckets
+		static int64_t quantize(double x, double tolerance)
+		{
+			double buckets = x / tolerance;
+			if (isnan(buckets)) { return numeric_limits<int64_t>::min(); }
+			if (buckets >= 9.0e18) { return numeric_limits<int64_t>::max(); } // includes INFINITY (perpetual maturity)
+			if (buckets <= -9.0e18) { return numeric_limits<int64_t>::min() + 1; }
+			return llround(buckets);
+		}
+
+		// splitmix64 finalizer: spreads nearby keys over shards and buckets
+		static uint64_t mix(uint64_t x)
+		{
+			x ^= x >> 30;
+			x *= 0xBF58476D1CE4E5B9ULL;
+			x ^= x >> 27;
+			x *= 0x94D049BB133111EBULL;
+			x ^= x >> 31;
+			return x;
+		}
+
+		double PriceCacheStatistics::hit_rate() const
+		{
+			uint64_t lookups = hits + misses;
+			return (lookups == 0) ? 0.0 : (double)hits / lookups;
+		}
+
+		bool PriceCache::Key::operator == (const Key& other) const
+		{
+			for (int i = 0; i < 6; i++)
+			{
+				if (values[i] != other.values[i]) { return false; }
+			}
+			return model == other.model && type == other.type;
+		}
+
+		size_t PriceCache::KeyHash::operator () (const Key& key) const
+		{
+			uint64_t h = mix(((uint64_t)key.model << 8) ^ (uint64_t)key.type);
+			for (int i = 0; i < 6; i++)
+			{
+				h = mix(h ^ (uint64_t)key.values[i]);
+			}
+			return (size_t)h;
+		}
+
+		PriceCache::PriceCache() : PriceCache(65536, 16, 0.001) {}
+
+		PriceCache::PriceCache(size_t capacity, size_t shards, double tolerance)
+		{
+			if (shards == 0) { shards = 1; }
+			if (capacity < shards) { capacity = shards; } // at least one entry per shard
+			if (!(tolerance > 0.0))
+			{
+				cout << "Invalid tolerance" << endl;
+				tolerance = 0.001;
+			}
+			m_shard_capacity = (capacity + shards - 1) / shards;
+			for (size_t i = 0; i < shards; i++)
+			{
+				m_shards.push_back(unique_ptr<Shard>(new Shard()));
+				m_shards[i]->hits = 0;
+				m_shards[i]->misses = 0;
+				m_shards[i]->evictions = 0;
+			}
+			for (int i = 0; i < 6; i++) { m_tolerance[i] = tolerance; }
+		}
+
+		PriceCache::~PriceCache() {}
+
+		void PriceCache::set_tolerance(OptionParameterType opt, double tolerance)
+		{
+			if (opt < StrikePrice || opt > CostOfCarry)
+			{
+				cout << "Invalid Option Parameter" << endl;
+				return;
+			}
+			if (!(tolerance > 0.0))
+			{
+				cout << "Invalid tolerance" << endl;
+				return;
+			}
+			m_tolerance[opt] = tolerance;
+			clear(); // existing keys were quantized with the old width
+		}
+
+		void PriceCache::clear()
+		{
+			for (size_t i = 0; i < m_shards.size(); i++)
+			{
+				lock_guard<mutex> lock(m_shards[i]->m);
+				m_shards[i]->entries.clear();
+				m_shards[i]->index.clear();
+			}
+		}
+
+		void PriceCache::reset_statistics()
+		{
+			for (size_t i = 0; i < m_shards.size(); i++)
+			{
+				lock_guard<mutex> lock(m_shards[i]->m);
+				m_shards[i]->hits = 0;
+				m_shards[i]->misses = 0;
+				m_shards[i]->evictions = 0;
+			}
+		}
+
+		double PriceCache::tolerance(OptionParameterType opt) const { return m_tolerance[opt]; }
+		size_t PriceCache::capacity() const { return m_shard_capacity * m_shards.size(); }
+		size_t PriceCache::shards() const { return m_shards.size(); }
+
+		PriceCacheStatistics PriceCache::statistics() const
+		{
+			PriceCacheStatistics s = { 0, 0, 0, 0 };
+			for (size_t i = 0; i < m_shards.size(); i++)
+			{
+				lock_guard<mutex> lock(m_shards[i]->m);
+				s.hits += m_shards[i]->hits;
+				s.misses += m_shards[i]->misses;
+				s.evictions += m_shards[i]->evictions;
+				s.size += m_shards[i]->entries.size();
+			}
+			return s;
+		}
+
+		PriceCache::Key PriceCache::make_key(PricingModel model, OptionType type, double T, double K, double sig, double S, double r, double b) const
+		{
+			Key key;
+			key.values[StrikePrice] = quantize(K, m_tolerance[StrikePrice]);
+			key.values[AssetPrice] = quantize(S, m_tolerance[AssetPrice]);
+			key.values[Maturity] = quantize(T, m_tolerance[Maturity]);
+			key.values[RFRate] = quantize(r, m_tolerance[RFRate]);
+			key.values[Volatility] = quantize(sig, m_tolerance[Volatility]);
+			key.values[CostOfCarry] = quantize(b, m_tolerance[CostOfCarry]);
+			key.model = (int32_t)model;
+			key.type = (int32_t)type;
+			return key;
+		}
+
+		PriceCache::Shard& PriceCache::shard_of(size_t hash)
+		{
+			return *m_shards[(hash >> 16) % m_shards.size()]; // high bits: the map buckets use the low ones
+		}
+
+		bool PriceCache::find_price(PricingModel model, OptionType type, double T, double K, double sig, double S, double r, double b, double& price)
+		{
+			Key key = make_key(model, type, T, K, sig, S, r, b);
+			Shard& shard = shard_of(KeyHash()(key));
+			lock_guard<mutex> lock(shard.m);
+			auto found = shard.index.find(key);
+			if (found == shard.index.end())
+			{
+				shard.misses++;
+				return false;
+			}
+			shard.entries.splice(shard.entries.begin(), shard.entries, found->second); // now most recently used
+			shard.hits++;
+			price = found->second->value.price;
+			return true;
+		}
+
+		bool PriceCache::find_greeks(PricingModel model, OptionType type, double T, double K, double sig, double S, double r, double b, OptionGreeks& greeks)
+		{
+			Key key = make_key(model, type, T, K, sig, S, r, b);
+			Shard& shard = shard_of(KeyHash()(key));
+			lock_guard<mutex> lock(shard.m);
+			auto found = shard.index.find(key);
+			if (found == shard.index.end() || !found->second->has_greeks)
+			{
+				shard.misses++;
+				return false;
+			}
+			shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+			shard.hits++;
+			greeks = found->second->value;
+			return true;
+		}
+
+		void PriceCache::insert_price(PricingModel model, OptionType type, double T, double K, double sig, double S, double r, double b, double price)
+		{
+			OptionGreeks value = { price, 0.0, 0.0, 0.0, 0.0, 0.0 };
+			insert(make_key(model, type, T, K, sig, S, r, b), value, false);
+		}
+
+		void PriceCache::insert_greeks(PricingModel model, OptionType type, double T, double K, double sig, double S, double r, double b, const OptionGreeks& greeks)
+		{
+			insert(make_key(model, type, T, K, sig, S, r, b), greeks, true);
+		}
+
+		void PriceCache::insert(const Key& key, const OptionGreeks& value, bool has_greeks)
+		{
+			Shard& shard = shard_of(KeyHash()(key));
+			lock_guard<mutex> lock(shard.m);
+			auto found = shard.index.find(key);
+			if (found != shard.index.end()) // another thread got there first, or greeks upgrade a price entry
+			{
+				if (has_greeks && !found->second->has_greeks)
+				{
+					found->second->value = value;
+					found->second->has_greeks = true;
+				}
+				shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+				return;
+			}
+
+			if (shard.entries.size() >= m_shard_capacity) // evict the least recently used entry
+			{
+				shard.index.erase(shard.entries.back().key);
+				shard.entries.pop_back();
+				shard.evictions++;
+			}
+			shard.entries.push_front(Entry{ key, value, has_greeks });
+			shard.index[key] = shard.entries.begin();
+		}
+
+		double PriceCache::calculate(const Option& o, OptionFunctionType oft)
+		{
+			if (oft == ApproxDelta) { return o.approximate_delta(); } // depend on Option::h, not cached
+			if (oft == ApproxGamma) { return o.approximate_gamma(); }
+			if (oft == TheoreticalPrice)
+			{
+				double price;
+				if (!find_price(o.pricing_model(), o.option_type(), o.time_to_maturity(), o.strike_price(), o.volatility(), o.current_price(), o.risk_free_rate(), o.cost_of_carry(), price))
+				{
+					price = o.theoretical_price();
+					insert_price(o.pricing_model(), o.option_type(), o.time_to_maturity(), o.strike_price(), o.volatility(), o.current_price(), o.risk_free_rate(), o.cost_of_carry(), price);
+				}
+				return price;
+			}
+			return greeks(o).get(oft);
+		}
+
+		OptionGreeks PriceCache::greeks(const Option& o)
+		{
+			OptionGreeks g;
+			if (!find_greeks(o.pricing_model(), o.option_type(), o.time_to_maturity(), o.strike_price(), o.volatility(), o.current_price(), o.risk_free_rate(), o.cost_of_carry(), g))
+			{
+				g = o.greeks();
+				insert_greeks(o.pricing_model(), o.option_type(), o.time_to_maturity(), o.strike_price(), o.volatility(), o.current_price(), o.risk_free_rate(), o.cost_of_carry(), g);
+			}
+			return g;
+		}
+	}
+}
@@ -0,0 +1,112 @@
+/*
+* PriceCache.hpp
+* Provides template methods for the Price Cache: a thread safe, bounded
+* memo of prices and greeks keyed on quantized option parameters.
+*
+* Each parameter is rounded to a multiple of its tolerance (0.001 by
+* default, as in have_same_option_values), so options whose parameters fall
+* in the same buckets share one entry and get the value computed for the
+* first of them. Entries are spread over independently locked shards, each
+* evicting its least recently used entry once full.
+*
+* A key holds the pricing model (so the lattice and the approximations of a
+* finite american option never share entries) and the parameters, not the
+* model settings: engines with different settings (e.g. lattice steps) need
+* separate caches.
+*/
+#ifndef PRICE_CACHE_HPP // Verify we have unique HPP file reference
+#define PRICE_CACHE_HPP // Name the file PRICE_CACHE_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+
+// Custom HPP files
+#include "OptionConstants.hpp"
+#include "Option.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		// Counters summed over every shard, see PriceCache::statistics
+		struct PriceCacheStatistics {
+			uint64_t hits; // lookups answered from the cache
+			uint64_t misses; // lookups that had to be computed
+			uint64_t evictions; // entries dropped to stay within capacity
+			size_t size; // entries currently held
+
+			double hit_rate() const; // hits / (hits + misses), 0 before any lookup
+		};
+
+		class PriceCache
+		{
+		public:
+			PriceCache(); // Default constructor: 65536 entries over 16 shards, tolerance 0.001
+			PriceCache(size_t capacity, size_t shards, double tolerance); // Holds at most about capacity entries
+			~PriceCache(); // Destructor: called when Price Cache gets removed from memory
+
+			// Setter Methods
+			void set_tolerance(OptionParameterType opt, double tolerance); // Bucket width of one parameter, clears the cache
+			void clear(); // Drops every entry, keeps the counters
+			void reset_statistics(); // Zeroes the counters
+
+			// Getter Methods
+			double tolerance(OptionParameterType opt) const;
+			size_t capacity() const;
+			size_t shards() const;
+			PriceCacheStatistics statistics() const;
+
+			// Lookups count a hit or a miss; a price is found in price or greeks entries, greeks only in greeks entries
+			bool find_price(PricingModel model, OptionType type, double T, double K, double sig, double S, double r, double b, double& price);
+			bool find_greeks(PricingModel model, OptionType type, double T, double K, double sig, double S, double r, double b, OptionGreeks& greeks);
+			void insert_price(PricingModel model, OptionType type, double T, double K, double sig, double S, double r, double b, double price);
+			void insert_greeks(PricingModel model, OptionType type, double T, double K, double sig, double S, double r, double b, const OptionGreeks& greeks);
+
+			// Memoized o.calculate(oft) (approximations are computed every time) and o.greeks()
+			double calculate(const Option& o, OptionFunctionType oft);
+			OptionGreeks greeks(const Option& o);
+
+		private:
+			PriceCache(const PriceCache& pc); // Non copyable: owns locks
+			PriceCache& operator = (const PriceCache& source);
+
+			struct Key {
+				int64_t values[6]; // quantized parameters, indexed by OptionParameterType
+				int32_t model; // PricingModel
+				int32_t type;
+
+				bool operator == (const Key& other) const;
+			};
+			struct KeyHash { size_t operator () (const Key& key) const; };
+			struct Entry {
+				Key key;
+				OptionGreeks value;
+				bool has_greeks; // false when only value.price is known
+			};
+			struct Shard {
+				mutex m;
+				list<Entry> entries; // most recently used first
+				unordered_map<Key, list<Entry>::iterator, KeyHash> index;
+				uint64_t hits;
+				uint64_t misses;
+				uint64_t evictions;
+			};
+
+			Key make_key(PricingModel model, OptionType type, double T, double K, double sig, double S, double r, double b) const;
+			Shard& shard_of(size_t hash); // shard owning keys of this hash
+			void insert(const Key& key, const OptionGreeks& value, bool has_greeks);
+
+			vector<unique_ptr<Shard>> m_shards;
+			size_t m_shard_capacity; // entries per shard
+			double m_tolerance[6]; // indexed by OptionParameterType
+		};
+	}
+}
+#endif // !PRICE_CACHE_HPP
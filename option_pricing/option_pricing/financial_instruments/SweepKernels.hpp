@@ -0,0 +1,177 @@
+/*
+* SweepKernels.hpp
+* Provides the compile-time specialized kernels behind OptionManager sweeps.
+*
+* A sweep moves one or more parameters of a single option along axes. The
+* kernels are templates over the option type, the option class and the set
+* of requested outputs (European kernels also over the set of moving
+* parameters among T, sig, r and b, so every term that does not depend on
+* them is hoisted out of the loop), so their per point loop holds no switch on
+* OptionFunctionType or OptionParameterType and no call/put branch: unused
+* outputs and terms are removed by the compiler. OptionManager picks the
+* instantiation once per sweep (see select_sweep_kernel in OptionManager.cpp).
+*
+* The terms and their order of evaluation follow Option::terms and the
+* OptionFormulas overloads on OptionIntermediates, so every value is
+* bit-identical to Option::calculate on the same parameters.
+* The templates have internal linkage, see utils/Simd.hpp.
+*/
+#ifndef SWEEP_KERNELS_HPP // Verify we have unique HPP file reference
+#define SWEEP_KERNELS_HPP // Name the file SWEEP_KERNELS_HPP
+
+#include <cstddef>
+#include <cmath>
+
+#include "OptionConstants.hpp"
+#include "OptionParameter.hpp"
+#include "OptionFormulas.hpp"
+#include "GenericFormulas.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace FinancialInstruments {
+
+		// Outputs of a sweep kernel, one bit per column in OptionGreeks field order
+		enum SweepOutput {
+			PriceOutput = 1,
+			DeltaOutput = 2,
+			GammaOutput = 4,
+			VegaOutput = 8,
+			ThetaOutput = 16,
+			RhoOutput = 32,
+			GreekOutputs = 63, // price and every greek
+		};
+
+		// Moving parameters of a European sweep that the hoisted terms depend on, one bit each (S and K only enter d1 per point)
+		enum SweepMoving {
+			MovesMaturity = 1,
+			MovesVolatility = 2,
+			MovesRFRate = 4,
+			MovesCostOfCarry = 8,
+			MovesAll = 15,
+		};
+
+		// Bit of SweepMoving for a parameter, 0 for the spot and the strike
+		inline unsigned sweep_moving(OptionParameterType type)
+		{
+			switch (type)
+			{
+			case Maturity: { return MovesMaturity; }
+			case Volatility: { return MovesVolatility; }
+			case RFRate: { return MovesRFRate; }
+			case CostOfCarry: { return MovesCostOfCarry; }
+			default: { return 0; }
+			}
+		}
+
+		/*
+		* One moving parameter, read in place: point i takes values[i] when the values are
+		* contiguous, start + step * i on an arithmetic range (the same value as
+		* OptionParameter::get), otherwise parameter->get(i).
+		*/
+		struct SweepAxis {
+			OptionParameterType type;
+			const double* values; // contiguous values, or null
+			const OptionParameter* parameter; // geometric and Chebyshev ranges, or null
+			double start; // arithmetic range when both are null
+			double step;
+
+			double at(size_t i) const
+			{
+				if (values) { return values[i]; }
+				if (parameter) { return parameter->get((int)i); }
+				return start + step * i;
+			}
+		};
+
+		// Axis reading op without copying its values
+		inline SweepAxis sweep_axis(const OptionParameter& op)
+		{
+			SweepAxis axis = { op.type(), op.data(), nullptr, 0.0, 0.0 };
+			if (!axis.values && !op.arithmetic_range(axis.start, axis.step)) { axis.parameter = &op; }
+			return axis;
+		}
+
+		// Axis over caller owned contiguous values
+		inline SweepAxis sweep_axis(OptionParameterType type, const double* values)
+		{
+			SweepAxis axis = { type, values, nullptr, 0.0, 0.0 };
+			return axis;
+		}
+
+		// Prices points [first, last) from base (parameters indexed by OptionParameterType), writing out[column][i]
+		typedef void (*SweepKernel)(const double* base, const SweepAxis* axes, size_t axis_count, size_t first, size_t last, double* const out[6]);
+
+		namespace {
+
+		// Price and greeks of a European option; terms that depend on none of the Moving parameters are computed once per sweep
+		template<OptionType Type, unsigned Outputs, unsigned Moving>
+		void european_sweep_kernel(const double* base, const SweepAxis* axes, size_t axis_count, size_t first, size_t last, double* const out[6])
+		{
+			const double phi = (Type == Call) ? 1.0 : -1.0; // puts use N(-d)
+			const bool needs_N1 = (Outputs & (PriceOutput | DeltaOutput | ThetaOutput)) != 0;
+			const bool needs_N2 = (Outputs & (PriceOutput | ThetaOutput | RhoOutput)) != 0;
+			const bool needs_n1 = (Outputs & (GammaOutput | VegaOutput | ThetaOutput)) != 0;
+			const bool needs_carry = (Outputs & (PriceOutput | DeltaOutput | GammaOutput | VegaOutput | ThetaOutput)) != 0;
+			const bool needs_discount = (Outputs & (PriceOutput | ThetaOutput | RhoOutput)) != 0;
+
+			double p[6];
+			for (int j = 0; j < 6; j++) { p[j] = base[j]; }
+			double T = p[Maturity], r = p[RFRate], sig = p[Volatility], b = p[CostOfCarry];
+			double sqrt_T = sqrt(T);
+			double sig_sqrt_T = sig * sqrt_T;
+			double drift = (b + sig * sig * 0.5) * T;
+			double carry = needs_carry ? exp((b - r) * T) : 0.0; // e^(bT-rT)
+			double discount = needs_discount ? exp(-r * T) : 0.0; // e^(-rT)
+			for (size_t i = first; i < last; i++)
+			{
+				for (size_t j = 0; j < axis_count; j++) { p[axes[j].type] = axes[j].at(i); }
+				double K = p[StrikePrice], S = p[AssetPrice];
+				if (Moving & MovesMaturity) { T = p[Maturity]; }
+				if (Moving & MovesRFRate) { r = p[RFRate]; }
+				if (Moving & MovesVolatility) { sig = p[Volatility]; }
+				if (Moving & MovesCostOfCarry) { b = p[CostOfCarry]; }
+				if (Moving & MovesMaturity) { sqrt_T = sqrt(T); }
+				if (Moving & (MovesMaturity | MovesVolatility)) { sig_sqrt_T = sig * sqrt_T; }
+				if (Moving & (MovesMaturity | MovesVolatility | MovesCostOfCarry)) { drift = (b + sig * sig * 0.5) * T; }
+				if (needs_carry && (Moving & (MovesMaturity | MovesRFRate | MovesCostOfCarry))) { carry = exp((b - r) * T); }
+				if (needs_discount && (Moving & (MovesMaturity | MovesRFRate))) { discount = exp(-r * T); }
+
+				double d1 = (log(S / K) + drift) / sig_sqrt_T;
+				double d2 = d1 - sig_sqrt_T;
+				double N1 = needs_N1 ? N(phi * d1) : 0.0;
+				double N2 = needs_N2 ? N(phi * d2) : 0.0;
+				double n1 = needs_n1 ? n(d1) : 0.0;
+
+				if (Outputs & PriceOutput) { out[0][i] = phi * (S * carry * N1 - K * discount * N2); }
+				if (Outputs & DeltaOutput) { out[1][i] = phi * carry * N1; }
+				if (Outputs & GammaOutput) { out[2][i] = carry * n1 / (S * sig_sqrt_T); }
+				if (Outputs & VegaOutput) { out[3][i] = S * sqrt_T * carry * n1; }
+				if (Outputs & ThetaOutput)
+				{
+					double S_carry = S * carry;
+					double K_discount = K * discount;
+					out[4][i] = -(S_carry * sig * n1) / (2 * sqrt_T) - phi * ((b - r) * S_carry * N1 + r * K_discount * N2);
+				}
+				if (Outputs & RhoOutput) { out[5][i] = phi * T * K * discount * N2; }
+			}
+		}
+
+		// Perpetual american price, the generic formula behind calculate_american_perpetual_theoretical_price
+		template<OptionType Type>
+		void american_perpetual_sweep_kernel(const double* base, const SweepAxis* axes, size_t axis_count, size_t first, size_t last, double* const out[6])
+		{
+			double p[6];
+			for (int j = 0; j < 6; j++) { p[j] = base[j]; }
+			for (size_t i = first; i < last; i++)
+			{
+				for (size_t j = 0; j < axis_count; j++) { p[axes[j].type] = axes[j].at(i); }
+				out[0][i] = generic_american_perpetual_price<double>(Type, p[StrikePrice], p[Volatility], p[AssetPrice], p[RFRate], p[CostOfCarry]);
+			}
+		}
+
+		}
+	}
+}
+#endif // !SWEEP_KERNELS_HPP
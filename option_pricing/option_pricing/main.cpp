@@ -6,15 +6,40 @@
 */
 
 // Standard Libraries
+#include <atomic>
 #include <iostream>
 #include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
 
 // Custom headers
 #include "financial_instruments/EuropeanOption.hpp"
 #include "financial_instruments/AmericanPerpetualOption.hpp"
+#include "financial_instruments/AmericanOption.hpp"
+#include "financial_instruments/BaroneAdesiWhaleyOption.hpp"
+#include "financial_instruments/BjerksundStenslandOption.hpp"
+#include "financial_instruments/MonteCarloEngine.hpp"
 #include "financial_instruments/OptionConstants.hpp"
 #include "financial_instruments/OptionParameter.hpp"
 #include "financial_instruments/OptionManager.hpp"
+#include "financial_instruments/OptionBatch.hpp"
+#include "financial_instruments/BatchPricer.hpp"
+#include "financial_instruments/ParameterGrid.hpp"
+#include "financial_instruments/GridSink.hpp"
+#include "financial_instruments/ImpliedVolatility.hpp"
+#include "financial_instruments/PriceCache.hpp"
+#include "financial_instruments/Portfolio.hpp"
+#include "financial_instruments/MarketData.hpp"
+#include "financial_instruments/InstrumentBook.hpp"
+#include "financial_instruments/GenericFormulas.hpp"
+#include "financial_instruments/BumpGreeks.hpp"
+#include "financial_instruments/BookFile.hpp"
+#include "financial_instruments/ChainReader.hpp"
+#include "utils/Instrumentation.hpp"
+#include "utils/PerfCounters.hpp"
 #include "utils/Print.hpp"
 
 // Boost libraries
@@ -224,6 +249,1392 @@ void test_perpetual_american_grid()
 	print(manager.matrix_pricer(americanCall, TheoreticalPrice, sampleParameterGrid));
 }
 
+void test_batch_pricing()
+{
+	/*
+	* Prices a random book with every available instruction set and compares
+	* against the scalar formulas, tolerances are documented in BatchPricer.hpp
+	*/
+	cout << "---Begin experiment for testing batch pricing---" << endl;
+	OptionBatch europeanBook(European);
+	OptionBatch americanBook(American);
+	srand(42);
+	for (int i = 0; i < 10000; i++)
+	{
+		OptionType t = (i % 2 == 0) ? Call : Put;
+		double ap = 10 + 190.0 * rand() / RAND_MAX;
+		double sp = 10 + 190.0 * rand() / RAND_MAX;
+		double ttm = 0.01 + 5.0 * rand() / RAND_MAX;
+		double rf = 0.1 * rand() / RAND_MAX;
+		double vol = 0.05 + 0.75 * rand() / RAND_MAX;
+		europeanBook.add(EuropeanOption(t, ap, sp, ttm, rf, vol, rf));
+		americanBook.add(AmericanPerpetualOption(t, ap, sp, rf + 0.01, vol, rf));
+	}
+
+	vector<SimdInstructionSet> sets = { ScalarInstructions, AVX2Instructions, AVX512Instructions };
+	vector<string> names = { "Scalar", "AVX2", "AVX-512" };
+	for (size_t s = 0; s < sets.size(); s++)
+	{
+		if (sets[s] > BatchPricer::supported_instruction_set()) { continue; } // Not available on this CPU/build
+		BatchPricer pricer(sets[s]);
+		vector<double> europeanPrices = pricer.theoretical_prices(europeanBook);
+		vector<double> americanPrices = pricer.theoretical_prices(americanBook);
+		double europeanErr = 0, americanErr = 0;
+		bool withinTolerance = true;
+		for (size_t i = 0; i < europeanBook.size(); i++)
+		{
+			double tol = 1e-10 * (europeanBook.S[i] + europeanBook.K[i]); // absolute, European
+			double relativeTol = 1e-10; // relative, American Perpetual
+			double e = fabs(europeanPrices[i] - calculate_theoretical_price(europeanBook.type[i], europeanBook.T[i], europeanBook.K[i], europeanBook.sig[i], europeanBook.S[i], europeanBook.r[i], europeanBook.b[i]));
+			double ref = calculate_american_perpetual_theoretical_price(americanBook.type[i], americanBook.K[i], americanBook.sig[i], americanBook.S[i], americanBook.r[i], americanBook.b[i]);
+			double a = fabs(americanPrices[i] - ref) / max(1.0, fabs(ref));
+			europeanErr = max(europeanErr, e);
+			americanErr = max(americanErr, a);
+			withinTolerance = withinTolerance && e <= tol && a <= relativeTol;
+		}
+		cout << names[s] << ": max |batch - scalar| European = " << europeanErr << ", American Perpetual = " << americanErr << ", within tolerance: " << withinTolerance << endl;
+	}
+}
+
+void test_normal_distribution_accuracy()
+{
+	/*
+	* Sweeps [-40, 40] in steps of 1e-5 and compares N()/n() against boost,
+	* the bounds checked are the ones stated in utils/NormalDistribution.hpp
+	*/
+	cout << "---Begin experiment for testing normal distribution accuracy---" << endl;
+	double cdfErr = 0, pdfErr = 0, cdfWorst = 0, pdfWorst = 0;
+	for (long i = -4000000; i <= 4000000; i++)
+	{
+		double x = i * 1e-5;
+		double c = fabs(N(x) - N_reference(x));
+		double p = fabs(n(x) - n_reference(x));
+		if (c > cdfErr) { cdfErr = c; cdfWorst = x; }
+		if (p > pdfErr) { pdfErr = p; pdfWorst = x; }
+	}
+	cout << "Max CDF error: " << cdfErr << " at x = " << cdfWorst << ", within 5e-14: " << (cdfErr < 5e-14) << endl;
+	cout << "Max PDF error: " << pdfErr << " at x = " << pdfWorst << ", within 2e-16: " << (pdfErr < 2e-16) << endl;
+}
+
+void test_fused_greeks()
+{
+	/*
+	* Checks the fused price/greeks call against the individual formulas,
+	* both directly and through the OptionManager sweep overload
+	*/
+	cout << "---Begin experiment for testing fused price and greeks---" << endl;
+	vector<EuropeanOption> options = { greekCall, greekPut, sampleCall, samplePut };
+	vector<OptionFunctionType> functions = { TheoreticalPrice, Delta, Gamma, Vega, Theta, Rho };
+	double maxErr = 0;
+	for (size_t i = 0; i < options.size(); i++)
+	{
+		OptionGreeks g = options[i].greeks();
+		for (size_t j = 0; j < functions.size(); j++)
+		{
+			maxErr = max(maxErr, fabs(g.get(functions[j]) - options[i].calculate(functions[j])));
+		}
+	}
+	cout << "Max |fused - individual| over price/delta/gamma/vega/theta/rho: " << maxErr << endl;
+
+	OptionParameter sampleRange(AssetPrice, generate_range(10, 50));
+	vector<OptionGreeks> sweep = manager.calculate_parameter(greekCall, sampleRange);
+	vector<double> deltas = manager.calculate_parameter(greekCall, Delta, sampleRange);
+	double sweepErr = 0;
+	for (size_t i = 0; i < sweep.size(); i++)
+	{
+		sweepErr = max(sweepErr, fabs(sweep[i].delta - deltas[i]));
+	}
+	cout << "Max |fused - individual| delta over asset price sweep: " << sweepErr << endl;
+}
+
+void test_parallel_manager()
+{
+	/*
+	* Runs the same sweeps serially and on a thread pool, results must be identical
+	*/
+	cout << "---Begin experiment for testing parallel option manager---" << endl;
+	OptionManager parallelManager(4);
+	OptionParameter largeRange(AssetPrice, 10, 200, 100000);
+	OptionParameter largeVols(Volatility, 0.1, 0.6, 100000);
+	vector<OptionParameter> largeGrid = { largeRange, largeVols };
+
+	vector<double> serialPrices = manager.calculate_parameter(greekCall, TheoreticalPrice, largeRange);
+	vector<double> parallelPrices = parallelManager.calculate_parameter(greekCall, TheoreticalPrice, largeRange);
+	vector<vector<double>> serialGrid = manager.matrix_pricer(greekPut, Delta, largeGrid);
+	vector<vector<double>> parallelGrid = parallelManager.matrix_pricer(greekPut, Delta, largeGrid);
+	vector<vector<OptionGreeks>> serialGreeks = manager.matrix_pricer(greekPut, largeGrid);
+	vector<vector<OptionGreeks>> parallelGreeks = parallelManager.matrix_pricer(greekPut, largeGrid);
+
+	bool identical = serialPrices == parallelPrices && serialGrid == parallelGrid;
+	for (size_t i = 0; i < serialGreeks[0].size(); i++)
+	{
+		identical = identical && serialGreeks[0][i].price == parallelGreeks[0][i].price && serialGreeks[0][i].theta == parallelGreeks[0][i].theta;
+	}
+	cout << "Threads: " << parallelManager.threads() << ", points: " << serialPrices.size() << endl;
+	cout << "Parallel results identical to serial: " << identical << endl;
+	cout << "Caller's option unchanged: " << (greekCall.current_price() == 105) << endl;
+
+	// A chunk throwing on a worker reaches the caller, and the pool keeps working afterwards
+	ThreadPool pool(4);
+	bool rethrown = false;
+	try
+	{
+		pool.parallel_for(0, 1000, 10, [](size_t first, size_t last) { if (first <= 500 && 500 < last) { throw runtime_error("chunk failed"); } });
+	}
+	catch (const runtime_error& e)
+	{
+		rethrown = string(e.what()) == "chunk failed";
+	}
+	atomic<size_t> visited(0);
+	pool.parallel_for(0, 1000, 10, [&visited](size_t first, size_t last) { visited += last - first; });
+	cout << "Exception in a chunk rethrown on the caller: " << rethrown << ", pool reusable: " << (visited.load() == 1000) << endl;
+}
+
+void test_parameter_grid_product()
+{
+	/*
+	* Streams the full product of four axes through reductions, serially and in
+	* parallel, and checks the result against pricing every point directly
+	*/
+	cout << "---Begin experiment for testing Cartesian product parameter grids---" << endl;
+	vector<OptionParameter> axes = {
+		OptionParameter(AssetPrice, 50, 150, 99),
+		OptionParameter(Volatility, 0.1, 0.5, 19),
+		OptionParameter(Maturity, 0.25, 2.5, 9),
+		OptionParameter(RFRate, 0.0, 0.09, 9),
+	};
+	ParameterGrid grid(axes);
+
+	GridReduction serialStats(20, 0, 100);
+	GridReduction parallelStats(20, 0, 100);
+	manager.grid_pricer(greekCall, TheoreticalPrice, grid, serialStats, 1000);
+	OptionManager(4).grid_pricer(greekCall, TheoreticalPrice, grid, parallelStats, 1000);
+
+	// Direct evaluation of every point for reference
+	double maxErr = 0;
+	EuropeanOption point = greekCall;
+	vector<size_t> coords;
+	GridCallbackSink checker([&](size_t first, const double* values, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			for (size_t j = 0; j < grid.dimensions(); j++) { point.set_parameter(grid.axis(j).type(), grid.value(first + i, j)); }
+			maxErr = max(maxErr, fabs(values[i] - point.theoretical_price()));
+		}
+	});
+	manager.grid_pricer(greekCall, TheoreticalPrice, grid, checker);
+
+	grid.coordinates(serialStats.argmax(), coords);
+	cout << "Points: " << serialStats.count() << " (" << grid.size() << " expected)" << endl;
+	cout << "Mean price: " << serialStats.mean() << ", min: " << serialStats.min() << ", max: " << serialStats.max() << endl;
+	cout << "Max price at S = " << grid.axis(0).get(coords[0]) << ", sig = " << grid.axis(1).get(coords[1]) << ", T = " << grid.axis(2).get(coords[2]) << ", r = " << grid.axis(3).get(coords[3]) << endl;
+	cout << "Price histogram [0, 100) in 20 buckets: ";
+	print(vector<double>(serialStats.histogram().begin(), serialStats.histogram().end()));
+	cout << "Max |streamed - direct|: " << maxErr << endl;
+	cout << "Parallel reductions identical to serial: " << (serialStats.sum() == parallelStats.sum() && serialStats.argmin() == parallelStats.argmin() && serialStats.histogram() == parallelStats.histogram()) << endl;
+}
+
+void test_lazy_parameters()
+{
+	/*
+	* Lazy ranges and views must give the same sweeps as materialized vectors
+	*/
+	cout << "---Begin experiment for testing lazy and viewed option parameters---" << endl;
+	OptionParameter lazyRange(AssetPrice, 10, 50, 40); // generated on demand
+	OptionParameter ownedRange(AssetPrice, lazyRange.values()); // same points, materialized
+	vector<double> spots = generate_range(10, 50);
+	OptionParameter viewedSpots(AssetPrice, spots.data(), spots.size()); // no copy of spots
+
+	cout << "Lazy range identical to materialized: " << (manager.calculate_parameter(sampleCall, TheoreticalPrice, lazyRange) == manager.calculate_parameter(sampleCall, TheoreticalPrice, ownedRange)) << endl;
+	cout << "View identical to owned vector: " << (manager.calculate_parameter(sampleCall, TheoreticalPrice, viewedSpots) == manager.calculate_parameter(sampleCall, TheoreticalPrice, OptionParameter(AssetPrice, spots))) << endl;
+
+	cout << "Geometric vols: ";
+	print(OptionParameter(Volatility, GeometricRange, 0.05, 0.8, 5).values());
+	cout << "Chebyshev spots: ";
+	print(OptionParameter(AssetPrice, ChebyshevRange, 50, 150, 5).values());
+	cout << "Geometric rates from 0 (rejected): ";
+	print(OptionParameter(RFRate, GeometricRange, 0.0, 0.1, 5).values());
+	cout << "Mesh sizes 0 and -3 (rejected): ";
+	OptionParameter zeroMesh(AssetPrice, 10, 50, 0), negativeMesh(AssetPrice, 10, 50, -3);
+	cout << "Empty ranges: " << (zeroMesh.size() == 0 && negativeMesh.size() == 0) << endl;
+}
+
+void test_implied_volatility()
+{
+	/*
+	* Prices a random chain at known volatilities, then backs them out again
+	*/
+	cout << "---Begin experiment for testing batch implied volatility---" << endl;
+	OptionBatch chain(European);
+	vector<double> quotes;
+	srand(7);
+	for (int i = 0; i < 20000; i++)
+	{
+		OptionType t = (i % 2 == 0) ? Call : Put;
+		double sp = 60 + 80.0 * rand() / RAND_MAX;
+		double ttm = 0.02 + 3.0 * rand() / RAND_MAX;
+		double vol = 0.05 + 1.0 * rand() / RAND_MAX;
+		chain.add(t, 100, sp, ttm, 0.03, vol, 0.01);
+		quotes.push_back(calculate_theoretical_price(t, ttm, sp, vol, 100, 0.03, 0.01));
+	}
+	quotes[0] = 0.0; // below intrinsic
+	quotes[1] = 1000.0; // above the no-arbitrage maximum
+
+	ImpliedVolatilitySolver solver(4);
+	vector<double> vols;
+	vector<int> iterations;
+	vector<ImpliedVolatilityStatus> status;
+	solver.solve(chain, quotes, vols, iterations, status);
+
+	double maxErr = 0, meanIterations = 0;
+	int converged = 0;
+	for (size_t i = 0; i < vols.size(); i++)
+	{
+		if (status[i] != ImpliedVolConverged) { continue; }
+		double vega = calculate_vega(chain.type[i], chain.T[i], chain.K[i], chain.sig[i], chain.S[i], chain.r[i], chain.b[i]);
+		if (vega > 1e-4) { maxErr = max(maxErr, fabs(vols[i] - chain.sig[i])); } // volatility is only identifiable where vega is not negligible
+		meanIterations += iterations[i];
+		converged++;
+	}
+	cout << "Converged: " << converged << " of " << vols.size() << ", mean iterations: " << meanIterations / converged << endl;
+	cout << "Max |implied - true| volatility (vega > 1e-4): " << maxErr << endl;
+	cout << "Status of quote below intrinsic: " << status[0] << ", above maximum: " << status[1] << endl;
+
+	// A quote needing more than the 10000% bracket cap (T = 1e-9, S = K = 100, price 3), in full vectors and the scalar tail
+	OptionBatch tiny(European);
+	vector<double> tiny_quotes(9, 3.0);
+	for (int i = 0; i < 9; i++) { tiny.add(Call, 100, 100, 1e-9, 0.0, 0.2, 0.0); }
+	solver.solve(tiny, tiny_quotes, vols, iterations, status);
+	bool capped = true;
+	for (size_t i = 0; i < status.size(); i++) { capped = capped && status[i] == ImpliedVolAboveBracket && isnan(vols[i]); }
+	cout << "Quote above the volatility cap reported as such (status " << ImpliedVolAboveBracket << "): " << (capped ? "true" : "false") << endl;
+}
+
+void test_american_lattice()
+{
+	/*
+	* Compares lattice configurations against a fine smoothed lattice, then prices a book of contracts on one engine
+	*/
+	cout << "---Begin experiment for testing finite maturity American Options on a lattice---" << endl;
+	LatticeEngine reference(BinomialLattice, 10000);
+	reference.set_richardson(true);
+	reference.set_control_variate(true);
+	AmericanOption put = AmericanOption(Put, 100, 100, 1.0, 0.05, 0.2, 0.05, reference);
+	double exact = put.theoretical_price();
+	double european = calculate_theoretical_price(Put, 1.0, 100, 0.2, 100, 0.05, 0.05);
+	cout << "American put (S = K = 100, T = 1, r = b = 0.05, vol = 0.2): " << exact << ", early exercise premium: " << exact - european << endl;
+
+	string names[] = { "binomial", "binomial + control variate", "binomial + richardson", "binomial + richardson + control variate", "trinomial", "trinomial + richardson + control variate" };
+	for (int c = 0; c < 6; c++)
+	{
+		LatticeEngine engine((c < 4) ? BinomialLattice : TrinomialLattice, 100);
+		engine.set_control_variate(c == 1 || c == 3 || c == 5);
+		engine.set_richardson(c == 2 || c == 3 || c == 5);
+		cout << names[c] << ": |error| ";
+		for (size_t steps = 50; steps <= 400; steps *= 2)
+		{
+			engine.set_steps(steps);
+			put.set_engine(engine);
+			cout << "N=" << steps << ": " << fabs(put.theoretical_price() - exact) << "  ";
+		}
+		cout << endl;
+	}
+
+	OptionBatch book(AmericanFinite);
+	srand(11);
+	for (int i = 0; i < 2000; i++)
+	{
+		OptionType t = (i % 2 == 0) ? Call : Put;
+		book.add(t, 100, 70 + 60.0 * rand() / RAND_MAX, 0.1 + 2.0 * rand() / RAND_MAX, 0.04, 0.1 + 0.5 * rand() / RAND_MAX, 0.01);
+	}
+	LatticeEngine engine(BinomialLattice, 100);
+	engine.set_richardson(true);
+	engine.set_control_variate(true);
+	vector<double> prices;
+	auto start = chrono::steady_clock::now();
+	engine.prices(book, prices);
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	cout << "Priced " << book.size() << " contracts on one 100 step engine: " << 1e6 * seconds / book.size() << " us per contract" << endl;
+
+	// Greeks come from the lattice, not Black-Scholes: deep in the exercise region the put is K - S
+	AmericanOption exercised = AmericanOption(Put, 80, 100, 1.0, 0.08, 0.2, 0.08);
+	OptionGreeks g = exercised.greeks();
+	cout << "Exercised put (S = 80, K = 100, r = b = 0.08): price " << g.price << ", delta " << exercised.calculate(Delta) << " (bumped " << exercised.calculate(ApproxDelta)
+		<< ", Black-Scholes " << calculate_delta(Put, 1.0, 100, 0.2, 80, 0.08, 0.08) << "), gamma " << g.gamma << ", vega " << g.vega << ", theta " << g.theta << ", rho " << g.rho << endl;
+	bool withinTolerance = fabs(g.delta + 1) < 1e-9 && fabs(exercised.calculate(ApproxDelta) + 1) < 1e-6 && fabs(g.gamma) < 1e-6 && fabs(g.vega) < 1e-9;
+	cout << "Lattice greeks match the exercise value: " << (withinTolerance ? "true" : "false") << endl;
+	AmericanOption atm = AmericanOption(Put, 100, 100, 1.0, 0.05, 0.2, 0.05);
+	cout << "greeks() gamma (center from the adjoint pass) against gamma(): |difference| " << fabs(atm.greeks().gamma - atm.gamma()) << endl;
+}
+
+void test_pde_engine()
+{
+	/*
+	* Checks one Crank-Nicolson solve against Black-Scholes over a spot ladder, then against the lattice for americans
+	*/
+	cout << "---Begin experiment for testing the finite difference engine---" << endl;
+	FiniteDifferenceEngine engine;
+	OptionParameter spots = OptionParameter(AssetPrice, 50, 150, 100);
+	vector<double> ladder = spots.values();
+	vector<double> out(ladder.size());
+
+	double europeanErr = 0;
+	for (OptionType t : { Call, Put })
+	{
+		engine.spot_ladder(European, t, 1.0, 100, 0.3, 0.05, 0.02, ladder.data(), out.data(), ladder.size());
+		for (size_t i = 0; i < ladder.size(); i++)
+		{
+			europeanErr = max(europeanErr, fabs(out[i] - calculate_theoretical_price(t, 1.0, 100, 0.3, ladder[i], 0.05, 0.02)));
+		}
+	}
+	cout << "European ladder of " << ladder.size() << " spots, max |PDE - Black-Scholes|: " << europeanErr << endl;
+
+	LatticeEngine reference(BinomialLattice, 10000);
+	reference.set_richardson(true);
+	reference.set_control_variate(true);
+	double exact = reference.price(Put, 1.0, 100, 0.2, 100, 0.05, 0.05);
+	engine.set_early_exercise(PenaltyExercise);
+	cout << "American put, |PDE - lattice| penalty: " << fabs(engine.price(AmericanFinite, Put, 1.0, 100, 0.2, 100, 0.05, 0.05) - exact);
+	engine.set_early_exercise(PsorExercise);
+	cout << ", PSOR: " << fabs(engine.price(AmericanFinite, Put, 1.0, 100, 0.2, 100, 0.05, 0.05) - exact) << endl;
+
+	// AssetPrice sweep of an american: lattice per spot against one PDE solve
+	AmericanOption put = AmericanOption(Put, 100, 100, 1.0, 0.05, 0.2, 0.05, LatticeEngine(BinomialLattice, 400));
+	OptionManager manager;
+	auto start = chrono::steady_clock::now();
+	vector<double> lattice = manager.calculate_parameter(put, TheoreticalPrice, spots);
+	double latticeSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	manager.set_spot_engine(FiniteDifferenceEngine());
+	start = chrono::steady_clock::now();
+	vector<double> pde = manager.calculate_parameter(put, TheoreticalPrice, spots);
+	double pdeSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	double sweepDiff = 0;
+	for (size_t i = 0; i < pde.size(); i++) { sweepDiff = max(sweepDiff, fabs(pde[i] - lattice[i])); }
+	cout << "American AssetPrice sweep: lattice " << 1e3 * latticeSeconds << " ms, PDE " << 1e3 * pdeSeconds << " ms, max |difference|: " << sweepDiff << endl;
+
+	// Approximations are not routed to the PDE: the sweep keeps their own prices
+	BaroneAdesiWhaleyOption baw = BaroneAdesiWhaleyOption(Put, 100, 100, 1.0, 0.05, 0.2, 0.05);
+	vector<double> approximated = manager.calculate_parameter(baw, TheoreticalPrice, spots);
+	size_t mismatches = 0;
+	for (size_t i = 0; i < spots.size(); i++)
+	{
+		baw.set_parameter(AssetPrice, spots.get((int)i));
+		mismatches += (baw.theoretical_price() != approximated[i]);
+	}
+	cout << "Barone-Adesi-Whaley AssetPrice sweep with the spot engine set, points differing from theoretical_price: " << mismatches << endl;
+}
+
+void test_monte_carlo()
+{
+	/*
+	* Convergence against the analytic price, reproducibility across thread counts, and Longstaff-Schwartz against the lattice
+	*/
+	cout << "---Begin experiment for testing the Monte Carlo engine---" << endl;
+	EuropeanOption call = EuropeanOption(Call, 100, 100, 1.0, 0.05, 0.2, 0.05);
+	double exact = call.theoretical_price();
+	MonteCarloEngine engine;
+	for (int antithetic = 0; antithetic < 2; antithetic++)
+	{
+		engine.set_antithetic(antithetic == 1);
+		for (size_t paths = 10000; paths <= 1000000; paths *= 10)
+		{
+			engine.set_paths(paths);
+			auto start = chrono::steady_clock::now();
+			MonteCarloResult result = engine.price(call);
+			double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			cout << (antithetic ? "antithetic " : "plain      ") << paths << " paths: |MC - analytic| = " << fabs(result.price - exact)
+				<< ", standard error = " << result.standard_error << ", " << 1e9 * seconds / result.paths << " ns per path" << endl;
+		}
+	}
+
+	MonteCarloEngine serial(200000, 1), parallel(200000, 4);
+	serial.set_antithetic(true);
+	parallel.set_antithetic(true);
+	cout << "Bit-identical price at 1 and 4 threads: " << (serial.price(call).price == parallel.price(call).price) << endl;
+	MonteCarloEngine tiny;
+	tiny.set_antithetic(true);
+	cout << "2 antithetic paths (rejected): ";
+	tiny.set_paths(2);
+	tiny.set_paths(3);
+	cout << "3 antithetic paths, finite standard error: " << isfinite(tiny.price(call).standard_error) << endl;
+
+	LatticeEngine reference(BinomialLattice, 10000);
+	reference.set_richardson(true);
+	reference.set_control_variate(true);
+	AmericanOption put = AmericanOption(Put, 100, 100, 1.0, 0.05, 0.2, 0.05, reference);
+	double lattice = put.theoretical_price();
+	MonteCarloEngine lsm(100000, 4);
+	lsm.set_antithetic(true);
+	for (int cv = 0; cv < 2; cv++)
+	{
+		lsm.set_control_variate(cv == 1);
+		MonteCarloResult result = lsm.price(put);
+		cout << "American put, Longstaff-Schwartz" << (cv ? " + control variate" : "") << ": " << result.price << " (lattice " << lattice << "), standard error = " << result.standard_error << endl;
+	}
+}
+
+void test_american_approximations()
+{
+	/*
+	* Compares the closed form american approximations with a fine lattice, then times their batch kernels
+	*/
+	cout << "---Begin experiment for testing Barone-Adesi & Whaley and Bjerksund & Stensland approximations---" << endl;
+	LatticeEngine reference(BinomialLattice, 2000);
+	reference.set_richardson(true);
+	reference.set_control_variate(true);
+	double spots[] = { 90, 100, 110 };
+	for (int i = 0; i < 3; i++)
+	{
+		BaroneAdesiWhaleyOption baw = BaroneAdesiWhaleyOption(Put, spots[i], 100, 0.5, 0.08, 0.25, 0.04);
+		BjerksundStenslandOption bs = BjerksundStenslandOption(Put, spots[i], 100, 0.5, 0.08, 0.25, 0.04);
+		AmericanOption lattice = AmericanOption(Put, spots[i], 100, 0.5, 0.08, 0.25, 0.04, reference);
+		cout << "Put S = " << spots[i] << ": BAW " << baw.calculate(TheoreticalPrice) << ", BS93 " << bs.calculate(TheoreticalPrice) << ", lattice " << lattice.calculate(TheoreticalPrice) << endl;
+		cout << "  delta: BAW " << baw.calculate(Delta) << ", BS93 " << bs.calculate(Delta) << ", lattice " << lattice.calculate(Delta)
+			<< "; gamma: BAW " << baw.calculate(Gamma) << ", BS93 " << bs.calculate(Gamma) << ", lattice " << lattice.calculate(Gamma) << endl;
+	}
+	// In the exercise region each model is worth K - S: delta -1, every other greek 0
+	BaroneAdesiWhaleyOption exercised_baw = BaroneAdesiWhaleyOption(Put, 80, 100, 1.0, 0.08, 0.2, 0.08);
+	BjerksundStenslandOption exercised_bs = BjerksundStenslandOption(Put, 80, 100, 1.0, 0.08, 0.2, 0.08);
+	OptionGreeks greeks_baw = exercised_baw.greeks(), greeks_bs = exercised_bs.greeks();
+	cout << "Exercised put (S = 80, K = 100): BAW delta " << greeks_baw.delta << " vega " << greeks_baw.vega << ", BS93 delta " << greeks_bs.delta << " vega " << greeks_bs.vega
+		<< " (Black-Scholes delta " << calculate_delta(Put, 1.0, 100, 0.2, 80, 0.08, 0.08) << ")" << endl;
+	bool withinTolerance = fabs(greeks_baw.delta + 1) < 1e-6 && fabs(greeks_bs.delta + 1) < 1e-6 && fabs(greeks_baw.vega) < 1e-6 && fabs(greeks_bs.vega) < 1e-6;
+	cout << "Approximation greeks match the exercise value: " << (withinTolerance ? "true" : "false") << endl;
+
+	OptionBatch book(AmericanFinite);
+	srand(13);
+	for (int i = 0; i < 100000; i++)
+	{
+		OptionType t = (i % 2 == 0) ? Call : Put;
+		book.add(t, 100, 70 + 60.0 * rand() / RAND_MAX, 0.05 + 1.0 * rand() / RAND_MAX, 0.05, 0.1 + 0.5 * rand() / RAND_MAX, 0.01);
+	}
+	size_t n = book.size();
+	vector<double> baw(n), bs(n), scalar_baw(n), scalar_bs(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		scalar_baw[i] = calculate_barone_adesi_whaley_price(book.type[i], book.T[i], book.K[i], book.sig[i], book.S[i], book.r[i], book.b[i]);
+		scalar_bs[i] = calculate_bjerksund_stensland_price(book.type[i], book.T[i], book.K[i], book.sig[i], book.S[i], book.r[i], book.b[i]);
+	}
+
+	string names[] = { "scalar", "AVX2", "AVX-512" };
+	for (int is = ScalarInstructions; is <= AVX512Instructions; is++)
+	{
+		BatchPricer pricer((SimdInstructionSet)is);
+		if (pricer.instruction_set() != is) { continue; }
+		auto start = chrono::steady_clock::now();
+		pricer.barone_adesi_whaley_prices(book.type.data(), book.T.data(), book.K.data(), book.sig.data(), book.S.data(), book.r.data(), book.b.data(), baw.data(), n);
+		auto middle = chrono::steady_clock::now();
+		pricer.bjerksund_stensland_prices(book.type.data(), book.T.data(), book.K.data(), book.sig.data(), book.S.data(), book.r.data(), book.b.data(), bs.data(), n);
+		auto end = chrono::steady_clock::now();
+		double error = 0.0;
+		for (size_t i = 0; i < n; i++)
+		{
+			error = fmax(error, fmax(fabs(baw[i] - scalar_baw[i]), fabs(bs[i] - scalar_bs[i])) / (book.S[i] + book.K[i]));
+		}
+		cout << names[is] << " kernels: BAW " << 1e9 * chrono::duration<double>(middle - start).count() / n << " ns, BS93 "
+			<< 1e9 * chrono::duration<double>(end - middle).count() / n << " ns per contract, max error / (S + K) vs scalar " << error << endl;
+	}
+}
+
+void test_incremental_repricing()
+{
+	/*
+	* Changes one parameter at a time on an option and checks the cached terms against the
+	* formulas evaluated from scratch, then times a spot sweep against rebuilding every term
+	*/
+	cout << "---Begin experiment for testing incremental repricing on cached terms---" << endl;
+	EuropeanOption put = EuropeanOption(Put, 100, 100, 0.5, 0.05, 0.2, 0.03);
+	OptionParameterType parameters[] = { AssetPrice, StrikePrice, Maturity, RFRate, Volatility, CostOfCarry };
+	double low[] = { 60, 80, 0.1, 0.0, 0.1, -0.02 };
+	double high[] = { 140, 120, 2.0, 0.1, 0.6, 0.08 };
+	srand(17);
+	double maxErr = 0;
+	for (int i = 0; i < 10000; i++)
+	{
+		int p = (i % 3 == 0) ? rand() % 6 : 0; // mostly spot moves, like a sweep
+		put.set_parameter(parameters[p], low[p] + (high[p] - low[p]) * rand() / RAND_MAX);
+		double T = put.time_to_maturity(), K = put.strike_price(), sig = put.volatility(), S = put.current_price(), r = put.risk_free_rate(), b = put.cost_of_carry();
+		OptionFunctionType oft = (OptionFunctionType)(i % 5); // price, delta, gamma, vega, theta in turn
+		double expected[] = { calculate_theoretical_price(Put, T, K, sig, S, r, b), calculate_delta(Put, T, K, sig, S, r, b),
+			calculate_gamma(Put, T, K, sig, S, r, b), calculate_vega(Put, T, K, sig, S, r, b), calculate_theta(Put, T, K, sig, S, r, b) };
+		maxErr = max(maxErr, fabs(put.calculate(oft) - expected[oft]) / max(1.0, fabs(expected[oft])));
+	}
+	cout << "Max relative |cached - from scratch| over 10000 parameter changes: " << maxErr << endl;
+
+	OptionParameter spots(AssetPrice, 50, 150, 1000000);
+	EuropeanOption call = EuropeanOption(Call, 100, 100, 0.5, 0.05, 0.2, 0.03);
+	OptionManager serial;
+	auto start = chrono::steady_clock::now();
+	vector<double> cached = serial.calculate_parameter(call, TheoreticalPrice, spots);
+	auto middle = chrono::steady_clock::now();
+	double checksum = 0;
+	for (size_t i = 0; i < spots.size(); i++)
+	{
+		checksum += fabs(calculate_theoretical_price(Call, 0.5, 100, 0.2, spots.get((int)i), 0.05, 0.03) - cached[i]);
+	}
+	auto end = chrono::steady_clock::now();
+	cout << "Spot sweep of " << spots.size() << " points: cached terms " << 1e9 * chrono::duration<double>(middle - start).count() / spots.size()
+		<< " ns per point, every term rebuilt " << 1e9 * chrono::duration<double>(end - middle).count() / spots.size() << " ns per point (sum |difference| " << checksum << ")" << endl;
+}
+
+void print_cache_statistics(const PriceCache& cache)
+{
+	PriceCacheStatistics stats = cache.statistics();
+	cout << "hits " << stats.hits << ", misses " << stats.misses << ", evictions " << stats.evictions << ", size " << stats.size << ", hit rate " << stats.hit_rate() << endl;
+}
+
+void test_price_cache()
+{
+	/*
+	* Reprices the same contracts through a shared cache: single options, a parallel sweep,
+	* SIMD and lattice batches, then a cache too small for its working set
+	*/
+	cout << "---Begin experiment for testing the memoizing price cache---" << endl;
+	shared_ptr<PriceCache> cache = make_shared<PriceCache>(); // 65536 entries, 16 shards, tolerance 0.001
+	EuropeanOption call = EuropeanOption(Call, 100, 100, 0.5, 0.05, 0.2, 0.03);
+	double uncached = call.calculate(Delta);
+	call.set_price_cache(cache);
+	double first = call.calculate(Delta);
+	double second = call.calculate(Delta);
+	call.set_parameter(AssetPrice, 100.0002); // same 0.001 bucket
+	double nearby = call.calculate(Delta);
+	cout << "Delta uncached " << uncached << ", first " << first << ", second " << second << ", S + 0.0002 " << nearby << endl;
+	print_cache_statistics(*cache);
+	call.set_parameter(AssetPrice, 100);
+
+	OptionManager parallel(4);
+	OptionParameter spots(AssetPrice, 50, 150, 20000);
+	vector<double> cold = parallel.calculate_parameter(call, TheoreticalPrice, spots); // clones share the cache
+	vector<double> warm = parallel.calculate_parameter(call, TheoreticalPrice, spots);
+	double sweepErr = 0;
+	for (size_t i = 0; i < cold.size(); i++) { sweepErr = max(sweepErr, fabs(cold[i] - warm[i])); }
+	cout << "Two parallel sweeps of " << spots.size() << " spots, max |cold - warm| " << sweepErr << ": ";
+	print_cache_statistics(*cache);
+
+	OptionBatch book(European);
+	srand(19);
+	for (int i = 0; i < 100000; i++) // 1000 distinct contracts quoted 100 times each
+	{
+		int c = rand() % 1000;
+		book.add((c % 2 == 0) ? Call : Put, 80 + 0.04 * c, 100, 0.25 + 0.001 * c, 0.05, 0.2, 0.03);
+	}
+	cache->clear();
+	cache->reset_statistics();
+	BatchPricer pricer;
+	vector<double> direct, memoized;
+	pricer.theoretical_prices(book, direct);
+	pricer.theoretical_prices(book, memoized, *cache);
+	double batchErr = 0;
+	for (size_t i = 0; i < book.size(); i++) { batchErr = max(batchErr, fabs(direct[i] - memoized[i])); }
+	cout << "SIMD batch, max |direct - memoized| " << batchErr << ": ";
+	print_cache_statistics(*cache);
+
+	OptionBatch americans(AmericanFinite);
+	for (size_t i = 0; i < 20000; i++) { americans.add(book.type[i], book.S[i], book.K[i], book.T[i], book.r[i], book.sig[i], book.b[i]); }
+	PriceCache lattice_cache; // separate cache: lattice prices depend on the engine settings
+	LatticeEngine engine(BinomialLattice, 200);
+	vector<double> lattice_prices;
+	auto start = chrono::steady_clock::now();
+	engine.prices(americans, lattice_prices);
+	auto middle = chrono::steady_clock::now();
+	engine.prices(americans, lattice_prices, lattice_cache);
+	auto end = chrono::steady_clock::now();
+	cout << "Lattice batch of " << americans.size() << ": " << 1e6 * chrono::duration<double>(middle - start).count() / americans.size() << " us per contract, memoized "
+		<< 1e6 * chrono::duration<double>(end - middle).count() / americans.size() << " us per contract: ";
+	print_cache_statistics(lattice_cache);
+
+	// Finite americans priced by different models share a class, not cache entries
+	shared_ptr<PriceCache> shared = make_shared<PriceCache>();
+	AmericanOption lattice_put = AmericanOption(Put, 100, 100, 1.0, 0.05, 0.2, 0.05);
+	BaroneAdesiWhaleyOption baw_put = BaroneAdesiWhaleyOption(Put, 100, 100, 1.0, 0.05, 0.2, 0.05);
+	lattice_put.set_price_cache(shared);
+	baw_put.set_price_cache(shared);
+	double lattice_price = lattice_put.calculate(TheoreticalPrice), baw_price = baw_put.calculate(TheoreticalPrice);
+	cout << "Shared cache, lattice put " << lattice_price << ", BAW put " << baw_price << " (BAW uncached " << baw_put.theoretical_price() << "), models kept apart: "
+		<< ((baw_price == baw_put.theoretical_price() && lattice_price != baw_price) ? "true" : "false") << endl;
+
+	PriceCache small(64, 4, 0.001);
+	for (int i = 0; i < 1000; i++) { small.insert_price(BlackScholesModel, Call, 1.0, 100, 0.2, 50 + 0.1 * i, 0.05, 0.05, i); }
+	double price;
+	bool recent = small.find_price(BlackScholesModel, Call, 1.0, 100, 0.2, 50 + 0.1 * 999, 0.05, 0.05, price);
+	bool oldest = small.find_price(BlackScholesModel, Call, 1.0, 100, 0.2, 50, 0.05, 0.05, price);
+	cout << "Cache of " << small.capacity() << " entries after 1000 inserts, newest kept " << recent << ", oldest kept " << oldest << ": ";
+	print_cache_statistics(small);
+}
+
+void test_portfolio()
+{
+	/*
+	* Aggregates a small mixed book against its options' own greeks, then a million position
+	* book on several thread counts: the totals must not change with the threads
+	*/
+	cout << "---Begin experiment for testing portfolio risk aggregation---" << endl;
+	Portfolio small;
+	EuropeanOption spx = EuropeanOption(Call, 100, 105, 0.75, 0.05, 0.2, 0.03);
+	AmericanPerpetualOption perpetual = AmericanPerpetualOption(Put, 100, 90, 0.1, 0.05, 0.02);
+	small.add_position("SPX", spx, 10);
+	small.add_position("SPX", greekPut, -4);
+	small.add_position("AAPL", perpetual, 3);
+	small.add_position("AAPL", AmericanFinite, Put, 100, 100, 1.5, 0.05, 0.25, 0.05, 2);
+	PortfolioRisk risk = small.risk();
+	OptionGreeks expected = calculate_price_and_greeks(Call, 0.75, 105, 0.2, 100, 0.05, 0.03);
+	OptionGreeks put = calculate_price_and_greeks(Put, 0.5, 100, 0.36, 105, 0.1, 0);
+	cout << "SPX delta " << risk.by_underlying[0].delta << " (expected " << 10 * expected.delta - 4 * put.delta << "), vega " << risk.by_underlying[0].vega
+		<< " (expected " << 10 * expected.vega - 4 * put.vega << ")" << endl;
+	cout << "AAPL perpetual bucket price " << risk.bucket(1, risk.buckets() - 1).price << " (expected " << 3 * perpetual.calculate(TheoreticalPrice) << "), delta "
+		<< risk.bucket(1, risk.buckets() - 1).delta << ", AmericanFinite bucket price " << risk.bucket(1, 3).price << ", delta " << risk.bucket(1, 3).delta << endl;
+	cout << "Total: price " << risk.total.price << ", delta " << risk.total.delta << ", gamma " << risk.total.gamma << ", vega " << risk.total.vega
+		<< ", theta " << risk.total.theta << ", rho " << risk.total.rho << endl;
+
+	Portfolio book;
+	string names[] = { "SPX", "NDX", "AAPL", "MSFT", "AMZN", "TSLA", "NVDA", "META" };
+	book.reserve(European, 1000000);
+	srand(23);
+	for (int i = 0; i < 1000000; i++)
+	{
+		OptionType t = (rand() % 2 == 0) ? Call : Put;
+		double quantity = (rand() % 201) - 100;
+		if (i % 50 == 0) { book.add_position(names[i % 8], American, t, 100, 60 + 80.0 * rand() / RAND_MAX, INFINITY, 0.05, 0.1 + 0.4 * rand() / RAND_MAX, 0.02, quantity); }
+		else { book.add_position(names[i % 8], European, t, 100, 60 + 80.0 * rand() / RAND_MAX, 0.02 + 3.0 * rand() / RAND_MAX, 0.05, 0.1 + 0.4 * rand() / RAND_MAX, 0.02, quantity); }
+	}
+	book.risk(); // sorts the book once
+	PortfolioRisk serial;
+	size_t threads[] = { 1, 2, 4, 8 };
+	for (int k = 0; k < 4; k++)
+	{
+		book.set_threads(threads[k]);
+		auto start = chrono::steady_clock::now();
+		PortfolioRisk parallel = book.risk();
+		auto end = chrono::steady_clock::now();
+		if (k == 0) { serial = parallel; }
+		bool identical = true;
+		for (size_t g = 0; g < parallel.by_bucket.size(); g++)
+		{
+			for (int f = TheoreticalPrice; f <= Rho; f++)
+			{
+				identical = identical && parallel.by_bucket[g].get((OptionFunctionType)f) == serial.by_bucket[g].get((OptionFunctionType)f);
+			}
+		}
+		cout << book.size() << " positions on " << threads[k] << " threads: " << 1e3 * chrono::duration<double>(end - start).count() << " ms, total delta "
+			<< parallel.total.delta << ", identical to serial " << identical << endl;
+	}
+	cout << "SPX 1y-2y bucket: price " << serial.bucket(0, 3).price << ", delta " << serial.bucket(0, 3).delta << ", vega " << serial.bucket(0, 3).vega << endl;
+}
+
+void test_market_data()
+{
+	/*
+	* Subscribes a book to spot, volatility and rate inputs, checks a tick reprices only its
+	* dependents, compares with set_parameter on every option, then replays a paced tick feed
+	*/
+	cout << "---Begin experiment for testing market data driven repricing---" << endl;
+	MarketData market;
+	string names[] = { "SPX", "NDX", "AAPL", "MSFT", "AMZN", "TSLA", "NVDA", "META" };
+	size_t spot[8], vol[8];
+	size_t rate = market.add_input("USD rate", 0.05);
+	for (int u = 0; u < 8; u++)
+	{
+		spot[u] = market.add_input(names[u] + " spot", 100);
+		vol[u] = market.add_input(names[u] + " vol", 0.2 + 0.02 * u);
+	}
+	vector<EuropeanOption> options;
+	srand(29);
+	for (int i = 0; i < 200000; i++)
+	{
+		int u = i % 8;
+		options.push_back(EuropeanOption((i % 3 == 0) ? Put : Call, 100, 60 + 80.0 * rand() / RAND_MAX, 0.05 + 2.0 * rand() / RAND_MAX, 0.05, 0.2 + 0.02 * u, 0.03));
+		size_t id = market.add_contract(options.back());
+		market.subscribe(id, AssetPrice, spot[u]);
+		market.subscribe(id, Volatility, vol[u]);
+		market.subscribe(id, RFRate, rate);
+	}
+
+	market.publish(spot[0], 103);
+	market.publish(spot[0], 104); // coalesced: only 104 is applied
+	auto start = chrono::steady_clock::now();
+	size_t repriced = market.process();
+	auto middle = chrono::steady_clock::now();
+	for (size_t i = 0; i < options.size(); i += 8) { options[i].set_parameter(AssetPrice, 104); options[i].greeks(); }
+	auto end = chrono::steady_clock::now();
+	cout << "SPX spot tick repriced " << repriced << " of " << market.contracts() << " contracts in " << 1e3 * chrono::duration<double>(middle - start).count()
+		<< " ms (set_parameter and greeks() on each option: " << 1e3 * chrono::duration<double>(end - middle).count() << " ms)" << endl;
+
+	market.publish(rate, 0.045);
+	market.publish(vol[2], 0.3);
+	repriced = market.process();
+	double error = 0;
+	for (size_t i = 0; i < options.size(); i++)
+	{
+		options[i].set_parameter(RFRate, 0.045);
+		if (i % 8 == 2) { options[i].set_parameter(Volatility, 0.3); }
+		OptionGreeks expected = options[i].greeks(), actual = market.greeks(i);
+		for (int f = TheoreticalPrice; f <= Rho; f++)
+		{
+			error = fmax(error, fabs(actual.get((OptionFunctionType)f) - expected.get((OptionFunctionType)f)) / fmax(1.0, fabs(expected.get((OptionFunctionType)f))));
+		}
+	}
+	cout << "Rate and AAPL vol ticks repriced " << repriced << " contracts, max relative error vs option greeks " << error << endl;
+
+	market.reset_statistics();
+	market.start();
+	thread feed([&]()
+	{
+		for (int k = 0; k < 4000; k++) // bursts of one tick per underlying, 100 us apart
+		{
+			market.publish(spot[k % 8], 100 + 0.01 * (k % 97));
+			if (k % 8 == 7) { this_thread::sleep_for(chrono::microseconds(100)); }
+		}
+	});
+	feed.join();
+	market.stop();
+	market.process(); // flushes what the worker had not picked up
+	MarketDataStatistics stats = market.statistics();
+	cout << "Feed: " << stats.ticks << " ticks, " << stats.coalesced << " coalesced, " << stats.batches << " batches, " << stats.repriced << " contracts repriced" << endl;
+	cout << "Tick to greeks latency (us): p50 " << stats.latency_p50 << ", p99 " << stats.latency_p99 << ", p99.9 " << stats.latency_p999 << ", max " << stats.latency_max << endl;
+}
+
+void test_instrument_book()
+{
+	/*
+	* Prices the same million options held by pointer (virtual calls) and as 64-byte records
+	* in an arena backed book (batch kernels over contiguous memory)
+	*/
+	cout << "---Begin experiment for testing POD instrument records in arena storage---" << endl;
+	cout << "sizeof(InstrumentRecord) " << sizeof(InstrumentRecord) << ", alignof " << alignof(InstrumentRecord) << ", sizeof(EuropeanOption) " << sizeof(EuropeanOption) << endl;
+	vector<unique_ptr<Option>> options;
+	InstrumentBook book;
+	book.reserve(1000000);
+	srand(31);
+	for (int i = 0; i < 1000000; i++)
+	{
+		OptionType t = (i % 2 == 0) ? Call : Put;
+		if (i % 10 == 0)
+		{
+			AmericanPerpetualOption o = AmericanPerpetualOption(t, 100, 60 + 80.0 * rand() / RAND_MAX, 0.05, 0.1 + 0.4 * rand() / RAND_MAX, 0.02);
+			book.add(o);
+			options.push_back(unique_ptr<Option>(o.clone()));
+		}
+		else
+		{
+			EuropeanOption o = EuropeanOption(t, 100, 60 + 80.0 * rand() / RAND_MAX, 0.05 + 2.0 * rand() / RAND_MAX, 0.05, 0.1 + 0.4 * rand() / RAND_MAX, 0.02);
+			book.add(o);
+			options.push_back(unique_ptr<Option>(o.clone()));
+		}
+	}
+
+	vector<double> virtual_prices(options.size()), record_prices;
+	auto start = chrono::steady_clock::now();
+	for (size_t i = 0; i < options.size(); i++) { virtual_prices[i] = options[i]->theoretical_price(); }
+	auto middle = chrono::steady_clock::now();
+	BatchPricer pricer;
+	book.theoretical_prices(pricer, record_prices);
+	auto end = chrono::steady_clock::now();
+	double error = 0;
+	for (size_t i = 0; i < book.size(); i++) { error = fmax(error, fabs(virtual_prices[i] - record_prices[i]) / (book[i].S + book[i].K)); }
+	cout << book.size() << " options: virtual theoretical_price() " << 1e9 * chrono::duration<double>(middle - start).count() / book.size() << " ns, records "
+		<< 1e9 * chrono::duration<double>(end - middle).count() / book.size() << " ns per option, max error / (S + K) " << error << endl;
+	cout << "Records start 64-byte aligned: " << (((uintptr_t)book.data() % 64) == 0) << ", ids kept: " << (book[7].id == options[7]->id()) << endl;
+}
+
+void test_specialized_sweeps()
+{
+	/*
+	* Sweeps through the compile-time specialized kernels must match Option::calculate point by
+	* point; times spot, volatility and rate sweeps against the per point set_parameter / calculate walk
+	*/
+	cout << "---Begin experiment for testing compile-time specialized sweep kernels---" << endl;
+	OptionManager serial;
+	OptionParameter spots(AssetPrice, 50, 150, 999999); // 1,000,000 points
+	OptionFunctionType functions[] = { TheoreticalPrice, Delta, Gamma, Vega, Theta, Rho };
+	string names[] = { "price", "delta", "gamma", "vega", "theta", "rho" };
+
+	// Both walks are timed warm, the best of three runs after the checked one
+	auto compare = [&serial](const string& name, Option& o, OptionFunctionType oft, const OptionParameter& axis)
+	{
+		double original_value = o.get(axis.type());
+		vector<double> swept = serial.calculate_parameter(o, oft, axis), walked(axis.size());
+		auto walk = [&]()
+		{
+			for (size_t i = 0; i < axis.size(); i++)
+			{
+				o.set_parameter(axis.type(), axis.get((int)i));
+				walked[i] = o.calculate(oft);
+			}
+		};
+		walk();
+		size_t mismatches = 0;
+		for (size_t i = 0; i < axis.size(); i++) { mismatches += (swept[i] != walked[i]); }
+
+		double kernel = 1e300, calculate = 1e300;
+		for (int run = 0; run < 3; run++)
+		{
+			auto start = chrono::steady_clock::now();
+			swept = serial.calculate_parameter(o, oft, axis);
+			auto middle = chrono::steady_clock::now();
+			walk();
+			auto end = chrono::steady_clock::now();
+			kernel = min(kernel, chrono::duration<double>(middle - start).count());
+			calculate = min(calculate, chrono::duration<double>(end - middle).count());
+		}
+		o.set_parameter(axis.type(), original_value);
+		cout << name << ": kernel " << 1e9 * kernel / axis.size() << " ns, set_parameter/calculate "
+			<< 1e9 * calculate / axis.size() << " ns per point, " << mismatches << " points differ" << endl;
+	};
+
+	EuropeanOption put = EuropeanOption(Put, 100, 100, 0.5, 0.05, 0.25, 0.03);
+	for (int f = 0; f < 6; f++) { compare(names[f], put, functions[f], spots); }
+	EuropeanOption call = EuropeanOption(Call, 100, 100, 0.5, 0.05, 0.25, 0.03);
+	compare("volatility axis price", call, TheoreticalPrice, OptionParameter(Volatility, 0.1, 0.6, 999999));
+	compare("rate axis price", call, TheoreticalPrice, OptionParameter(RFRate, 0.0, 0.1, 999999));
+
+	OptionParameter vols(Volatility, 0.1, 0.6, 999);
+	vector<OptionParameter> paired = { OptionParameter(AssetPrice, 80, 120, 999), OptionParameter(Maturity, 0.1, 2.0, 999) };
+	vector<OptionGreeks> greeks = serial.calculate_parameter(call, vols);
+	vector<vector<OptionGreeks>> matrix = OptionManager(4).matrix_pricer(call, paired);
+	size_t mismatches = 0;
+	for (size_t i = 0; i < vols.size(); i++)
+	{
+		EuropeanOption a = call, m = call;
+		a.set_parameter(Volatility, vols.get((int)i));
+		m.set_parameter(AssetPrice, paired[0].get((int)i));
+		m.set_parameter(Maturity, paired[1].get((int)i));
+		for (int f = 0; f < 6; f++)
+		{
+			mismatches += (a.calculate(functions[f]) != greeks[i].get(functions[f])) + (m.calculate(functions[f]) != matrix[0][i].get(functions[f]));
+		}
+	}
+	AmericanPerpetualOption perpetual = AmericanPerpetualOption(Put, 100, 90, 0.1, 0.05, 0.02);
+	vector<double> perpetual_prices = serial.calculate_parameter(perpetual, TheoreticalPrice, spots);
+	for (size_t i = 0; i < spots.size(); i += 1000)
+	{
+		perpetual.set_parameter(AssetPrice, spots.get((int)i));
+		mismatches += (perpetual.calculate(TheoreticalPrice) != perpetual_prices[i]);
+	}
+	cout << "Greeks sweep, parallel two axis matrix and perpetual sweep: " << mismatches << " values differ from Option::calculate" << endl;
+}
+
+void test_generic_formulas()
+{
+	/*
+	* The scalar-generic formulas instantiated for float, second order duals (and AVX2 lanes when
+	* this file is compiled for them) must agree with the double formulas; dual greeks are compared
+	* with the closed forms and with the bump approximations they replace
+	*/
+	cout << "---Begin experiment for testing scalar-generic formulas---" << endl;
+	typedef Dual<double> D;
+	double greek_error[6] = { 0, 0, 0, 0, 0, 0 }; // dual price, delta, gamma, vega, theta, rho against the closed forms
+	double fused_error = 0.0, float_error = 0.0, approximation_error = 0.0;
+	size_t value_mismatches = 0, count = 0;
+	for (int t = 0; t < 2; t++)
+	{
+		OptionType type = t ? Put : Call;
+		for (double S = 60; S <= 140; S += 2.5)
+		{
+			for (double T = 0.1; T <= 2.0; T += 0.3)
+			{
+				for (double sig = 0.1; sig <= 0.6; sig += 0.125)
+				{
+					double K = 100, r = 0.05, b = 0.02;
+					OptionGreeks fused = calculate_price_and_greeks(type, T, K, sig, S, r, b);
+					double price = calculate_theoretical_price(type, T, K, sig, S, r, b);
+					fused_error = fmax(fused_error, fabs(price - fused.price) + fabs(calculate_theta(type, T, K, sig, S, r, b) - fused.theta));
+
+					double dual_price, delta, gamma;
+					generic_dual_delta_gamma(type, T, K, sig, S, r, b, dual_price, delta, gamma);
+					D vega = generic_theoretical_price<D>(type, D(T), D(K), D(sig, 1), D(S), D(r), D(b));
+					D theta = generic_theoretical_price<D>(type, D(T, 1), D(K), D(sig), D(S), D(r), D(b));
+					D rho = generic_theoretical_price<D>(type, D(T), D(K), D(sig), D(S), D(r, 1), D(r, 1)); // carry moves with the rate
+					value_mismatches += (dual_price != price) + (vega.value != price) + (theta.value != price);
+					greek_error[1] = fmax(greek_error[1], fabs(delta - calculate_delta(type, T, K, sig, S, r, b)));
+					greek_error[2] = fmax(greek_error[2], fabs(gamma - calculate_gamma(type, T, K, sig, S, r, b)));
+					greek_error[3] = fmax(greek_error[3], fabs(vega.derivative - calculate_vega(type, T, K, sig, S, r, b)));
+					greek_error[4] = fmax(greek_error[4], fabs(-theta.derivative - calculate_theta(type, T, K, sig, S, r, b)));
+					greek_error[5] = fmax(greek_error[5], fabs(rho.derivative - calculate_rho(type, T, K, sig, S, r, r)));
+					approximation_error = fmax(approximation_error, fabs(calculate_delta_approximation(type, T, K, sig, S, r, b, 0.01) - delta) + fabs(calculate_gamma_approximation(type, T, K, sig, S, r, b, 0.01) - gamma));
+
+					float single = generic_theoretical_price<float>(type, (float)T, (float)K, (float)sig, (float)S, (float)r, (float)b);
+					float_error = fmax(float_error, fabs(single - price) / K);
+					count++;
+				}
+			}
+		}
+	}
+	cout << count << " options, generic double against the fused greeks: " << fused_error << ", float price error (per unit strike): " << float_error << endl;
+	cout << "Dual evaluations: " << value_mismatches << " prices differ from the double formulas; greek errors against the closed forms: delta " << greek_error[1] << ", gamma " << greek_error[2]
+		<< ", vega " << greek_error[3] << ", theta " << greek_error[4] << ", rho " << greek_error[5] << endl;
+	cout << "Bump approximations (h = 0.01) against the dual delta + gamma: " << approximation_error << endl;
+
+	// Perpetual: exact delta and gamma against central bumps
+	double perpetual_error = 0.0;
+	for (double S = 70; S <= 130; S += 5)
+	{
+		double h = 1e-3 * S;
+		double up = calculate_american_perpetual_theoretical_price(Put, 100, 0.1, S + h, 0.05, 0.02);
+		double mid = calculate_american_perpetual_theoretical_price(Put, 100, 0.1, S, 0.05, 0.02);
+		double down = calculate_american_perpetual_theoretical_price(Put, 100, 0.1, S - h, 0.05, 0.02);
+		perpetual_error = fmax(perpetual_error, fabs(calculate_american_perpetual_dual_delta(Put, 100, 0.1, S, 0.05, 0.02) - (up - down) / (2 * h)));
+		perpetual_error = fmax(perpetual_error, fabs(calculate_american_perpetual_dual_gamma(Put, 100, 0.1, S, 0.05, 0.02) - (up - 2 * mid + down) / (h * h)));
+	}
+	cout << "Perpetual put dual delta and gamma against central bumps: " << perpetual_error << endl;
+
+	// Timing: one second order dual pricing against the five repricings of the two approximations
+	const int repeats = 200000;
+	double sink = 0.0;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < repeats; i++)
+	{
+		double S = 80 + 40.0 * i / repeats;
+		sink += calculate_delta_approximation(Put, 0.5, 100, 0.25, S, 0.05, 0.03, 0.01) + calculate_gamma_approximation(Put, 0.5, 100, 0.25, S, 0.05, 0.03, 0.01);
+	}
+	auto middle = chrono::steady_clock::now();
+	for (int i = 0; i < repeats; i++)
+	{
+		double S = 80 + 40.0 * i / repeats, price, delta, gamma;
+		generic_dual_delta_gamma(Put, 0.5, 100.0, 0.25, S, 0.05, 0.03, price, delta, gamma);
+		sink -= delta + gamma;
+	}
+	auto end = chrono::steady_clock::now();
+	cout << "Delta + gamma: approximations " << 1e9 * chrono::duration<double>(middle - start).count() / repeats << " ns, dual " << 1e9 * chrono::duration<double>(end - middle).count() / repeats
+		<< " ns per option (checksum " << sink << ")" << endl;
+
+#if defined(__AVX2__)
+	// Four strikes of one call per AVX2 vector
+	double strikes[4] = { 80, 95, 105, 120 }, lanes[4];
+	vstore(lanes, generic_theoretical_price<Avx2Double>(Call, 0.5, vload<Avx2Double>(strikes), 0.25, 100.0, 0.05, 0.03));
+	double lane_error = 0.0;
+	for (int j = 0; j < 4; j++) { lane_error = fmax(lane_error, fabs(lanes[j] - calculate_theoretical_price(Call, 0.5, strikes[j], 0.25, 100, 0.05, 0.03))); }
+	cout << "AVX2 lanes against the double formulas: " << lane_error << endl;
+#endif
+}
+
+void test_adjoint_sensitivities()
+{
+	/*
+	* Adjoint sensitivities (S, K, T, r, sig, b from one backward sweep) against closed forms, dual numbers
+	* and bump-and-reprice; cost against one pricing
+	*/
+	cout << "---Begin experiment for testing adjoint sensitivities---" << endl;
+	string names[] = { "K", "S", "T", "r", "sig", "b" }; // OptionParameterType order
+	double T = 0.75, K = 100, sig = 0.3, S = 95, r = 0.06, b = 0.02;
+
+	// Closed form: every european sensitivity against the greeks and a dual number in K
+	OptionSensitivities bs = calculate_adjoint_sensitivities(Put, T, K, sig, S, r, b);
+	Dual<double> strike = generic_theoretical_price<Dual<double>>(Put, T, Dual<double>(K, 1), sig, S, r, b);
+	double closed[6] = { strike.derivative, calculate_delta(Put, T, K, sig, S, r, b), -calculate_theta(Put, T, K, sig, S, r, b), 0.0, calculate_vega(Put, T, K, sig, S, r, b), 0.0 };
+	OptionSensitivities stock = calculate_adjoint_sensitivities(Put, T, K, sig, S, r, r); // calculate_rho moves r and b together (b = r)
+	double closed_error = fabs(bs.price - calculate_theoretical_price(Put, T, K, sig, S, r, b)) + fabs(stock.get(RFRate) + stock.get(CostOfCarry) - calculate_rho(Put, T, K, sig, S, r, r));
+	for (int j = 0; j < 6; j++) { closed_error += (j == RFRate || j == CostOfCarry) ? 0.0 : fabs(bs.sensitivity[j] - closed[j]); }
+	cout << "European closed form: adjoint against the greeks " << closed_error << endl;
+
+	// Lattice: one sweep against central bumps (12 repricings)
+	LatticeEngine lattice(BinomialLattice, 1000);
+	lattice.set_control_variate(true);
+	auto start = chrono::steady_clock::now();
+	double price = lattice.price(Put, T, K, sig, S, r, b);
+	auto middle = chrono::steady_clock::now();
+	OptionSensitivities adjoint = lattice.sensitivities(Put, T, K, sig, S, r, b);
+	auto end = chrono::steady_clock::now();
+	double base[6] = { K, S, T, r, sig, b };
+	cout << "American put, 1000 step lattice: price " << price << " (adjoint recording differs by " << fabs(adjoint.price - price) << ")" << endl;
+	for (int j = 0; j < 6; j++)
+	{
+		double h = (j == AssetPrice || j == StrikePrice) ? 0.5 : 1e-4; // spot and strike bumps above the node spacing
+		double up[6], down[6];
+		for (int k = 0; k < 6; k++) { up[k] = base[k]; down[k] = base[k]; }
+		up[j] += h;
+		down[j] -= h;
+		double bumped = (lattice.price(Put, up[Maturity], up[StrikePrice], up[Volatility], up[AssetPrice], up[RFRate], up[CostOfCarry])
+			- lattice.price(Put, down[Maturity], down[StrikePrice], down[Volatility], down[AssetPrice], down[RFRate], down[CostOfCarry])) / (2 * h);
+		cout << "  d/d" << names[j] << ": adjoint " << adjoint.sensitivity[j] << ", bumped " << bumped << endl;
+	}
+	double pricing = chrono::duration<double, milli>(middle - start).count(), sweep = chrono::duration<double, milli>(end - middle).count();
+	cout << "Lattice cost: price " << pricing << " ms, adjoint " << sweep << " ms (" << sweep / pricing << " pricings, bumping all six costs 12)" << endl;
+
+	// Monte Carlo: pathwise european sensitivities against the closed form, american against the lattice
+	MonteCarloEngine mc(200000, 4);
+	mc.set_antithetic(true);
+	EuropeanOption european = EuropeanOption(Put, S, K, T, r, sig, b);
+	start = chrono::steady_clock::now();
+	MonteCarloResult mc_price = mc.price(european);
+	middle = chrono::steady_clock::now();
+	OptionSensitivities pathwise = mc.sensitivities(european);
+	end = chrono::steady_clock::now();
+	cout << "European Monte Carlo (" << mc_price.paths << " paths): price " << pathwise.price << " vs " << bs.price << endl;
+	for (int j = 0; j < 6; j++) { cout << "  d/d" << names[j] << ": pathwise " << pathwise.sensitivity[j] << ", closed form " << bs.sensitivity[j] << endl; }
+	cout << "Monte Carlo cost: price " << chrono::duration<double, milli>(middle - start).count() << " ms, adjoint " << chrono::duration<double, milli>(end - middle).count() << " ms" << endl;
+
+	MonteCarloEngine mc_american(100000, 4);
+	mc_american.set_antithetic(true);
+	AmericanOption american = AmericanOption(Put, S, K, T, r, sig, b);
+	OptionSensitivities american_pathwise = mc_american.sensitivities(american);
+	cout << "American Monte Carlo (frozen exercise policy): price " << american_pathwise.price << " vs lattice " << adjoint.price << endl;
+	for (int j = 0; j < 6; j++) { cout << "  d/d" << names[j] << ": pathwise " << american_pathwise.sensitivity[j] << ", lattice adjoint " << adjoint.sensitivity[j] << endl; }
+}
+
+void test_bump_greeks()
+{
+	/*
+	* Batched finite difference greeks (shared stencil, Richardson extrapolation) against exact greeks,
+	* and against the one step approximations with Option's default h
+	*/
+	cout << "---Begin experiment for testing bump greeks---" << endl;
+	typedef Dual<double> D;
+	OptionBatch book(European);
+	for (int i = 0; i < 2000; i++)
+	{
+		double u = (i % 97) / 96.0, v = (i % 89) / 88.0, w = (i % 13) / 12.0;
+		book.add((i % 2) ? Call : Put, 70 + 60 * u, 100, 0.1 + 1.9 * v, 0.01 + 0.07 * w, 0.1 + 0.4 * (1 - u * v), 0.02 * w);
+	}
+
+	BumpGreeks bumps;
+	BumpGreekColumns out;
+	auto start = chrono::steady_clock::now();
+	bumps.greeks(book, out);
+	auto end = chrono::steady_clock::now();
+
+	string names[] = { "delta", "gamma", "vega", "theta", "rho", "vanna", "volga" };
+	double error[7] = { 0 }, legacy_error = 0.0;
+	int max_rounds = 0;
+	for (size_t i = 0; i < book.size(); i++)
+	{
+		OptionType type = book.type[i];
+		double T = book.T[i], K = book.K[i], sig = book.sig[i], S = book.S[i], r = book.r[i], b = book.b[i];
+		double exact[7] = { calculate_delta(type, T, K, sig, S, r, b), calculate_gamma(type, T, K, sig, S, r, b), calculate_vega(type, T, K, sig, S, r, b), calculate_theta(type, T, K, sig, S, r, b),
+			generic_theoretical_price<D>(type, D(T), D(K), D(sig), D(S), D(r, 1), D(b, 1)).derivative, // carry moves with the rate
+			generic_vega<D>(type, D(T), D(K), D(sig), D(S, 1), D(r), D(b)).derivative, generic_vega<D>(type, D(T), D(K), D(sig, 1), D(S), D(r), D(b)).derivative };
+		double bumped[7] = { out.delta[i], out.gamma[i], out.vega[i], out.theta[i], out.rho[i], out.vanna[i], out.volga[i] };
+		for (int j = 0; j < 7; j++) { error[j] = fmax(error[j], fabs(bumped[j] - exact[j]) / fmax(1.0, fabs(exact[j]))); }
+		legacy_error = fmax(legacy_error, fabs(calculate_delta_approximation(type, T, K, sig, S, r, b, 0.001) - exact[0]) + fabs(calculate_gamma_approximation(type, T, K, sig, S, r, b, 0.001) - exact[1]));
+		max_rounds = max(max_rounds, out.rounds[i]);
+	}
+	cout << book.size() << " european options, " << (double)bumps.evaluations() / book.size() << " pricings per option for price and 7 greeks (at most " << max_rounds << " rounds), "
+		<< chrono::duration<double, milli>(end - start).count() << " ms" << endl;
+	cout << "Largest error against the exact greeks (relative to max(1, |greek|)):";
+	for (int j = 0; j < 7; j++) { cout << " " << names[j] << " " << error[j]; }
+	cout << endl;
+	cout << "Delta + gamma approximations (h = 0.001, 5 pricings for 2 greeks): " << legacy_error << endl;
+
+	// Perpetual americans have no closed form greeks: against the dual numbers
+	OptionBatch perpetual(American);
+	for (double S = 70; S <= 130; S += 5) { perpetual.add(Put, S, 100, INFINITY, 0.05, 0.25, 0.02); }
+	bumps.greeks(perpetual, out);
+	double perpetual_error = 0.0;
+	for (size_t i = 0; i < perpetual.size(); i++)
+	{
+		perpetual_error = fmax(perpetual_error, fabs(out.delta[i] - calculate_american_perpetual_dual_delta(Put, 100, 0.25, perpetual.S[i], 0.05, 0.02)));
+		perpetual_error = fmax(perpetual_error, fabs(out.gamma[i] - calculate_american_perpetual_dual_gamma(Put, 100, 0.25, perpetual.S[i], 0.05, 0.02)));
+	}
+	cout << "Perpetual puts: delta and gamma against the dual numbers " << perpetual_error << ", theta " << out.theta[0] << endl;
+}
+
+void test_book_file()
+{
+	/*
+	* Columnar binary book files: startup from text and option objects against mapping the file,
+	* mapped pricing against the in-memory batch, results written and mapped back
+	*/
+	cout << "---Begin experiment for testing book files---" << endl;
+	const size_t contracts = 1000000;
+	OptionBatch batch(European);
+	batch.reserve(contracts);
+	for (size_t i = 0; i < contracts; i++)
+	{
+		double u = (i % 1009) / 1008.0, v = (i % 997) / 996.0;
+		batch.add((i % 3) ? Call : Put, 60 + 80 * u, 100, 0.05 + 2 * v, 0.01 + 0.05 * u * v, 0.1 + 0.5 * v, 0.02 * u);
+	}
+
+	// Startup from text: parse every line and build the options one constructor at a time
+	{
+		ofstream text("book_test.csv");
+		text.precision(17);
+		for (size_t i = 0; i < contracts; i++)
+		{
+			text << (char)batch.type[i] << "," << batch.S[i] << "," << batch.K[i] << "," << batch.T[i] << "," << batch.r[i] << "," << batch.sig[i] << "," << batch.b[i] << "\n";
+		}
+	}
+	auto start = chrono::steady_clock::now();
+	OptionBatch parsed(European);
+	{
+		ifstream text("book_test.csv");
+		char type, comma;
+		double S, K, T, r, sig, b;
+		while (text >> type >> comma >> S >> comma >> K >> comma >> T >> comma >> r >> comma >> sig >> comma >> b)
+		{
+			parsed.add(EuropeanOption((OptionType)type, S, K, T, r, sig, b));
+		}
+	}
+	double text_startup = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+	// Binary: write once, then startup is one mapping
+	start = chrono::steady_clock::now();
+	bool written = write_book("book_test.bin", batch);
+	double write_time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	start = chrono::steady_clock::now();
+	MappedBook mapped("book_test.bin");
+	double map_startup = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	cout << contracts << " contracts: text startup " << text_startup << " ms (" << parsed.size() << " parsed), binary written in " << write_time << " ms (" << (written ? "ok" : "failed")
+		<< "), mapped in " << map_startup << " ms (" << mapped.size() << " contracts)" << endl;
+
+	// Mapped columns priced in place, against the in-memory batch
+	BatchPricer pricer;
+	vector<double> expected, prices;
+	pricer.theoretical_prices(batch, expected);
+	start = chrono::steady_clock::now();
+	mapped.theoretical_prices(pricer, prices);
+	double price_time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	size_t mismatches = 0;
+	for (size_t i = 0; i < contracts; i++) { mismatches += (prices[i] != expected[i]); }
+	cout << "Mapped pricing (first touch of the pages included): " << price_time << " ms, " << mismatches << " prices differ from the in-memory batch" << endl;
+
+	// Results: price and greeks written in the same layout and mapped back
+	vector<double> greeks[6];
+	for (int k = 0; k < 6; k++) { greeks[k].resize(contracts); }
+	mapped.european_greeks(pricer, greeks[0].data(), greeks[1].data(), greeks[2].data(), greeks[3].data(), greeks[4].data(), greeks[5].data());
+	BookWriter results(contracts);
+	for (int k = 0; k < 6; k++) { results.add_column((BookColumn)(PriceColumn + k), greeks[k].data()); }
+	results.write("book_test_results.bin");
+	MappedBook mapped_results("book_test_results.bin");
+	size_t result_mismatches = (mapped_results.size() != contracts);
+	for (int k = 0; k < 6 && !result_mismatches; k++)
+	{
+		const double* column = mapped_results.column((BookColumn)(PriceColumn + k));
+		result_mismatches += (column == nullptr) || memcmp(column, greeks[k].data(), contracts * sizeof(double)) != 0;
+	}
+	cout << "Results file: " << result_mismatches << " greek columns differ, price column matches the prices: " << (memcmp(mapped_results.column(PriceColumn), prices.data(), contracts * sizeof(double)) == 0) << endl;
+
+	// Mixed classes from an instrument book: runs of each class priced in place
+	InstrumentBook book;
+	for (int i = 0; i < 1000; i++)
+	{
+		OptionClass oc = (i / 100 % 3 == 0) ? American : European;
+		book.add(make_record(oc, (i % 2) ? Call : Put, 80 + i % 40, 100, (oc == American) ? INFINITY : 0.5, 0.05, 0.25, 0.02));
+	}
+	vector<double> book_prices, mapped_book_prices;
+	book.theoretical_prices(pricer, book_prices);
+	write_book("book_test_mixed.bin", book);
+	MappedBook mixed("book_test_mixed.bin");
+	mixed.theoretical_prices(pricer, mapped_book_prices);
+	size_t mixed_mismatches = 0;
+	for (size_t i = 0; i < book.size(); i++)
+	{
+		// Runs and chunks split differently, so a few options go through the scalar tail of the kernels: within the BatchPricer tolerance
+		mixed_mismatches += (fabs(mapped_book_prices[i] - book_prices[i]) > 1e-10 * (book[i].S + book[i].K)) + (mixed.option_class(i) != book[i].option_class) + (mixed.type(i) != book[i].type);
+	}
+	cout << "Mixed european and perpetual book: " << mixed_mismatches << " contracts differ from the instrument book" << endl;
+
+	// A truncated file is refused
+	{
+		ofstream truncated("book_test_truncated.bin", ios::binary);
+		truncated << "OPTBOOK";
+	}
+	MappedBook refused;
+	bool opened = refused.open("book_test_truncated.bin");
+	cout << "Truncated file opened: " << opened << endl;
+
+	mapped.close();
+	mapped_results.close();
+	mixed.close();
+	remove("book_test.csv");
+	remove("book_test.bin");
+	remove("book_test_results.bin");
+	remove("book_test_mixed.bin");
+	remove("book_test_truncated.bin");
+}
+
+void test_chain_reader()
+{
+	/*
+	* Chain reader: parsed values against the source batch, parse throughput in GB/s with 0, 1 and every
+	* hardware thread, and pricing pipelined with parsing against parsing then pricing
+	*/
+	cout << "---Begin experiment for testing the chain reader---" << endl;
+	const size_t contracts = 500000;
+	OptionBatch european(European), american(American);
+	string text = "symbol,Class,type,K,S,sig,r,b,T\n"; // columns in any order, symbol skipped
+	char line[256];
+	for (size_t i = 0; i < contracts; i++)
+	{
+		double u = (i % 1009) / 1008.0, v = (i % 997) / 996.0;
+		OptionType type = (i % 3) ? Call : Put;
+		double S = 60 + 80 * u, sig = 0.1 + 0.5 * v, r = 0.01 + 0.05 * u * v, b = 0.02 * u, T = 0.05 + 2 * v;
+		bool perpetual = (i % 10 == 0);
+		(perpetual ? american : european).add(type, S, 100, perpetual ? INFINITY : T, r, sig, b);
+		snprintf(line, sizeof(line), "OPT%zu,%s,%s,100,%.17g,%.17g,%.17g,%.17g,%.17g%s\n", i, perpetual ? "A" : "E", (type == Call) ? "Call" : "Put", S, sig, r, b, T, (i % 7) ? "" : "\r");
+		text += line;
+		if (i == contracts / 2) { text += "\nOPTX,E,Put,100,abc,0.2,0.05,0,1\n"; } // blank line, then a malformed row
+	}
+
+	// Values: rows map back to the source contracts, every number read exactly
+	auto row_of = [&](size_t i) { return i + (i > contracts / 2); }; // the malformed row is a row too
+	ChainReader reader;
+	size_t european_seen = 0, american_seen = 0, mismatches = 0;
+	reader.read(text.data(), text.size(), [&](const ChainChunk& chunk)
+	{
+		for (size_t i = 0; i < chunk.european.size(); i++)
+		{
+			size_t j = european_seen++;
+			mismatches += chunk.european.type[i] != european.type[j] || chunk.european.S[i] != european.S[j] || chunk.european.K[i] != european.K[j] || chunk.european.T[i] != european.T[j]
+				|| chunk.european.r[i] != european.r[j] || chunk.european.sig[i] != european.sig[j] || chunk.european.b[i] != european.b[j] || chunk.european_rows[i] != row_of(j + j / 9 + 1);
+		}
+		for (size_t i = 0; i < chunk.american.size(); i++)
+		{
+			size_t j = american_seen++;
+			mismatches += chunk.american.type[i] != american.type[j] || chunk.american.S[i] != american.S[j] || chunk.american.T[i] != INFINITY
+				|| chunk.american.sig[i] != american.sig[j] || chunk.american.b[i] != american.b[j] || chunk.american_rows[i] != row_of(10 * j);
+		}
+	});
+	cout << reader.rows() << " rows (" << reader.errors() << " malformed), " << european_seen << " european and " << american_seen << " perpetual read, " << mismatches << " differ from the source" << endl;
+
+	// Parse throughput from memory
+	for (size_t threads : { (size_t)0, (size_t)1, ThreadPool::hardware_threads() })
+	{
+		ChainReader parser(threads, 1 << 20);
+		auto start = chrono::steady_clock::now();
+		parser.read(text.data(), text.size(), [](const ChainChunk&) {});
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		cout << threads << " parser threads: " << text.size() / seconds / 1e9 << " GB/s (" << parser.bytes() / 1e6 << " MB in " << seconds * 1e3 << " ms)" << endl;
+	}
+
+	// Pipeline from a file: chunks priced while the next ones are parsed
+	{
+		ofstream file("chain_test.csv", ios::binary);
+		file.write(text.data(), text.size());
+	}
+	BatchPricer pricer;
+	vector<double> prices;
+	double first = 0, checksum = 0;
+	auto start = chrono::steady_clock::now();
+	reader.read("chain_test.csv", [&](const ChainChunk& chunk)
+	{
+		pricer.theoretical_prices(chunk.european, prices);
+		for (double p : prices) { checksum += isfinite(p) ? p : 0; }
+		pricer.theoretical_prices(chunk.american, prices);
+		for (double p : prices) { checksum += isfinite(p) ? p : 0; }
+		if (chunk.index == 0) { first = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count(); }
+	});
+	double pipelined = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+	// Parse everything, then price everything
+	start = chrono::steady_clock::now();
+	OptionBatch all_european(European), all_american(American);
+	reader.read("chain_test.csv", [&](const ChainChunk& chunk)
+	{
+		for (size_t i = 0; i < chunk.european.size(); i++) { all_european.add(chunk.european.type[i], chunk.european.S[i], chunk.european.K[i], chunk.european.T[i], chunk.european.r[i], chunk.european.sig[i], chunk.european.b[i]); }
+		for (size_t i = 0; i < chunk.american.size(); i++) { all_american.add(chunk.american.type[i], chunk.american.S[i], chunk.american.K[i], chunk.american.T[i], chunk.american.r[i], chunk.american.sig[i], chunk.american.b[i]); }
+	});
+	double parsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	double sequential_checksum = 0;
+	pricer.theoretical_prices(all_european, prices);
+	for (double p : prices) { sequential_checksum += isfinite(p) ? p : 0; }
+	pricer.theoretical_prices(all_american, prices);
+	for (double p : prices) { sequential_checksum += isfinite(p) ? p : 0; }
+	double sequential = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	cout << "File parsed and priced: pipelined " << pipelined << " ms (first chunk priced after " << first << " ms), parse then price " << sequential << " ms (parse " << parsed
+		<< " ms), checksums agree: " << (fabs(checksum - sequential_checksum) < 1e-6 * fabs(sequential_checksum)) << endl;
+
+	// A sink throwing while parsers are still running: the exception reaches the caller, the reader stays usable
+	bool rethrown = false;
+	try
+	{
+		reader.read("chain_test.csv", [](const ChainChunk& chunk) { if (chunk.index == 1) { throw runtime_error("sink failed"); } });
+	}
+	catch (const runtime_error&)
+	{
+		rethrown = true;
+	}
+	size_t chunks = 0;
+	reader.read("chain_test.csv", [&chunks](const ChainChunk&) { chunks++; });
+	cout << "Exception in the sink rethrown: " << rethrown << ", reader reusable: " << (chunks > 1) << endl;
+	remove("chain_test.csv");
+}
+
+void test_instrumentation()
+{
+	/*
+	* Hot path instrumentation: call counts, elements and latency percentiles per probe when built with
+	* OPTION_PRICING_INSTRUMENTATION; otherwise only the cost of Option::calculate, to compare the two builds
+	*/
+	cout << "---Begin experiment for testing instrumentation---" << endl;
+	cout << "Instrumentation compiled in: " << Instrumentation::enabled() << endl;
+	Instrumentation::reset();
+
+	const int calls = 100000;
+	EuropeanOption option = greekCall;
+	double sum = 0;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < calls; i++)
+	{
+		option.set_parameter(AssetPrice, 90 + (i % 31));
+		sum += option.calculate(Delta);
+	}
+	double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / calls;
+	cout << "Option::calculate(Delta): " << ns << " ns per call (checksum " << sum << ")" << endl;
+
+	// Sweeps on each engine: specialized kernel, serial and parallel walks of Option::calculate
+	OptionParameter spots(AssetPrice, 50, 150, 9999);
+	manager.calculate_parameter(greekCall, Delta, spots);
+	manager.calculate_parameter(greekCall, spots);
+	manager.matrix_pricer(americanPut, ApproxGamma, vector<OptionParameter>{ spots });
+	OptionManager(2).calculate_parameter(americanPut, ApproxGamma, spots);
+
+	vector<ProbeStats> stats = Instrumentation::snapshot();
+	for (const ProbeStats& s : stats)
+	{
+		cout << s.name << ": " << s.calls << " calls, " << s.elements << " elements, " << s.elements * 1e9 / max<uint64_t>(s.total_ns, 1) << " elements/s, p50 "
+			<< s.percentile(50) << " ns, p99 " << s.percentile(99) << " ns, max " << s.max_ns << " ns" << endl;
+	}
+	string json = Instrumentation::snapshot_json();
+	cout << "JSON snapshot: " << json.size() << " bytes, " << stats.size() << " probes" << (stats.empty() ? ": " + json : "") << endl;
+	if (Instrumentation::enabled())
+	{
+		// Every Option::calculate(Delta) call above is counted once, sweep elements are their points
+		uint64_t delta_calls = 0, perpetual_points = 0;
+		for (const ProbeStats& s : stats)
+		{
+			if (s.name == "Option::calculate/European/Delta") { delta_calls = s.calls; }
+			if (s.name == "Option::calculate/AmericanPerpetual/ApproxGamma") { perpetual_points = s.calls; }
+		}
+		cout << "Counts match the calls made: " << (delta_calls == (uint64_t)calls && perpetual_points == 2 * spots.size()) << endl;
+	}
+}
+
+void test_perf_counters()
+{
+	/*
+	* Hardware counters per element around a batch pricing call and an OptionManager sweep,
+	* or the reason they cannot be read (the pricing runs either way)
+	*/
+	cout << "---Begin experiment for testing hardware performance counters---" << endl;
+	PerfCounters counters;
+	cout << "Counters available: " << counters.available();
+	if (!counters.unavailable_reason().empty()) { cout << " (" << counters.unavailable_reason() << ")"; }
+	cout << endl;
+
+	const size_t n = 100000;
+	OptionBatch batch(European);
+	for (size_t i = 0; i < n; i++) { batch.add((i % 2) ? Call : Put, 80 + (i % 41), 100, 0.25 + (i % 7) * 0.25, 0.05, 0.2 + (i % 5) * 0.05, 0.02); }
+	BatchPricer pricer;
+	vector<double> prices;
+	OptionParameter spots(AssetPrice, 50, 150, n - 1);
+	vector<double> sweep;
+
+	PerfSample samples[2] = {
+		counters.measure([&]() { pricer.theoretical_prices(batch, prices); }),
+		counters.measure([&]() { sweep = manager.calculate_parameter(americanPut, ApproxGamma, spots); }),
+	};
+	const char* names[2] = { "BatchPricer::theoretical_prices", "OptionManager::calculate_parameter(ApproxGamma)" };
+	for (int k = 0; k < 2; k++)
+	{
+		cout << names[k] << ": " << ((k == 0) ? prices.size() : sweep.size()) << " elements";
+		for (int e = 0; e < PerfEventCount; e++)
+		{
+			if (samples[k].valid[e]) { cout << ", " << PerfCounters::event_name((PerfEvent)e) << " " << samples[k].per_element((PerfEvent)e, n) << " per element"; }
+		}
+		if (samples[k].valid[CyclesEvent] && samples[k].valid[InstructionsEvent]) { cout << ", IPC " << samples[k].ipc(); }
+		cout << endl;
+	}
+}
+
 int main()
 {
 	
@@ -232,4 +1643,52 @@ int main()
 	test_perpetual_american_parameter();
 	cout << "<==========================================================>\n\n";
 	test_perpetual_american_grid();
+	cout << "<==========================================================>\n\n";
+	test_batch_pricing();
+	cout << "<==========================================================>\n\n";
+	test_normal_distribution_accuracy();
+	cout << "<==========================================================>\n\n";
+	test_fused_greeks();
+	cout << "<==========================================================>\n\n";
+	test_parallel_manager();
+	cout << "<==========================================================>\n\n";
+	test_parameter_grid_product();
+	cout << "<==========================================================>\n\n";
+	test_lazy_parameters();
+	cout << "<==========================================================>\n\n";
+	test_implied_volatility();
+	cout << "<==========================================================>\n\n";
+	test_american_lattice();
+	cout << "<==========================================================>\n\n";
+	test_pde_engine();
+	cout << "<==========================================================>\n\n";
+	test_monte_carlo();
+	cout << "<==========================================================>\n\n";
+	test_american_approximations();
+	cout << "<==========================================================>\n\n";
+	test_incremental_repricing();
+	cout << "<==========================================================>\n\n";
+	test_price_cache();
+	cout << "<==========================================================>\n\n";
+	test_portfolio();
+	cout << "<==========================================================>\n\n";
+	test_market_data();
+	cout << "<==========================================================>\n\n";
+	test_instrument_book();
+	cout << "<==========================================================>\n\n";
+	test_specialized_sweeps();
+	cout << "<==========================================================>\n\n";
+	test_generic_formulas();
+	cout << "<==========================================================>\n\n";
+	test_adjoint_sensitivities();
+	cout << "<==========================================================>\n\n";
+	test_bump_greeks();
+	cout << "<==========================================================>\n\n";
+	test_book_file();
+	cout << "<==========================================================>\n\n";
+	test_chain_reader();
+	cout << "<==========================================================>\n\n";
+	test_instrumentation();
+	cout << "<==========================================================>\n\n";
+	test_perf_counters();
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+/*
+* Arena.cpp
+* Defines the Arena class methods
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+#include "Arena.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+
+		static const size_t MAX_ALIGNMENT = 4096;
+
+		Arena::Arena() : Arena(1 << 20) {}
+
+		Arena::Arena(size_t chunk_bytes) : m_offset(0), m_chunk_bytes(max(chunk_bytes, (size_t)4096)), m_used(0) {}
+
+		Arena::~Arena()
+		{
+			for (size_t i = 0; i < m_chunks.size(); i++) { delete[] m_chunks[i].memory; }
+		}
+
+		void* Arena::allocate(size_t bytes, size_t alignment)
+		{
+			if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment > MAX_ALIGNMENT) { alignment = MAX_ALIGNMENT; } // Invalid alignment: be safe
+			if (!m_chunks.empty())
+			{
+				uintptr_t base = (uintptr_t)m_chunks.back().memory;
+				uintptr_t start = (base + m_offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+				if (start + bytes <= base + m_chunks.back().size)
+				{
+					m_offset = start + bytes - base;
+					return (void*)start;
+				}
+				m_used += m_offset;
+			}
+
+			// New chunk, room for the block at any alignment
+			Chunk chunk;
+			chunk.size = max(m_chunk_bytes, bytes + alignment);
+			chunk.memory = new char[chunk.size];
+			m_chunks.push_back(chunk);
+			uintptr_t base = (uintptr_t)chunk.memory;
+			uintptr_t start = (base + alignment - 1) & ~(uintptr_t)(alignment - 1);
+			m_offset = start + bytes - base;
+			return (void*)start;
+		}
+
+		void Arena::reset()
+		{
+			if (m_chunks.empty()) { return; }
+			size_t largest = 0;
+			for (size_t i = 1; i < m_chunks.size(); i++)
+			{
+				if (m_chunks[i].size > m_chunks[largest].size) { largest = i; }
+			}
+			for (size_t i = 0; i < m_chunks.size(); i++)
+			{
+				if (i != largest) { delete[] m_chunks[i].memory; }
+			}
+			Chunk kept = m_chunks[largest];
+			m_chunks.clear();
+			m_chunks.push_back(kept);
+			m_offset = 0;
+			m_used = 0;
+		}
+
+		size_t Arena::bytes_used() const { return m_used + m_offset; }
+
+		size_t Arena::bytes_reserved() const
+		{
+			size_t total = 0;
+			for (size_t i = 0; i < m_chunks.size(); i++) { total += m_chunks[i].size; }
+			return total;
+		}
+	}
+}
@@ -0,0 +1,50 @@
+/*
+* Arena.hpp
+* Provides template methods for a bump Arena: hands out aligned blocks
+* carved from large chunks and frees them all at once.
+*
+* An allocation costs a pointer increment; memory only returns to the
+* system in reset() or the destructor. Objects placed in an arena are never
+* destroyed, so it is meant for trivially destructible data (records,
+* columns).
+*/
+#ifndef ARENA_HPP // Verify we have unique HPP file reference
+#define ARENA_HPP // Name the file ARENA_HPP
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+		class Arena
+		{
+		public:
+			Arena(); // Default constructor: 1 MiB chunks
+			Arena(size_t chunk_bytes); // Arena growing by chunks of chunk_bytes (larger blocks get a chunk of their own)
+			~Arena(); // Destructor: releases every chunk
+
+			void* allocate(size_t bytes, size_t alignment); // alignment is a power of two, at most 4096
+			void reset(); // Forgets every block, keeps the largest chunk for reuse
+
+			size_t bytes_used() const; // Handed out, alignment padding included
+			size_t bytes_reserved() const; // Held from the system
+
+		private:
+			Arena(const Arena& a); // Non copyable: owns its chunks
+			Arena& operator = (const Arena& source);
+
+			struct Chunk {
+				char* memory; // as returned by new[]
+				size_t size;
+			};
+
+			vector<Chunk> m_chunks; // the last one is being carved
+			size_t m_offset; // first free byte of the last chunk
+			size_t m_chunk_bytes;
+			size_t m_used; // in previous chunks
+		};
+	}
+}
+#endif // !ARENA_HPP
@@ -0,0 +1,71 @@
+/*
+* Dual.hpp
+* Provides template methods for forward-mode Dual numbers: a value and its
+* derivative along one direction, carried through every operation with the
+* chain rule.
+*
+* Seeding an input with derivative 1 (every other input with 0) makes a
+* single evaluation return f and df/dinput, exact to rounding instead of
+* bump-and-reprice. Duals nest: Dual<Dual<double>> seeded with
+* Dual<double>(x, 1) as value and Dual<double>(1, 0) as derivative also
+* carries the second derivative in derivative.derivative.
+*
+* The value part runs exactly the operations of the plain scalar code, so
+* value is bit-identical to the undifferentiated result. Only arithmetic
+* lives here; elementary functions (exp, log, normal CDF...) are written
+* for Duals next to the formulas using them, see
+* financial_instruments/GenericFormulas.hpp, through dual_chain.
+*
+* Internal linkage for the same reason as Simd.hpp.
+*/
+#ifndef DUAL_HPP // Verify we have unique HPP file reference
+#define DUAL_HPP // Name the file DUAL_HPP
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+		namespace {
+
+		template<class T>
+		struct Dual
+		{
+			T value;
+			T derivative; // along the seeded direction
+
+			Dual() : value(0), derivative(0) {}
+			Dual(const T& v) : value(v), derivative(0) {} // constant
+			Dual(const T& v, const T& d) : value(v), derivative(d) {}
+		};
+
+		// Returns f(x) as a Dual given f(x.value) and f'(x.value)
+		template<class T>
+		inline Dual<T> dual_chain(const Dual<T>& x, const T& f, const T& df)
+		{
+			return Dual<T>(f, df * x.derivative);
+		}
+
+		template<class T>
+		inline Dual<T> operator + (const Dual<T>& a, const Dual<T>& b) { return Dual<T>(a.value + b.value, a.derivative + b.derivative); }
+
+		template<class T>
+		inline Dual<T> operator - (const Dual<T>& a, const Dual<T>& b) { return Dual<T>(a.value - b.value, a.derivative - b.derivative); }
+
+		template<class T>
+		inline Dual<T> operator - (const Dual<T>& a) { return Dual<T>(-a.value, -a.derivative); }
+
+		template<class T>
+		inline Dual<T> operator * (const Dual<T>& a, const Dual<T>& b) { return Dual<T>(a.value * b.value, a.derivative * b.value + a.value * b.derivative); }
+
+		// (a/b)' = (a' - (a/b) b') / b
+		template<class T>
+		inline Dual<T> operator / (const Dual<T>& a, const Dual<T>& b)
+		{
+			T q = a.value / b.value;
+			return Dual<T>(q, (a.derivative - q * b.derivative) / b.value);
+		}
+
+		}
+	}
+}
+#endif // !DUAL_HPP
@@ -0,0 +1,291 @@
+/*
+* Instrumentation.cpp
+* Defines the Instrumentation and LatencyHistogram class methods
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "Instrumentation.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+
+		static const uint64_t NO_MINIMUM = ~(uint64_t)0;
+
+		LatencyHistogram::LatencyHistogram() : m_counts(BUCKETS, 0), m_total(0) {}
+		LatencyHistogram::LatencyHistogram(const LatencyHistogram& lh) : m_counts(lh.m_counts), m_total(lh.m_total) {}
+		LatencyHistogram::~LatencyHistogram() {}
+
+		LatencyHistogram& LatencyHistogram::operator = (const LatencyHistogram& source)
+		{
+			if (this == &source) // if current address is the same as source's address
+			{
+				return *this; // return current object (avoid assignment on itself)
+			}
+			m_counts = source.m_counts;
+			m_total = source.m_total;
+			return *this; // return current object's pointer
+		}
+
+		size_t LatencyHistogram::bucket(uint64_t ns)
+		{
+			if (ns < SUB_BUCKETS) { return (size_t)ns; } // exact
+#if defined(_MSC_VER)
+			unsigned long e; // position of the highest set bit, at least 4
+			_BitScanReverse64(&e, ns);
+#else
+			size_t e = 63 - __builtin_clzll(ns); // position of the highest set bit, at least 4
+#endif
+			size_t b = (e - 3) * SUB_BUCKETS + (size_t)((ns >> (e - 4)) - SUB_BUCKETS); // next 4 bits pick the sub-bucket
+			return (b < BUCKETS) ? b : BUCKETS - 1;
+		}
+
+		uint64_t LatencyHistogram::bucket_lower(size_t bucket)
+		{
+			if (bucket < SUB_BUCKETS) { return bucket; }
+			size_t e = bucket / SUB_BUCKETS + 3;
+			return (uint64_t)(bucket % SUB_BUCKETS + SUB_BUCKETS) << (e - 4);
+		}
+
+		uint64_t LatencyHistogram::bucket_upper(size_t bucket)
+		{
+			if (bucket < SUB_BUCKETS) { return bucket; }
+			size_t e = bucket / SUB_BUCKETS + 3;
+			return bucket_lower(bucket) + ((uint64_t)1 << (e - 4)) - 1;
+		}
+
+		void LatencyHistogram::add(size_t bucket, uint64_t count)
+		{
+			m_counts[bucket] += count;
+			m_total += count;
+		}
+
+		void LatencyHistogram::merge(const LatencyHistogram& other)
+		{
+			for (size_t i = 0; i < BUCKETS; i++) { m_counts[i] += other.m_counts[i]; }
+			m_total += other.m_total;
+		}
+
+		void LatencyHistogram::clear()
+		{
+			fill(m_counts.begin(), m_counts.end(), 0);
+			m_total = 0;
+		}
+
+		uint64_t LatencyHistogram::count() const { return m_total; }
+		uint64_t LatencyHistogram::count(size_t bucket) const { return m_counts[bucket]; }
+
+		uint64_t LatencyHistogram::percentile(double p) const
+		{
+			if (m_total == 0) { return 0; }
+			uint64_t rank = (uint64_t)(p / 100.0 * m_total + 0.5);
+			rank = (rank < 1) ? 1 : ((rank > m_total) ? m_total : rank);
+			uint64_t seen = 0;
+			for (size_t i = 0; i < BUCKETS; i++)
+			{
+				seen += m_counts[i];
+				if (seen >= rank) { return bucket_upper(i); }
+			}
+			return bucket_upper(BUCKETS - 1);
+		}
+
+		uint64_t ProbeStats::percentile(double p) const
+		{
+			return min(latency.percentile(p), max_ns);
+		}
+
+		/*
+		* Per thread counters: only the owning thread writes them (plain load and store,
+		* no read-modify-write), snapshot reads them from any thread
+		*/
+		struct ProbeSlot {
+			atomic<uint64_t> calls;
+			atomic<uint64_t> elements;
+			atomic<uint64_t> total_ns;
+			atomic<uint64_t> min_ns;
+			atomic<uint64_t> max_ns;
+			atomic<uint64_t> buckets[LatencyHistogram::BUCKETS];
+		};
+
+		struct ThreadBlock {
+			atomic<ProbeSlot*> slots[Instrumentation::MAX_PROBES]; // allocated on the first record of each probe
+		};
+
+		struct Registry {
+			mutex m; // guards the names and the list of blocks, never taken while recording
+			vector<string> names;
+			map<string, size_t> ids;
+			vector<ThreadBlock*> blocks;
+		};
+
+		// Never destroyed: pool threads may still record while static objects are being destroyed
+		static Registry& registry()
+		{
+			static Registry* r = new Registry();
+			return *r;
+		}
+
+		static thread_local ThreadBlock* thread_block = nullptr; // kept after the thread exits, so its samples stay in snapshots
+
+		static void bump(atomic<uint64_t>& counter, uint64_t value)
+		{
+			counter.store(counter.load(memory_order_relaxed) + value, memory_order_relaxed); // single writer
+		}
+
+		static void clear_slot(ProbeSlot& slot)
+		{
+			slot.calls.store(0, memory_order_relaxed);
+			slot.elements.store(0, memory_order_relaxed);
+			slot.total_ns.store(0, memory_order_relaxed);
+			slot.min_ns.store(NO_MINIMUM, memory_order_relaxed);
+			slot.max_ns.store(0, memory_order_relaxed);
+			for (size_t i = 0; i < LatencyHistogram::BUCKETS; i++) { slot.buckets[i].store(0, memory_order_relaxed); }
+		}
+
+		bool Instrumentation::enabled()
+		{
+#if defined(OPTION_PRICING_INSTRUMENTATION)
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		size_t Instrumentation::probe(const string& name)
+		{
+			Registry& reg = registry();
+			lock_guard<mutex> lock(reg.m);
+			map<string, size_t>::const_iterator found = reg.ids.find(name);
+			if (found != reg.ids.end()) { return found->second; }
+			if (reg.names.size() == MAX_PROBES)
+			{
+				cout << "Invalid probe: more than " << MAX_PROBES << " probes, " << name << " is not recorded" << endl;
+				return MAX_PROBES;
+			}
+			reg.ids[name] = reg.names.size();
+			reg.names.push_back(name);
+			return reg.names.size() - 1;
+		}
+
+		void Instrumentation::record(size_t probe, uint64_t elements, uint64_t ns)
+		{
+			if (probe >= MAX_PROBES) { return; }
+			if (thread_block == nullptr) // first record of this thread
+			{
+				thread_block = new ThreadBlock();
+				for (size_t i = 0; i < MAX_PROBES; i++) { thread_block->slots[i].store(nullptr, memory_order_relaxed); }
+				Registry& reg = registry();
+				lock_guard<mutex> lock(reg.m);
+				reg.blocks.push_back(thread_block);
+			}
+			ProbeSlot* slot = thread_block->slots[probe].load(memory_order_relaxed);
+			if (slot == nullptr)
+			{
+				slot = new ProbeSlot();
+				clear_slot(*slot);
+				thread_block->slots[probe].store(slot, memory_order_release);
+			}
+			bump(slot->calls, 1);
+			bump(slot->elements, elements);
+			bump(slot->total_ns, ns);
+			if (ns < slot->min_ns.load(memory_order_relaxed)) { slot->min_ns.store(ns, memory_order_relaxed); }
+			if (ns > slot->max_ns.load(memory_order_relaxed)) { slot->max_ns.store(ns, memory_order_relaxed); }
+			bump(slot->buckets[LatencyHistogram::bucket(ns)], 1);
+		}
+
+		vector<ProbeStats> Instrumentation::snapshot()
+		{
+			Registry& reg = registry();
+			lock_guard<mutex> lock(reg.m);
+			vector<ProbeStats> stats;
+			for (size_t p = 0; p < reg.names.size(); p++)
+			{
+				ProbeStats s;
+				s.name = reg.names[p];
+				s.calls = 0;
+				s.elements = 0;
+				s.total_ns = 0;
+				s.min_ns = NO_MINIMUM;
+				s.max_ns = 0;
+				for (size_t t = 0; t < reg.blocks.size(); t++)
+				{
+					const ProbeSlot* slot = reg.blocks[t]->slots[p].load(memory_order_acquire);
+					if (slot == nullptr) { continue; }
+					s.calls += slot->calls.load(memory_order_relaxed);
+					s.elements += slot->elements.load(memory_order_relaxed);
+					s.total_ns += slot->total_ns.load(memory_order_relaxed);
+					s.min_ns = min(s.min_ns, slot->min_ns.load(memory_order_relaxed));
+					s.max_ns = max(s.max_ns, slot->max_ns.load(memory_order_relaxed));
+					for (size_t i = 0; i < LatencyHistogram::BUCKETS; i++)
+					{
+						uint64_t count = slot->buckets[i].load(memory_order_relaxed);
+						if (count) { s.latency.add(i, count); }
+					}
+				}
+				if (s.calls == 0) { continue; }
+				stats.push_back(s);
+			}
+			return stats;
+		}
+
+		string Instrumentation::snapshot_json()
+		{
+			vector<ProbeStats> stats = snapshot();
+			stringstream out;
+			out.precision(6);
+			out << "{\n  \"enabled\": " << (enabled() ? "true" : "false") << ",\n  \"probes\": [";
+			for (size_t p = 0; p < stats.size(); p++)
+			{
+				const ProbeStats& s = stats[p];
+				string name;
+				for (char c : s.name)
+				{
+					if (c == '"' || c == '\\') { name += '\\'; }
+					name += c;
+				}
+				out << (p ? ",\n" : "\n") << "    {\"name\": \"" << name << "\", \"calls\": " << s.calls << ", \"elements\": " << s.elements << ", \"total_ns\": " << s.total_ns
+					<< ", \"elements_per_second\": " << (s.total_ns ? s.elements * 1e9 / s.total_ns : 0.0) << ",\n     \"latency_ns\": {\"min\": " << s.min_ns
+					<< ", \"mean\": " << (double)s.total_ns / s.calls << ", \"p50\": " << s.percentile(50) << ", \"p90\": " << s.percentile(90)
+					<< ", \"p99\": " << s.percentile(99) << ", \"p999\": " << s.percentile(99.9) << ", \"max\": " << s.max_ns << "},\n     \"histogram\": [";
+				bool first = true;
+				for (size_t i = 0; i < LatencyHistogram::BUCKETS; i++) // [lowest ns, highest ns, count] of every non-empty bucket
+				{
+					if (s.latency.count(i) == 0) { continue; }
+					out << (first ? "" : ", ") << "[" << LatencyHistogram::bucket_lower(i) << ", " << LatencyHistogram::bucket_upper(i) << ", " << s.latency.count(i) << "]";
+					first = false;
+				}
+				out << "]}";
+			}
+			out << (stats.empty() ? "" : "\n  ") << "]\n}\n";
+			return out.str();
+		}
+
+		void Instrumentation::reset()
+		{
+			Registry& reg = registry();
+			lock_guard<mutex> lock(reg.m);
+			for (size_t t = 0; t < reg.blocks.size(); t++)
+			{
+				for (size_t p = 0; p < MAX_PROBES; p++)
+				{
+					ProbeSlot* slot = reg.blocks[t]->slots[p].load(memory_order_acquire);
+					if (slot) { clear_slot(*slot); }
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,86 @@
+/*
+* MappedFile.cpp
+* Defines the MappedFile class methods
+*/
+
+
+// Standard Libraries
+#include <cstddef>
+#include <string>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Custom header
+#include "MappedFile.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+
+		MappedFile::MappedFile() : m_data(nullptr), m_size(0) {}
+		MappedFile::~MappedFile() { close(); }
+
+		bool MappedFile::open(const string& path)
+		{
+			close();
+#if defined(_WIN32)
+			HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			if (file == INVALID_HANDLE_VALUE) { return false; }
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+			{
+				CloseHandle(file);
+				return false;
+			}
+			HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			CloseHandle(file); // the mapping keeps the file open
+			if (mapping == NULL) { return false; }
+			void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping); // the view keeps the mapping alive
+			if (view == NULL) { return false; }
+			m_data = (const char*)view;
+			m_size = (size_t)size.QuadPart;
+#else
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0) { return false; }
+			struct stat status;
+			if (fstat(fd, &status) != 0 || status.st_size <= 0)
+			{
+				::close(fd);
+				return false;
+			}
+			void* view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd); // the mapping keeps the file open
+			if (view == MAP_FAILED) { return false; }
+			posix_madvise(view, (size_t)status.st_size, POSIX_MADV_SEQUENTIAL);
+			m_data = (const char*)view;
+			m_size = (size_t)status.st_size;
+#endif
+			return true;
+		}
+
+		void MappedFile::close()
+		{
+			if (m_data == nullptr) { return; }
+#if defined(_WIN32)
+			UnmapViewOfFile(m_data);
+#else
+			munmap((void*)m_data, m_size);
+#endif
+			m_data = nullptr;
+			m_size = 0;
+		}
+
+		bool MappedFile::is_open() const { return m_data != nullptr; }
+		const char* MappedFile::data() const { return m_data; }
+		size_t MappedFile::size() const { return m_size; }
+	}
+}
@@ -0,0 +1,42 @@
+/*
+* MappedFile.hpp
+* Provides template methods for Mapped Files: a whole file mapped read-only
+* into memory (mmap on POSIX, MapViewOfFile on Windows).
+*
+* Nothing is read at open: pages are brought in by the first access and are
+* shared with the page cache, so opening a file of any size costs a few
+* system calls. The mapping is hinted for sequential access.
+*/
+#ifndef MAPPED_FILE_HPP // Verify we have unique HPP file reference
+#define MAPPED_FILE_HPP // Name the file MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+		class MappedFile
+		{
+		public:
+			MappedFile(); // Default constructor: nothing mapped
+			~MappedFile(); // Destructor: unmaps the file
+
+			bool open(const string& path); // Maps the whole file, false (nothing mapped) if it cannot be opened or is empty
+			void close(); // Unmaps the file
+
+			bool is_open() const;
+			const char* data() const; // First byte of the file, page aligned
+			size_t size() const; // Bytes mapped
+
+		private:
+			MappedFile(const MappedFile& mf); // Non copyable: owns the mapping
+			MappedFile& operator = (const MappedFile& source);
+
+			const char* m_data;
+			size_t m_size;
+		};
+	}
+}
+#endif // !MAPPED_FILE_HPP
@@ -0,0 +1,135 @@
+/*
+* NormalDistribution.hpp
+* Provides the in-house standard normal CDF/PDF used by every pricing and
+* greek formula, as inline scalar functions and as vector lane templates
+* (double, Avx2Double, Avx512Double from Simd.hpp).
+*
+* Max absolute error against boost::math::normal_distribution, measured
+* over [-40, 40] (see test_normal_distribution_accuracy in main.cpp):
+* normal_cdf: below 5e-14 (worst case near |x| = 7.07, where Hart switches branch)
+* normal_pdf: below 2e-16
+* normal_inverse_cdf: relative error below 1.2e-9 (Acklam), meant for
+* turning uniforms into normals, where it is far below sampling noise
+*
+* Internal linkage for the same reason as Simd.hpp.
+*/
+#ifndef NORMAL_DISTRIBUTION_HPP // Verify we have unique HPP file reference
+#define NORMAL_DISTRIBUTION_HPP // Name the file NORMAL_DISTRIBUTION_HPP
+
+#include "Simd.hpp"
+#include "SimdMath.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+		namespace {
+
+		// Returns standard normal PDF of x
+		template<class V>
+		inline V vnormal_pdf(V x)
+		{
+			return V(0.39894228040143267794) * vexp(V(-0.5) * x * x); // e^(-x^2/2) / sqrt(2*pi)
+		}
+
+		/*
+		* Returns standard normal CDF of x
+		* Hart (1968) double precision rational approximation as presented by
+		* West, "Better approximations to cumulative normal functions" (2005).
+		* Both of Hart's branches are evaluated and blended so there is no
+		* data dependent branching inside a vector.
+		*/
+		template<class V>
+		inline V vnormal_cdf(V x)
+		{
+			V ax = vabs(x);
+			V e = vexp(V(-0.5) * ax * ax);
+
+			// |x| < 7.07: rational function in |x|
+			V num = 3.52624965998911e-02;
+			num = vfma(num, ax, V(0.700383064443688));
+			num = vfma(num, ax, V(6.37396220353165));
+			num = vfma(num, ax, V(33.912866078383));
+			num = vfma(num, ax, V(112.079291497871));
+			num = vfma(num, ax, V(221.213596169931));
+			num = vfma(num, ax, V(220.206867912376));
+			V den = 8.83883476483184e-02;
+			den = vfma(den, ax, V(1.75566716318264));
+			den = vfma(den, ax, V(16.064177579207));
+			den = vfma(den, ax, V(86.7807322029461));
+			den = vfma(den, ax, V(296.564248779674));
+			den = vfma(den, ax, V(637.333633378831));
+			den = vfma(den, ax, V(793.826512519948));
+			den = vfma(den, ax, V(440.413735824752));
+			V near_tail = e * num / den;
+
+			// |x| >= 7.07: continued fraction
+			V cf = ax + V(0.65);
+			cf = ax + V(1.0) / cf;
+			cf = ax + V(2.0) / cf;
+			cf = ax + V(3.0) / cf;
+			cf = ax + V(4.0) / cf;
+			V far_tail = e / cf * V(0.39894228040143267794);
+
+			V tail = vselect(ax < V(7.07106781186547), near_tail, far_tail);
+			tail = vselect(ax > V(37.0), V(0.0), tail);
+			return vselect(x > V(0.0), V(1.0) - tail, tail);
+		}
+
+		/*
+		* Returns x with normal CDF(x) = p, for p in (0, 1)
+		* Acklam's rational approximations: one for the central region and
+		* one for both tails (by symmetry), blended without branching.
+		*/
+		template<class V>
+		inline V vnormal_inverse_cdf(V p)
+		{
+			// Central region, 0.02425 <= p <= 0.97575
+			V q = p - V(0.5);
+			V r = q * q;
+			V num = -3.969683028665376e+01;
+			num = vfma(num, r, V(2.209460984245205e+02));
+			num = vfma(num, r, V(-2.759285104469687e+02));
+			num = vfma(num, r, V(1.383577518672690e+02));
+			num = vfma(num, r, V(-3.066479806614716e+01));
+			num = vfma(num, r, V(2.506628277459239e+00));
+			V den = -5.447609879822406e+01;
+			den = vfma(den, r, V(1.615858368580409e+02));
+			den = vfma(den, r, V(-1.556989798598866e+02));
+			den = vfma(den, r, V(6.680131188771972e+01));
+			den = vfma(den, r, V(-1.328068155288572e+01));
+			den = vfma(den, r, V(1.0));
+			V central = num * q / den;
+
+			// Tails, in terms of the smaller of p and 1 - p
+			V tail_p = vmin(p, V(1.0) - p);
+			V t = vsqrt(V(-2.0) * vlog(tail_p));
+			V tnum = -7.784894002430293e-03;
+			tnum = vfma(tnum, t, V(-3.223964580411365e-01));
+			tnum = vfma(tnum, t, V(-2.400758277161838e+00));
+			tnum = vfma(tnum, t, V(-2.549732539343734e+00));
+			tnum = vfma(tnum, t, V(4.374664141464968e+00));
+			tnum = vfma(tnum, t, V(2.938163982698783e+00));
+			V tden = 7.784695709041462e-03;
+			tden = vfma(tden, t, V(3.224671290700398e-01));
+			tden = vfma(tden, t, V(2.445134137142996e+00));
+			tden = vfma(tden, t, V(3.754408661907416e+00));
+			tden = vfma(tden, t, V(1.0));
+			V tail = tnum / tden; // negative: lower tail value
+			tail = vselect(p > V(0.5), -tail, tail);
+
+			return vselect(tail_p < V(0.02425), tail, central);
+		}
+
+		// Scalar standard normal CDF
+		inline double normal_cdf(double x) { return vnormal_cdf<double>(x); }
+
+		// Scalar standard normal PDF
+		inline double normal_pdf(double x) { return vnormal_pdf<double>(x); }
+
+		// Scalar inverse standard normal CDF
+		inline double normal_inverse_cdf(double p) { return vnormal_inverse_cdf<double>(p); }
+		}
+	}
+}
+#endif // !NORMAL_DISTRIBUTION_HPP
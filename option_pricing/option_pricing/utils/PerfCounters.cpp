@@ -0,0 +1,155 @@
+/*
+* PerfCounters.cpp
+* Defines the PerfCounters class methods
+*/
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "PerfCounters.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+
+		double PerfSample::ipc() const
+		{
+			if (!valid[CyclesEvent] || !valid[InstructionsEvent] || counts[CyclesEvent] == 0) { return NAN; }
+			return (double)counts[InstructionsEvent] / counts[CyclesEvent];
+		}
+
+		double PerfSample::per_element(PerfEvent e, size_t elements) const
+		{
+			if (!valid[e] || elements == 0) { return NAN; }
+			return (double)counts[e] / elements;
+		}
+
+		PerfCounters::PerfCounters()
+		{
+			for (int e = 0; e < PerfEventCount; e++) { m_fd[e] = -1; }
+#if defined(__linux__)
+			const uint64_t configs[PerfEventCount] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES }; // PerfEvent
+			int errors[PerfEventCount] = { 0 };
+			for (int e = 0; e < PerfEventCount; e++)
+			{
+				perf_event_attr attr;
+				memset(&attr, 0, sizeof(attr));
+				attr.size = sizeof(attr);
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = configs[e];
+				attr.disabled = 1;
+				attr.exclude_kernel = 1; // allowed up to perf_event_paranoid = 2
+				attr.exclude_hv = 1;
+				attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING; // to scale multiplexed counts
+				m_fd[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0); // this thread, any CPU
+				if (m_fd[e] < 0)
+				{
+					errors[e] = errno;
+					m_fd[e] = -1;
+				}
+			}
+
+			// Why: one line per distinct error, with the events it hit
+			for (int e = 0; e < PerfEventCount; e++)
+			{
+				bool reported = (errors[e] == 0);
+				for (int f = 0; f < e && !reported; f++) { reported = (errors[f] == errors[e]); }
+				if (reported) { continue; }
+				string events;
+				for (int f = e; f < PerfEventCount; f++)
+				{
+					if (errors[f] == errors[e]) { events += string(events.empty() ? "" : ", ") + event_name((PerfEvent)f); }
+				}
+				m_reason += string(m_reason.empty() ? "" : "; ") + events + ": " + strerror(errors[e]);
+				if (errors[e] == EACCES || errors[e] == EPERM) { m_reason += " (see /proc/sys/kernel/perf_event_paranoid)"; }
+				if (errors[e] == ENOENT || errors[e] == EOPNOTSUPP) { m_reason += " (not counted by this CPU, or no PMU exposed to this VM)"; }
+			}
+#else
+			m_reason = "hardware counters are only read on Linux (perf_event_open)";
+#endif
+		}
+
+		PerfCounters::~PerfCounters()
+		{
+#if defined(__linux__)
+			for (int e = 0; e < PerfEventCount; e++)
+			{
+				if (m_fd[e] >= 0) { close(m_fd[e]); }
+			}
+#endif
+		}
+
+		bool PerfCounters::available() const
+		{
+			for (int e = 0; e < PerfEventCount; e++)
+			{
+				if (m_fd[e] >= 0) { return true; }
+			}
+			return false;
+		}
+
+		bool PerfCounters::available(PerfEvent e) const { return m_fd[e] >= 0; }
+		const string& PerfCounters::unavailable_reason() const { return m_reason; }
+
+		const char* PerfCounters::event_name(PerfEvent e)
+		{
+			static const char* names[PerfEventCount] = { "cycles", "instructions", "cache_misses", "branch_misses" };
+			return names[e];
+		}
+
+		void PerfCounters::start()
+		{
+#if defined(__linux__)
+			for (int e = 0; e < PerfEventCount; e++)
+			{
+				if (m_fd[e] < 0) { continue; }
+				ioctl(m_fd[e], PERF_EVENT_IOC_RESET, 0);
+				ioctl(m_fd[e], PERF_EVENT_IOC_ENABLE, 0);
+			}
+#endif
+		}
+
+		PerfSample PerfCounters::stop()
+		{
+			PerfSample sample;
+			for (int e = 0; e < PerfEventCount; e++)
+			{
+				sample.counts[e] = 0;
+				sample.valid[e] = false;
+			}
+#if defined(__linux__)
+			for (int e = 0; e < PerfEventCount; e++)
+			{
+				if (m_fd[e] >= 0) { ioctl(m_fd[e], PERF_EVENT_IOC_DISABLE, 0); }
+			}
+			for (int e = 0; e < PerfEventCount; e++)
+			{
+				uint64_t values[3]; // count, time enabled, time running
+				if (m_fd[e] < 0 || read(m_fd[e], values, sizeof(values)) != (ssize_t)sizeof(values) || values[2] == 0) { continue; } // never scheduled: no count
+				sample.counts[e] = (values[2] < values[1]) ? (uint64_t)((double)values[0] * values[1] / values[2]) : values[0]; // multiplexed: scale up
+				sample.valid[e] = true;
+			}
+#endif
+			return sample;
+		}
+
+		PerfSample PerfCounters::measure(const function<void()>& body)
+		{
+			start();
+			body();
+			return stop();
+		}
+	}
+}
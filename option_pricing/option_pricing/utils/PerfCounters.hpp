@@ -0,0 +1,72 @@
+/*
+* PerfCounters.hpp
+* Provides template methods for hardware Performance Counters: cycles,
+* instructions, cache misses and branch misses of the calling thread around
+* a piece of work (a batch pricing call, an OptionManager sweep), read with
+* Linux perf_event_open.
+*
+* Each counter is opened on its own, so a CPU or VM lacking one event still
+* reports the others; when none can be opened (other platforms, no PMU
+* exposed to a VM, perf_event_paranoid too strict) available() is false,
+* unavailable_reason() says why and every sample comes back invalid: callers
+* keep working and simply print no counters. Counters exclude the kernel
+* and are scaled when the kernel multiplexes them.
+*
+* Only the calling thread is counted: for a parallel sweep that is the
+* caller's share of the work, so measure sweeps on one thread.
+*/
+#ifndef PERF_COUNTERS_HPP // Verify we have unique HPP file reference
+#define PERF_COUNTERS_HPP // Name the file PERF_COUNTERS_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+
+		enum PerfEvent {
+			CyclesEvent,
+			InstructionsEvent,
+			CacheMissesEvent, // last level cache
+			BranchMissesEvent,
+			PerfEventCount,
+		};
+
+		// Counts of one measurement, valid[e] false when event e could not be counted
+		struct PerfSample {
+			uint64_t counts[PerfEventCount];
+			bool valid[PerfEventCount];
+
+			double ipc() const; // Instructions per cycle, NaN if either is missing
+			double per_element(PerfEvent e, size_t elements) const; // Count of e per element, NaN if missing
+		};
+
+		class PerfCounters
+		{
+		public:
+			PerfCounters(); // Default constructor: opens every counter for the calling thread (see available)
+			~PerfCounters(); // Destructor: closes the counters
+
+			// Getter Methods
+			bool available() const; // At least one counter opened
+			bool available(PerfEvent e) const;
+			const string& unavailable_reason() const; // Why counters are missing, empty if every one opened
+			static const char* event_name(PerfEvent e); // e.g. "cycles"
+
+			void start(); // Zeroes and enables the counters
+			PerfSample stop(); // Disables and reads them
+			PerfSample measure(const function<void()>& body); // Counts body, run on the calling thread
+
+		private:
+			PerfCounters(const PerfCounters& pc); // Non copyable: owns file descriptors
+			PerfCounters& operator = (const PerfCounters& source);
+
+			int m_fd[PerfEventCount]; // -1 when not available
+			string m_reason;
+		};
+	}
+}
+#endif // !PERF_COUNTERS_HPP
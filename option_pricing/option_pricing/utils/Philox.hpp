@@ -0,0 +1,49 @@
+/*
+* Philox.hpp
+* Provides the Philox4x32-10 counter-based random number generator
+* (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", 2011).
+*
+* A counter-based generator has no state to advance: the output is a pure
+* function of (counter, key), so stream i can be produced directly from i
+* on any thread, in any order, and always gives the same numbers.
+*/
+#ifndef PHILOX_HPP // Verify we have unique HPP file reference
+#define PHILOX_HPP // Name the file PHILOX_HPP
+
+#include <cstdint>
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+
+		// Fills out with the four 32 bit words of block counter under key (ten rounds)
+		inline void philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4])
+		{
+			uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+			uint32_t k0 = key[0], k1 = key[1];
+			for (int round = 0; round < 10; round++)
+			{
+				uint64_t p0 = (uint64_t)0xD2511F53u * c0;
+				uint64_t p1 = (uint64_t)0xCD9E8D57u * c2;
+				uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+				uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+				c1 = (uint32_t)p1;
+				c3 = (uint32_t)p0;
+				c0 = n0;
+				c2 = n2;
+				k0 += 0x9E3779B9u; // bump the key (golden ratio / sqrt(3) - 1 Weyl sequence)
+				k1 += 0xBB67AE85u;
+			}
+			out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+		}
+
+		// Maps two 32 bit words to a double uniform in the open interval (0, 1), with 53 random bits
+		inline double philox_uniform(uint32_t hi, uint32_t lo)
+		{
+			uint64_t bits = (((uint64_t)hi << 32) | lo) >> 11;
+			return ((double)bits + 0.5) * (1.0 / 9007199254740992.0); // 2^-53
+		}
+	}
+}
+#endif // !PHILOX_HPP
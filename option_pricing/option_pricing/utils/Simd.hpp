@@ -0,0 +1,193 @@
+/*
+* Simd.hpp
+* Provides thin vector wrappers so that pricing math can be written once
+* and instantiated for plain doubles, AVX2 lanes and AVX-512 lanes.
+*
+* The AVX2 and AVX-512 types only exist in translation units compiled with
+* the matching instruction set (__AVX2__ / __AVX512F__), runtime dispatch
+* lives in BatchPricer.cpp.
+*
+* Everything here has internal linkage (unnamed namespace): the same inline
+* function compiled with and without AVX must never be merged by the linker,
+* or a scalar caller could end up running AVX encoded code.
+*/
+#ifndef SIMD_HPP // Verify we have unique HPP file reference
+#define SIMD_HPP // Name the file SIMD_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+		namespace {
+
+		// Number of doubles held by a vector type
+		template<class V> struct SimdWidth { static const int value = 1; };
+
+		// Loads/stores a full vector from/to unaligned memory
+		template<class V> V vload(const double* p);
+
+		/*
+		* Scalar (double) primitives
+		* These let the generic math in SimdMath.hpp compile for plain doubles
+		*/
+		template<> inline double vload<double>(const double* p) { return *p; }
+		inline void vstore(double* p, double x) { *p = x; }
+
+		inline double vsqrt(double x) { return std::sqrt(x); }
+		inline double vabs(double x) { return std::fabs(x); }
+		inline double vmin(double a, double b) { return a < b ? a : b; }
+		inline double vmax(double a, double b) { return a > b ? a : b; }
+		inline double vselect(bool m, double a, double b) { return m ? a : b; } // a where m holds, else b
+		inline double vfma(double a, double b, double c) { return a * b + c; } // a*b + c
+		inline bool vand(bool a, bool b) { return a && b; } // lane-wise mask and
+		inline bool vor(bool a, bool b) { return a || b; } // lane-wise mask or
+		inline bool vnot(bool a) { return !a; } // lane-wise mask not
+		inline bool vany(bool a) { return a; } // true if any lane is set
+
+		inline uint64_t double_bits(double x) { uint64_t u; memcpy(&u, &x, sizeof(u)); return u; }
+		inline double bits_double(uint64_t u) { double x; memcpy(&x, &u, sizeof(x)); return x; }
+
+		// Returns 2^k given t = k + 1.5*2^52 (k already rounded into the mantissa)
+		inline double vpow2_rounded(double t) { return bits_double((double_bits(t) + 1023) << 52); }
+
+		// Returns mantissa of a positive normal double scaled into [1, 2)
+		inline double vmantissa(double x) { return bits_double((double_bits(x) & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL); }
+
+		// Returns unbiased binary exponent of a positive normal double, as a double
+		inline double vexponent(double x) { return bits_double(0x4330000000000000ULL | (double_bits(x) >> 52)) - 4503599627370496.0 - 1023.0; }
+
+#if defined(__AVX2__)
+		/*
+		* AVX2: four doubles per vector
+		*/
+		struct Avx2Double
+		{
+			__m256d v;
+			Avx2Double() {}
+			Avx2Double(__m256d x) : v(x) {}
+			Avx2Double(double x) : v(_mm256_set1_pd(x)) {}
+		};
+
+		struct Avx2Mask
+		{
+			__m256d m;
+			Avx2Mask(__m256d x) : m(x) {}
+		};
+
+		template<> struct SimdWidth<Avx2Double> { static const int value = 4; };
+		template<> inline Avx2Double vload<Avx2Double>(const double* p) { return _mm256_loadu_pd(p); }
+		inline void vstore(double* p, Avx2Double x) { _mm256_storeu_pd(p, x.v); }
+
+		inline Avx2Double operator + (Avx2Double a, Avx2Double b) { return _mm256_add_pd(a.v, b.v); }
+		inline Avx2Double operator - (Avx2Double a, Avx2Double b) { return _mm256_sub_pd(a.v, b.v); }
+		inline Avx2Double operator * (Avx2Double a, Avx2Double b) { return _mm256_mul_pd(a.v, b.v); }
+		inline Avx2Double operator / (Avx2Double a, Avx2Double b) { return _mm256_div_pd(a.v, b.v); }
+		inline Avx2Double operator - (Avx2Double a) { return _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)); }
+		inline Avx2Mask operator < (Avx2Double a, Avx2Double b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ); }
+		inline Avx2Mask operator > (Avx2Double a, Avx2Double b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ); }
+		inline Avx2Mask operator <= (Avx2Double a, Avx2Double b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ); }
+		inline Avx2Mask operator >= (Avx2Double a, Avx2Double b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ); }
+
+		inline Avx2Double vsqrt(Avx2Double x) { return _mm256_sqrt_pd(x.v); }
+		inline Avx2Double vabs(Avx2Double x) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x.v); }
+		inline Avx2Double vmin(Avx2Double a, Avx2Double b) { return _mm256_min_pd(a.v, b.v); }
+		inline Avx2Double vmax(Avx2Double a, Avx2Double b) { return _mm256_max_pd(a.v, b.v); }
+		inline Avx2Double vselect(Avx2Mask m, Avx2Double a, Avx2Double b) { return _mm256_blendv_pd(b.v, a.v, m.m); }
+		inline Avx2Mask vand(Avx2Mask a, Avx2Mask b) { return _mm256_and_pd(a.m, b.m); }
+		inline Avx2Mask vor(Avx2Mask a, Avx2Mask b) { return _mm256_or_pd(a.m, b.m); }
+		inline Avx2Mask vnot(Avx2Mask a) { return _mm256_xor_pd(a.m, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))); }
+		inline bool vany(Avx2Mask a) { return _mm256_movemask_pd(a.m) != 0; }
+#if defined(__FMA__)
+		inline Avx2Double vfma(Avx2Double a, Avx2Double b, Avx2Double c) { return _mm256_fmadd_pd(a.v, b.v, c.v); }
+#else
+		inline Avx2Double vfma(Avx2Double a, Avx2Double b, Avx2Double c) { return _mm256_add_pd(_mm256_mul_pd(a.v, b.v), c.v); }
+#endif
+
+		inline Avx2Double vpow2_rounded(Avx2Double t)
+		{
+			__m256i bits = _mm256_add_epi64(_mm256_castpd_si256(t.v), _mm256_set1_epi64x(1023));
+			return _mm256_castsi256_pd(_mm256_slli_epi64(bits, 52));
+		}
+
+		inline Avx2Double vmantissa(Avx2Double x)
+		{
+			__m256i bits = _mm256_and_si256(_mm256_castpd_si256(x.v), _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL));
+			return _mm256_castsi256_pd(_mm256_or_si256(bits, _mm256_set1_epi64x(0x3FF0000000000000LL)));
+		}
+
+		inline Avx2Double vexponent(Avx2Double x)
+		{
+			__m256i bits = _mm256_srli_epi64(_mm256_castpd_si256(x.v), 52);
+			__m256d e = _mm256_castsi256_pd(_mm256_or_si256(bits, _mm256_set1_epi64x(0x4330000000000000LL)));
+			return _mm256_sub_pd(e, _mm256_set1_pd(4503599627370496.0 + 1023.0));
+		}
+#endif // __AVX2__
+
+#if defined(__AVX512F__)
+		/*
+		* AVX-512: eight doubles per vector
+		*/
+		struct Avx512Double
+		{
+			__m512d v;
+			Avx512Double() {}
+			Avx512Double(__m512d x) : v(x) {}
+			Avx512Double(double x) : v(_mm512_set1_pd(x)) {}
+		};
+
+		template<> struct SimdWidth<Avx512Double> { static const int value = 8; };
+		template<> inline Avx512Double vload<Avx512Double>(const double* p) { return _mm512_loadu_pd(p); }
+		inline void vstore(double* p, Avx512Double x) { _mm512_storeu_pd(p, x.v); }
+
+		inline Avx512Double operator + (Avx512Double a, Avx512Double b) { return _mm512_add_pd(a.v, b.v); }
+		inline Avx512Double operator - (Avx512Double a, Avx512Double b) { return _mm512_sub_pd(a.v, b.v); }
+		inline Avx512Double operator * (Avx512Double a, Avx512Double b) { return _mm512_mul_pd(a.v, b.v); }
+		inline Avx512Double operator / (Avx512Double a, Avx512Double b) { return _mm512_div_pd(a.v, b.v); }
+		inline Avx512Double operator - (Avx512Double a) { return _mm512_sub_pd(_mm512_setzero_pd(), a.v); }
+		inline __mmask8 operator < (Avx512Double a, Avx512Double b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ); }
+		inline __mmask8 operator > (Avx512Double a, Avx512Double b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ); }
+		inline __mmask8 operator <= (Avx512Double a, Avx512Double b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_LE_OQ); }
+		inline __mmask8 operator >= (Avx512Double a, Avx512Double b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_GE_OQ); }
+
+		inline Avx512Double vsqrt(Avx512Double x) { return _mm512_sqrt_pd(x.v); }
+		inline Avx512Double vabs(Avx512Double x) { return _mm512_abs_pd(x.v); }
+		inline Avx512Double vmin(Avx512Double a, Avx512Double b) { return _mm512_min_pd(a.v, b.v); }
+		inline Avx512Double vmax(Avx512Double a, Avx512Double b) { return _mm512_max_pd(a.v, b.v); }
+		inline Avx512Double vselect(__mmask8 m, Avx512Double a, Avx512Double b) { return _mm512_mask_blend_pd(m, b.v, a.v); }
+		inline __mmask8 vand(__mmask8 a, __mmask8 b) { return (__mmask8)(a & b); }
+		inline __mmask8 vor(__mmask8 a, __mmask8 b) { return (__mmask8)(a | b); }
+		inline __mmask8 vnot(__mmask8 a) { return (__mmask8)~a; }
+		inline bool vany(__mmask8 a) { return a != 0; }
+		inline Avx512Double vfma(Avx512Double a, Avx512Double b, Avx512Double c) { return _mm512_fmadd_pd(a.v, b.v, c.v); }
+
+		inline Avx512Double vpow2_rounded(Avx512Double t)
+		{
+			__m512i bits = _mm512_add_epi64(_mm512_castpd_si512(t.v), _mm512_set1_epi64(1023));
+			return _mm512_castsi512_pd(_mm512_slli_epi64(bits, 52));
+		}
+
+		inline Avx512Double vmantissa(Avx512Double x)
+		{
+			__m512i bits = _mm512_and_si512(_mm512_castpd_si512(x.v), _mm512_set1_epi64(0x000FFFFFFFFFFFFFLL));
+			return _mm512_castsi512_pd(_mm512_or_si512(bits, _mm512_set1_epi64(0x3FF0000000000000LL)));
+		}
+
+		inline Avx512Double vexponent(Avx512Double x)
+		{
+			__m512i bits = _mm512_srli_epi64(_mm512_castpd_si512(x.v), 52);
+			__m512d e = _mm512_castsi512_pd(_mm512_or_si512(bits, _mm512_set1_epi64(0x4330000000000000LL)));
+			return _mm512_sub_pd(e, _mm512_set1_pd(4503599627370496.0 + 1023.0));
+		}
+#endif // __AVX512F__
+		}
+	}
+}
+#endif // !SIMD_HPP
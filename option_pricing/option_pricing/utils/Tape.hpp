@@ -0,0 +1,218 @@
+/*
+* Tape.hpp
+* Provides template methods for reverse-mode (adjoint) differentiation.
+*
+* Every operation on Adjoint numbers appends a node to the calling thread's
+* Tape (see thread_tape) holding the partial derivatives of its result with
+* respect to its (at most two) operands. Seeding a result and sweeping the
+* tape backwards (propagate) then gives its derivative with respect to every
+* input at once, for a small constant multiple of the cost of recording it,
+* whatever the number of inputs.
+*
+* Nodes live in fixed blocks carved from an Arena. clear and rewind only
+* move the end of the tape back: blocks are kept, so recording the same
+* computation again allocates nothing. Rewinding to a mark after every path
+* of a simulation keeps the tape at the size of one path; the adjoints
+* accumulated on the nodes before the mark are swept once at the end.
+*
+* Hot loops need not be recorded node by node: a section can run on plain
+* doubles, keep what its reverse needs in the tape's scratch memory and
+* register a checkpoint, a hand-written reverse of the section that
+* propagate calls once every node recorded after it has been swept (see the
+* Adjoint roll of LatticeEngine.cpp).
+*
+* Node 0 stands for every constant: it has no operands and its adjoint is
+* meaningless. Adjoint comparisons compare values, so branches taken on the
+* recording are frozen into it (e.g. the exercise decisions of a lattice).
+*
+* Internal linkage for the same reason as Simd.hpp; a tape belongs to one
+* thread and one translation unit.
+*/
+#ifndef TAPE_HPP // Verify we have unique HPP file reference
+#define TAPE_HPP // Name the file TAPE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Arena.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+		namespace {
+
+		struct TapeNode
+		{
+			double partial[2]; // d(node)/d(parent[j])
+			double adjoint; // d(seeded results)/d(node), filled by propagate
+			uint32_t parent[2];
+		};
+
+		class Tape
+		{
+		public:
+			Tape() : m_size(0), m_capacity(0) { clear(); }
+
+			// Appends a node, returns its index
+			uint32_t record(uint32_t a, double da, uint32_t b, double db)
+			{
+				if (m_size == m_capacity) { grow(); }
+				TapeNode& node = at(m_size);
+				node.partial[0] = da;
+				node.partial[1] = db;
+				node.adjoint = 0.0;
+				node.parent[0] = a;
+				node.parent[1] = b;
+				return (uint32_t)m_size++;
+			}
+
+			size_t mark() const { return m_size; } // current end of the tape
+			// Forgets the nodes (and checkpoints) recorded after mark
+			void rewind(size_t mark)
+			{
+				m_size = (mark < 1) ? 1 : mark;
+				while (!m_checkpoints.empty() && m_checkpoints.back().position >= m_size) { m_checkpoints.pop_back(); }
+			}
+
+			// Forgets every node but the constant one, every checkpoint and the scratch memory
+			void clear()
+			{
+				m_size = 0;
+				record(0, 0.0, 0, 0.0);
+				m_checkpoints.clear();
+				m_scratch.reset();
+			}
+
+			// Memory for checkpoints, valid until the next clear
+			void* allocate(size_t bytes) { return m_scratch.allocate(bytes, 64); }
+
+			// propagate calls backward once every node from position on has been swept, before the nodes below;
+			// backward seeds the adjoints of the section's inputs. Positions are registered in increasing order
+			void checkpoint(size_t position, const function<void()>& backward)
+			{
+				Checkpoint c;
+				c.position = position;
+				c.backward = backward;
+				m_checkpoints.push_back(c);
+			}
+
+			void seed(uint32_t node, double adjoint) { at(node).adjoint += adjoint; }
+			double adjoint(uint32_t node) const { return m_blocks[node / BLOCK_NODES][node % BLOCK_NODES].adjoint; }
+
+			// Sweeps nodes from the end of the tape down to first, pushing each adjoint onto its operands
+			void propagate(size_t first)
+			{
+				if (first < 1) { first = 1; }
+				size_t c = m_checkpoints.size();
+				for (size_t i = m_size; i > first; i--)
+				{
+					for (; c > 0 && m_checkpoints[c - 1].position >= i; c--) { m_checkpoints[c - 1].backward(); }
+					const TapeNode& node = at(i - 1);
+					if (node.adjoint == 0.0) { continue; }
+					at(node.parent[0]).adjoint += node.partial[0] * node.adjoint;
+					at(node.parent[1]).adjoint += node.partial[1] * node.adjoint;
+				}
+				for (; c > 0 && m_checkpoints[c - 1].position >= first; c--) { m_checkpoints[c - 1].backward(); }
+			}
+
+			size_t size() const { return m_size; }
+			size_t bytes_reserved() const { return m_arena.bytes_reserved() + m_scratch.bytes_reserved(); }
+
+		private:
+			static const size_t BLOCK_NODES = 16384; // 512 KiB per block
+
+			Tape(const Tape& t); // Non copyable: owns its arena
+			Tape& operator = (const Tape& source);
+
+			TapeNode& at(size_t i) { return m_blocks[i / BLOCK_NODES][i % BLOCK_NODES]; }
+
+			void grow()
+			{
+				m_blocks.push_back((TapeNode*)m_arena.allocate(BLOCK_NODES * sizeof(TapeNode), 64));
+				m_capacity += BLOCK_NODES;
+			}
+
+			struct Checkpoint {
+				size_t position;
+				function<void()> backward;
+			};
+
+			Arena m_arena;
+			Arena m_scratch; // checkpoint memory
+			vector<TapeNode*> m_blocks;
+			vector<Checkpoint> m_checkpoints;
+			size_t m_size; // nodes recorded
+			size_t m_capacity; // nodes held by m_blocks
+		};
+
+		// Tape recording the calling thread's Adjoint operations, kept (with its memory) for the thread's lifetime
+		inline Tape& thread_tape()
+		{
+			static thread_local Tape tape;
+			return tape;
+		}
+
+		struct Adjoint
+		{
+			double value;
+			uint32_t node; // 0 for constants
+
+			Adjoint() : value(0.0), node(0) {}
+			Adjoint(double v) : value(v), node(0) {} // constant
+			Adjoint(double v, uint32_t n) : value(v), node(n) {}
+		};
+
+		// Returns a new input of the thread's tape
+		inline Adjoint adjoint_input(double value) { return Adjoint(value, thread_tape().record(0, 0.0, 0, 0.0)); }
+
+		// Returns f(x) given f(x.value) and f'(x.value)
+		inline Adjoint adjoint_chain(const Adjoint& x, double f, double df)
+		{
+			if (x.node == 0) { return Adjoint(f); }
+			return Adjoint(f, thread_tape().record(x.node, df, 0, 0.0));
+		}
+
+		// Returns f(a, b) given its value and partial derivatives
+		inline Adjoint adjoint_chain(const Adjoint& a, const Adjoint& b, double f, double da, double db)
+		{
+			if (a.node == 0 && b.node == 0) { return Adjoint(f); }
+			return Adjoint(f, thread_tape().record(a.node, da, b.node, db));
+		}
+
+		inline Adjoint operator + (const Adjoint& a, const Adjoint& b) { return adjoint_chain(a, b, a.value + b.value, 1.0, 1.0); }
+		inline Adjoint operator + (const Adjoint& a, double b) { return adjoint_chain(a, a.value + b, 1.0); }
+		inline Adjoint operator + (double a, const Adjoint& b) { return adjoint_chain(b, a + b.value, 1.0); }
+
+		inline Adjoint operator - (const Adjoint& a, const Adjoint& b) { return adjoint_chain(a, b, a.value - b.value, 1.0, -1.0); }
+		inline Adjoint operator - (const Adjoint& a, double b) { return adjoint_chain(a, a.value - b, 1.0); }
+		inline Adjoint operator - (double a, const Adjoint& b) { return adjoint_chain(b, a - b.value, -1.0); }
+		inline Adjoint operator - (const Adjoint& a) { return adjoint_chain(a, -a.value, -1.0); }
+
+		inline Adjoint operator * (const Adjoint& a, const Adjoint& b) { return adjoint_chain(a, b, a.value * b.value, b.value, a.value); }
+		inline Adjoint operator * (const Adjoint& a, double b) { return adjoint_chain(a, a.value * b, b); }
+		inline Adjoint operator * (double a, const Adjoint& b) { return adjoint_chain(b, a * b.value, a); }
+
+		inline Adjoint operator / (const Adjoint& a, const Adjoint& b)
+		{
+			double q = a.value / b.value;
+			return adjoint_chain(a, b, q, 1.0 / b.value, -q / b.value);
+		}
+		inline Adjoint operator / (const Adjoint& a, double b) { return adjoint_chain(a, a.value / b, 1.0 / b); }
+		inline Adjoint operator / (double a, const Adjoint& b)
+		{
+			double q = a / b.value;
+			return adjoint_chain(b, q, -q / b.value);
+		}
+
+		inline bool operator < (const Adjoint& a, const Adjoint& b) { return a.value < b.value; }
+		inline bool operator > (const Adjoint& a, const Adjoint& b) { return a.value > b.value; }
+		inline bool operator <= (const Adjoint& a, const Adjoint& b) { return a.value <= b.value; }
+		inline bool operator >= (const Adjoint& a, const Adjoint& b) { return a.value >= b.value; }
+
+		}
+	}
+}
+#endif // !TAPE_HPP
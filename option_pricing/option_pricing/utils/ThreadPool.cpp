@@ -0,0 +1,185 @@
+/*
+* ThreadPool.cpp
+* Defines the ThreadPool class methods
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+
+		struct ThreadPool::Job
+		{
+			const function<void(size_t, size_t)>* body;
+			atomic<size_t> remaining; // chunks not finished yet
+			atomic<bool> failed; // a chunk threw: the chunks left are skipped
+			exception_ptr error; // first exception thrown by body, guarded by m
+			mutex m;
+			condition_variable done;
+		};
+
+		ThreadPool::ThreadPool() : ThreadPool(hardware_threads()) {}
+
+		ThreadPool::ThreadPool(size_t threads) : queued(0), stopping(false)
+		{
+			if (threads == 0) { threads = 1; }
+			for (size_t i = 0; i < threads; i++)
+			{
+				queues.push_back(unique_ptr<TaskQueue>(new TaskQueue()));
+			}
+			for (size_t i = 1; i < threads; i++) // the calling thread is thread 0
+			{
+				workers.push_back(thread(&ThreadPool::worker_loop, this, i));
+			}
+		}
+
+		ThreadPool::~ThreadPool()
+		{
+			{
+				lock_guard<mutex> lock(sleep_mutex);
+				stopping = true;
+			}
+			sleep_cv.notify_all();
+			for (size_t i = 0; i < workers.size(); i++)
+			{
+				workers[i].join();
+			}
+		}
+
+		size_t ThreadPool::size() const { return queues.size(); }
+
+		size_t ThreadPool::hardware_threads()
+		{
+			size_t n = thread::hardware_concurrency();
+			return n == 0 ? 1 : n;
+		}
+
+		void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain, const function<void(size_t, size_t)>& body)
+		{
+			if (end <= begin) { return; }
+			if (grain == 0) { grain = 1; }
+			size_t chunks = (end - begin + grain - 1) / grain;
+			if (queues.size() == 1 || chunks == 1) // Nothing to share, run inline
+			{
+				body(begin, end);
+				return;
+			}
+
+			Job job;
+			job.body = &body;
+			job.remaining = chunks;
+			job.failed = false;
+
+			// Deal contiguous chunks round-robin so every deque starts with local work
+			for (size_t c = 0; c < chunks; c++)
+			{
+				Task task = { &job, begin + c * grain, min(end, begin + (c + 1) * grain) };
+				TaskQueue& q = *queues[c % queues.size()];
+				lock_guard<mutex> lock(q.m);
+				q.tasks.push_back(task);
+			}
+			{
+				lock_guard<mutex> lock(sleep_mutex);
+				queued += chunks;
+			}
+			sleep_cv.notify_all();
+
+			// The caller works too, then waits for chunks still running elsewhere
+			Task task;
+			while (job.remaining.load() > 0 && pop_task(0, task))
+			{
+				run_task(task);
+			}
+			unique_lock<mutex> lock(job.m);
+			job.done.wait(lock, [&job]() { return job.remaining.load() == 0; });
+			if (job.error) { rethrow_exception(job.error); } // on the calling thread, once no chunk still uses job
+		}
+
+		void ThreadPool::worker_loop(size_t index)
+		{
+			while (true)
+			{
+				Task task;
+				if (pop_task(index, task))
+				{
+					run_task(task);
+					continue;
+				}
+				unique_lock<mutex> lock(sleep_mutex);
+				sleep_cv.wait(lock, [this]() { return stopping.load() || queued.load() > 0; });
+				if (stopping.load() && queued.load() == 0) { return; }
+			}
+		}
+
+		bool ThreadPool::pop_task(size_t index, Task& task)
+		{
+			// Own deque first, newest chunk (back)
+			{
+				TaskQueue& q = *queues[index];
+				lock_guard<mutex> lock(q.m);
+				if (!q.tasks.empty())
+				{
+					task = q.tasks.back();
+					q.tasks.pop_back();
+					queued--;
+					return true;
+				}
+			}
+			// Otherwise steal the oldest chunk (front) of another deque
+			for (size_t i = 1; i < queues.size(); i++)
+			{
+				TaskQueue& q = *queues[(index + i) % queues.size()];
+				lock_guard<mutex> lock(q.m);
+				if (!q.tasks.empty())
+				{
+					task = q.tasks.front();
+					q.tasks.pop_front();
+					queued--;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void ThreadPool::run_task(const Task& task)
+		{
+			Job* job = task.job;
+			exception_ptr error;
+			if (!job->failed.load())
+			{
+				try
+				{
+					(*job->body)(task.first, task.last);
+				}
+				catch (...) // a worker must not die, nor leave the caller waiting: parallel_for rethrows it
+				{
+					error = current_exception();
+				}
+			}
+
+			// Decrement under the job's lock: the waiting caller owns job and may destroy it as soon as it sees zero
+			lock_guard<mutex> lock(job->m);
+			if (error && !job->error)
+			{
+				job->error = error;
+				job->failed = true;
+			}
+			if (job->remaining.fetch_sub(1) == 1) // last chunk of the job
+			{
+				job->done.notify_all();
+			}
+		}
+	}
+}
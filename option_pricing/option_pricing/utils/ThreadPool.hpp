@@ -0,0 +1,60 @@
+/*
+* ThreadPool.hpp
+* Provides template methods for a reusable work-stealing Thread Pool.
+*
+* Each thread owns a task deque: it pops its own work from the back and,
+* when empty, steals from the front of the other deques. The thread calling
+* parallel_for takes part in the work, so a pool of size 1 runs serially.
+*/
+#ifndef THREAD_POOL_HPP // Verify we have unique HPP file reference
+#define THREAD_POOL_HPP // Name the file THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace Colin {
+	namespace Utils {
+		class ThreadPool
+		{
+		public:
+			ThreadPool(); // Default constructor: one thread per hardware thread
+			ThreadPool(size_t threads); // Pool running on threads threads, including the caller
+			~ThreadPool(); // Destructor: joins all workers
+
+			size_t size() const; // Number of threads taking part in parallel_for
+			static size_t hardware_threads(); // Hardware concurrency, at least 1
+
+			// Runs body(first, last) over [begin, end) split into chunks of grain indices, returns when all chunks are done.
+			// If body throws, the chunks not started yet are skipped and the first exception is rethrown here.
+			void parallel_for(size_t begin, size_t end, size_t grain, const function<void(size_t, size_t)>& body);
+
+		private:
+			ThreadPool(const ThreadPool& tp); // Non copyable: owns threads
+			ThreadPool& operator = (const ThreadPool& source);
+
+			struct Job; // One parallel_for call
+			struct Task { Job* job; size_t first; size_t last; }; // One chunk of a job
+			struct TaskQueue { mutex m; deque<Task> tasks; }; // Per thread deque
+
+			void worker_loop(size_t index); // Body of each background thread
+			bool pop_task(size_t index, Task& task); // Pops own work or steals from other deques
+			void run_task(const Task& task); // Executes a chunk and signals its job
+
+			vector<unique_ptr<TaskQueue>> queues; // queues[0] belongs to calling threads, queues[i] to worker i
+			vector<thread> workers;
+			atomic<size_t> queued; // tasks waiting in any queue
+			atomic<bool> stopping;
+			mutex sleep_mutex;
+			condition_variable sleep_cv; // wakes idle workers when tasks arrive
+		};
+	}
+}
+#endif // !THREAD_POOL_HPP